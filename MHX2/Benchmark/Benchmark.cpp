@@ -0,0 +1,615 @@
+/****************************************************************************
+ * ==> Benchmark -----------------------------------------------------------*
+ ****************************************************************************
+ * Description : Skinning and loading benchmarks                            *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+// std
+#include <cstdio>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <memory>
+#include <cmath>
+
+// classes
+#include "Quaternion.h"
+#include "SkinningHelper.h"
+#include "AnimationSampler.h"
+#include "PoseBlender.h"
+#include "MHX2Model.h"
+
+//------------------------------------------------------------------------------
+const std::size_t g_BoneCount   = 64;
+const std::size_t g_VertexCount = 100000;
+const std::size_t g_Passes      = 20;
+const std::size_t g_AnimSets    = 4;
+const std::size_t g_AnimKeys    = 30;
+const std::size_t g_BlendPasses = 200;
+const std::size_t g_ReadPasses  = 5;
+const std::size_t g_GridWidth   = 200;
+const std::size_t g_GridHeight  = 250;
+//------------------------------------------------------------------------------
+std::mt19937 g_Random(1);
+//------------------------------------------------------------------------------
+/**
+* Skinning benchmark buffers
+*/
+struct ISkinBuffers
+{
+    Model::IMatrices            m_Bones;
+    SkinningHelper::IPalette    m_Palette;
+    SkinningHelper::IPalette    m_DQPalette;
+    std::vector<unsigned short> m_BoneIndices;
+    std::vector<float>          m_Weights;
+    std::vector<float>          m_Src;
+    std::vector<float>          m_Dst;
+};
+//------------------------------------------------------------------------------
+/**
+* Gets a random value
+*@param min - min value
+*@param max - max value
+*@return random value between min and max
+*/
+float GetRandom(float min, float max)
+{
+    return std::uniform_real_distribution<float>(min, max)(g_Random);
+}
+//------------------------------------------------------------------------------
+/**
+* Gets the elapsed time since a start time
+*@param start - start time
+*@return elapsed time in milliseconds
+*/
+double GetElapsed(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+//------------------------------------------------------------------------------
+/**
+* Builds the skinning buffers, with rigid bone transformations, thus both skinning methods may use them
+*@param slotCount - influence slot count per vertex
+*@param stride - vertex stride in floats, the normal follows the position if at least 6
+*@param[out] buffers - buffers to build
+*/
+void BuildSkinBuffers(std::size_t slotCount, std::size_t stride, ISkinBuffers& buffers)
+{
+    buffers.m_Bones.resize(g_BoneCount);
+
+    for (std::size_t i = 0; i < g_BoneCount; ++i)
+    {
+        const QuaternionF rotation = QuaternionF(GetRandom(-1.0f, 1.0f),
+                                                 GetRandom(-1.0f, 1.0f),
+                                                 GetRandom(-1.0f, 1.0f),
+                                                 GetRandom(-1.0f, 1.0f)).Normalize();
+
+        buffers.m_Bones[i]               = rotation.ToMatrix();
+        buffers.m_Bones[i].m_Table[3][0] = GetRandom(-5.0f, 5.0f);
+        buffers.m_Bones[i].m_Table[3][1] = GetRandom(-5.0f, 5.0f);
+        buffers.m_Bones[i].m_Table[3][2] = GetRandom(-5.0f, 5.0f);
+    }
+
+    SkinningHelper::BuildPalette(buffers.m_Bones, buffers.m_Palette);
+    SkinningHelper::BuildDQPalette(buffers.m_Bones, buffers.m_DQPalette);
+
+    buffers.m_BoneIndices.resize(g_VertexCount * slotCount);
+    buffers.m_Weights.resize(g_VertexCount * slotCount);
+
+    // the weights are sorted by decreasing value, and sum to 1
+    for (std::size_t i = 0; i < g_VertexCount; ++i)
+    {
+        float total = 0.0f;
+
+        for (std::size_t j = 0; j < slotCount; ++j)
+        {
+            buffers.m_BoneIndices[i * slotCount + j] = (unsigned short)(g_Random() % g_BoneCount);
+            buffers.m_Weights[i * slotCount + j]     = 1.0f / float(j + 1);
+            total                                    += buffers.m_Weights[i * slotCount + j];
+        }
+
+        for (std::size_t j = 0; j < slotCount; ++j)
+            buffers.m_Weights[i * slotCount + j] /= total;
+    }
+
+    buffers.m_Src.resize(g_VertexCount * stride);
+    buffers.m_Dst.resize(g_VertexCount * stride);
+
+    for (std::size_t i = 0; i < buffers.m_Src.size(); ++i)
+        buffers.m_Src[i] = GetRandom(-1.0f, 1.0f);
+}
+//------------------------------------------------------------------------------
+/**
+* Gets the skinning data matching with the skinning buffers
+*@param buffers - skinning buffers
+*@param method - skinning method
+*@param slotCount - influence slot count per vertex
+*@param stride - vertex stride in floats
+*@param normals - if true, the normals are also skinned
+*@return skinning data
+*/
+SkinningHelper::ISkinData GetSkinData(ISkinBuffers&            buffers,
+                                      SkinningHelper::IEMethod method,
+                                      std::size_t              slotCount,
+                                      std::size_t              stride,
+                                      bool                     normals)
+{
+    const bool dualQuaternion = (method == SkinningHelper::IEMethod::IE_M_DualQuaternion);
+
+    SkinningHelper::ISkinData data;
+    data.m_Method       = method;
+    data.m_pPalette     = dualQuaternion ? &buffers.m_DQPalette[0] : &buffers.m_Palette[0];
+    data.m_pBoneIndices = &buffers.m_BoneIndices[0];
+    data.m_pWeights     = &buffers.m_Weights[0];
+    data.m_pSrc         = &buffers.m_Src[0];
+    data.m_pDst         = &buffers.m_Dst[0];
+    data.m_pSrcNormals  = normals ? &buffers.m_Src[3] : nullptr;
+    data.m_pDstNormals  = normals ? &buffers.m_Dst[3] : nullptr;
+    data.m_SlotCount    = slotCount;
+    data.m_Stride       = stride;
+    data.m_NormalStride = normals ? stride : 0;
+    data.m_Count        = g_VertexCount;
+
+    return data;
+}
+//------------------------------------------------------------------------------
+/**
+* Measures the skinning time
+*@param data - skinning data
+*@param kernel - skinning kernel
+*@return skinning time per pass, in milliseconds
+*/
+double MeasureSkinning(const SkinningHelper::ISkinData& data, SkinningHelper::IEKernel kernel)
+{
+    // warm up the caches
+    SkinningHelper::Skin(data, kernel);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < g_Passes; ++i)
+        SkinningHelper::Skin(data, kernel);
+
+    return GetElapsed(start) / double(g_Passes);
+}
+//------------------------------------------------------------------------------
+/**
+* Gets a kernel name
+*@param kernel - kernel
+*@return kernel name
+*/
+const char* GetKernelName(SkinningHelper::IEKernel kernel)
+{
+    switch (kernel)
+    {
+        case SkinningHelper::IEKernel::IE_K_Scalar: return "scalar";
+        case SkinningHelper::IEKernel::IE_K_SSE41:  return "sse4.1";
+        case SkinningHelper::IEKernel::IE_K_AVX2:   return "avx2";
+        case SkinningHelper::IEKernel::IE_K_AVX512: return "avx-512";
+        default:                                    return "unknown";
+    }
+}
+//------------------------------------------------------------------------------
+/**
+* Compares the dual quaternion and the linear blend skinning costs, for each kernel the CPU supports
+*/
+void BenchSkinningMethods()
+{
+    const std::size_t stride = 8;
+
+    std::printf("\nDual quaternion vs linear blend skinning, %u vertices with normals\n", unsigned(g_VertexCount));
+    std::printf("%-10s %6s %12s %12s %8s\n", "kernel", "slots", "linear (ms)", "dq (ms)", "ratio");
+
+    const std::size_t slotCounts[3] = {2, 4, 8};
+
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        ISkinBuffers buffers;
+        BuildSkinBuffers(slotCounts[i], stride, buffers);
+
+        for (int j = int(SkinningHelper::IEKernel::IE_K_Scalar); j <= int(SkinningHelper::IEKernel::IE_K_AVX512); ++j)
+        {
+            const SkinningHelper::IEKernel kernel = SkinningHelper::IEKernel(j);
+
+            if (!SkinningHelper::IsSupported(kernel))
+                continue;
+
+            const double linear = MeasureSkinning(GetSkinData(buffers,
+                                                              SkinningHelper::IEMethod::IE_M_Linear,
+                                                              slotCounts[i],
+                                                              stride,
+                                                              true),
+                                                  kernel);
+            const double dq     = MeasureSkinning(GetSkinData(buffers,
+                                                              SkinningHelper::IEMethod::IE_M_DualQuaternion,
+                                                              slotCounts[i],
+                                                              stride,
+                                                              true),
+                                                  kernel);
+
+            std::printf("%-10s %6u %12.3f %12.3f %8.2f\n",
+                        GetKernelName(kernel),
+                        unsigned(slotCounts[i]),
+                        linear,
+                        dq,
+                        dq / linear);
+        }
+    }
+}
+//------------------------------------------------------------------------------
+/**
+* Measures the cost of the normal stream on the linear blend skinning, for each kernel the CPU supports
+*/
+void BenchNormalStream()
+{
+    const std::size_t stride = 8;
+
+    std::printf("\nNormal stream cost, linear blend skinning, %u vertices\n", unsigned(g_VertexCount));
+    std::printf("%-10s %6s %15s %15s %8s\n", "kernel", "slots", "positions (ms)", "normals (ms)", "ratio");
+
+    const std::size_t slotCounts[3] = {2, 4, 8};
+
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        ISkinBuffers buffers;
+        BuildSkinBuffers(slotCounts[i], stride, buffers);
+
+        for (int j = int(SkinningHelper::IEKernel::IE_K_Scalar); j <= int(SkinningHelper::IEKernel::IE_K_AVX512); ++j)
+        {
+            const SkinningHelper::IEKernel kernel = SkinningHelper::IEKernel(j);
+
+            if (!SkinningHelper::IsSupported(kernel))
+                continue;
+
+            const double positions = MeasureSkinning(GetSkinData(buffers,
+                                                                 SkinningHelper::IEMethod::IE_M_Linear,
+                                                                 slotCounts[i],
+                                                                 stride,
+                                                                 false),
+                                                     kernel);
+            const double normals   = MeasureSkinning(GetSkinData(buffers,
+                                                                 SkinningHelper::IEMethod::IE_M_Linear,
+                                                                 slotCounts[i],
+                                                                 stride,
+                                                                 true),
+                                                     kernel);
+
+            std::printf("%-10s %6u %15.3f %15.3f %8.2f\n",
+                        GetKernelName(kernel),
+                        unsigned(slotCounts[i]),
+                        positions,
+                        normals,
+                        normals / positions);
+        }
+    }
+}
+//------------------------------------------------------------------------------
+/**
+* Builds an animated model, whose skeleton is a binary tree
+*@param[out] model - model to build
+*@note The model doesn't own its skeleton and animation sets, ReleaseAnimatedModel() should be called to delete them
+*/
+void BuildAnimatedModel(Model& model)
+{
+    std::vector<Model::IBone*> bones(g_BoneCount);
+
+    for (std::size_t i = 0; i < g_BoneCount; ++i)
+    {
+        bones[i]                         = new Model::IBone();
+        bones[i]->m_Name                 = "bone" + std::to_string(i);
+        bones[i]->m_Matrix.m_Table[3][1] = 0.1f;
+
+        if (!i)
+            continue;
+
+        bones[i]->m_pParent = bones[(i - 1) / 2];
+        bones[i]->m_pParent->m_Children.push_back(bones[i]);
+    }
+
+    model.m_pSkeleton = bones[0];
+    model.BuildBoneTable();
+
+    // each animation set rotates all the bones, over one second
+    for (std::size_t i = 0; i < g_AnimSets; ++i)
+    {
+        Model::IAnimationSet* pAnimSet = new Model::IAnimationSet();
+        pAnimSet->m_MaxValue           = AnimationSampler::m_TicksPerSecond;
+        model.m_AnimationSet.push_back(pAnimSet);
+
+        for (std::size_t j = 0; j < g_BoneCount; ++j)
+        {
+            Model::IAnimation* pAnimation = new Model::IAnimation();
+            pAnimation->m_BoneName        = bones[j]->m_Name;
+            pAnimation->m_pBone           = bones[j];
+            pAnimSet->m_Animations.push_back(pAnimation);
+
+            Model::IAnimationKeys* pRotations = new Model::IAnimationKeys();
+            pRotations->m_Type                = Model::IEAnimKeyType::IE_KT_Rotation;
+            pAnimation->m_Keys.push_back(pRotations);
+
+            for (std::size_t k = 0; k <= g_AnimKeys; ++k)
+            {
+                const float       angle    = float(k + i + j) * 0.1f;
+                const QuaternionF rotation = QuaternionF(0.3f * std::sin(angle),
+                                                         0.2f * std::cos(angle),
+                                                         0.1f,
+                                                         1.0f).Normalize();
+
+                Model::IAnimationKey* pKey = new Model::IAnimationKey();
+                pKey->m_Frame              = k;
+                pKey->m_TimeStamp          = (AnimationSampler::m_TicksPerSecond * (long long)k) /
+                                                     (long long)g_AnimKeys;
+                pKey->m_Values             = {rotation.m_X, rotation.m_Y, rotation.m_Z, rotation.m_W};
+                pRotations->m_Keys.push_back(pKey);
+            }
+
+            Model::IAnimationKeys* pPositions = new Model::IAnimationKeys();
+            pPositions->m_Type                = Model::IEAnimKeyType::IE_KT_Position;
+            pAnimation->m_Keys.push_back(pPositions);
+
+            Model::IAnimationKey* pKey = new Model::IAnimationKey();
+            pKey->m_Values             = {bones[j]->m_Matrix.m_Table[3][0],
+                                          bones[j]->m_Matrix.m_Table[3][1],
+                                          bones[j]->m_Matrix.m_Table[3][2]};
+            pPositions->m_Keys.push_back(pKey);
+        }
+    }
+}
+//------------------------------------------------------------------------------
+/**
+* Releases the skeleton and the animation sets of a model built by BuildAnimatedModel()
+*@param model - model to release
+*/
+void ReleaseAnimatedModel(Model& model)
+{
+    for (std::size_t i = 0; i < model.m_AnimationSet.size(); ++i)
+        delete model.m_AnimationSet[i];
+
+    model.m_AnimationSet.clear();
+
+    delete model.m_pSkeleton;
+    model.m_pSkeleton = nullptr;
+}
+//------------------------------------------------------------------------------
+/**
+* Measures the pose blending cost for 1, 10 and 100 active layers
+*/
+void BenchPoseBlending()
+{
+    Model model;
+    BuildAnimatedModel(model);
+
+    // the masked layers only apply on the half of the skeleton below the second bone
+    PoseBlender::IMask mask;
+    PoseBlender::BuildMask(model, "bone1", mask);
+
+    std::printf("\nPose blending, %u bones\n", unsigned(g_BoneCount));
+    std::printf("%-8s %15s %15s\n", "layers", "evaluate (ms)", "per layer (us)");
+
+    const std::size_t layerCounts[3] = {1, 10, 100};
+
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        PoseBlender blender;
+
+        if (!blender.SetLayerCount(model, layerCounts[i]))
+        {
+            std::printf("%-8u failed to create the layers\n", unsigned(layerCounts[i]));
+            continue;
+        }
+
+        // the first layer overrides the bind pose, the next ones alternate the additive and the override modes
+        for (std::size_t j = 0; j < layerCounts[i]; ++j)
+        {
+            PoseBlender::ILayer* pLayer = blender.GetLayer(j);
+            pLayer->m_AnimSetIndex      = int(j % g_AnimSets);
+            pLayer->m_Weight            = j ? 0.5f : 1.0f;
+            pLayer->m_Mode              = (j % 2) ? PoseBlender::IEBlendMode::IE_BM_Additive :
+                                                    PoseBlender::IEBlendMode::IE_BM_Override;
+            pLayer->m_pMask             = (j % 3 == 2) ? &mask : nullptr;
+        }
+
+        Model::IMatrices localPose;
+
+        // warm up the caches
+        blender.Evaluate(localPose);
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (std::size_t j = 0; j < g_BlendPasses; ++j)
+        {
+            for (std::size_t k = 0; k < layerCounts[i]; ++k)
+                blender.GetLayer(k)->m_ElapsedTime = double(j) * 0.016 + double(k) * 0.01;
+
+            blender.Evaluate(localPose);
+        }
+
+        const double elapsed = GetElapsed(start) / double(g_BlendPasses);
+
+        std::printf("%-8u %15.4f %15.3f\n",
+                    unsigned(layerCounts[i]),
+                    elapsed,
+                    (elapsed * 1000.0) / double(layerCounts[i]));
+    }
+
+    ReleaseAnimatedModel(model);
+}
+//------------------------------------------------------------------------------
+/**
+* Builds a mhx2 document containing a skinned grid, whose skeleton is a binary tree
+*@return mhx2 document
+*/
+std::string BuildMHX2Data()
+{
+    std::ostringstream data;
+
+    data << "{\"mhx2_version\":\"0.27\",\"skeleton\":{\"name\":\"skeleton\",\"offset\":[0,0,0],\"scale\":1,\"bones\":[";
+
+    // the bone matrices are relative to the model, each bone is a bit higher than its parent
+    for (std::size_t i = 0; i < g_BoneCount; ++i)
+    {
+        std::size_t depth = 0;
+
+        for (std::size_t j = i; j; j = (j - 1) / 2)
+            ++depth;
+
+        const float y = float(depth) * 0.1f;
+
+        data << (i ? "," : "") << "{\"name\":\"bone" << i << "\",";
+
+        if (i)
+            data << "\"parent\":\"bone" << (i - 1) / 2 << "\",";
+
+        data << "\"head\":[0," << y << ",0],\"tail\":[0," << (y + 0.1f) << ",0],\"roll\":0,"
+             << "\"matrix\":[[1,0,0,0],[0,1,0," << y << "],[0,0,1,0],[0,0,0,1]]}";
+    }
+
+    data << "]},\"materials\":[],\"geometries\":[{\"name\":\"grid\",\"uuid\":\"grid\",\"material\":\"\","
+         << "\"offset\":[0,0,0],\"scale\":1,\"mesh\":{\"vertices\":[";
+
+    for (std::size_t i = 0; i < g_GridHeight; ++i)
+        for (std::size_t j = 0; j < g_GridWidth; ++j)
+            data << ((i || j) ? "," : "") << "[" << (float(j) * 0.01f) << "," << (float(i) * 0.01f) << ",0]";
+
+    data << "],\"faces\":[";
+
+    for (std::size_t i = 0; i < g_GridHeight - 1; ++i)
+        for (std::size_t j = 0; j < g_GridWidth - 1; ++j)
+        {
+            const std::size_t index = i * g_GridWidth + j;
+
+            data << ((i || j) ? "," : "") << "[" << index << "," << (index + 1) << ","
+                 << (index + g_GridWidth + 1) << "," << (index + g_GridWidth) << "]";
+        }
+
+    data << "],\"uv_coordinates\":[[0,0]],\"uv_faces\":[";
+
+    for (std::size_t i = 0; i < (g_GridHeight - 1) * (g_GridWidth - 1); ++i)
+        data << (i ? "," : "") << "[0,0,0,0]";
+
+    data << "],\"weights\":{";
+
+    // each vertex is influenced by 2 bones, the first one by its row, the second one by its column
+    for (std::size_t i = 0; i < g_BoneCount; ++i)
+    {
+        data << (i ? "," : "") << "\"bone" << i << "\":[";
+
+        bool first = true;
+
+        for (std::size_t j = 0; j < g_GridHeight; ++j)
+            for (std::size_t k = 0; k < g_GridWidth; ++k)
+            {
+                const std::size_t rowBone    = j % g_BoneCount;
+                const std::size_t columnBone = (rowBone + 1 + k % (g_BoneCount - 1)) % g_BoneCount;
+
+                if (i != rowBone && i != columnBone)
+                    continue;
+
+                data << (first ? "" : ",") << "[" << (j * g_GridWidth + k) << "," << (i == rowBone ? 0.7f : 0.3f)
+                     << "]";
+
+                first = false;
+            }
+
+        data << "]";
+    }
+
+    data << "}}}]}";
+
+    return data.str();
+}
+//------------------------------------------------------------------------------
+/**
+* Measures the mhx2 parsing and the skinning costs, which depend on the math types layout
+*/
+void BenchParsingAndSkinning()
+{
+    std::printf("\nParsing and skinning, Vector3F %u bytes, QuaternionF %u bytes, Matrix4x4F %u bytes\n",
+                unsigned(sizeof(Vector3F)),
+                unsigned(sizeof(QuaternionF)),
+                unsigned(sizeof(Matrix4x4F)));
+
+    const std::string data = BuildMHX2Data();
+
+    MHX2Model mhx2;
+    double    readTime = 0.0;
+
+    for (std::size_t i = 0; i < g_ReadPasses; ++i)
+    {
+        // the json parser works in place, thus each pass reads its own copy
+        const std::string document = data;
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        if (!mhx2.Read(document))
+        {
+            std::printf("failed to read the mhx2 document\n");
+            return;
+        }
+
+        readTime += GetElapsed(start) / double(g_ReadPasses);
+    }
+
+    std::shared_ptr<const Model>   pModel = mhx2.GetSharedModel();
+    std::unique_ptr<ModelInstance> pInstance(mhx2.CreateInstance());
+
+    // rotate all the bones around their parent
+    const Matrix4x4F rotation = QuaternionF(0.1f, 0.0f, 0.2f, 1.0f).Normalize().ToMatrix();
+    Model::IMatrices localPose(pModel->m_BoneTable.m_Local.size());
+
+    for (std::size_t i = 0; i < localPose.size(); ++i)
+        localPose[i] = rotation.Multiply(pModel->m_BoneTable.m_Local[i]);
+
+    // warm up the caches
+    pInstance->Update(localPose);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < g_Passes; ++i)
+        pInstance->Update(localPose);
+
+    const double skinTime = GetElapsed(start) / double(g_Passes);
+
+    std::printf("%-10s %12s %12s %12s\n", "document", "vertices", "read (ms)", "skin (ms)");
+    std::printf("%-10s %12u %12.3f %12.3f\n",
+                (std::to_string(data.size() / 1024) + "KB").c_str(),
+                unsigned(pModel->m_Mesh[0]->m_VB[0]->GetVertexCount()),
+                readTime,
+                skinTime);
+}
+//------------------------------------------------------------------------------
+int main()
+{
+    std::printf("Best skinning kernel: %s\n", GetKernelName(SkinningHelper::GetBestKernel()));
+
+    BenchNormalStream();
+    BenchSkinningMethods();
+    BenchPoseBlending();
+    BenchParsingAndSkinning();
+
+    return 0;
+}
+//------------------------------------------------------------------------------
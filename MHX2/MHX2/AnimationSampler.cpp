@@ -0,0 +1,476 @@
+/****************************************************************************
+ * ==> AnimationSampler ----------------------------------------------------*
+ ****************************************************************************
+ * Description : Keyframe animation sampler, writes a flat local pose       *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "AnimationSampler.h"
+
+// std
+#include <cmath>
+#include <algorithm>
+
+// classes
+#include "Quaternion.h"
+#include "CompressedAnimation.h"
+
+// the rotations are interpolated by SSE2 instructions when available
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ANIMATION_SAMPLER_SSE2
+
+    // std
+    #include <emmintrin.h>
+#endif
+
+//---------------------------------------------------------------------------
+// AnimationSampler::ITrack
+//---------------------------------------------------------------------------
+AnimationSampler::ITrack::ITrack() :
+    m_pKeys(nullptr),
+    m_Cursor(0)
+{}
+//---------------------------------------------------------------------------
+AnimationSampler::ITrack::~ITrack()
+{}
+//---------------------------------------------------------------------------
+// AnimationSampler::IChannel
+//---------------------------------------------------------------------------
+AnimationSampler::IChannel::IChannel() :
+    m_BoneIndex(0)
+{
+    m_BindScale[0] = 1.0f;
+    m_BindScale[1] = 1.0f;
+    m_BindScale[2] = 1.0f;
+}
+//---------------------------------------------------------------------------
+AnimationSampler::IChannel::~IChannel()
+{}
+//---------------------------------------------------------------------------
+// AnimationSampler
+//---------------------------------------------------------------------------
+AnimationSampler::AnimationSampler() :
+    m_pModel(nullptr),
+    m_pAnimSet(nullptr),
+    m_Interpolation(IEInterpolation::IE_I_Nlerp)
+{}
+//---------------------------------------------------------------------------
+AnimationSampler::~AnimationSampler()
+{}
+//---------------------------------------------------------------------------
+void AnimationSampler::SetInterpolation(IEInterpolation interpolation)
+{
+    m_Interpolation = interpolation;
+}
+//---------------------------------------------------------------------------
+bool AnimationSampler::Sample(const Model&               model,
+                                    int                  animSetIndex,
+                                    double               elapsedTime,
+                                    Model::IMatrices&    localPose,
+                              const Model::ISkeletonLOD* pLOD)
+{
+    // invalid animation set?
+    if (animSetIndex < 0 || std::size_t(animSetIndex) >= model.m_AnimationSet.size())
+        return false;
+
+    const Model::IAnimationSet* pAnimSet = model.m_AnimationSet[animSetIndex];
+
+    if (!pAnimSet)
+        return false;
+
+    // compressed animation set?
+    if (pAnimSet->m_pCompressed)
+        return pAnimSet->m_pCompressed->Sample(model, GetTime(*pAnimSet, elapsedTime), localPose, pLOD);
+
+    // animation set changed since the previous sampling?
+    if (&model != m_pModel || pAnimSet != m_pAnimSet)
+        Bind(model, pAnimSet);
+
+    const Model::IBoneTable& boneTable = model.m_BoneTable;
+    const double             time      = GetTime(*pAnimSet, elapsedTime);
+    const std::size_t        boneCount = boneTable.m_Local.size();
+
+    localPose.resize(boneCount);
+
+    // the level of detail should match the skeleton
+    if (pLOD && pLOD->m_Targets.size() != boneCount)
+        pLOD = nullptr;
+
+    // write the animated bones, the collapsed ones keep their bind pose relative to their target
+    for (std::size_t i = 0; i < m_Channels.size(); ++i)
+    {
+        IChannel& channel = m_Channels[i];
+
+        if (pLOD && pLOD->m_Targets[channel.m_BoneIndex] != channel.m_BoneIndex)
+            localPose[channel.m_BoneIndex] = boneTable.m_Local[channel.m_BoneIndex];
+        else
+            SampleChannel(channel, time, boneTable.m_Local[channel.m_BoneIndex], m_Interpolation, localPose[channel.m_BoneIndex]);
+    }
+
+    // the other bones keep their bind pose
+    for (std::size_t i = 0; i < m_StaticBones.size(); ++i)
+        localPose[m_StaticBones[i]] = boneTable.m_Local[m_StaticBones[i]];
+
+    return true;
+}
+//---------------------------------------------------------------------------
+void AnimationSampler::SampleBone(const Model::IAnimation& animation,
+                                        double             time,
+                                  const Matrix4x4F&        bindLocal,
+                                        IEInterpolation    interpolation,
+                                        Matrix4x4F&        matrix)
+{
+    IChannel channel;
+
+    // link the animation keys to a temporary channel
+    LinkTracks(animation, bindLocal, channel);
+
+    SampleChannel(channel, time, bindLocal, interpolation, matrix);
+}
+//---------------------------------------------------------------------------
+double AnimationSampler::GetTime(const Model::IAnimationSet& animSet, double elapsedTime)
+{
+    // no duration?
+    if (animSet.m_MaxValue <= 0)
+        return 0.0;
+
+    const double duration = double(animSet.m_MaxValue);
+    const double time     = std::fmod(elapsedTime, duration / double(m_TicksPerSecond)) * double(m_TicksPerSecond);
+
+    return (time < 0.0) ? time + duration : time;
+}
+//---------------------------------------------------------------------------
+void AnimationSampler::Bind(const Model& model, const Model::IAnimationSet* pAnimSet)
+{
+    m_pModel   = &model;
+    m_pAnimSet = pAnimSet;
+    m_Channels.clear();
+    m_StaticBones.clear();
+
+    const Model::IBoneTable& boneTable = model.m_BoneTable;
+    const std::size_t        boneCount = boneTable.m_Bones.size();
+
+    std::vector<bool> animated(boneCount, false);
+
+    // link each animation to its bone
+    for (std::size_t i = 0; i < pAnimSet->m_Animations.size(); ++i)
+    {
+        const Model::IAnimation* pAnimation = pAnimSet->m_Animations[i];
+
+        if (!pAnimation)
+            continue;
+
+        int boneIndex = -1;
+
+        // the bone may be linked, otherwise it's searched by name
+        if (pAnimation->m_pBone                        &&
+            pAnimation->m_pBone->m_Index < boneCount   &&
+            boneTable.m_Bones[pAnimation->m_pBone->m_Index] == pAnimation->m_pBone)
+            boneIndex = int(pAnimation->m_pBone->m_Index);
+        else
+            boneIndex = model.FindBoneIndex(pAnimation->m_BoneName);
+
+        // bone not found, or already animated?
+        if (boneIndex < 0 || animated[boneIndex])
+            continue;
+
+        IChannel channel;
+        channel.m_BoneIndex = std::size_t(boneIndex);
+
+        LinkTracks(*pAnimation, boneTable.m_Local[boneIndex], channel);
+
+        m_Channels.push_back(channel);
+        animated[boneIndex] = true;
+    }
+
+    // list the bones which aren't animated
+    for (std::size_t i = 0; i < boneCount; ++i)
+        if (!animated[i])
+            m_StaticBones.push_back(i);
+}
+//---------------------------------------------------------------------------
+void AnimationSampler::LinkTracks(const Model::IAnimation& animation, const Matrix4x4F& bindLocal, IChannel& channel)
+{
+    // link the first non-empty keys of each type
+    for (std::size_t i = 0; i < animation.m_Keys.size(); ++i)
+    {
+        const Model::IAnimationKeys* pKeys = animation.m_Keys[i];
+
+        if (!pKeys || pKeys->m_Keys.empty())
+            continue;
+
+        switch (pKeys->m_Type)
+        {
+            case Model::IEAnimKeyType::IE_KT_Rotation:   if (!channel.m_Rotation.m_pKeys) channel.m_Rotation.m_pKeys = pKeys; break;
+            case Model::IEAnimKeyType::IE_KT_Scale:      if (!channel.m_Scale.m_pKeys)    channel.m_Scale.m_pKeys    = pKeys; break;
+            case Model::IEAnimKeyType::IE_KT_Position:   if (!channel.m_Position.m_pKeys) channel.m_Position.m_pKeys = pKeys; break;
+            case Model::IEAnimKeyType::IE_KT_MatrixKeys: if (!channel.m_Matrix.m_pKeys)   channel.m_Matrix.m_pKeys   = pKeys; break;
+            default:                                                                                                          break;
+        }
+    }
+
+    // keep the bind pose scale, which applies if the bone isn't scaled by keys
+    for (std::size_t i = 0; i < 3; ++i)
+        channel.m_BindScale[i] = std::sqrt(bindLocal.m_Table[i][0] * bindLocal.m_Table[i][0] +
+                                           bindLocal.m_Table[i][1] * bindLocal.m_Table[i][1] +
+                                           bindLocal.m_Table[i][2] * bindLocal.m_Table[i][2]);
+}
+//---------------------------------------------------------------------------
+float AnimationSampler::FindKey(const Model::IAnimationKeys& keys, double time, std::size_t& cursor)
+{
+    const Model::IAnimationKeys::IKeys& items = keys.m_Keys;
+    const std::size_t                   count = items.size();
+
+    // before the first key?
+    if (count < 2 || time <= double(items[0]->m_TimeStamp))
+    {
+        cursor = 0;
+        return 0.0f;
+    }
+
+    // after the last key?
+    if (time >= double(items[count - 1]->m_TimeStamp))
+    {
+        cursor = count - 1;
+        return 0.0f;
+    }
+
+    // the time is now surrounded by 2 keys. On a monotonic playback, they are either the cursor or its next key
+    const bool atCursor = cursor + 1 < count                             &&
+                          double(items[cursor]->m_TimeStamp)     <= time &&
+                          double(items[cursor + 1]->m_TimeStamp) >  time;
+    const bool atNext   = !atCursor                                      &&
+                          cursor + 2 < count                             &&
+                          double(items[cursor + 1]->m_TimeStamp) <= time &&
+                          double(items[cursor + 2]->m_TimeStamp) >  time;
+
+    if (atNext)
+        ++cursor;
+    else
+    if (!atCursor)
+    {
+        std::size_t first = 0;
+        std::size_t last  = count - 1;
+
+        // search the keys by dichotomy
+        while (last - first > 1)
+        {
+            const std::size_t middle = (first + last) / 2;
+
+            if (double(items[middle]->m_TimeStamp) <= time)
+                first = middle;
+            else
+                last = middle;
+        }
+
+        cursor = first;
+    }
+
+    const double start = double(items[cursor]->m_TimeStamp);
+    const double span  = double(items[cursor + 1]->m_TimeStamp) - start;
+
+    return (span > 0.0) ? float((time - start) / span) : 0.0f;
+}
+//---------------------------------------------------------------------------
+void AnimationSampler::SampleChannel(      IChannel&       channel,
+                                           double          time,
+                                     const Matrix4x4F&     bindLocal,
+                                           IEInterpolation interpolation,
+                                           Matrix4x4F&     matrix)
+{
+    // matrix keys contain the whole transformation, they cannot be interpolated without being decomposed
+    if (channel.m_Matrix.m_pKeys)
+    {
+        FindKey(*channel.m_Matrix.m_pKeys, time, channel.m_Matrix.m_Cursor);
+
+        const Model::IAnimationKey::IValues& values = channel.m_Matrix.m_pKeys->m_Keys[channel.m_Matrix.m_Cursor]->m_Values;
+
+        if (values.size() >= 16)
+        {
+            for (std::size_t i = 0; i < 4; ++i)
+                for (std::size_t j = 0; j < 4; ++j)
+                    matrix.m_Table[i][j] = values[i * 4 + j];
+
+            return;
+        }
+    }
+
+    float rotation[4];
+    float scale[3];
+    float position[3];
+    bool  hasRotation = false;
+    bool  hasScale    = false;
+    bool  hasPosition = false;
+
+    // interpolate the rotation
+    if (channel.m_Rotation.m_pKeys)
+    {
+        const Model::IAnimationKeys& keys   = *channel.m_Rotation.m_pKeys;
+        const float                  factor = FindKey(keys, time, channel.m_Rotation.m_Cursor);
+        const std::size_t            next   = std::min(channel.m_Rotation.m_Cursor + 1, keys.m_Keys.size() - 1);
+        const float*                 pFrom  = keys.m_Keys[channel.m_Rotation.m_Cursor]->m_Values.data();
+        const float*                 pTo    = keys.m_Keys[next]->m_Values.data();
+
+        if (keys.m_Keys[channel.m_Rotation.m_Cursor]->m_Values.size() >= 4 && keys.m_Keys[next]->m_Values.size() >= 4)
+        {
+            bool error = true;
+
+            if (interpolation == IEInterpolation::IE_I_Slerp)
+            {
+                const QuaternionF result = QuaternionF(pFrom[0], pFrom[1], pFrom[2], pFrom[3]).Slerp
+                        (QuaternionF(pTo[0], pTo[1], pTo[2], pTo[3]), factor, error);
+
+                rotation[0] = result.m_X;
+                rotation[1] = result.m_Y;
+                rotation[2] = result.m_Z;
+                rotation[3] = result.m_W;
+            }
+
+            // the normalized linear interpolation is also the fallback if the spherical one fails
+            if (error)
+                Nlerp(pFrom, pTo, factor, rotation);
+
+            hasRotation = true;
+        }
+    }
+
+    // interpolate the scale and the position
+    ITrack* tracks[2]  = {&channel.m_Scale, &channel.m_Position};
+    float*  results[2] = {scale,            position};
+    bool*   found[2]   = {&hasScale,        &hasPosition};
+
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        if (!tracks[i]->m_pKeys)
+            continue;
+
+        const Model::IAnimationKeys& keys   = *tracks[i]->m_pKeys;
+        const float                  factor = FindKey(keys, time, tracks[i]->m_Cursor);
+        const std::size_t            next   = std::min(tracks[i]->m_Cursor + 1, keys.m_Keys.size() - 1);
+        const Model::IAnimationKey&  from   = *keys.m_Keys[tracks[i]->m_Cursor];
+        const Model::IAnimationKey&  to     = *keys.m_Keys[next];
+
+        if (from.m_Values.size() < 3 || to.m_Values.size() < 3)
+            continue;
+
+        for (std::size_t j = 0; j < 3; ++j)
+            results[i][j] = from.m_Values[j] + (to.m_Values[j] - from.m_Values[j]) * factor;
+
+        *found[i] = true;
+    }
+
+    // get the rotation and scale rows, the transformations without keys keep their bind pose
+    if (hasRotation)
+    {
+        matrix = QuaternionF(rotation[0], rotation[1], rotation[2], rotation[3]).ToMatrix();
+
+        const float* pScale = hasScale ? scale : channel.m_BindScale;
+
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            matrix.m_Table[i][0] *= pScale[i];
+            matrix.m_Table[i][1] *= pScale[i];
+            matrix.m_Table[i][2] *= pScale[i];
+        }
+    }
+    else
+    {
+        matrix = bindLocal;
+
+        // replace the bind pose scale by the key one
+        if (hasScale)
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                if (channel.m_BindScale[i] <= 0.0f)
+                    continue;
+
+                const float factor = scale[i] / channel.m_BindScale[i];
+
+                matrix.m_Table[i][0] *= factor;
+                matrix.m_Table[i][1] *= factor;
+                matrix.m_Table[i][2] *= factor;
+            }
+    }
+
+    // set the translation, from the keys or from the bind pose
+    for (std::size_t i = 0; i < 3; ++i)
+        matrix.m_Table[3][i] = hasPosition ? position[i] : bindLocal.m_Table[3][i];
+}
+//---------------------------------------------------------------------------
+void AnimationSampler::Nlerp(const float* pFrom, const float* pTo, float factor, float* pResult)
+{
+    #ifdef ANIMATION_SAMPLER_SSE2
+        const __m128 from = _mm_loadu_ps(pFrom);
+              __m128 to   = _mm_loadu_ps(pTo);
+
+        // calculate the dot product in all the lanes
+        __m128 dot = _mm_mul_ps(from, to);
+        dot        = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(2, 3, 0, 1)));
+        dot        = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 0, 3, 2)));
+
+        // follow the shortest path, by negating the target rotation if the dot product is negative
+        to = _mm_xor_ps(to, _mm_and_ps(dot, _mm_set1_ps(-0.0f)));
+
+        // interpolate, then normalize
+        __m128 result = _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), _mm_set1_ps(factor)));
+        __m128 length = _mm_mul_ps(result, result);
+        length        = _mm_add_ps(length, _mm_shuffle_ps(length, length, _MM_SHUFFLE(2, 3, 0, 1)));
+        length        = _mm_add_ps(length, _mm_shuffle_ps(length, length, _MM_SHUFFLE(1, 0, 3, 2)));
+        length        = _mm_sqrt_ps(length);
+
+        // if the rotations are opposite, keep the source one
+        if (_mm_cvtss_f32(length) <= 0.0f)
+        {
+            _mm_storeu_ps(pResult, from);
+            return;
+        }
+
+        _mm_storeu_ps(pResult, _mm_div_ps(result, length));
+    #else
+        const float dot  = pFrom[0] * pTo[0] + pFrom[1] * pTo[1] + pFrom[2] * pTo[2] + pFrom[3] * pTo[3];
+        const float sign = (dot < 0.0f) ? -1.0f : 1.0f;
+
+        // interpolate following the shortest path
+        for (std::size_t i = 0; i < 4; ++i)
+            pResult[i] = pFrom[i] + (pTo[i] * sign - pFrom[i]) * factor;
+
+        const float length = std::sqrt(pResult[0] * pResult[0] +
+                                       pResult[1] * pResult[1] +
+                                       pResult[2] * pResult[2] +
+                                       pResult[3] * pResult[3]);
+
+        // if the rotations are opposite, keep the source one
+        if (length <= 0.0f)
+        {
+            for (std::size_t i = 0; i < 4; ++i)
+                pResult[i] = pFrom[i];
+
+            return;
+        }
+
+        for (std::size_t i = 0; i < 4; ++i)
+            pResult[i] /= length;
+    #endif
+}
+//---------------------------------------------------------------------------
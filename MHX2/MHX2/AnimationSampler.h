@@ -0,0 +1,190 @@
+/****************************************************************************
+ * ==> AnimationSampler ----------------------------------------------------*
+ ****************************************************************************
+ * Description : Keyframe animation sampler, writes a flat local pose       *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <vector>
+
+// classes
+#include "Model.h"
+
+/**
+* Animation sampler, samples the keys of an animation set and writes the resulting local pose in the same order as
+* the model bone table. Each key track keeps a cursor on its last sampled key, thus a monotonic playback finds its
+* keys without search
+*@author Jean-Milost Reymond
+*/
+class AnimationSampler
+{
+    public:
+        static const long long m_TicksPerSecond = 46186158000LL; // animation key time stamps per second, as in fbx files
+
+        /**
+        * Rotation interpolation
+        */
+        enum class IEInterpolation
+        {
+            IE_I_Nlerp = 0, // normalized linear interpolation, fastest, the speed slightly varies between wide keys
+            IE_I_Slerp      // spherical linear interpolation, constant speed
+        };
+
+        AnimationSampler();
+        virtual ~AnimationSampler();
+
+        /**
+        * Sets the rotation interpolation
+        *@param interpolation - rotation interpolation
+        */
+        virtual void SetInterpolation(IEInterpolation interpolation);
+
+        /**
+        * Samples an animation set
+        *@param model - model owning the animation set
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds, loops on the animation set duration
+        *@param[out] localPose - local bone matrices, in the same order as the model bone table
+        *@param pLOD - skeleton level of detail, its collapsed bones aren't sampled. Ignored if nullptr
+        *@return true on success, otherwise false
+        *@note The bones the animation set doesn't animate take their bind pose, as the collapsed bones do, thus
+        *      they follow their target. The bone table should be built before this function is called
+        */
+        virtual bool Sample(const Model&               model,
+                                  int                  animSetIndex,
+                                  double               elapsedTime,
+                                  Model::IMatrices&    localPose,
+                            const Model::ISkeletonLOD* pLOD = nullptr);
+
+        /**
+        * Samples the local matrix of a single bone animation, without any cursor
+        *@param animation - bone animation
+        *@param time - time, in animation key time stamps
+        *@param bindLocal - bone bind pose local matrix, used for the transformations which have no keys
+        *@param interpolation - rotation interpolation
+        *@param[out] matrix - local bone matrix
+        */
+        static void SampleBone(const Model::IAnimation& animation,
+                                     double             time,
+                               const Matrix4x4F&        bindLocal,
+                                     IEInterpolation    interpolation,
+                                     Matrix4x4F&        matrix);
+
+        /**
+        * Converts an elapsed time to an animation set time
+        *@param animSet - animation set
+        *@param elapsedTime - elapsed time in seconds
+        *@return the time, in animation key time stamps, looped on the animation set duration
+        */
+        static double GetTime(const Model::IAnimationSet& animSet, double elapsedTime);
+
+        /**
+        * Interpolates 2 rotations by normalized linear interpolation, following the shortest path
+        *@param pFrom - rotation to interpolate from, in x, y, z, w order
+        *@param pTo - rotation to interpolate to, in x, y, z, w order
+        *@param factor - interpolation factor, between 0.0f and 1.0f
+        *@param[out] pResult - interpolated rotation, in x, y, z, w order
+        */
+        static void Nlerp(const float* pFrom, const float* pTo, float factor, float* pResult);
+
+    private:
+        /**
+        * Key track, i.e. the keys of one transformation of one bone
+        */
+        struct ITrack
+        {
+            const Model::IAnimationKeys* m_pKeys;  // track keys, nullptr if the transformation isn't animated
+                  std::size_t            m_Cursor; // last sampled key
+
+            ITrack();
+            ~ITrack();
+        };
+
+        /**
+        * Channel, i.e. all the key tracks animating a bone
+        */
+        struct IChannel
+        {
+            std::size_t m_BoneIndex;    // animated bone index in the model bone table
+            ITrack      m_Rotation;     // rotation keys
+            ITrack      m_Scale;        // scale keys
+            ITrack      m_Position;     // position keys
+            ITrack      m_Matrix;       // matrix keys
+            float       m_BindScale[3]; // bind pose scale, applied if the bone has no scale keys
+
+            IChannel();
+            ~IChannel();
+        };
+
+        typedef std::vector<IChannel>    IChannels;
+        typedef std::vector<std::size_t> IBoneIndices;
+
+        const Model*                m_pModel;
+        const Model::IAnimationSet* m_pAnimSet;
+        IChannels                   m_Channels;
+        IBoneIndices                m_StaticBones;
+        IEInterpolation             m_Interpolation;
+
+        /**
+        * Binds the sampler to an animation set, i.e. links each animation to its bone and resets the cursors
+        *@param model - model owning the animation set
+        *@param pAnimSet - animation set to bind
+        */
+        void Bind(const Model& model, const Model::IAnimationSet* pAnimSet);
+
+        /**
+        * Links the keys of an animation to a channel
+        *@param animation - bone animation
+        *@param bindLocal - bone bind pose local matrix
+        *@param[in, out] channel - channel to link
+        */
+        static void LinkTracks(const Model::IAnimation& animation, const Matrix4x4F& bindLocal, IChannel& channel);
+
+        /**
+        * Finds the keys surrounding a time
+        *@param keys - keys to search in, sorted by time stamp
+        *@param time - time, in animation key time stamps
+        *@param[in, out] cursor - key found by the previous search, updated with the key found by this one
+        *@return the interpolation factor between the found key and the next one
+        *@note The cursor is checked first, then its next key, and only then the keys are searched by dichotomy
+        */
+        static float FindKey(const Model::IAnimationKeys& keys, double time, std::size_t& cursor);
+
+        /**
+        * Samples a channel
+        *@param channel - channel to sample
+        *@param time - time, in animation key time stamps
+        *@param bindLocal - bone bind pose local matrix
+        *@param interpolation - rotation interpolation
+        *@param[out] matrix - local bone matrix
+        */
+        static void SampleChannel(      IChannel&       channel,
+                                        double          time,
+                                  const Matrix4x4F&     bindLocal,
+                                        IEInterpolation interpolation,
+                                        Matrix4x4F&     matrix);
+};
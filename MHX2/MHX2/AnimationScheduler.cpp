@@ -0,0 +1,486 @@
+/****************************************************************************
+ * ==> AnimationScheduler --------------------------------------------------*
+ ****************************************************************************
+ * Description : Animation level of detail and update rate scheduler        *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "AnimationScheduler.h"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+//---------------------------------------------------------------------------
+// AnimationScheduler::IStats
+//---------------------------------------------------------------------------
+AnimationScheduler::IStats::IStats() :
+    m_Cost(0.0),
+    m_Estimated(0.0),
+    m_Budget(0.0),
+    m_Updated(0),
+    m_Interpolated(0),
+    m_Idle(0),
+    m_Paused(0),
+    m_Demoted(0)
+{}
+//---------------------------------------------------------------------------
+AnimationScheduler::IStats::~IStats()
+{}
+//---------------------------------------------------------------------------
+// AnimationScheduler::IEntry
+//---------------------------------------------------------------------------
+AnimationScheduler::IEntry::IEntry() :
+    m_pInstance(nullptr),
+    m_Rate(IERate::IE_R_EveryFrame),
+    m_AnimSetIndex(0),
+    m_TimeOffset(0.0),
+    m_ToTime(0.0),
+    m_UpdateCost(0.0),
+    m_SkinCost(0.0),
+    m_ScreenSize(1.0f),
+    m_Phase(0),
+    m_UpdateFrame(0),
+    m_Period(0),
+    m_Updated(false),
+    m_Interpolate(false)
+{}
+//---------------------------------------------------------------------------
+AnimationScheduler::IEntry::~IEntry()
+{}
+//---------------------------------------------------------------------------
+// AnimationScheduler
+//---------------------------------------------------------------------------
+AnimationScheduler::AnimationScheduler() :
+    m_Budget(0.0),
+    m_LastTime(0.0),
+    m_FrameDuration(1.0 / 60.0),
+    m_EveryFrame(0.25f),
+    m_Every2ndFrame(0.1f),
+    m_Every4thFrame(0.02f),
+    m_Frame(0),
+    m_NextPhase(0),
+    m_Interpolation(false)
+{}
+//---------------------------------------------------------------------------
+AnimationScheduler::~AnimationScheduler()
+{}
+//---------------------------------------------------------------------------
+void AnimationScheduler::Clear()
+{
+    m_Entries.clear();
+    m_Order.clear();
+
+    m_Stats     = IStats();
+    m_Frame     = 0;
+    m_NextPhase = 0;
+}
+//---------------------------------------------------------------------------
+bool AnimationScheduler::Add(ModelInstance* pInstance, int animSetIndex, double timeOffset)
+{
+    // no instance, or already scheduled?
+    if (!pInstance || Find(pInstance))
+        return false;
+
+    std::unique_ptr<IEntry> pEntry(new IEntry());
+    pEntry->m_pInstance    = pInstance;
+    pEntry->m_AnimSetIndex = animSetIndex;
+    pEntry->m_TimeOffset   = timeOffset;
+
+    // each instance gets the next phase, thus the instances sharing a rate are updated on successive frames
+    pEntry->m_Phase = m_NextPhase++;
+
+    m_Entries.push_back(std::move(pEntry));
+    m_Order.reserve(m_Entries.size());
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool AnimationScheduler::Remove(ModelInstance* pInstance)
+{
+    for (IEntries::iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+        if ((*it)->m_pInstance == pInstance)
+        {
+            m_Entries.erase(it);
+            return true;
+        }
+
+    return false;
+}
+//---------------------------------------------------------------------------
+bool AnimationScheduler::SetAnimation(ModelInstance* pInstance, int animSetIndex, double timeOffset)
+{
+    IEntry* pEntry = Find(pInstance);
+
+    if (!pEntry)
+        return false;
+
+    pEntry->m_AnimSetIndex = animSetIndex;
+    pEntry->m_TimeOffset   = timeOffset;
+
+    // the palettes sampled ahead no longer match the animation, update the instance on the next frame
+    pEntry->m_Period  = 0;
+    pEntry->m_Updated = false;
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool AnimationScheduler::SetScreenSize(ModelInstance* pInstance, float screenSize)
+{
+    IEntry* pEntry = Find(pInstance);
+
+    if (!pEntry)
+        return false;
+
+    pEntry->m_ScreenSize = screenSize;
+    return true;
+}
+//---------------------------------------------------------------------------
+AnimationScheduler::IERate AnimationScheduler::GetRate(ModelInstance* pInstance) const
+{
+    const IEntry* pEntry = Find(pInstance);
+
+    if (!pEntry)
+        return IERate::IE_R_Paused;
+
+    return pEntry->m_Rate;
+}
+//---------------------------------------------------------------------------
+void AnimationScheduler::SetThresholds(float everyFrame, float every2ndFrame, float every4thFrame)
+{
+    m_EveryFrame    = everyFrame;
+    m_Every2ndFrame = every2ndFrame;
+    m_Every4thFrame = every4thFrame;
+}
+//---------------------------------------------------------------------------
+void AnimationScheduler::SetBudget(double budget)
+{
+    m_Budget = std::max(budget, 0.0);
+}
+//---------------------------------------------------------------------------
+void AnimationScheduler::SetInterpolation(bool value)
+{
+    m_Interpolation = value;
+}
+//---------------------------------------------------------------------------
+bool AnimationScheduler::Update(double elapsedTime)
+{
+    typedef std::chrono::steady_clock                 IClock;
+    typedef std::chrono::duration<double, std::milli> IMilliseconds;
+
+    const IClock::time_point frameStart = IClock::now();
+
+    // the frame duration is required to sample the interpolated palettes ahead
+    if (m_Frame && elapsedTime > m_LastTime)
+        m_FrameDuration = elapsedTime - m_LastTime;
+
+    m_LastTime = elapsedTime;
+
+    m_Stats          = IStats();
+    m_Stats.m_Budget = m_Budget;
+
+    m_Order.clear();
+
+    // assign the rate matching the importance of each instance
+    for (IEntries::iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+    {
+        (*it)->m_Rate        = GetTargetRate((*it)->m_ScreenSize);
+        (*it)->m_Interpolate = m_Interpolation;
+
+        m_Order.push_back(it->get());
+    }
+
+    // sort the instances by importance, the most important first
+    std::sort(m_Order.begin(), m_Order.end(), [](const IEntry* pA, const IEntry* pB)
+    {
+        if (pA->m_ScreenSize != pB->m_ScreenSize)
+            return pA->m_ScreenSize > pB->m_ScreenSize;
+
+        return pA->m_Phase < pB->m_Phase;
+    });
+
+    double estimated = 0.0;
+
+    for (IOrder::const_iterator it = m_Order.begin(); it != m_Order.end(); ++it)
+        estimated += GetCost(**it, (*it)->m_Rate, (*it)->m_Interpolate);
+
+    if (m_Budget > 0.0)
+    {
+        // demote the less important instances first, until the estimated cost fits the budget. As the update frames
+        // of a rate are also update frames of the higher rates, a demotion never adds an update
+        for (IOrder::reverse_iterator it = m_Order.rbegin(); it != m_Order.rend() && estimated > m_Budget; ++it)
+        {
+            IEntry& entry   = **it;
+            bool    demoted = false;
+
+            while (estimated > m_Budget && (entry.m_Rate == IERate::IE_R_EveryFrame ||
+                                            entry.m_Rate == IERate::IE_R_Every2ndFrame))
+            {
+                const IERate rate = (entry.m_Rate == IERate::IE_R_EveryFrame) ? IERate::IE_R_Every2ndFrame :
+                                                                                 IERate::IE_R_Every4thFrame;
+
+                estimated   += GetCost(entry, rate, entry.m_Interpolate) -
+                               GetCost(entry, entry.m_Rate, entry.m_Interpolate);
+                entry.m_Rate = rate;
+                demoted      = true;
+            }
+
+            if (demoted)
+                ++m_Stats.m_Demoted;
+        }
+
+        // still over budget? Stop interpolating the less important instances, they keep their last update pose
+        for (IOrder::reverse_iterator it = m_Order.rbegin(); it != m_Order.rend() && estimated > m_Budget; ++it)
+        {
+            IEntry& entry = **it;
+
+            if (!entry.m_Interpolate)
+                continue;
+
+            estimated          += GetCost(entry, entry.m_Rate, false) - GetCost(entry, entry.m_Rate, true);
+            entry.m_Interpolate = false;
+
+            ++m_Stats.m_Demoted;
+        }
+    }
+
+    m_Stats.m_Estimated = estimated;
+
+    // the cost averages are smoothed, thus a single slow frame doesn't demote the instances
+    const double smoothing = 0.25;
+    bool         success   = true;
+
+    for (IEntries::iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+    {
+        IEntry& entry = **it;
+
+        if (IsDue(entry, entry.m_Rate))
+        {
+            const IClock::time_point start = IClock::now();
+
+            if (!UpdateEntry(entry, elapsedTime))
+                success = false;
+
+            const double cost = IMilliseconds(IClock::now() - start).count();
+
+            entry.m_UpdateCost = (entry.m_UpdateCost > 0.0) ? entry.m_UpdateCost + (cost - entry.m_UpdateCost) * smoothing :
+                                                               cost;
+
+            ++m_Stats.m_Updated;
+        }
+        else
+        if (entry.m_Rate == IERate::IE_R_Paused)
+            ++m_Stats.m_Paused;
+        else
+        if (entry.m_Interpolate && entry.m_Period > 1)
+        {
+            const IClock::time_point start = IClock::now();
+
+            if (!InterpolateEntry(entry))
+                success = false;
+
+            const double cost = IMilliseconds(IClock::now() - start).count();
+
+            entry.m_SkinCost = (entry.m_SkinCost > 0.0) ? entry.m_SkinCost + (cost - entry.m_SkinCost) * smoothing :
+                                                           cost;
+
+            ++m_Stats.m_Interpolated;
+        }
+        else
+            ++m_Stats.m_Idle;
+    }
+
+    ++m_Frame;
+
+    m_Stats.m_Cost = IMilliseconds(IClock::now() - frameStart).count();
+
+    return success;
+}
+//---------------------------------------------------------------------------
+const AnimationScheduler::IStats& AnimationScheduler::GetStats() const
+{
+    return m_Stats;
+}
+//---------------------------------------------------------------------------
+float AnimationScheduler::GetScreenSize(const SphereF& sphere, const Vector3F& eye, float fov)
+{
+    if (sphere.IsEmpty())
+        return 0.0f;
+
+    const Vector3F delta    = sphere.m_Center - eye;
+    const float    distance = delta.Length();
+
+    // camera inside the sphere?
+    if (distance <= sphere.m_Radius)
+        return 1.0f;
+
+    // get the half viewport height at the sphere distance
+    const float halfHeight = distance * std::tan(fov * 0.5f);
+
+    if (halfHeight <= 0.0f)
+        return 1.0f;
+
+    return std::min(sphere.m_Radius / halfHeight, 1.0f);
+}
+//---------------------------------------------------------------------------
+AnimationScheduler::IEntry* AnimationScheduler::Find(const ModelInstance* pInstance) const
+{
+    for (IEntries::const_iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+        if ((*it)->m_pInstance == pInstance)
+            return it->get();
+
+    return nullptr;
+}
+//---------------------------------------------------------------------------
+AnimationScheduler::IERate AnimationScheduler::GetTargetRate(float screenSize) const
+{
+    if (screenSize >= m_EveryFrame)
+        return IERate::IE_R_EveryFrame;
+    else
+    if (screenSize >= m_Every2ndFrame)
+        return IERate::IE_R_Every2ndFrame;
+    else
+    if (screenSize >= m_Every4thFrame)
+        return IERate::IE_R_Every4thFrame;
+
+    return IERate::IE_R_Paused;
+}
+//---------------------------------------------------------------------------
+std::size_t AnimationScheduler::GetPeriod(IERate rate)
+{
+    switch (rate)
+    {
+        case IERate::IE_R_EveryFrame:    return 1;
+        case IERate::IE_R_Every2ndFrame: return 2;
+        case IERate::IE_R_Every4thFrame: return 4;
+        default:                         return 0;
+    }
+}
+//---------------------------------------------------------------------------
+bool AnimationScheduler::IsDue(const IEntry& entry, IERate rate) const
+{
+    // never updated? Update it once, even if paused
+    if (!entry.m_Updated)
+        return true;
+
+    const std::size_t period = GetPeriod(rate);
+
+    if (!period)
+        return false;
+
+    // the phase spreads the updates of a rate across its frames
+    return !((m_Frame + entry.m_Phase) % period);
+}
+//---------------------------------------------------------------------------
+double AnimationScheduler::GetCost(const IEntry& entry, IERate rate, bool interpolate) const
+{
+    if (IsDue(entry, rate))
+        return entry.m_UpdateCost;
+
+    if (interpolate && rate != IERate::IE_R_Paused)
+        return entry.m_SkinCost;
+
+    return 0.0;
+}
+//---------------------------------------------------------------------------
+bool AnimationScheduler::UpdateEntry(IEntry& entry, double elapsedTime)
+{
+    const double      time   = elapsedTime - entry.m_TimeOffset;
+    const std::size_t period = GetPeriod(entry.m_Rate);
+    const Model*      pModel = entry.m_pInstance->GetModel();
+
+    entry.m_UpdateFrame = m_Frame;
+    entry.m_Updated     = true;
+
+    // no interpolation? Just update the instance, this also applies to the models without animation
+    if (!entry.m_Interpolate || period <= 1 || !pModel || !pModel->m_pSkeleton || pModel->m_PoseOnly)
+    {
+        entry.m_Period = 0;
+        return entry.m_pInstance->Update(entry.m_AnimSetIndex, time);
+    }
+
+    // the palette sampled ahead by the previous update matches the current time? Start from it, otherwise sample it
+    if (entry.m_Period && !entry.m_To.empty() && std::fabs(entry.m_ToTime - time) <= m_FrameDuration * 0.5)
+        std::swap(entry.m_From, entry.m_To);
+    else
+        BuildPalette(entry, time, entry.m_From);
+
+    // sample the palette of the next update, the palettes of the frames between are interpolated
+    entry.m_ToTime = time + double(period) * m_FrameDuration;
+    entry.m_Period = period;
+
+    BuildPalette(entry, entry.m_ToTime, entry.m_To);
+
+    return entry.m_pInstance->UpdatePalette(entry.m_From);
+}
+//---------------------------------------------------------------------------
+bool AnimationScheduler::InterpolateEntry(IEntry& entry)
+{
+    const std::size_t boneCount = entry.m_From.size();
+
+    if (entry.m_To.size() != boneCount)
+        return false;
+
+    const float factor = std::min(float(m_Frame - entry.m_UpdateFrame) / float(entry.m_Period), 1.0f);
+
+    entry.m_Palette.resize(boneCount);
+
+    // the palettes are linearly interpolated, which also linearly interpolates the skinned vertices
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        const float* pFrom = &entry.m_From[i].m_Table[0][0];
+        const float* pTo   = &entry.m_To[i].m_Table[0][0];
+              float* pDst  = &entry.m_Palette[i].m_Table[0][0];
+
+        for (std::size_t j = 0; j < 16; ++j)
+            pDst[j] = pFrom[j] + (pTo[j] - pFrom[j]) * factor;
+    }
+
+    return entry.m_pInstance->UpdatePalette(entry.m_Palette);
+}
+//---------------------------------------------------------------------------
+void AnimationScheduler::BuildPalette(IEntry& entry, double elapsedTime, Model::IMatrices& palette)
+{
+    const Model&               model     = *entry.m_pInstance->GetModel();
+    const Model::IBoneTable&   boneTable = model.m_BoneTable;
+    const int                  lodIndex  = entry.m_pInstance->GetSkeletonLOD();
+    const Model::ISkeletonLOD* pLOD      = (lodIndex >= 0 && std::size_t(lodIndex) < model.m_SkeletonLODs.size()) ?
+                                            model.m_SkeletonLODs[lodIndex] : nullptr;
+
+    // sample the animation set, the bind pose is used on error. The bones the instance level of detail collapses
+    // aren't sampled
+    if (!entry.m_Sampler.Sample(model, entry.m_AnimSetIndex, elapsedTime, entry.m_LocalPose, pLOD))
+        entry.m_LocalPose = boneTable.m_Local;
+
+    model.GetGlobalPose(entry.m_LocalPose, entry.m_GlobalPose);
+
+    const std::size_t boneCount = entry.m_GlobalPose.size();
+
+    palette.resize(boneCount);
+
+    for (std::size_t i = 0; i < boneCount; ++i)
+        palette[i] = boneTable.m_InverseBind[i].Multiply(entry.m_GlobalPose[i]);
+}
+//---------------------------------------------------------------------------
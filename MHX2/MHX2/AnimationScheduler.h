@@ -0,0 +1,282 @@
+/****************************************************************************
+ * ==> AnimationScheduler --------------------------------------------------*
+ ****************************************************************************
+ * Description : Animation level of detail and update rate scheduler        *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <vector>
+#include <memory>
+
+// classes
+#include "Model.h"
+#include "ModelInstance.h"
+#include "AnimationSampler.h"
+#include "Sphere.h"
+#include "Vector3.h"
+
+/**
+* Animation scheduler, updates the model instances at a rate depending on their importance, i.e. on their screen
+* size. The important instances are updated on each frame, the others on each 2nd or 4th frame, or are paused. The
+* updates of a same rate are spread across the frames, thus the cost remains flat, and the less important instances
+* are demoted to a lower rate when the frame cost exceeds the CPU budget. Between 2 updates, the palettes may be
+* interpolated, in which case the instances are skinned on each frame but sampled only on their updates
+*@author Jean-Milost Reymond
+*/
+class AnimationScheduler
+{
+    public:
+        /**
+        * Update rate
+        */
+        enum class IERate
+        {
+            IE_R_EveryFrame = 0, // the instance is updated on each frame
+            IE_R_Every2ndFrame,  // the instance is updated on each 2nd frame
+            IE_R_Every4thFrame,  // the instance is updated on each 4th frame
+            IE_R_Paused          // the instance keeps its last pose
+        };
+
+        /**
+        * Frame statistics
+        */
+        struct IStats
+        {
+            double      m_Cost;         // measured frame cost, in milliseconds
+            double      m_Estimated;    // cost estimated before the frame was updated, in milliseconds
+            double      m_Budget;       // frame budget, in milliseconds, 0.0 if unlimited
+            std::size_t m_Updated;      // instances sampled and skinned during the frame
+            std::size_t m_Interpolated; // instances skinned from an interpolated palette during the frame
+            std::size_t m_Idle;         // instances waiting for their next update
+            std::size_t m_Paused;       // paused instances
+            std::size_t m_Demoted;      // instances demoted to a lower rate to fit the budget
+
+            IStats();
+            ~IStats();
+        };
+
+        AnimationScheduler();
+        virtual ~AnimationScheduler();
+
+        /**
+        * Clears the scheduler
+        */
+        virtual void Clear();
+
+        /**
+        * Adds an instance to schedule
+        *@param pInstance - instance, not owned. Should remain valid until removed
+        *@param animSetIndex - animation set the instance plays
+        *@param timeOffset - time offset in seconds, subtracted from the scheduler elapsed time
+        *@return true on success, otherwise false
+        */
+        virtual bool Add(ModelInstance* pInstance, int animSetIndex, double timeOffset = 0.0);
+
+        /**
+        * Removes a scheduled instance
+        *@param pInstance - instance to remove
+        *@return true on success, otherwise false
+        */
+        virtual bool Remove(ModelInstance* pInstance);
+
+        /**
+        * Sets the animation a scheduled instance plays
+        *@param pInstance - instance
+        *@param animSetIndex - animation set index
+        *@param timeOffset - time offset in seconds, subtracted from the scheduler elapsed time
+        *@return true on success, otherwise false
+        */
+        virtual bool SetAnimation(ModelInstance* pInstance, int animSetIndex, double timeOffset = 0.0);
+
+        /**
+        * Sets the importance of a scheduled instance
+        *@param pInstance - instance
+        *@param screenSize - instance screen size, e.g. as returned by GetScreenSize()
+        *@return true on success, otherwise false
+        */
+        virtual bool SetScreenSize(ModelInstance* pInstance, float screenSize);
+
+        /**
+        * Gets the rate at which a scheduled instance was updated during the last frame
+        *@param pInstance - instance
+        *@return the update rate, paused if the instance isn't scheduled
+        */
+        virtual IERate GetRate(ModelInstance* pInstance) const;
+
+        /**
+        * Sets the screen sizes from which the rates apply
+        *@param everyFrame - minimum screen size to update an instance on each frame
+        *@param every2ndFrame - minimum screen size to update an instance on each 2nd frame
+        *@param every4thFrame - minimum screen size to update an instance on each 4th frame, below it's paused
+        */
+        virtual void SetThresholds(float everyFrame, float every2ndFrame, float every4thFrame);
+
+        /**
+        * Sets the frame budget
+        *@param budget - frame budget in milliseconds, unlimited if 0.0
+        *@note The less important instances are demoted until the estimated cost fits the budget, however an instance
+        *      is never paused to fit it, thus the budget may be exceeded
+        */
+        virtual void SetBudget(double budget);
+
+        /**
+        * Enables or disables the palette interpolation between 2 updates
+        *@param value - if true, the palettes are interpolated
+        *@note When enabled, the instances aren't sampled on each frame, but are skinned on each frame, and their
+        *      pose cache doesn't apply
+        */
+        virtual void SetInterpolation(bool value);
+
+        /**
+        * Updates the scheduled instances due on this frame
+        *@param elapsedTime - elapsed time in seconds since the animation started
+        *@return true on success, otherwise false
+        */
+        virtual bool Update(double elapsedTime);
+
+        /**
+        * Gets the last frame statistics
+        *@return the last frame statistics
+        */
+        virtual const IStats& GetStats() const;
+
+        /**
+        * Gets the screen size of a bounding sphere, i.e. its radius relatively to the half viewport height
+        *@param sphere - bounding sphere, in world coordinates
+        *@param eye - camera position, in world coordinates
+        *@param fov - camera vertical field of view, in radians
+        *@return the screen size, between 0.0 and 1.0
+        */
+        static float GetScreenSize(const SphereF& sphere, const Vector3F& eye, float fov);
+
+    private:
+        /**
+        * Scheduled instance
+        */
+        struct IEntry
+        {
+            ModelInstance*   m_pInstance;
+            AnimationSampler m_Sampler;      // sampler used to build the interpolated palettes
+            Model::IMatrices m_LocalPose;
+            Model::IMatrices m_GlobalPose;
+            Model::IMatrices m_From;         // palette at the last update
+            Model::IMatrices m_To;           // palette at the next update
+            Model::IMatrices m_Palette;      // interpolated palette
+            IERate           m_Rate;
+            int              m_AnimSetIndex;
+            double           m_TimeOffset;
+            double           m_ToTime;       // time at which the next update palette was sampled
+            double           m_UpdateCost;   // average cost of an update, in milliseconds
+            double           m_SkinCost;     // average cost of an interpolated skinning, in milliseconds
+            float            m_ScreenSize;
+            std::size_t      m_Phase;        // offsets the update frames, to spread the updates
+            std::size_t      m_UpdateFrame;  // frame of the last update
+            std::size_t      m_Period;       // frame count between the last update and the next one
+            bool             m_Updated;      // if true, the instance was updated at least once
+            bool             m_Interpolate;  // if true, the palette is interpolated until the next update
+
+            IEntry();
+            ~IEntry();
+        };
+
+        typedef std::vector<std::unique_ptr<IEntry>> IEntries;
+        typedef std::vector<IEntry*>                 IOrder;
+
+        IEntries    m_Entries;
+        IOrder      m_Order;
+        IStats      m_Stats;
+        double      m_Budget;
+        double      m_LastTime;
+        double      m_FrameDuration;
+        float       m_EveryFrame;
+        float       m_Every2ndFrame;
+        float       m_Every4thFrame;
+        std::size_t m_Frame;
+        std::size_t m_NextPhase;
+        bool        m_Interpolation;
+
+        /**
+        * Finds a scheduled instance
+        *@param pInstance - instance to find
+        *@return the scheduled instance, nullptr if not found
+        */
+        IEntry* Find(const ModelInstance* pInstance) const;
+
+        /**
+        * Gets the rate matching a screen size
+        *@param screenSize - screen size
+        *@return the rate
+        */
+        IERate GetTargetRate(float screenSize) const;
+
+        /**
+        * Gets the frame count between 2 updates
+        *@param rate - update rate
+        *@return the frame count, 0 if paused
+        */
+        static std::size_t GetPeriod(IERate rate);
+
+        /**
+        * Checks if a scheduled instance should be updated on the current frame
+        *@param entry - scheduled instance
+        *@param rate - update rate
+        *@return true if the instance should be updated, otherwise false
+        */
+        bool IsDue(const IEntry& entry, IERate rate) const;
+
+        /**
+        * Gets the cost a scheduled instance will take on the current frame
+        *@param entry - scheduled instance
+        *@param rate - update rate
+        *@param interpolate - if true, the palette is interpolated between 2 updates
+        *@return the estimated cost in milliseconds
+        */
+        double GetCost(const IEntry& entry, IERate rate, bool interpolate) const;
+
+        /**
+        * Updates a scheduled instance due on the current frame
+        *@param entry - scheduled instance
+        *@param elapsedTime - elapsed time in seconds since the animation started
+        *@return true on success, otherwise false
+        */
+        bool UpdateEntry(IEntry& entry, double elapsedTime);
+
+        /**
+        * Skins a scheduled instance with its palette interpolated between its 2 last updates
+        *@param entry - scheduled instance
+        *@return true on success, otherwise false
+        */
+        bool InterpolateEntry(IEntry& entry);
+
+        /**
+        * Samples a pose and calculates its palette
+        *@param entry - scheduled instance
+        *@param elapsedTime - instance elapsed time in seconds
+        *@param[out] palette - matrix palette
+        */
+        static void BuildPalette(IEntry& entry, double elapsedTime, Model::IMatrices& palette);
+};
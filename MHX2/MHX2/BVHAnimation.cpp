@@ -0,0 +1,598 @@
+/****************************************************************************
+ * ==> BVHAnimation --------------------------------------------------------*
+ ****************************************************************************
+ * Description : Motion capture .bvh file reader                            *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "BVHAnimation.h"
+
+// std
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <memory>
+
+// classes
+#include "Quaternion.h"
+#include "AnimationSampler.h"
+
+//---------------------------------------------------------------------------
+// BVHAnimation::IJoint
+//---------------------------------------------------------------------------
+BVHAnimation::IJoint::IJoint() :
+    m_Parent(-1),
+    m_HasPosition(false)
+{
+    m_Offset[0] = 0.0f;
+    m_Offset[1] = 0.0f;
+    m_Offset[2] = 0.0f;
+}
+//---------------------------------------------------------------------------
+BVHAnimation::IJoint::~IJoint()
+{}
+//---------------------------------------------------------------------------
+// BVHAnimation
+//---------------------------------------------------------------------------
+BVHAnimation::BVHAnimation() :
+    m_ChannelCount(0),
+    m_FrameCount(0),
+    m_FrameTime(0.0),
+    m_Scale(1.0f)
+{}
+//---------------------------------------------------------------------------
+BVHAnimation::~BVHAnimation()
+{}
+//---------------------------------------------------------------------------
+void BVHAnimation::Clear()
+{
+    m_Joints.clear();
+    m_Rotations.clear();
+    m_Positions.clear();
+
+    m_ChannelCount = 0;
+    m_FrameCount   = 0;
+    m_FrameTime    = 0.0;
+}
+//---------------------------------------------------------------------------
+bool BVHAnimation::Open(const std::string& fileName)
+{
+    // no file name?
+    if (fileName.empty())
+        return false;
+
+    std::FILE* pStream = nullptr;
+
+    // open file for read
+    #ifdef _WINDOWS
+        const errno_t error = fopen_s(&pStream, fileName.c_str(), "rb");
+
+        // error occurred?
+        if (error != 0)
+            return false;
+    #else
+        pStream = std::fopen(fileName.c_str(), "rb");
+    #endif
+
+    // is file stream opened?
+    if (!pStream)
+        return false;
+
+    // get file size
+    std::fseek(pStream, 0, SEEK_END);
+    const long fileSize = std::ftell(pStream);
+    std::fseek(pStream, 0, SEEK_SET);
+
+    std::string data;
+    std::size_t readSize = 0;
+
+    // read the whole file at once, the data are then parsed in a single pass
+    try
+    {
+        if (fileSize > 0)
+        {
+            data.resize(std::size_t(fileSize));
+            readSize = std::fread(&data[0], 1, data.size(), pStream);
+        }
+    }
+    catch (...)
+    {
+        std::fclose(pStream);
+        return false;
+    }
+
+    std::fclose(pStream);
+
+    return (fileSize > 0 && readSize == std::size_t(fileSize) && Read(data));
+}
+//---------------------------------------------------------------------------
+bool BVHAnimation::Read(const std::string& data)
+{
+    Clear();
+
+    const char* pData = data.c_str();
+    const char* pEnd  = pData + data.size();
+
+    if (!ReadHierarchy(pData, pEnd) || !ReadMotion(pData, pEnd))
+    {
+        Clear();
+        return false;
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+void BVHAnimation::SetRenameTable(const IRenameTable& renameTable)
+{
+    m_RenameTable = renameTable;
+}
+//---------------------------------------------------------------------------
+void BVHAnimation::SetScale(float scale)
+{
+    m_Scale = scale;
+}
+//---------------------------------------------------------------------------
+std::size_t BVHAnimation::GetFrameCount() const
+{
+    return m_FrameCount;
+}
+//---------------------------------------------------------------------------
+double BVHAnimation::GetFrameTime() const
+{
+    return m_FrameTime;
+}
+//---------------------------------------------------------------------------
+Model::IAnimationSet* BVHAnimation::CreateAnimationSet(const Model& model) const
+{
+    // nothing to animate?
+    if (!m_FrameCount || m_Joints.empty())
+        return nullptr;
+
+    const Model::IBoneTable& boneTable = model.m_BoneTable;
+    const std::size_t        boneCount = boneTable.m_Bones.size();
+
+    // no bone table?
+    if (!boneCount || boneTable.m_Global.size() != boneCount)
+        return nullptr;
+
+    std::vector<QuaternionF> restRotations(boneCount);
+
+    // get the bind pose rotation of each bone, without its scale
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        Matrix4x4F rotation = boneTable.m_Global[i];
+
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+            const float length = std::sqrt(rotation.m_Table[j][0] * rotation.m_Table[j][0] +
+                                           rotation.m_Table[j][1] * rotation.m_Table[j][1] +
+                                           rotation.m_Table[j][2] * rotation.m_Table[j][2]);
+
+            if (length > 0.0f)
+                for (std::size_t k = 0; k < 3; ++k)
+                    rotation.m_Table[j][k] /= length;
+        }
+
+        bool error = false;
+        restRotations[i] = QuaternionF().FromMatrix(rotation, error).Conjugate().Normalize();
+
+        if (error)
+            restRotations[i] = QuaternionF(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    const double ticksPerFrame = m_FrameTime * double(AnimationSampler::m_TicksPerSecond);
+    const std::size_t jointCount = m_Joints.size();
+
+    std::unique_ptr<Model::IAnimationSet> pAnimSet(new Model::IAnimationSet());
+    pAnimSet->m_MaxValue = (long long)(double(m_FrameCount) * ticksPerFrame + 0.5);
+
+    // convert each joint linked to a bone
+    for (std::size_t i = 0; i < jointCount; ++i)
+    {
+        const IJoint& joint = m_Joints[i];
+
+        // get the bone name, renamed if required
+        IRenameTable::const_iterator it   = m_RenameTable.find(joint.m_Name);
+        const std::string&           name = (it != m_RenameTable.end()) ? it->second : joint.m_Name;
+
+        const int boneIndex = model.FindBoneIndex(name);
+
+        // no matching bone?
+        if (boneIndex < 0)
+            continue;
+
+        const int         parent        = boneTable.m_Parents[boneIndex];
+        const QuaternionF rest          = restRotations[boneIndex];
+        const QuaternionF invParentRest = (parent >= 0) ? restRotations[parent].Conjugate() : QuaternionF(0.0f, 0.0f, 0.0f, 1.0f);
+
+        std::unique_ptr<Model::IAnimation> pAnimation(new Model::IAnimation());
+        pAnimation->m_BoneName = name;
+        pAnimation->m_pBone    = boneTable.m_Bones[boneIndex];
+
+        std::unique_ptr<Model::IAnimationKeys> pRotationKeys(new Model::IAnimationKeys());
+        pRotationKeys->m_Type = Model::IEAnimKeyType::IE_KT_Rotation;
+        pRotationKeys->m_Keys.reserve(m_FrameCount);
+
+        // the capture rotation is a delta in the model space, which is applied on the bind pose, then expressed in
+        // the parent bone space. NOTE the capture rotations rotate column vectors, whereas the model matrices
+        // transform row vectors, thus the capture rotation is conjugated
+        for (std::size_t j = 0; j < m_FrameCount; ++j)
+        {
+            const float*      pRotation = &m_Rotations[(j * jointCount + i) * 4];
+            const QuaternionF rotation  = rest.Multiply(QuaternionF(-pRotation[0],
+                                                                    -pRotation[1],
+                                                                    -pRotation[2],
+                                                                     pRotation[3])).Multiply(invParentRest).Normalize();
+
+            std::unique_ptr<Model::IAnimationKey> pKey(new Model::IAnimationKey());
+            pKey->m_Frame     = j;
+            pKey->m_TimeStamp = (long long)(double(j) * ticksPerFrame + 0.5);
+            pKey->m_Values    = {rotation.m_X, rotation.m_Y, rotation.m_Z, rotation.m_W};
+
+            pRotationKeys->m_Keys.push_back(pKey.get());
+            pKey.release();
+        }
+
+        pAnimation->m_Keys.push_back(pRotationKeys.get());
+        pRotationKeys.release();
+
+        if (joint.m_HasPosition)
+        {
+            const Matrix4x4F  toParent = invParentRest.ToMatrix();
+            const Matrix4x4F& local    = boneTable.m_Local[boneIndex];
+            const float*      pFirst   = &m_Positions[i * 3];
+
+            std::unique_ptr<Model::IAnimationKeys> pPositionKeys(new Model::IAnimationKeys());
+            pPositionKeys->m_Type = Model::IEAnimKeyType::IE_KT_Position;
+            pPositionKeys->m_Keys.reserve(m_FrameCount);
+
+            // the capture position is an offset from the first frame in the model space, which is applied on the
+            // bind pose, then expressed in the parent bone space
+            for (std::size_t j = 0; j < m_FrameCount; ++j)
+            {
+                const float*   pPosition = &m_Positions[(j * jointCount + i) * 3];
+                const Vector3F offset    = toParent.Transform(Vector3F((pPosition[0] - pFirst[0]) * m_Scale,
+                                                                       (pPosition[1] - pFirst[1]) * m_Scale,
+                                                                       (pPosition[2] - pFirst[2]) * m_Scale));
+
+                std::unique_ptr<Model::IAnimationKey> pKey(new Model::IAnimationKey());
+                pKey->m_Frame     = j;
+                pKey->m_TimeStamp = (long long)(double(j) * ticksPerFrame + 0.5);
+                pKey->m_Values    = {local.m_Table[3][0] + offset.m_X,
+                                     local.m_Table[3][1] + offset.m_Y,
+                                     local.m_Table[3][2] + offset.m_Z};
+
+                pPositionKeys->m_Keys.push_back(pKey.get());
+                pKey.release();
+            }
+
+            pAnimation->m_Keys.push_back(pPositionKeys.get());
+            pPositionKeys.release();
+        }
+
+        pAnimSet->m_Animations.push_back(pAnimation.get());
+        pAnimation.release();
+    }
+
+    // no joint matches the model skeleton?
+    if (pAnimSet->m_Animations.empty())
+        return nullptr;
+
+    return pAnimSet.release();
+}
+//---------------------------------------------------------------------------
+bool BVHAnimation::ReadHierarchy(const char*& pData, const char* pEnd)
+{
+    if (!ExpectWord(pData, pEnd, "HIERARCHY"))
+        return false;
+
+    // open blocks, containing either a joint index or -1 for an end site
+    std::vector<int> blocks;
+
+    while (true)
+    {
+        const char*       pWord  = nullptr;
+        const std::size_t length = ReadWord(pData, pEnd, pWord);
+        const std::string word(pWord, length);
+
+        // unexpected end?
+        if (!length)
+            return false;
+
+        if (word == "ROOT" || word == "JOINT")
+        {
+            IJoint joint;
+
+            // a joint is always declared in its parent block
+            if (word == "JOINT" && (blocks.empty() || blocks.back() < 0))
+                return false;
+
+            const char*       pName      = nullptr;
+            const std::size_t nameLength = ReadWord(pData, pEnd, pName);
+
+            if (!nameLength || !ExpectWord(pData, pEnd, "{"))
+                return false;
+
+            joint.m_Name.assign(pName, nameLength);
+            joint.m_Parent = (word == "JOINT") ? blocks.back() : -1;
+
+            blocks.push_back(int(m_Joints.size()));
+            m_Joints.push_back(joint);
+        }
+        else
+        if (word == "End")
+        {
+            if (blocks.empty() || !ExpectWord(pData, pEnd, "Site") || !ExpectWord(pData, pEnd, "{"))
+                return false;
+
+            blocks.push_back(-1);
+        }
+        else
+        if (word == "OFFSET")
+        {
+            float offset[3];
+
+            if (blocks.empty()                         ||
+                !ReadFloat(pData, pEnd, offset[0]) ||
+                !ReadFloat(pData, pEnd, offset[1]) ||
+                !ReadFloat(pData, pEnd, offset[2]))
+                return false;
+
+            // the end site offsets are useless, the end sites have no channel
+            if (blocks.back() >= 0)
+                std::memcpy(m_Joints[blocks.back()].m_Offset, offset, sizeof(offset));
+        }
+        else
+        if (word == "CHANNELS")
+        {
+            float count = 0.0f;
+
+            if (blocks.empty() || blocks.back() < 0 || !ReadFloat(pData, pEnd, count) || count < 0.0f)
+                return false;
+
+            IJoint& joint = m_Joints[blocks.back()];
+
+            for (std::size_t i = 0; i < std::size_t(count); ++i)
+            {
+                const char*       pChannel      = nullptr;
+                const std::size_t channelLength = ReadWord(pData, pEnd, pChannel);
+                const std::string channel(pChannel, channelLength);
+
+                if (channel == "Xposition")
+                    joint.m_Channels.push_back(IEChannel::IE_C_XPosition);
+                else
+                if (channel == "Yposition")
+                    joint.m_Channels.push_back(IEChannel::IE_C_YPosition);
+                else
+                if (channel == "Zposition")
+                    joint.m_Channels.push_back(IEChannel::IE_C_ZPosition);
+                else
+                if (channel == "Xrotation")
+                    joint.m_Channels.push_back(IEChannel::IE_C_XRotation);
+                else
+                if (channel == "Yrotation")
+                    joint.m_Channels.push_back(IEChannel::IE_C_YRotation);
+                else
+                if (channel == "Zrotation")
+                    joint.m_Channels.push_back(IEChannel::IE_C_ZRotation);
+                else
+                    return false;
+
+                if (joint.m_Channels.back() <= IEChannel::IE_C_ZPosition)
+                    joint.m_HasPosition = true;
+            }
+
+            m_ChannelCount += std::size_t(count);
+        }
+        else
+        if (word == "}")
+        {
+            if (blocks.empty())
+                return false;
+
+            blocks.pop_back();
+        }
+        else
+        if (word == "MOTION")
+            // the hierarchy should be complete
+            return (blocks.empty() && !m_Joints.empty());
+        else
+            return false;
+    }
+}
+//---------------------------------------------------------------------------
+bool BVHAnimation::ReadMotion(const char*& pData, const char* pEnd)
+{
+    float frameCount = 0.0f;
+    float frameTime  = 0.0f;
+
+    if (!ExpectWord(pData, pEnd, "Frames:") || !ReadFloat(pData, pEnd, frameCount) || frameCount < 0.0f)
+        return false;
+
+    if (!ExpectWord(pData, pEnd, "Frame") || !ExpectWord(pData, pEnd, "Time:") || !ReadFloat(pData, pEnd, frameTime))
+        return false;
+
+    m_FrameCount = std::size_t(frameCount);
+    m_FrameTime  = frameTime;
+
+    const std::size_t  jointCount = m_Joints.size();
+    const float        toRadians  = 3.14159265358979f / 180.0f;
+    std::vector<float> channels(m_ChannelCount);
+
+    m_Rotations.resize(m_FrameCount * jointCount * 4);
+    m_Positions.resize(m_FrameCount * jointCount * 3, 0.0f);
+
+    // read the frames one by one, and convert their rotations to quaternions immediately
+    for (std::size_t i = 0; i < m_FrameCount; ++i)
+    {
+        for (std::size_t j = 0; j < m_ChannelCount; ++j)
+            if (!ReadFloat(pData, pEnd, channels[j]))
+                return false;
+
+        std::size_t channel = 0;
+
+        for (std::size_t j = 0; j < jointCount; ++j)
+        {
+            const IJoint& joint     = m_Joints[j];
+            float*        pPosition = &m_Positions[(i * jointCount + j) * 3];
+            QuaternionF   rotation(0.0f, 0.0f, 0.0f, 1.0f);
+
+            // the rotations are applied in the channel order, the first one being the outermost
+            for (std::size_t k = 0; k < joint.m_Channels.size(); ++k)
+            {
+                const float value = channels[channel++];
+
+                switch (joint.m_Channels[k])
+                {
+                    case IEChannel::IE_C_XPosition: pPosition[0] = value; break;
+                    case IEChannel::IE_C_YPosition: pPosition[1] = value; break;
+                    case IEChannel::IE_C_ZPosition: pPosition[2] = value; break;
+
+                    default:
+                    {
+                        const float angle = value * toRadians * 0.5f;
+                        const float sinus = std::sin(angle);
+
+                        QuaternionF axisRotation(0.0f, 0.0f, 0.0f, std::cos(angle));
+
+                        if (joint.m_Channels[k] == IEChannel::IE_C_XRotation)
+                            axisRotation.m_X = sinus;
+                        else
+                        if (joint.m_Channels[k] == IEChannel::IE_C_YRotation)
+                            axisRotation.m_Y = sinus;
+                        else
+                            axisRotation.m_Z = sinus;
+
+                        rotation = rotation.Multiply(axisRotation);
+                        break;
+                    }
+                }
+            }
+
+            float* pRotation = &m_Rotations[(i * jointCount + j) * 4];
+            pRotation[0] = rotation.m_X;
+            pRotation[1] = rotation.m_Y;
+            pRotation[2] = rotation.m_Z;
+            pRotation[3] = rotation.m_W;
+        }
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+std::size_t BVHAnimation::ReadWord(const char*& pData, const char* pEnd, const char*& pStart)
+{
+    // skip the blank chars
+    while (pData < pEnd && (*pData == ' ' || *pData == '\t' || *pData == '\r' || *pData == '\n'))
+        ++pData;
+
+    pStart = pData;
+
+    // read until the next blank char
+    while (pData < pEnd && *pData != ' ' && *pData != '\t' && *pData != '\r' && *pData != '\n')
+        ++pData;
+
+    return std::size_t(pData - pStart);
+}
+//---------------------------------------------------------------------------
+bool BVHAnimation::ExpectWord(const char*& pData, const char* pEnd, const char* pValue)
+{
+    const char*       pWord  = nullptr;
+    const std::size_t length = ReadWord(pData, pEnd, pWord);
+
+    return (length == std::strlen(pValue) && !std::memcmp(pWord, pValue, length));
+}
+//---------------------------------------------------------------------------
+bool BVHAnimation::ReadFloat(const char*& pData, const char* pEnd, float& value)
+{
+    static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    // skip the blank chars
+    while (pData < pEnd && (*pData == ' ' || *pData == '\t' || *pData == '\r' || *pData == '\n'))
+        ++pData;
+
+    bool negative = false;
+
+    // read the sign
+    if (pData < pEnd && (*pData == '-' || *pData == '+'))
+    {
+        negative = (*pData == '-');
+        ++pData;
+    }
+
+    double      mantissa = 0.0;
+    int         exponent = 0;
+    std::size_t digits   = 0;
+
+    // read the integer part
+    for (; pData < pEnd && *pData >= '0' && *pData <= '9'; ++pData, ++digits)
+        mantissa = mantissa * 10.0 + (*pData - '0');
+
+    // read the decimal part
+    if (pData < pEnd && *pData == '.')
+        for (++pData; pData < pEnd && *pData >= '0' && *pData <= '9'; ++pData, ++digits, --exponent)
+            mantissa = mantissa * 10.0 + (*pData - '0');
+
+    // no digit?
+    if (!digits)
+        return false;
+
+    // read the exponent
+    if (pData < pEnd && (*pData == 'e' || *pData == 'E'))
+    {
+        ++pData;
+
+        bool negativeExp = false;
+
+        if (pData < pEnd && (*pData == '-' || *pData == '+'))
+        {
+            negativeExp = (*pData == '-');
+            ++pData;
+        }
+
+        // malformed exponent?
+        if (pData >= pEnd || *pData < '0' || *pData > '9')
+            return false;
+
+        int exp = 0;
+
+        for (; pData < pEnd && *pData >= '0' && *pData <= '9'; ++pData)
+            if (exp < 1000)
+                exp = exp * 10 + (*pData - '0');
+
+        exponent += negativeExp ? -exp : exp;
+    }
+
+    // apply the exponent
+    if (exponent >= 0)
+        mantissa *= (exponent <= 22) ? powers[exponent] : std::pow(10.0, exponent);
+    else
+        mantissa /= (exponent >= -22) ? powers[-exponent] : std::pow(10.0, -exponent);
+
+    value = float(negative ? -mantissa : mantissa);
+    return true;
+}
+//---------------------------------------------------------------------------
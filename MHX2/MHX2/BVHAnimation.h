@@ -0,0 +1,196 @@
+/****************************************************************************
+ * ==> BVHAnimation --------------------------------------------------------*
+ ****************************************************************************
+ * Description : Motion capture .bvh file reader                            *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <string>
+#include <vector>
+#include <map>
+
+// classes
+#include "Model.h"
+
+/**
+* Biovision .bvh motion capture file reader. The joint rotations are converted to quaternions while the file is read,
+* then an animation set may be created for any model whose skeleton matches the capture
+*@author Jean-Milost Reymond
+*/
+class BVHAnimation
+{
+    public:
+        /**
+        * Rename table, it's a dictionary which links the capture joint names to the model bone names
+        */
+        typedef std::map<std::string, std::string> IRenameTable;
+
+        BVHAnimation();
+        virtual ~BVHAnimation();
+
+        /**
+        * Clears the read capture
+        */
+        virtual void Clear();
+
+        /**
+        * Opens a .bvh file
+        *@param fileName - bvh file to open
+        *@return true on success, otherwise false
+        */
+        virtual bool Open(const std::string& fileName);
+
+        /**
+        * Reads a bvh data
+        *@param data - bvh data to read
+        *@return true on success, otherwise false
+        */
+        virtual bool Read(const std::string& data);
+
+        /**
+        * Sets the rename table
+        *@param renameTable - rename table, the joints it doesn't contain keep their name
+        *@note This allows to play the same capture on several rigs, e.g. the MakeHuman default and game engine rigs
+        */
+        virtual void SetRenameTable(const IRenameTable& renameTable);
+
+        /**
+        * Sets the scale to apply to the capture positions
+        *@param scale - scale, e.g. to convert the capture units to the model ones
+        */
+        virtual void SetScale(float scale);
+
+        /**
+        * Gets the capture frame count
+        *@return the frame count
+        */
+        virtual std::size_t GetFrameCount() const;
+
+        /**
+        * Gets the capture frame time
+        *@return the frame time in seconds
+        */
+        virtual double GetFrameTime() const;
+
+        /**
+        * Creates an animation set for a model
+        *@param model - model to animate, its bone table should be built
+        *@return the animation set, nullptr on error
+        *@note The joints are linked to the model bones by name, the joints which match no bone are ignored. The
+        *      capture rest pose is expected to match the model bind pose, the joint rotations are thus applied as
+        *      model space deltas on the bind pose. The positions are applied as offsets from the first frame. The
+        *      returned animation set should be deleted when useless
+        */
+        virtual Model::IAnimationSet* CreateAnimationSet(const Model& model) const;
+
+    private:
+        /**
+        * Channel type
+        */
+        enum class IEChannel
+        {
+            IE_C_XPosition = 0,
+            IE_C_YPosition,
+            IE_C_ZPosition,
+            IE_C_XRotation,
+            IE_C_YRotation,
+            IE_C_ZRotation
+        };
+
+        /**
+        * Capture joint
+        */
+        struct IJoint
+        {
+            typedef std::vector<IEChannel> IChannels;
+
+            std::string m_Name;        // joint name
+            int         m_Parent;      // parent joint index, -1 for a root joint
+            float       m_Offset[3];   // offset from the parent joint
+            IChannels   m_Channels;    // joint channels, in the order they appear in the frames
+            bool        m_HasPosition; // if true, the joint channels contain a position
+
+            IJoint();
+            ~IJoint();
+        };
+
+        typedef std::vector<IJoint> IJoints;
+
+        IJoints            m_Joints;
+        std::vector<float> m_Rotations;    // joint rotations, as x, y, z, w quaternions, per frame then per joint
+        std::vector<float> m_Positions;    // joint positions, as x, y, z, per frame then per joint
+        IRenameTable       m_RenameTable;
+        std::size_t        m_ChannelCount;
+        std::size_t        m_FrameCount;
+        double             m_FrameTime;
+        float              m_Scale;
+
+        /**
+        * Reads the joint hierarchy
+        *@param pData - data to read from, updated to the position following the hierarchy
+        *@param pEnd - data end
+        *@return true on success, otherwise false
+        */
+        bool ReadHierarchy(const char*& pData, const char* pEnd);
+
+        /**
+        * Reads the motion and converts it to quaternions
+        *@param pData - data to read from
+        *@param pEnd - data end
+        *@return true on success, otherwise false
+        */
+        bool ReadMotion(const char*& pData, const char* pEnd);
+
+        /**
+        * Reads the next word
+        *@param pData - data to read from, updated to the position following the word
+        *@param pEnd - data end
+        *@param[out] pStart - word start
+        *@return the word length, 0 if no word was found
+        */
+        static std::size_t ReadWord(const char*& pData, const char* pEnd, const char*& pStart);
+
+        /**
+        * Reads the next word and compares it with a value
+        *@param pData - data to read from, updated to the position following the word
+        *@param pEnd - data end
+        *@param pValue - expected value
+        *@return true if the word matches the value, otherwise false
+        */
+        static bool ExpectWord(const char*& pData, const char* pEnd, const char* pValue);
+
+        /**
+        * Reads the next number
+        *@param pData - data to read from, updated to the position following the number
+        *@param pEnd - data end
+        *@param[out] value - read number
+        *@return true on success, otherwise false
+        *@note This function is much faster than the standard library ones, but doesn't support the locales, the
+        *      hexadecimal notation, the infinites and the NaN
+        */
+        static bool ReadFloat(const char*& pData, const char* pEnd, float& value);
+};
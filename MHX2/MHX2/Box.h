@@ -0,0 +1,227 @@
+/****************************************************************************
+ * ==> Box -----------------------------------------------------------------*
+ ****************************************************************************
+ * Description : Axis aligned bounding box                                  *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <algorithm>
+#include <type_traits>
+#include <limits>
+
+// classes
+#include "Vector3.h"
+#include "Matrix4x4.h"
+
+/**
+* Axis aligned bounding box
+*@author Jean-Milost Reymond
+*/
+template <class T>
+class Box
+{
+    public:
+        Vector3<T> m_Min; // box min corner
+        Vector3<T> m_Max; // box max corner
+
+        /**
+        * Constructor
+        *@note The box is empty until a point or another box is added to it
+        */
+        inline Box();
+
+        /**
+        * Constructor
+        *@param min - box min corner
+        *@param max - box max corner
+        */
+        inline Box(const Vector3<T>& min, const Vector3<T>& max);
+
+        /**
+        * Copy constructor
+        *@param other - other box to copy from
+        */
+        Box(const Box& other) = default;
+
+        ~Box() = default;
+
+        /**
+        * Copy operator
+        *@param other - other box to copy from
+        *@return this box
+        */
+        Box& operator = (const Box& other) = default;
+
+        /**
+        * Clears the box, thus it becomes empty
+        */
+        inline void Clear();
+
+        /**
+        * Checks if the box is empty
+        *@return true if the box is empty (i.e. nothing was added to it), otherwise false
+        */
+        inline bool IsEmpty() const;
+
+        /**
+        * Extends the box to contain a point
+        *@param point - point to add
+        */
+        inline void Add(const Vector3<T>& point);
+
+        /**
+        * Extends the box to contain another box
+        *@param other - other box to merge with
+        */
+        inline void Merge(const Box& other);
+
+        /**
+        * Gets the box center
+        *@return the box center
+        */
+        inline Vector3<T> GetCenter() const;
+
+        /**
+        * Gets the radius of the sphere surrounding the box
+        *@return the radius (i.e. the half diagonal length)
+        */
+        inline T GetRadius() const;
+
+        /**
+        * Transforms the box by a matrix
+        *@param matrix - transform matrix
+        *@return the axis aligned box surrounding the transformed box
+        */
+        inline Box Transform(const Matrix4x4<T>& matrix) const;
+};
+
+typedef Box<float>  BoxF;
+typedef Box<double> BoxD;
+
+// the boxes contain only their corners, thus their arrays may be copied as raw memory, e.g. in the meshlets
+static_assert(sizeof(BoxF)  == 2 * sizeof(Vector3F), "BoxF should contain only its corners");
+static_assert(alignof(BoxF) == alignof(float),       "BoxF should be aligned as its components");
+static_assert(std::is_trivially_copyable<BoxF>::value, "BoxF should be trivially copyable");
+
+//---------------------------------------------------------------------------
+// Box
+//---------------------------------------------------------------------------
+template <class T>
+Box<T>::Box() :
+    m_Min( std::numeric_limits<T>::max(),  std::numeric_limits<T>::max(),  std::numeric_limits<T>::max()),
+    m_Max(-std::numeric_limits<T>::max(), -std::numeric_limits<T>::max(), -std::numeric_limits<T>::max())
+{}
+//---------------------------------------------------------------------------
+template <class T>
+Box<T>::Box(const Vector3<T>& min, const Vector3<T>& max) :
+    m_Min(min),
+    m_Max(max)
+{}
+//---------------------------------------------------------------------------
+template <class T>
+void Box<T>::Clear()
+{
+    m_Min = Vector3<T>( std::numeric_limits<T>::max(),  std::numeric_limits<T>::max(),  std::numeric_limits<T>::max());
+    m_Max = Vector3<T>(-std::numeric_limits<T>::max(), -std::numeric_limits<T>::max(), -std::numeric_limits<T>::max());
+}
+//---------------------------------------------------------------------------
+template <class T>
+bool Box<T>::IsEmpty() const
+{
+    return (m_Min.m_X > m_Max.m_X || m_Min.m_Y > m_Max.m_Y || m_Min.m_Z > m_Max.m_Z);
+}
+//---------------------------------------------------------------------------
+template <class T>
+void Box<T>::Add(const Vector3<T>& point)
+{
+    m_Min.m_X = std::min(m_Min.m_X, point.m_X);
+    m_Min.m_Y = std::min(m_Min.m_Y, point.m_Y);
+    m_Min.m_Z = std::min(m_Min.m_Z, point.m_Z);
+    m_Max.m_X = std::max(m_Max.m_X, point.m_X);
+    m_Max.m_Y = std::max(m_Max.m_Y, point.m_Y);
+    m_Max.m_Z = std::max(m_Max.m_Z, point.m_Z);
+}
+//---------------------------------------------------------------------------
+template <class T>
+void Box<T>::Merge(const Box& other)
+{
+    // nothing to merge?
+    if (other.IsEmpty())
+        return;
+
+    Add(other.m_Min);
+    Add(other.m_Max);
+}
+//---------------------------------------------------------------------------
+template <class T>
+Vector3<T> Box<T>::GetCenter() const
+{
+    return Vector3<T>((m_Min.m_X + m_Max.m_X) * T(0.5),
+                      (m_Min.m_Y + m_Max.m_Y) * T(0.5),
+                      (m_Min.m_Z + m_Max.m_Z) * T(0.5));
+}
+//---------------------------------------------------------------------------
+template <class T>
+T Box<T>::GetRadius() const
+{
+    // empty box?
+    if (IsEmpty())
+        return T(0.0);
+
+    return (m_Max - m_Min).Length() * T(0.5);
+}
+//---------------------------------------------------------------------------
+template <class T>
+Box<T> Box<T>::Transform(const Matrix4x4<T>& matrix) const
+{
+    // nothing to transform?
+    if (IsEmpty())
+        return *this;
+
+    const T min[3] = {m_Min.m_X, m_Min.m_Y, m_Min.m_Z};
+    const T max[3] = {m_Max.m_X, m_Max.m_Y, m_Max.m_Z};
+
+    // start from the translation
+    T resultMin[3] = {matrix.m_Table[3][0], matrix.m_Table[3][1], matrix.m_Table[3][2]};
+    T resultMax[3] = {matrix.m_Table[3][0], matrix.m_Table[3][1], matrix.m_Table[3][2]};
+
+    // add the smallest and largest contribution of each source axis to each destination axis
+    // (see Graphics Gems, "Transforming Axis-Aligned Bounding Boxes", J. Arvo)
+    for (std::size_t i = 0; i < 3; ++i)
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+            const T a = matrix.m_Table[i][j] * min[i];
+            const T b = matrix.m_Table[i][j] * max[i];
+
+            resultMin[j] += std::min(a, b);
+            resultMax[j] += std::max(a, b);
+        }
+
+    return Box(Vector3<T>(resultMin[0], resultMin[1], resultMin[2]),
+               Vector3<T>(resultMax[0], resultMax[1], resultMax[2]));
+}
+//---------------------------------------------------------------------------
@@ -28,6 +28,9 @@
 
 #pragma once
 
+// std
+#include <type_traits>
+
 /**
 * Color
 *@author Jean-Milost Reymond
@@ -56,35 +59,44 @@ class Color
         * Copy constructor
         *@param other - other color to copy from
         */
-        inline Color(const Color& other);
+        Color(const Color& other) = default;
 
-        virtual ~Color();
+        ~Color() = default;
 
         /**
         * Copy operator
         *@param other - other color to copy from
         *@return this vector
         */
-        virtual inline Color& operator = (const Color& other);
+        Color& operator = (const Color& other) = default;
 
         /**
         * Equality operator
         *@param value - value to compare
         *@return true if values are identical, otherwise false
         */
-        virtual inline bool operator == (const Color& value) const;
+        inline bool operator == (const Color& value) const;
 
         /**
         * Not equality operator
         *@param value - value to compare
         *@return true if values are not identical, otherwise false
         */
-        virtual inline bool operator != (const Color& value) const;
+        inline bool operator != (const Color& value) const;
 };
 
 typedef Color<unsigned> ColorU;
 typedef Color<float>    ColorF;
 
+// the colors contain only their components, thus their arrays may be copied as raw memory
+static_assert(sizeof(ColorF)  == 4 * sizeof(float), "ColorF should contain only its components");
+static_assert(alignof(ColorF) == alignof(float),    "ColorF should be aligned as its components");
+static_assert(std::is_trivially_copyable<ColorF>::value, "ColorF should be trivially copyable");
+
+static_assert(sizeof(ColorU)  == 4 * sizeof(unsigned), "ColorU should contain only its components");
+static_assert(alignof(ColorU) == alignof(unsigned),    "ColorU should be aligned as its components");
+static_assert(std::is_trivially_copyable<ColorU>::value, "ColorU should be trivially copyable");
+
 //---------------------------------------------------------------------------
 // Color
 //---------------------------------------------------------------------------
@@ -104,29 +116,6 @@ Color<T>::Color(T r, T g, T b, T a) :
     m_A(a)
 {}
 //---------------------------------------------------------------------------
-template <class T>
-Color<T>::Color(const Color& other) :
-    m_R(other.m_R),
-    m_G(other.m_G),
-    m_B(other.m_B),
-    m_A(other.m_A)
-{}
-//---------------------------------------------------------------------------
-template <class T>
-Color<T>::~Color()
-{}
-//---------------------------------------------------------------------------
-template<class T>
-Color<T>& Color<T>::operator = (const Color& other)
-{
-    m_R = other.m_R;
-    m_G = other.m_G;
-    m_B = other.m_B;
-    m_A = other.m_A;
-
-    return *this;
-}
-//---------------------------------------------------------------------------
 template<class T>
 bool Color<T>::operator == (const Color& value) const
 {
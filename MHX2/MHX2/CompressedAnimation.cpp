@@ -0,0 +1,689 @@
+/****************************************************************************
+ * ==> CompressedAnimation -------------------------------------------------*
+ ****************************************************************************
+ * Description : Quantized, key reduced animation set                       *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "CompressedAnimation.h"
+
+// std
+#include <cmath>
+#include <algorithm>
+
+// classes
+#include "Quaternion.h"
+#include "AnimationSampler.h"
+
+//---------------------------------------------------------------------------
+// CompressedAnimation::ITrack
+//---------------------------------------------------------------------------
+CompressedAnimation::ITrack::ITrack() :
+    m_Type(IETrackType::IE_TT_Constant),
+    m_FirstKey(0),
+    m_KeyCount(0),
+    m_Offset(0)
+{
+    std::fill(m_Value,  m_Value  + 4, 0.0f);
+    std::fill(m_Extent, m_Extent + 3, 0.0f);
+}
+//---------------------------------------------------------------------------
+CompressedAnimation::ITrack::~ITrack()
+{}
+//---------------------------------------------------------------------------
+// CompressedAnimation::IChannel
+//---------------------------------------------------------------------------
+CompressedAnimation::IChannel::IChannel() :
+    m_BoneIndex(0)
+{}
+//---------------------------------------------------------------------------
+CompressedAnimation::IChannel::~IChannel()
+{}
+//---------------------------------------------------------------------------
+// CompressedAnimation
+//---------------------------------------------------------------------------
+CompressedAnimation::CompressedAnimation() :
+    m_FrameCount(0),
+    m_FrameRate(0.0),
+    m_Error(0.0f)
+{}
+//---------------------------------------------------------------------------
+CompressedAnimation::~CompressedAnimation()
+{}
+//---------------------------------------------------------------------------
+void CompressedAnimation::Clear()
+{
+    m_Channels.clear();
+    m_BoneChannels.clear();
+    m_StaticBones.clear();
+    m_KeyFrames.clear();
+    m_Values.clear();
+
+    m_FrameCount = 0;
+    m_FrameRate  = 0.0;
+    m_Error      = 0.0f;
+}
+//---------------------------------------------------------------------------
+bool CompressedAnimation::Compress(const Model&                model,
+                                   const Model::IAnimationSet& animSet,
+                                         float                 maxError,
+                                         double                frameRate)
+{
+    Clear();
+
+    const Model::IBoneTable& boneTable = model.m_BoneTable;
+    const std::size_t        boneCount = boneTable.m_Bones.size();
+
+    // nothing to compress, or invalid parameters?
+    if (!boneCount || maxError <= 0.0f || frameRate <= 0.0)
+        return false;
+
+    // resample the whole duration, with an integer frame count
+    const double duration  = double(animSet.m_MaxValue) / double(AnimationSampler::m_TicksPerSecond);
+    const double intervals = (duration > 0.0) ? std::ceil(duration * frameRate - 0.001) : 0.0;
+
+    // the frames should be indexable on 16 bits
+    if (intervals >= double(0xFFFF))
+        return false;
+
+    m_FrameCount = std::size_t(intervals) + 1;
+    m_FrameRate  = (intervals > 0.0) ? intervals / duration : frameRate;
+
+    std::vector<const Model::IAnimation*> animations(boneCount, nullptr);
+    std::vector<bool>                     animated(boneCount, false);
+
+    // link each animation to its bone, as the sampler does
+    for (std::size_t i = 0; i < animSet.m_Animations.size(); ++i)
+    {
+        const Model::IAnimation* pAnimation = animSet.m_Animations[i];
+
+        if (!pAnimation)
+            continue;
+
+        int boneIndex = -1;
+
+        if (pAnimation->m_pBone                      &&
+            pAnimation->m_pBone->m_Index < boneCount &&
+            boneTable.m_Bones[pAnimation->m_pBone->m_Index] == pAnimation->m_pBone)
+            boneIndex = int(pAnimation->m_pBone->m_Index);
+        else
+            boneIndex = model.FindBoneIndex(pAnimation->m_BoneName);
+
+        if (boneIndex < 0 || animated[boneIndex])
+            continue;
+
+        animations[boneIndex] = pAnimation;
+        animated[boneIndex]   = true;
+    }
+
+    Model::IMatrices rawPose(m_FrameCount * boneCount);
+
+    // resample the animations
+    for (std::size_t i = 0; i < m_FrameCount; ++i)
+    {
+        const double time = (m_FrameCount > 1) ? double(animSet.m_MaxValue) * double(i) / intervals : 0.0;
+
+        for (std::size_t j = 0; j < boneCount; ++j)
+            if (animations[j])
+                AnimationSampler::SampleBone(*animations[j],
+                                              time,
+                                              boneTable.m_Local[j],
+                                              AnimationSampler::IEInterpolation::IE_I_Nlerp,
+                                              rawPose[i * boneCount + j]);
+            else
+                rawPose[i * boneCount + j] = boneTable.m_Local[j];
+    }
+
+    IValues                  extents(boneCount, 0.0f);
+    std::vector<std::size_t> chains(boneCount, 1);
+
+    // get the depth of each bone
+    for (std::size_t i = 0; i < boneCount; ++i)
+        if (boneTable.m_Parents[i] >= 0)
+            chains[i] = chains[boneTable.m_Parents[i]] + 1;
+
+    // get the distance between each bone and its farthest child, and the longest bone chain passing through it. A
+    // leaf bone is considered as long as the distance to its parent
+    for (std::size_t i = boneCount; i-- > 0;)
+    {
+        const int parent = boneTable.m_Parents[i];
+
+        if (parent < 0)
+            continue;
+
+        const Matrix4x4F& bone       = boneTable.m_Global[i];
+        const Matrix4x4F& parentBone = boneTable.m_Global[parent];
+        const float       x          = bone.m_Table[3][0] - parentBone.m_Table[3][0];
+        const float       y          = bone.m_Table[3][1] - parentBone.m_Table[3][1];
+        const float       z          = bone.m_Table[3][2] - parentBone.m_Table[3][2];
+        const float       distance   = std::sqrt(x * x + y * y + z * z);
+
+        if (extents[i] <= 0.0f)
+            extents[i] = distance;
+
+        extents[parent] = std::max(extents[parent], distance + extents[i]);
+        chains[parent]  = std::max(chains[parent],  chains[i]);
+    }
+
+    for (std::size_t i = 0; i < boneCount; ++i)
+        if (extents[i] <= 0.0f)
+            extents[i] = 1.0f;
+
+    IValues tolerances(boneCount);
+    float   budget = 1.0f;
+
+    // the error bound is shared between the bones of each chain, then tightened until it's respected
+    for (std::size_t i = 0; i < m_MaxAttempts; ++i, budget *= 0.5f)
+    {
+        for (std::size_t j = 0; j < boneCount; ++j)
+            tolerances[j] = maxError * budget / float(chains[j]);
+
+        Build(model, rawPose, animated, tolerances, extents);
+
+        m_Error = MeasureError(model, rawPose, extents);
+
+        if (m_Error <= maxError)
+            return true;
+    }
+
+    Clear();
+    return false;
+}
+//---------------------------------------------------------------------------
+bool CompressedAnimation::Sample(const Model&               model,
+                                       double               time,
+                                       Model::IMatrices&    localPose,
+                                 const Model::ISkeletonLOD* pLOD) const
+{
+    const Model::IBoneTable& boneTable = model.m_BoneTable;
+    const std::size_t        boneCount = boneTable.m_Local.size();
+
+    // not compressed for this skeleton?
+    if (!m_FrameCount || m_BoneChannels.size() != boneCount)
+        return false;
+
+    const double frame = GetFrame(time);
+
+    localPose.resize(boneCount);
+
+    // the level of detail should match the skeleton
+    if (pLOD && pLOD->m_Targets.size() != boneCount)
+        pLOD = nullptr;
+
+    // write the animated bones, the collapsed ones keep their bind pose relative to their target
+    for (std::size_t i = 0; i < m_Channels.size(); ++i)
+    {
+        const std::size_t boneIndex = m_Channels[i].m_BoneIndex;
+
+        if (pLOD && pLOD->m_Targets[boneIndex] != boneIndex)
+            localPose[boneIndex] = boneTable.m_Local[boneIndex];
+        else
+            SampleChannel(m_Channels[i], frame, localPose[boneIndex]);
+    }
+
+    // the other bones keep their bind pose
+    for (std::size_t i = 0; i < m_StaticBones.size(); ++i)
+        localPose[m_StaticBones[i]] = boneTable.m_Local[m_StaticBones[i]];
+
+    return true;
+}
+//---------------------------------------------------------------------------
+void CompressedAnimation::SampleBone(      std::size_t boneIndex,
+                                           double      time,
+                                     const Matrix4x4F& bindLocal,
+                                           Matrix4x4F& matrix) const
+{
+    // bone not animated?
+    if (boneIndex >= m_BoneChannels.size() || m_BoneChannels[boneIndex] < 0)
+    {
+        matrix = bindLocal;
+        return;
+    }
+
+    SampleChannel(m_Channels[m_BoneChannels[boneIndex]], GetFrame(time), matrix);
+}
+//---------------------------------------------------------------------------
+float CompressedAnimation::GetError() const
+{
+    return m_Error;
+}
+//---------------------------------------------------------------------------
+std::size_t CompressedAnimation::GetSize() const
+{
+    return m_Channels.size()     * sizeof(IChannel)    +
+           m_BoneChannels.size() * sizeof(int)         +
+           m_StaticBones.size()  * sizeof(std::size_t) +
+           m_KeyFrames.size()    * sizeof(unsigned short) +
+           m_Values.size()       * sizeof(unsigned short);
+}
+//---------------------------------------------------------------------------
+std::size_t CompressedAnimation::GetKeyCount() const
+{
+    return m_KeyFrames.size();
+}
+//---------------------------------------------------------------------------
+void CompressedAnimation::Build(const Model&             model,
+                                const Model::IMatrices&  rawPose,
+                                const std::vector<bool>& animated,
+                                const IValues&           tolerances,
+                                const IValues&           extents)
+{
+    const Model::IBoneTable& boneTable = model.m_BoneTable;
+    const std::size_t        boneCount = boneTable.m_Bones.size();
+
+    m_Channels.clear();
+    m_BoneChannels.assign(boneCount, -1);
+    m_StaticBones.clear();
+    m_KeyFrames.clear();
+    m_Values.clear();
+
+    IValues rotations(m_FrameCount * 4);
+    IValues positions(m_FrameCount * 3);
+    IValues scales(m_FrameCount * 3);
+
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        if (!animated[i])
+        {
+            m_StaticBones.push_back(i);
+            continue;
+        }
+
+        // decompose the bone matrices, keeping the rotations in the same hemisphere
+        for (std::size_t j = 0; j < m_FrameCount; ++j)
+        {
+            float* pRotation = &rotations[j * 4];
+
+            Decompose(rawPose[j * boneCount + i], pRotation, &positions[j * 3], &scales[j * 3]);
+
+            if (j && pRotation[0] * pRotation[-4] + pRotation[1] * pRotation[-3] +
+                     pRotation[2] * pRotation[-2] + pRotation[3] * pRotation[-1] < 0.0f)
+                for (std::size_t k = 0; k < 4; ++k)
+                    pRotation[k] = -pRotation[k];
+        }
+
+        float bindRotation[4];
+        float bindPosition[3];
+        float bindScale[3];
+
+        Decompose(boneTable.m_Local[i], bindRotation, bindPosition, bindScale);
+
+        IChannel channel;
+        channel.m_BoneIndex = i;
+
+        // a rotation or scale error moves the bone children up to its extent
+        const bool rotationIsBind = BuildTrack(rotations, 4, bindRotation, tolerances[i] / extents[i], channel.m_Rotation);
+        const bool positionIsBind = BuildTrack(positions, 3, bindPosition, tolerances[i],              channel.m_Position);
+        const bool scaleIsBind    = BuildTrack(scales,    3, bindScale,    tolerances[i] / extents[i], channel.m_Scale);
+
+        // the bone keeps its bind pose, strip it
+        if (rotationIsBind && positionIsBind && scaleIsBind)
+        {
+            m_StaticBones.push_back(i);
+            continue;
+        }
+
+        m_BoneChannels[i] = int(m_Channels.size());
+        m_Channels.push_back(channel);
+    }
+}
+//---------------------------------------------------------------------------
+bool CompressedAnimation::BuildTrack(const IValues&     values,
+                                           std::size_t  componentCount,
+                                     const float*       bindValue,
+                                           float        tolerance,
+                                           ITrack&      track)
+{
+    const bool        isRotation = (componentCount == 4);
+    const std::size_t frameCount = values.size() / componentCount;
+
+    // gets the error between 2 values
+    auto getError = [isRotation](const float* pFirst, const float* pSecond)
+    {
+        if (isRotation)
+            return GetAngle(pFirst, pSecond);
+
+        const float x = pFirst[0] - pSecond[0];
+        const float y = pFirst[1] - pSecond[1];
+        const float z = pFirst[2] - pSecond[2];
+
+        return std::sqrt(x * x + y * y + z * z);
+    };
+
+    bool isBind     = true;
+    bool isConstant = true;
+
+    // check if the track keeps its bind pose, or at least a constant value
+    for (std::size_t i = 0; i < frameCount && (isBind || isConstant); ++i)
+    {
+        isBind     = isBind     && getError(&values[i * componentCount], bindValue)  <= tolerance;
+        isConstant = isConstant && getError(&values[i * componentCount], &values[0]) <= tolerance;
+    }
+
+    track.m_Type = IETrackType::IE_TT_Constant;
+
+    if (isBind || isConstant)
+    {
+        std::copy(isBind ? bindValue : &values[0], (isBind ? bindValue : &values[0]) + componentCount, track.m_Value);
+        return isBind;
+    }
+
+    track.m_Type     = IETrackType::IE_TT_Animated;
+    track.m_FirstKey = m_KeyFrames.size();
+    track.m_Offset   = m_Values.size();
+
+    // get the range of the positions and scales
+    if (!isRotation)
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            float minValue = values[i];
+            float maxValue = values[i];
+
+            for (std::size_t j = 1; j < frameCount; ++j)
+            {
+                minValue = std::min(minValue, values[j * 3 + i]);
+                maxValue = std::max(maxValue, values[j * 3 + i]);
+            }
+
+            track.m_Value[i]  = minValue;
+            track.m_Extent[i] = maxValue - minValue;
+        }
+
+    IQuantizedValues quantized(frameCount * 3);
+    IValues          decoded(frameCount * componentCount);
+
+    // quantize all the frames, the keys are then selected on the quantized values, thus the quantization error is
+    // part of the measured error
+    for (std::size_t i = 0; i < frameCount; ++i)
+        if (isRotation)
+        {
+            EncodeRotation(&values[i * 4], &quantized[i * 3]);
+            DecodeRotation(&quantized[i * 3], &decoded[i * 4]);
+        }
+        else
+            for (std::size_t j = 0; j < 3; ++j)
+            {
+                const float extent = track.m_Extent[j];
+                const float factor = (extent > 0.0f) ? (values[i * 3 + j] - track.m_Value[j]) / extent : 0.0f;
+
+                quantized[i * 3 + j] = (unsigned short)(std::min(std::max(factor, 0.0f), 1.0f) * 65535.0f + 0.5f);
+                decoded[i * 3 + j]   = track.m_Value[j] + float(quantized[i * 3 + j]) * (extent / 65535.0f);
+            }
+
+    std::vector<std::size_t> keys;
+    keys.push_back(0);
+
+    std::size_t anchor = 0;
+    float       interpolated[4];
+
+    // keep extending the segment starting on the last key until an intermediate frame can no longer be interpolated
+    for (std::size_t i = 2; i < frameCount; ++i)
+    {
+        bool canReach = (i - anchor <= m_MaxKeyGap);
+
+        for (std::size_t j = anchor + 1; j < i && canReach; ++j)
+        {
+            const float  factor = float(j - anchor) / float(i - anchor);
+            const float* pFrom  = &decoded[anchor * componentCount];
+            const float* pTo    = &decoded[i      * componentCount];
+
+            if (isRotation)
+                AnimationSampler::Nlerp(pFrom, pTo, factor, interpolated);
+            else
+                for (std::size_t k = 0; k < 3; ++k)
+                    interpolated[k] = pFrom[k] + (pTo[k] - pFrom[k]) * factor;
+
+            canReach = getError(interpolated, &values[j * componentCount]) <= tolerance;
+        }
+
+        if (!canReach)
+        {
+            anchor = i - 1;
+            keys.push_back(anchor);
+        }
+    }
+
+    if (frameCount > 1)
+        keys.push_back(frameCount - 1);
+
+    // write the kept keys
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        m_KeyFrames.push_back((unsigned short)keys[i]);
+        m_Values.insert(m_Values.end(), quantized.begin() + keys[i] * 3, quantized.begin() + keys[i] * 3 + 3);
+    }
+
+    track.m_KeyCount = keys.size();
+
+    return false;
+}
+//---------------------------------------------------------------------------
+float CompressedAnimation::MeasureError(const Model&            model,
+                                        const Model::IMatrices& rawPose,
+                                        const IValues&          extents) const
+{
+    const Model::IBoneTable& boneTable = model.m_BoneTable;
+    const std::size_t        boneCount = boneTable.m_Bones.size();
+
+    Model::IMatrices rawLocal;
+    Model::IMatrices local(boneCount);
+    Model::IMatrices rawGlobal;
+    Model::IMatrices global;
+
+    float error = 0.0f;
+
+    for (std::size_t i = 0; i < m_FrameCount; ++i)
+    {
+        rawLocal.assign(rawPose.begin() + i * boneCount, rawPose.begin() + (i + 1) * boneCount);
+
+        for (std::size_t j = 0; j < m_Channels.size(); ++j)
+            SampleChannel(m_Channels[j], double(i), local[m_Channels[j].m_BoneIndex]);
+
+        for (std::size_t j = 0; j < m_StaticBones.size(); ++j)
+            local[m_StaticBones[j]] = boneTable.m_Local[m_StaticBones[j]];
+
+        model.GetGlobalPose(rawLocal, rawGlobal);
+        model.GetGlobalPose(local,    global);
+
+        // measure the error on the bone position, and on a virtual point at the bone extent on each axis
+        for (std::size_t j = 0; j < boneCount; ++j)
+        {
+            float offset[3];
+
+            for (std::size_t k = 0; k < 3; ++k)
+                offset[k] = global[j].m_Table[3][k] - rawGlobal[j].m_Table[3][k];
+
+            error = std::max(error, std::sqrt(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]));
+
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                float point[3];
+
+                for (std::size_t l = 0; l < 3; ++l)
+                    point[l] = offset[l] + extents[j] * (global[j].m_Table[k][l] - rawGlobal[j].m_Table[k][l]);
+
+                error = std::max(error, std::sqrt(point[0] * point[0] + point[1] * point[1] + point[2] * point[2]));
+            }
+        }
+    }
+
+    return error;
+}
+//---------------------------------------------------------------------------
+void CompressedAnimation::SampleChannel(const IChannel& channel, double frame, Matrix4x4F& matrix) const
+{
+    float rotation[4];
+    float position[3];
+    float scale[3];
+
+    SampleTrack(channel.m_Rotation, true,  frame, rotation);
+    SampleTrack(channel.m_Position, false, frame, position);
+    SampleTrack(channel.m_Scale,    false, frame, scale);
+
+    matrix = QuaternionF(rotation[0], rotation[1], rotation[2], rotation[3]).ToMatrix();
+
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        matrix.m_Table[i][0] *= scale[i];
+        matrix.m_Table[i][1] *= scale[i];
+        matrix.m_Table[i][2] *= scale[i];
+        matrix.m_Table[3][i]  = position[i];
+    }
+}
+//---------------------------------------------------------------------------
+void CompressedAnimation::SampleTrack(const ITrack& track, bool isRotation, double frame, float* pValue) const
+{
+    const std::size_t componentCount = isRotation ? 4 : 3;
+
+    if (track.m_Type == IETrackType::IE_TT_Constant || track.m_KeyCount < 2)
+    {
+        std::copy(track.m_Value, track.m_Value + componentCount, pValue);
+        return;
+    }
+
+    const unsigned short* pFrames = &m_KeyFrames[track.m_FirstKey];
+    const unsigned short* pValues = &m_Values[track.m_Offset];
+
+    // find the key following the frame, the first key is always the frame 0
+    const std::size_t next = std::min(std::size_t(std::upper_bound(pFrames, pFrames + track.m_KeyCount, frame) - pFrames),
+                                      track.m_KeyCount - 1);
+    const std::size_t key    = next - 1;
+    const float       factor = std::min(float((frame - pFrames[key]) / double(pFrames[next] - pFrames[key])), 1.0f);
+
+    if (isRotation)
+    {
+        float from[4];
+        float to[4];
+
+        DecodeRotation(&pValues[key  * 3], from);
+        DecodeRotation(&pValues[next * 3], to);
+
+        AnimationSampler::Nlerp(from, to, factor, pValue);
+        return;
+    }
+
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        const float from = float(pValues[key  * 3 + i]);
+        const float to   = float(pValues[next * 3 + i]);
+
+        pValue[i] = track.m_Value[i] + (from + (to - from) * factor) * (track.m_Extent[i] / 65535.0f);
+    }
+}
+//---------------------------------------------------------------------------
+double CompressedAnimation::GetFrame(double time) const
+{
+    if (m_FrameCount < 2)
+        return 0.0;
+
+    const double frame = time * m_FrameRate / double(AnimationSampler::m_TicksPerSecond);
+
+    return std::min(std::max(frame, 0.0), double(m_FrameCount - 1));
+}
+//---------------------------------------------------------------------------
+void CompressedAnimation::Decompose(const Matrix4x4F& matrix, float* pRotation, float* pPosition, float* pScale)
+{
+    Matrix4x4F rotation = Matrix4x4F::Identity();
+
+    // extract the scale from the rotation rows
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        pScale[i]    = std::sqrt(matrix.m_Table[i][0] * matrix.m_Table[i][0] +
+                                 matrix.m_Table[i][1] * matrix.m_Table[i][1] +
+                                 matrix.m_Table[i][2] * matrix.m_Table[i][2]);
+        pPosition[i] = matrix.m_Table[3][i];
+
+        for (std::size_t j = 0; j < 3; ++j)
+            rotation.m_Table[i][j] = (pScale[i] > 0.0f) ? matrix.m_Table[i][j] / pScale[i] : 0.0f;
+    }
+
+    bool              error      = false;
+    const QuaternionF quaternion = QuaternionF().FromMatrix(rotation, error).Conjugate().Normalize();
+
+    pRotation[0] = error ? 0.0f : quaternion.m_X;
+    pRotation[1] = error ? 0.0f : quaternion.m_Y;
+    pRotation[2] = error ? 0.0f : quaternion.m_Z;
+    pRotation[3] = error ? 1.0f : quaternion.m_W;
+}
+//---------------------------------------------------------------------------
+void CompressedAnimation::EncodeRotation(const float* pRotation, unsigned short* pValues)
+{
+    std::size_t largest = 0;
+
+    // find the largest component, which is restored from the others
+    for (std::size_t i = 1; i < 4; ++i)
+        if (std::fabs(pRotation[i]) > std::fabs(pRotation[largest]))
+            largest = i;
+
+    // the largest component is always stored as positive, the quaternion and its opposite being the same rotation
+    const float sign = (pRotation[largest] < 0.0f) ? -1.0f : 1.0f;
+
+    // the other components are between -1/sqrt(2) and 1/sqrt(2)
+    for (std::size_t i = 0, j = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+
+        const float factor = (pRotation[i] * sign * 1.41421356f + 1.0f) * 0.5f;
+
+        pValues[j++] = (unsigned short)(std::min(std::max(factor, 0.0f), 1.0f) * 32767.0f + 0.5f);
+    }
+
+    pValues[0] |= (unsigned short)((largest & 2) << 14);
+    pValues[1] |= (unsigned short)((largest & 1) << 15);
+}
+//---------------------------------------------------------------------------
+void CompressedAnimation::DecodeRotation(const unsigned short* pValues, float* pRotation)
+{
+    const std::size_t largest = ((pValues[0] >> 15) << 1) | (pValues[1] >> 15);
+
+    float sum = 0.0f;
+
+    for (std::size_t i = 0, j = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+
+        pRotation[i] = (float(pValues[j++] & 0x7FFF) * (2.0f / 32767.0f) - 1.0f) * 0.70710678f;
+        sum         += pRotation[i] * pRotation[i];
+    }
+
+    pRotation[largest] = std::sqrt(std::max(1.0f - sum, 0.0f));
+}
+//---------------------------------------------------------------------------
+float CompressedAnimation::GetAngle(const float* pFirst, const float* pSecond)
+{
+    const float dot  = pFirst[0] * pSecond[0] + pFirst[1] * pSecond[1] + pFirst[2] * pSecond[2] + pFirst[3] * pSecond[3];
+    const float sign = (dot < 0.0f) ? -1.0f : 1.0f;
+
+    float distance = 0.0f;
+
+    // the angle is calculated from the chord between the quaternions, which remains accurate for small angles, unlike
+    // the arc cosine of their dot product
+    for (std::size_t i = 0; i < 4; ++i)
+        distance += (pFirst[i] - pSecond[i] * sign) * (pFirst[i] - pSecond[i] * sign);
+
+    return 4.0f * std::asin(std::min(std::sqrt(distance) * 0.5f, 1.0f));
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,269 @@
+/****************************************************************************
+ * ==> CompressedAnimation -------------------------------------------------*
+ ****************************************************************************
+ * Description : Quantized, key reduced animation set                       *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <vector>
+
+// classes
+#include "Model.h"
+
+/**
+* Compressed animation set. The animations are resampled at a fixed frame rate, then each bone transformation is
+* either stripped if it keeps its bind pose, stored once if it's constant, or reduced to the keys required to remain
+* within an error bound, measured in the model space. The remaining rotations are quantized by their smallest three
+* components, and the positions and scales relatively to their range. The pose is sampled directly from the
+* compressed data
+*@author Jean-Milost Reymond
+*/
+class CompressedAnimation
+{
+    public:
+        CompressedAnimation();
+        virtual ~CompressedAnimation();
+
+        /**
+        * Clears the compressed data
+        */
+        virtual void Clear();
+
+        /**
+        * Compresses an animation set
+        *@param model - model owning the animation set
+        *@param animSet - animation set to compress
+        *@param maxError - maximum error allowed, in model units, measured on each bone position and on virtual
+        *                  points placed around each bone at the distance of its farthest child
+        *@param frameRate - frame rate at which the animation set is resampled, in frames per second
+        *@return true on success, otherwise false
+        *@note The bone table should be built before this function is called. The tolerance of each transformation
+        *      is derived from the error bound and from the bone position in the skeleton, then tightened until the
+        *      measured error is within the bound. The function fails if the bound cannot be reached, e.g. if it's
+        *      lower than the quantization error
+        */
+        virtual bool Compress(const Model&                model,
+                              const Model::IAnimationSet& animSet,
+                                    float                 maxError,
+                                    double                frameRate = 30.0);
+
+        /**
+        * Samples the compressed animation set
+        *@param model - model owning the animation set
+        *@param time - time, in animation key time stamps
+        *@param[out] localPose - local bone matrices, in the same order as the model bone table
+        *@param pLOD - skeleton level of detail, its collapsed bones aren't sampled. Ignored if nullptr
+        *@return true on success, otherwise false
+        *@note The bones which aren't animated, or which are collapsed, take their bind pose
+        */
+        virtual bool Sample(const Model&               model,
+                                  double               time,
+                                  Model::IMatrices&    localPose,
+                            const Model::ISkeletonLOD* pLOD = nullptr) const;
+
+        /**
+        * Samples the local matrix of a single bone
+        *@param boneIndex - bone index in the model bone table
+        *@param time - time, in animation key time stamps
+        *@param bindLocal - bone bind pose local matrix, returned if the bone isn't animated
+        *@param[out] matrix - local bone matrix
+        */
+        virtual void SampleBone(      std::size_t boneIndex,
+                                      double      time,
+                                const Matrix4x4F& bindLocal,
+                                      Matrix4x4F& matrix) const;
+
+        /**
+        * Gets the maximum error measured while compressing
+        *@return the maximum error, in model units
+        */
+        virtual float GetError() const;
+
+        /**
+        * Gets the compressed data size
+        *@return the compressed data size, in bytes
+        */
+        virtual std::size_t GetSize() const;
+
+        /**
+        * Gets the key count, i.e. the count of animated transformation values which are kept
+        *@return the key count
+        */
+        virtual std::size_t GetKeyCount() const;
+
+    private:
+        /**
+        * Track type
+        */
+        enum class IETrackType
+        {
+            IE_TT_Constant = 0, // the track has a single value, which may be its bind pose
+            IE_TT_Animated      // the track has quantized keys
+        };
+
+        /**
+        * Track, i.e. the values of one transformation of one bone
+        */
+        struct ITrack
+        {
+            IETrackType m_Type;      // track type
+            std::size_t m_FirstKey;  // first key in the key frame table
+            std::size_t m_KeyCount;  // key count
+            std::size_t m_Offset;    // first key value in the quantized value table
+            float       m_Value[4];  // constant value, or minimum value for the range reduced tracks
+            float       m_Extent[3]; // range extent of the range reduced tracks
+
+            ITrack();
+            ~ITrack();
+        };
+
+        /**
+        * Channel, i.e. the tracks of one bone
+        */
+        struct IChannel
+        {
+            std::size_t m_BoneIndex; // animated bone index in the model bone table
+            ITrack      m_Rotation;  // rotation track, in x, y, z, w order
+            ITrack      m_Position;  // position track
+            ITrack      m_Scale;     // scale track
+
+            IChannel();
+            ~IChannel();
+        };
+
+        typedef std::vector<IChannel>       IChannels;
+        typedef std::vector<int>            IChannelIndices;
+        typedef std::vector<std::size_t>    IBoneIndices;
+        typedef std::vector<unsigned short> IQuantizedValues;
+        typedef std::vector<float>          IValues;
+
+        static const std::size_t m_MaxAttempts = 8;   // compression attempts, the tolerances are halved after each one
+        static const std::size_t m_MaxKeyGap   = 255; // maximum frame count between 2 keys, bounds the key reduction time
+
+        IChannels        m_Channels;
+        IChannelIndices  m_BoneChannels;
+        IBoneIndices     m_StaticBones;
+        IQuantizedValues m_KeyFrames;
+        IQuantizedValues m_Values;
+        std::size_t      m_FrameCount;
+        double           m_FrameRate;
+        float            m_Error;
+
+        /**
+        * Compresses the tracks of all the animated bones with given tolerances
+        *@param model - model owning the animation set
+        *@param rawPose - resampled local poses, frame after frame
+        *@param animated - for each bone, true if the bone is animated
+        *@param tolerances - position tolerance of each bone, the angular and scale tolerances are derived from it
+        *@param extents - distance between each bone and its farthest child
+        */
+        void Build(const Model&             model,
+                   const Model::IMatrices&  rawPose,
+                   const std::vector<bool>& animated,
+                   const IValues&           tolerances,
+                   const IValues&           extents);
+
+        /**
+        * Compresses a track
+        *@param values - raw track values, frame after frame
+        *@param componentCount - component count per value, 4 for rotations, 3 for positions and scales
+        *@param bindValue - bind pose value
+        *@param tolerance - maximum error allowed, in radians for the rotations
+        *@param[out] track - compressed track
+        *@return true if the track keeps its bind pose, otherwise false
+        */
+        bool BuildTrack(const IValues&     values,
+                              std::size_t  componentCount,
+                        const float*       bindValue,
+                              float        tolerance,
+                              ITrack&      track);
+
+        /**
+        * Measures the maximum error between the compressed poses and the resampled ones
+        *@param model - model owning the animation set
+        *@param rawPose - resampled local poses, frame after frame
+        *@param extents - distance between each bone and its farthest child
+        *@return the maximum error, in model units
+        */
+        float MeasureError(const Model& model, const Model::IMatrices& rawPose, const IValues& extents) const;
+
+        /**
+        * Samples a channel
+        *@param channel - channel to sample
+        *@param frame - frame position, between 0 and the last frame
+        *@param[out] matrix - local bone matrix
+        */
+        void SampleChannel(const IChannel& channel, double frame, Matrix4x4F& matrix) const;
+
+        /**
+        * Samples a track
+        *@param track - track to sample
+        *@param isRotation - if true, the track contains rotations, otherwise positions or scales
+        *@param frame - frame position, between 0 and the last frame
+        *@param[out] pValue - sampled value
+        */
+        void SampleTrack(const ITrack& track, bool isRotation, double frame, float* pValue) const;
+
+        /**
+        * Converts a time to a frame position
+        *@param time - time, in animation key time stamps
+        *@return the frame position, between 0 and the last frame
+        */
+        double GetFrame(double time) const;
+
+        /**
+        * Decomposes a local matrix
+        *@param matrix - local matrix
+        *@param[out] pRotation - rotation, in x, y, z, w order
+        *@param[out] pPosition - position
+        *@param[out] pScale - scale
+        */
+        static void Decompose(const Matrix4x4F& matrix, float* pRotation, float* pPosition, float* pScale);
+
+        /**
+        * Quantizes a rotation by its smallest three components, on 15 bits each. The largest component index is
+        * stored in the high bits of the 2 first values
+        *@param pRotation - normalized rotation, in x, y, z, w order
+        *@param[out] pValues - 3 quantized values
+        */
+        static void EncodeRotation(const float* pRotation, unsigned short* pValues);
+
+        /**
+        * Restores a quantized rotation
+        *@param pValues - 3 quantized values
+        *@param[out] pRotation - rotation, in x, y, z, w order
+        */
+        static void DecodeRotation(const unsigned short* pValues, float* pRotation);
+
+        /**
+        * Gets the angle between 2 rotations
+        *@param pFirst - first rotation, in x, y, z, w order
+        *@param pSecond - second rotation, in x, y, z, w order
+        *@return the angle, in radians
+        */
+        static float GetAngle(const float* pFirst, const float* pSecond);
+};
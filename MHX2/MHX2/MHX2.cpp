@@ -186,96 +186,65 @@ void DrawMHX2(const MHX2Model&       mhx2Model,
     if (!pShader)
         return;
 
-    Model* pModel = mhx2Model.GetModel(animSetIndex, elapsedTime);
+    ModelInstance* pInstance = mhx2Model.GetModel(animSetIndex, elapsedTime);
+
+    if (!pInstance)
+        return;
 
     // iterate through the meshes to draw
-    for (std::size_t i = 0; i < pModel->m_Mesh.size(); ++i)
+    for (std::size_t i = 0; i < pInstance->m_Mesh.size(); ++i)
         // draw the model mesh
-        pRenderer->Draw(*pModel->m_Mesh[i], modelMatrix, pShader);
+        pRenderer->Draw(*pInstance->m_Mesh[i], modelMatrix, pShader);
 }
 //---------------------------------------------------------------------------
-void DrawBone(const MHX2Model&       mhx2Model,
-              const Model*           pModel,
-              const Model::IBone*    pBone,
-              const Matrix4x4F&      modelMatrix,
-              const Shader_OpenGL*   pShader,
-              const Renderer_OpenGL* pRenderer,
-              int                    animSetIndex,
-              double                 elapsedTime)
+void DrawSkeleton(const MHX2Model&       mhx2Model,
+                  const Matrix4x4F&      modelMatrix,
+                  const Shader_OpenGL*   pShader,
+                  const Renderer_OpenGL* pRenderer,
+                  int                    animSetIndex,
+                  double                 elapsedTime)
 {
-    if (!pModel)
+    if (!pRenderer)
         return;
 
-    if (!pBone)
+    if (!pShader)
         return;
 
-    if (!pRenderer)
+    ModelInstance* pInstance = mhx2Model.GetModel(animSetIndex, elapsedTime);
+
+    if (!pInstance)
         return;
 
-    if (!pShader)
+    const Model* pModel = pInstance->GetModel();
+
+    // no model or the pose doesn't follow the bone table?
+    if (!pModel || pModel->m_BoneTable.m_Parents.size() != pInstance->m_GlobalPose.size())
         return;
 
-    for (std::size_t i = 0; i < pBone->m_Children.size(); ++i)
+    const std::size_t boneCount = pInstance->m_GlobalPose.size();
+
+    glDisable(GL_DEPTH_TEST);
+
+    // draw a line between each bone and its parent, the bone table lists them without recursion
+    for (std::size_t i = 0; i < boneCount; ++i)
     {
-        Model::IBone* pChild = pBone->m_Children[i];
+        const int parent = pModel->m_BoneTable.m_Parents[i];
 
-        Matrix4x4F topMatrix;
+        if (parent < 0)
+            continue;
+
+        const Matrix4x4F& topMatrix    = pInstance->m_GlobalPose[parent];
+        const Matrix4x4F& bottomMatrix = pInstance->m_GlobalPose[i];
 
-        if (pModel->m_PoseOnly)
-            // in mhx2 files, the bones matrix are pre-calculated, so don't call the pModel->GetBoneMatrix() function
-            topMatrix = pBone->m_Matrix;
-        /*
-        else
-            mhx2Model.GetBoneAnimMatrix(pBone,
-                                        pModel->m_AnimationSet[animSetIndex],
-                                        std::fmod(elapsedTime, (double)pModel->m_AnimationSet[animSetIndex]->m_MaxValue / 46186158000.0),
-                                        Matrix4x4F::Identity(),
-                                        topMatrix);
-        */
-
-        Matrix4x4F bottomMatrix;
-
-        if (pModel->m_PoseOnly)
-            // in mhx2 files, the bones matrix are pre-calculated, so don't call the pModel->GetBoneMatrix() function
-            bottomMatrix = pChild->m_Matrix;
-        /*
-        else
-            mhx2Model.GetBoneAnimMatrix(pChild,
-                                        pModel->m_AnimationSet[animSetIndex],
-                                        std::fmod(elapsedTime, (double)pModel->m_AnimationSet[animSetIndex]->m_MaxValue / 46186158000.0),
-                                        Matrix4x4F::Identity(),
-                                        bottomMatrix);
-        */
-
-        glDisable(GL_DEPTH_TEST);
         pRenderer->DrawLine(Vector3F(topMatrix.m_Table[3][0],    topMatrix.m_Table[3][1],    topMatrix.m_Table[3][2]),
                             Vector3F(bottomMatrix.m_Table[3][0], bottomMatrix.m_Table[3][1], bottomMatrix.m_Table[3][2]),
                             ColorF(0.25f, 0.12f, 0.1f, 1.0f),
                             ColorF(0.95f, 0.06f, 0.15f, 1.0f),
                             modelMatrix,
                             pShader);
-        glEnable(GL_DEPTH_TEST);
-
-        DrawBone(mhx2Model, pModel, pChild, modelMatrix, pShader, pRenderer, animSetIndex, elapsedTime);
     }
-}
-//---------------------------------------------------------------------------
-void DrawSkeleton(const MHX2Model&       mhx2Model,
-                  const Matrix4x4F&      modelMatrix,
-                  const Shader_OpenGL*   pShader,
-                  const Renderer_OpenGL* pRenderer,
-                  int                    animSetIndex,
-                  double                 elapsedTime)
-{
-    if (!pRenderer)
-        return;
-
-    if (!pShader)
-        return;
-
-    Model* pModel = mhx2Model.GetModel(animSetIndex, elapsedTime);
 
-    DrawBone(mhx2Model, pModel, pModel->m_pSkeleton, modelMatrix, pShader, pRenderer, animSetIndex, elapsedTime);
+    glEnable(GL_DEPTH_TEST);
 }
 //------------------------------------------------------------------------------
 int APIENTRY wWinMain(_In_     HINSTANCE hInstance,
@@ -28,6 +28,13 @@
 
 #include "MHX2Model.h"
 
+// std
+#include <algorithm>
+
+// classes
+#include "MeshletHelper.h"
+#include "MeshMergeHelper.h"
+
 //---------------------------------------------------------------------------
 // MHX2Model::ILogger
 //---------------------------------------------------------------------------
@@ -1707,8 +1714,17 @@ bool MHX2Model::IModelItem::Parse(json_value* pJson, ILogger& logger)
 // MHX2Model
 //---------------------------------------------------------------------------
 MHX2Model::MHX2Model() :
-    m_pModel(nullptr),
+    m_pInstance(nullptr),
+    m_pThreadPool(nullptr),
+    m_MeshletMaxVertices(64),
+    m_MeshletMaxTriangles(124),
+    m_MaxInfluences(8),
+    m_MinWeight(0.0f),
+    m_MaxAtlasTextureSize(512),
+    m_MaxAtlasSize(2048),
+    m_MergeMeshes(false),
     m_PoseOnly(false),
+    m_DQSkinning(false),
     m_fOnGetVertexColor(nullptr),
     m_fOnLoadTexture(nullptr)
 {
@@ -1726,8 +1742,8 @@ MHX2Model::MHX2Model() :
 //---------------------------------------------------------------------------
 MHX2Model::~MHX2Model()
 {
-    if (m_pModel)
-        delete m_pModel;
+    if (m_pInstance)
+        delete m_pInstance;
 }
 //---------------------------------------------------------------------------
 bool MHX2Model::Open(const std::string& fileName)
@@ -1800,16 +1816,21 @@ bool MHX2Model::Open(const std::string& fileName)
 //---------------------------------------------------------------------------
 bool MHX2Model::Read(const std::string& data)
 {
-    // delete any previously opened model
-    if (m_pModel)
+    // delete any previously opened model. The model data remain alive as long as an instance still shares them
+    if (m_pInstance)
     {
-        delete m_pModel;
-        m_pModel = nullptr;
+        delete m_pInstance;
+        m_pInstance = nullptr;
     }
 
+    m_pModel.reset();
+
     // clear the previous log
     m_Logger.Clear();
 
+    // the morph targets were bound to the previous model
+    m_MorphTargets.Clear();
+
     char*           pErrorPos  = 0;
     const char*     pErrorDesc = 0;
     int             pErrorLine = 0;
@@ -1843,123 +1864,152 @@ bool MHX2Model::Read(const std::string& data)
         if (!BuildGeometry(pModelItem.get(), pModelItem->m_Geometries[i], pModel.get()))
             return false;
 
-    // to show only the pose without animation
-    pModel->m_PoseOnly = m_PoseOnly;
+    // merge the meshes, if required
+    if (m_MergeMeshes && !MeshMergeHelper::Merge(*pModel, m_MaxAtlasTextureSize, m_MaxAtlasSize))
+        return false;
 
-    m_pModel = pModel.release();
-    return true;
-}
-//---------------------------------------------------------------------------
-Model* MHX2Model::GetModel(int animSetIndex, double elapsedTime) const
-{
-    // no model?
-    if (!m_pModel)
-        return nullptr;
+    // the merged meshes no longer match their morph target bindings
+    if (m_MergeMeshes)
+        m_MorphTargets.Clear();
 
-    // if mesh has no skeleton, perform a simple draw
-    if (!m_pModel->m_pSkeleton)
-        return m_pModel;
+    // flatten the skeleton, the matrix palettes and the vertex influences are indexed by its bones. In mhx2 files,
+    // the bone matrices are pre-calculated, i.e. relative to the model
+    if (!pModel->BuildBoneTable(true))
+        return false;
 
-    // clear the animation matrix cache
-    const_cast<IAnimBoneCacheDict&>(m_AnimBoneCacheDict).clear();
+    // pack the vertex influences, once the meshes are in their final order. The weak influences are dropped, if required
+    pModel->m_MaxInfluences = m_MaxInfluences;
+    pModel->m_MinWeight     = m_MinWeight;
 
-    const std::size_t meshCount = m_pModel->m_Mesh.size();
+    for (std::size_t i = 0; i < pModel->m_Mesh.size(); ++i)
+        if (!pModel->BuildInfluences(i))
+            return false;
 
-    // iterate through model meshes
-    for (std::size_t i = 0; i < meshCount; ++i)
-    {
-        // get model mesh
-        Mesh* pMesh = m_pModel->m_Mesh[i];
+    // calculate the meshlet bone spheres, which are keyed by the bone table indices
+    for (std::size_t i = 0; i < pModel->m_Meshlets.size(); ++i)
+        if (pModel->m_Meshlets[i] && pModel->m_Mesh[i]->m_VB.size() == 1)
+            MeshletHelper::UpdateBounds(*pModel->m_Mesh[i]->m_VB[0], pModel->m_Deformers[i], *pModel->m_Meshlets[i]);
 
-        // found it?
-        if (!pMesh)
-            continue;
+    // to show only the pose without animation
+    pModel->m_PoseOnly = m_PoseOnly;
 
-        // normally each mesh should contain only one vertex buffer
-        if (pMesh->m_VB.size() != 1)
-            // unsupported if not (because cannot know which texture should be binded. If a such model
-            // exists, a custom version of this function should also be written for it)
-            continue;
+    // to skin the model by dual quaternions
+    pModel->m_DQSkinning = m_DQSkinning;
 
-        // malformed deformers?
-        if (meshCount != m_pModel->m_Deformers.size())
-            return nullptr;
+    m_pModel.reset(pModel.release());
 
-        const std::size_t weightCount = m_pModel->m_Deformers[i]->m_SkinWeights.size();
+    // create the default instance
+    m_pInstance = CreateInstance();
 
-        // mesh contains skin weights?
-        if (!weightCount)
-            return nullptr;
+    return (m_pInstance != nullptr);
+}
+//---------------------------------------------------------------------------
+ModelInstance* MHX2Model::GetModel(int animSetIndex, double elapsedTime) const
+{
+    // no model?
+    if (!m_pModel || !m_pInstance)
+        return nullptr;
 
-        // clear the previous vertex buffer vertices in order to rebuild them
-        for (std::size_t j = 0; j < pMesh->m_VB[0]->m_Data.size(); j += pMesh->m_VB[0]->m_Format.m_Stride)
-        {
-            pMesh->m_VB[0]->m_Data[j]     = 0.0f;
-            pMesh->m_VB[0]->m_Data[j + 1] = 0.0f;
-            pMesh->m_VB[0]->m_Data[j + 2] = 0.0f;
-        }
+    // update the default instance on the calling thread
+    if (!m_pThreadPool)
+        return m_pInstance->Update(animSetIndex, elapsedTime) ? m_pInstance : nullptr;
 
-        // iterate through mesh skin weights
-        for (std::size_t j = 0; j < weightCount; ++j)
-        {
-            Matrix4x4F boneMatrix;
+    ThreadPool::ITaskGroup group;
 
-            // get the bone matrix
-            if (m_pModel->m_PoseOnly)
-                // in mhx2 files, the bones matrix are pre-calculated, so don't call the pModel->GetBoneMatrix() function
-                boneMatrix = m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_pBone->m_Matrix;
-            /*
-            else
-                GetBoneAnimMatrix(m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_pBone,
-                                  m_pModel->m_AnimationSet[animSetIndex],
-                                  std::fmod(elapsedTime, (double)m_pModel->m_AnimationSet[animSetIndex]->m_MaxValue / 46186158000.0),
-                                  Matrix4x4F::Identity(),
-                                  boneMatrix);
-            */
+    // update the default instance in the thread pool
+    const bool success = m_pInstance->Update(animSetIndex, elapsedTime, *m_pThreadPool, group);
 
-            // get the final matrix after bones transform
-            const Matrix4x4F finalMatrix = m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_Matrix.Multiply(boneMatrix);
+    // wait until the meshes are skinned
+    m_pThreadPool->Wait(group);
 
-            // get the weight influence count
-            const std::size_t weightInfluenceCount = m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_WeightInfluences.size();
+    return success ? m_pInstance : nullptr;
+}
+//---------------------------------------------------------------------------
+bool MHX2Model::OpenTarget(const std::string& fileName)
+{
+    return m_MorphTargets.Open(fileName);
+}
+//---------------------------------------------------------------------------
+bool MHX2Model::SetTargetWeight(const std::string& name, float weight)
+{
+    const int index = m_MorphTargets.Find(name);
 
-            // apply the bone and its skin weights to each vertices
-            for (std::size_t k = 0; k < weightInfluenceCount; ++k)
-            {
-                // get the vertex index count
-                const std::size_t vertexIndexCount =
-                        m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_WeightInfluences[k]->m_VertexIndex.size();
+    if (index < 0)
+        return false;
 
-                // iterate through weights influences vertex indices
-                for (std::size_t l = 0; l < vertexIndexCount; ++l)
-                {
-                    // get the next vertex to which the next skin weight should be applied
-                    const std::size_t iX = m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_WeightInfluences[k]->m_VertexIndex[l];
-                    const std::size_t iY = m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_WeightInfluences[k]->m_VertexIndex[l] + 1;
-                    const std::size_t iZ = m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_WeightInfluences[k]->m_VertexIndex[l] + 2;
+    return m_MorphTargets.SetWeight(std::size_t(index), weight);
+}
+//---------------------------------------------------------------------------
+bool MHX2Model::ApplyTargets()
+{
+    // no model?
+    if (!m_pModel)
+        return false;
 
-                    Vector3F inputVertex;
+    // no weight changed?
+    if (!m_MorphTargets.IsPending())
+        return true;
 
-                    // get input vertex
-                    inputVertex.m_X = (*m_VBCache[i])[iX];
-                    inputVertex.m_Y = (*m_VBCache[i])[iY];
-                    inputVertex.m_Z = (*m_VBCache[i])[iZ];
+    // the model revision is incremented, thus all the instances, including the default one, will be skinned again
+    return m_MorphTargets.Apply(*m_pModel);
+}
+//---------------------------------------------------------------------------
+void MHX2Model::InvalidatePose()
+{
+    if (m_pInstance)
+        m_pInstance->Invalidate();
+}
+//---------------------------------------------------------------------------
+std::size_t MHX2Model::GetPoseCacheHits() const
+{
+    return m_pInstance ? m_pInstance->GetCacheHits() : 0;
+}
+//---------------------------------------------------------------------------
+std::size_t MHX2Model::GetPoseCacheMisses() const
+{
+    return m_pInstance ? m_pInstance->GetCacheMisses() : 0;
+}
+//---------------------------------------------------------------------------
+bool MHX2Model::AddAnimationSet(Model::IAnimationSet* pAnimSet)
+{
+    std::unique_ptr<Model::IAnimationSet> pNewAnimSet(pAnimSet);
 
-                    // apply bone transformation to vertex
-                    const Vector3F outputVertex = finalMatrix.Transform(inputVertex);
+    // no model or no animation set to add?
+    if (!m_pModel || !pNewAnimSet)
+        return false;
 
-                    // apply the skin weights and calculate the final output vertex
-                    pMesh->m_VB[0]->m_Data[iX] += (outputVertex.m_X * (float)m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_Weights[k]);
-                    pMesh->m_VB[0]->m_Data[iY] += (outputVertex.m_Y * (float)m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_Weights[k]);
-                    pMesh->m_VB[0]->m_Data[iZ] += (outputVertex.m_Z * (float)m_pModel->m_Deformers[i]->m_SkinWeights[j]->m_Weights[k]);
-                }
-            }
-        }
-    }
+    m_pModel->m_AnimationSet.push_back(pNewAnimSet.get());
+    pNewAnimSet.release();
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool MHX2Model::CompressAnimationSet(std::size_t animSetIndex, float maxError, double frameRate)
+{
+    // no model?
+    if (!m_pModel)
+        return false;
 
+    // the cached pose may have been sampled from the uncompressed keys
+    InvalidatePose();
+
+    return m_pModel->CompressAnimationSet(animSetIndex, maxError, frameRate);
+}
+//---------------------------------------------------------------------------
+std::shared_ptr<const Model> MHX2Model::GetSharedModel() const
+{
     return m_pModel;
 }
 //---------------------------------------------------------------------------
+ModelInstance* MHX2Model::CreateInstance() const
+{
+    // no model?
+    if (!m_pModel)
+        return nullptr;
+
+    return new ModelInstance(m_pModel);
+}
+//---------------------------------------------------------------------------
 void MHX2Model::SetVertFormatTemplate(const VertexFormat& vertFormatTemplate)
 {
     m_VertFormatTemplate = vertFormatTemplate;
@@ -1980,6 +2030,113 @@ void MHX2Model::SetPoseOnly(bool value)
     m_PoseOnly = value;
 }
 //---------------------------------------------------------------------------
+void MHX2Model::SetDQSkinning(bool value)
+{
+    m_DQSkinning = value;
+}
+//---------------------------------------------------------------------------
+void MHX2Model::SetInfluenceLimits(std::size_t maxInfluences, float minWeight)
+{
+    m_MaxInfluences = maxInfluences;
+    m_MinWeight     = minWeight;
+}
+//---------------------------------------------------------------------------
+bool MHX2Model::GetInfluenceError(int animSetIndex, double elapsedTime, float& maxError) const
+{
+    maxError = 0.0f;
+
+    // no model?
+    if (!m_pModel)
+        return false;
+
+    const Model::IBoneTable& boneTable = m_pModel->m_BoneTable;
+    Model::IMatrices         palette(boneTable.m_Bones.size(), Matrix4x4F::Identity());
+
+    // get the pose palette, the bind pose palette contains only identities
+    if (animSetIndex >= 0)
+    {
+        AnimationSampler sampler;
+        Model::IMatrices localPose;
+        Model::IMatrices globalPose;
+
+        if (!sampler.Sample(*m_pModel, animSetIndex, elapsedTime, localPose))
+            return false;
+
+        m_pModel->GetGlobalPose(localPose, globalPose);
+
+        for (std::size_t i = 0; i < globalPose.size() && i < palette.size(); ++i)
+            palette[i] = boneTable.m_InverseBind[i].Multiply(globalPose[i]);
+    }
+
+    // measure each mesh
+    for (std::size_t i = 0; i < m_pModel->m_Mesh.size(); ++i)
+    {
+        // mesh without influence?
+        if (i >= m_pModel->m_Influences.size() || !m_pModel->m_Influences[i])
+            continue;
+
+        float error = 0.0f;
+
+        if (!m_pModel->GetInfluenceError(i, palette, error))
+            return false;
+
+        maxError = std::max(maxError, error);
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool MHX2Model::AddSkeletonLOD(const std::vector<std::string>& bones,
+                                     std::size_t               maxDepth,
+                                     float                     minVolume,
+                                     std::size_t&              lodIndex)
+{
+    // no model?
+    if (!m_pModel)
+        return false;
+
+    Model::IBoneSelection selection;
+
+    // select the bones to collapse
+    if (!m_pModel->SelectBonesByName(bones, selection))
+        return false;
+
+    if (maxDepth && !m_pModel->SelectBonesByDepth(maxDepth, selection))
+        return false;
+
+    if (minVolume > 0.0f && !m_pModel->SelectBonesByVolume(minVolume, selection))
+        return false;
+
+    return m_pModel->AddSkeletonLOD(selection, lodIndex);
+}
+//---------------------------------------------------------------------------
+bool MHX2Model::SetSkeletonLOD(int lodIndex)
+{
+    // no default instance?
+    if (!m_pInstance)
+        return false;
+
+    return m_pInstance->SetSkeletonLOD(lodIndex);
+}
+//---------------------------------------------------------------------------
+void MHX2Model::SetMeshletLimits(std::size_t maxVertices, std::size_t maxTriangles)
+{
+    m_MeshletMaxVertices  = maxVertices;
+    m_MeshletMaxTriangles = maxTriangles;
+}
+//---------------------------------------------------------------------------
+void MHX2Model::SetMergeMeshes(bool value, int maxAtlasTextureSize, int maxAtlasSize)
+{
+    m_MergeMeshes         = value;
+    m_MaxAtlasTextureSize = maxAtlasTextureSize;
+    m_MaxAtlasSize        = maxAtlasSize;
+}
+//---------------------------------------------------------------------------
+void MHX2Model::SetThreadPool(ThreadPool* pThreadPool)
+{
+    m_pThreadPool = pThreadPool;
+}
+//---------------------------------------------------------------------------
 void MHX2Model::Set_OnGetVertexColor(VertexBuffer::ITfOnGetVertexColor fOnGetVertexColor)
 {
     m_fOnGetVertexColor = fOnGetVertexColor;
@@ -2093,6 +2250,7 @@ bool MHX2Model::BuildGeometry(const IModelItem* pModelItem, const IGeometryItem*
 
     std::unique_ptr<Model::IDeformers> pDeformers(new Model::IDeformers());
     IIndexToInflDict                   indexToInfl;
+    MeshletHelper::IIndices            sourceIndices;
     float                              determinant;
 
     const std::size_t weightsGroupCount = pGeometryItem->m_Mesh.m_WeightGroups.size();
@@ -2143,6 +2301,23 @@ bool MHX2Model::BuildGeometry(const IModelItem* pModelItem, const IGeometryItem*
         pSkinWeights.release();
     }
 
+    std::size_t vertexCount = 0;
+
+    // count the vertices to build, in order to allocate the memory only once
+    for (std::size_t i = 0; i < faceCount; ++i)
+        if (pGeometryItem->m_Mesh.m_Faces[i]->m_Values.size() >= 3)
+            vertexCount += (pGeometryItem->m_Mesh.m_Faces[i]->m_Values.size() - 2) * 3;
+
+    // the weight influences reference the vertex positions, which are tightly packed if the storage is planar
+    const std::size_t positionStride =
+            pVB->m_Format.m_Storage == VertexFormat::IEStorage::IE_VS_Planar ? 3 : pVB->m_Format.m_Stride;
+
+    std::vector<Vector3F> vertices;
+    std::vector<Vector2F> uvs;
+    vertices.reserve(vertexCount);
+    uvs.reserve(vertexCount);
+    sourceIndices.reserve(vertexCount);
+
     // iterate through the faces to build
     for (std::size_t i = 0; i < faceCount; ++i)
     {
@@ -2154,28 +2329,48 @@ bool MHX2Model::BuildGeometry(const IModelItem* pModelItem, const IGeometryItem*
         for (std::size_t j = 0; j < valueCount - 2; ++j)
             for (unsigned char k = 0; k < 3; ++k)
             {
-                const std::size_t index       = !k ? 0 : j + k;
-                const std::size_t vertexIndex = pVB->m_Data.size();
-                const std::size_t faceIndex   = pFace->m_Values[index];
-                const std::size_t uvIndex     = pUVFace->m_Values[index];
-                const Vector3F    normal;
-
-                AddWeightInfluence(&indexToInfl, faceIndex, pVB.get());
-
-                // add the vertex to the buffer
-                pVB->Add(pGeometryItem->m_Mesh.m_Vertices[faceIndex],
-                        &normal,
-                        &pGeometryItem->m_Mesh.m_UVCoords[uvIndex]->m_Value,
-                         0,
-                         m_fOnGetVertexColor);
+                const std::size_t index        = !k ? 0 : j + k;
+                const std::size_t vertexOffset = (pVB->GetVertexCount() + vertices.size()) * positionStride;
+                const std::size_t faceIndex    = pFace->m_Values[index];
+                const std::size_t uvIndex      = pUVFace->m_Values[index];
+
+                AddWeightInfluence(&indexToInfl, faceIndex, vertexOffset);
+
+                // keep the source vertex index, the meshlets are built from it
+                sourceIndices.push_back(faceIndex);
+
+                // collect the vertex to add
+                vertices.push_back(*pGeometryItem->m_Mesh.m_Vertices[faceIndex]);
+                uvs.push_back(pGeometryItem->m_Mesh.m_UVCoords[uvIndex]->m_Value);
             }
     }
 
-    // cache the vertex buffer
-    std::unique_ptr<VertexBuffer::IData> pVBData(new VertexBuffer::IData());
-    *pVBData = pVB->m_Data;
-    m_VBCache.push_back(pVBData.get());
-    pVBData.release();
+    // add the vertices to the buffer, normals are left empty
+    if (!pVB->Add(vertices.empty() ? nullptr : &vertices[0],
+                  nullptr,
+                  uvs.empty()      ? nullptr : &uvs[0],
+                  vertices.size(),
+                  0,
+                  m_fOnGetVertexColor))
+        return false;
+
+    // split the vertex buffer into meshlets, if required. Their bone spheres are calculated once the bone table is built
+    if (m_MeshletMaxVertices && m_MeshletMaxTriangles)
+    {
+        std::unique_ptr<Model::IMeshlets> pMeshlets(new Model::IMeshlets());
+
+        if (!MeshletHelper::Build(*pVB,
+                                  &sourceIndices,
+                                  nullptr,
+                                  m_MeshletMaxVertices,
+                                  m_MeshletMaxTriangles,
+                                  *pMeshlets))
+            return false;
+
+        // add the meshlets to the model
+        pModel->m_Meshlets.push_back(pMeshlets.get());
+        pMeshlets.release();
+    }
 
     // add the vertex buffer to the mesh
     pMesh->m_VB.push_back(pVB.get());
@@ -2189,10 +2384,14 @@ bool MHX2Model::BuildGeometry(const IModelItem* pModelItem, const IGeometryItem*
     pModel->m_Deformers.push_back(pDeformers.get());
     pDeformers.release();
 
-    return true;
+    // bind the mesh to the basemesh, thus the morph targets may be applied to it
+    BindTargets(*pGeometryItem, sourceIndices, pModel->m_Mesh.size() - 1);
+
+    // calculate the mesh and bone bounds, while the vertex buffer still contains the bind pose
+    return pModel->BuildBounds(pModel->m_Mesh.size() - 1);
 }
 //---------------------------------------------------------------------------
-void MHX2Model::AddWeightInfluence(const IIndexToInflDict* pIndexToInfl, std::size_t indice, VertexBuffer* pModelVB) const
+void MHX2Model::AddWeightInfluence(const IIndexToInflDict* pIndexToInfl, std::size_t indice, std::size_t vertexOffset) const
 {
     if (!pIndexToInfl)
         return;
@@ -2204,7 +2403,62 @@ void MHX2Model::AddWeightInfluence(const IIndexToInflDict* pIndexToInfl, std::si
         const std::size_t weightInflCount = it->second.size();
 
         for (std::size_t j = 0; j < weightInflCount; ++j)
-            it->second[j]->m_VertexIndex.push_back(pModelVB->m_Data.size());
+            it->second[j]->m_VertexIndex.push_back(vertexOffset);
+    }
+}
+//---------------------------------------------------------------------------
+void MHX2Model::BindTargets(const IGeometryItem&          geometryItem,
+                            const MorphTargets::IIndices& sourceIndices,
+                                  std::size_t             meshIndex)
+{
+    // the subdivided meshes no longer match the basemesh vertices
+    if (geometryItem.m_IsSubdivided || sourceIndices.empty())
+        return;
+
+    const IFitItems&       fitting     = geometryItem.m_Proxy.m_Fitting;
+    const std::size_t      vertexCount = sourceIndices.size();
+    MorphTargets::IIndices refs;
+    MorphTargets::IWeights weights;
+
+    // fitted proxy? Each vertex follows 3 basemesh vertices, its offset remains unchanged
+    if (!fitting.empty())
+    {
+        refs.reserve(vertexCount * 3);
+        weights.reserve(vertexCount * 3);
+
+        for (std::size_t i = 0; i < vertexCount; ++i)
+        {
+            const std::size_t sourceIndex = sourceIndices[i];
+
+            // malformed fitting?
+            if (sourceIndex >= fitting.size() || fitting[sourceIndex]->m_Values.size() < 2)
+                return;
+
+            // the fitting contains the referenced vertices, then their weights
+            const Vector3F& ref    = *fitting[sourceIndex]->m_Values[0];
+            const Vector3F& weight = *fitting[sourceIndex]->m_Values[1];
+
+            refs.push_back(std::size_t(ref.m_X + 0.5f));
+            refs.push_back(std::size_t(ref.m_Y + 0.5f));
+            refs.push_back(std::size_t(ref.m_Z + 0.5f));
+
+            weights.push_back(weight.m_X);
+            weights.push_back(weight.m_Y);
+            weights.push_back(weight.m_Z);
+        }
+
+        m_MorphTargets.Bind(meshIndex, refs, weights, 3);
+        return;
     }
+
+    // other than the human body, the meshes don't follow the basemesh
+    if (!geometryItem.m_IsHuman)
+        return;
+
+    // the human mesh vertices are the basemesh vertices
+    refs.assign(sourceIndices.begin(), sourceIndices.end());
+    weights.assign(vertexCount, 1.0f);
+
+    m_MorphTargets.Bind(meshIndex, refs, weights, 1);
 }
 //---------------------------------------------------------------------------
@@ -32,6 +32,7 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <memory>
 
 // libraries
 #include "json.h"
@@ -43,6 +44,8 @@
 #include "Matrix4x4.h"
 #include "Vertex.h"
 #include "Model.h"
+#include "ModelInstance.h"
+#include "MorphTargets.h"
 
 /**
 * MakeHuman .mhx2 file reader
@@ -69,12 +72,96 @@ class MHX2Model
         virtual bool Read(const std::string& data);
 
         /**
-        * Gets a ready-to-draw copy of the model
+        * Gets a ready-to-draw instance of the model
         *@param animSetIndex - animation set index
-        *@param elapsedTime - elapsed time in milliseconds
-        *@return a ready-to-draw copy of the model, nullptr on error
+        *@param elapsedTime - elapsed time in seconds
+        *@return a ready-to-draw instance of the model, nullptr on error
+        *@note The returned instance is owned by this class and is updated on each call, unless the pose didn't
+        *      change since the previous call. Use CreateInstance() to draw several copies of the model in different
+        *      poses
         */
-        virtual Model* GetModel(int animSetIndex, double elapsedTime) const;
+        virtual ModelInstance* GetModel(int animSetIndex, double elapsedTime) const;
+
+        /**
+        * Gets the shared model data
+        *@return the shared model data, empty if no model was opened
+        *@note The data may be shared by any number of instances, and remain valid even if this class is deleted or
+        *      opens another model. Only ApplyTargets() modifies them, and increments the model revision, thus the
+        *      instances skin their meshes again on their next update
+        */
+        virtual std::shared_ptr<const Model> GetSharedModel() const;
+
+        /**
+        * Creates a new instance of the model
+        *@return the newly created instance, nullptr on error
+        *@note The instance should be deleted when useless. Call its Update() function to pose it
+        */
+        virtual ModelInstance* CreateInstance() const;
+
+        /**
+        * Adds an animation set to the model, e.g. an animation set created from a motion capture file
+        *@param pAnimSet - animation set to add, the model takes its ownership
+        *@return true on success, otherwise false
+        *@note The animation set is deleted on error. The model data are shared by all its instances, thus this
+        *      function should not be called while an instance is updated. The new animation set index is the
+        *      previous animation set count
+        */
+        virtual bool AddAnimationSet(Model::IAnimationSet* pAnimSet);
+
+        /**
+        * Compresses an animation set of the model
+        *@param animSetIndex - animation set index
+        *@param maxError - maximum error allowed, in model units
+        *@param frameRate - frame rate at which the animation set is resampled, in frames per second
+        *@return true on success, otherwise false
+        *@note See Model::CompressAnimationSet(). Should not be called while an instance is updated
+        */
+        virtual bool CompressAnimationSet(std::size_t animSetIndex, float maxError, double frameRate = 30.0);
+
+        /**
+        * Opens a MakeHuman morph target, i.e. a .target file containing sparse basemesh vertex deltas
+        *@param fileName - target file name, the target is named from it, without path nor extension
+        *@return true on success, otherwise false
+        *@note The target applies to the human mesh and to the proxies fitted on the basemesh. The targets are
+        *      unavailable if the meshes are merged or subdivided. The opened targets are cleared when another model
+        *      is opened
+        */
+        virtual bool OpenTarget(const std::string& fileName);
+
+        /**
+        * Sets the weight of a morph target
+        *@param name - target name
+        *@param weight - target weight, 0.0 to remove the target
+        *@return true on success, otherwise false
+        *@note The weight is only applied on the next ApplyTargets() call
+        */
+        virtual bool SetTargetWeight(const std::string& name, float weight);
+
+        /**
+        * Applies the morph target weights changed since the last call to the model
+        *@return true on success, otherwise false
+        *@note Only the vertices affected by the changed targets are updated. The model data are shared by all its
+        *      instances, thus this function should not be called while an instance is updated. The instances skin
+        *      their meshes again on their next update
+        */
+        virtual bool ApplyTargets();
+
+        /**
+        * Invalidates the pose of the default instance, thus the next GetModel() call will skin it again
+        */
+        virtual void InvalidatePose();
+
+        /**
+        * Gets the pose cache hit count of the default instance
+        *@return the pose cache hit count, i.e. the GetModel() calls which reused the skinned meshes
+        */
+        virtual std::size_t GetPoseCacheHits() const;
+
+        /**
+        * Gets the pose cache miss count of the default instance
+        *@return the pose cache miss count, i.e. the GetModel() calls which skinned the meshes
+        */
+        virtual std::size_t GetPoseCacheMisses() const;
 
         /**
         * Changes the vertex format template
@@ -101,6 +188,82 @@ class MHX2Model
         */
         virtual void SetPoseOnly(bool value);
 
+        /**
+        * Sets if the model should be skinned by dual quaternions instead of blended matrices
+        *@param value - if true, the model will be skinned by dual quaternions
+        *@note The dual quaternion skinning keeps the volume around the twisted joints, but ignores the bone scaling.
+        *      This function should be called before open the model
+        */
+        virtual void SetDQSkinning(bool value);
+
+        /**
+        * Sets the skin influence limits, the weaker influences are dropped and the weights are renormalized to 1
+        *@param maxInfluences - max influences kept per vertex, either 2, 4 or 8
+        *@param minWeight - influences weaker than this weight are dropped, except the strongest one of each vertex
+        *@note Fewer influences bound the skinning cost per vertex. Use GetInfluenceError() to measure the error it
+        *      causes on an animated pose. This function should be called before open the model
+        */
+        virtual void SetInfluenceLimits(std::size_t maxInfluences, float minWeight);
+
+        /**
+        * Gets the max vertex position error the influence limits cause on a pose
+        *@param animSetIndex - animation set index, the bind pose is measured if -1
+        *@param elapsedTime - elapsed time in seconds
+        *@param[out] maxError - max vertex position error, in model units
+        *@return true on success, otherwise false
+        *@note The pruned weights are renormalized, thus the bind pose error is always about 0. The error should be
+        *      measured on a representative pose, e.g. on a few times of each animation set
+        */
+        virtual bool GetInfluenceError(int animSetIndex, double elapsedTime, float& maxError) const;
+
+        /**
+        * Adds a skeleton level of detail, in which the minor bones are collapsed into their ancestors
+        *@param bones - names of the bones to collapse, with their descendants
+        *@param maxDepth - the bones deeper than this depth in the skeleton are collapsed, ignored if 0
+        *@param minVolume - the bones whose influence volume, added to the one of their descendants, is lower than
+        *                   this volume are collapsed, ignored if 0.0f
+        *@param[out] lodIndex - level of detail index, to pass to SetSkeletonLOD()
+        *@return true on success, otherwise false
+        *@note The model data are shared by all its instances, thus this function should be called after the model
+        *      is opened and before its instances are updated
+        */
+        virtual bool AddSkeletonLOD(const std::vector<std::string>& bones,
+                                          std::size_t               maxDepth,
+                                          float                     minVolume,
+                                          std::size_t&              lodIndex);
+
+        /**
+        * Sets the skeleton level of detail of the default instance
+        *@param lodIndex - level of detail index, the full skeleton is used if -1
+        *@return true on success, otherwise false
+        */
+        virtual bool SetSkeletonLOD(int lodIndex);
+
+        /**
+        * Sets the meshlet (i.e. mesh cluster) limits
+        *@param maxVertices - max unique source vertices a meshlet may reference
+        *@param maxTriangles - max triangles a meshlet may contain
+        *@note If one of the limits is 0, no meshlet will be built. This function should be called before open the model
+        */
+        virtual void SetMeshletLimits(std::size_t maxVertices, std::size_t maxTriangles);
+
+        /**
+        * Sets if the meshes should be merged in a single mesh, drawn with a range per material
+        *@param value - if true, the meshes will be merged
+        *@param maxAtlasTextureSize - max width and height a texture may have to be packed in an atlas, 0 to disable
+        *                             the atlas
+        *@param maxAtlasSize - max atlas width and height
+        *@note This function should be called before open the model
+        */
+        virtual void SetMergeMeshes(bool value, int maxAtlasTextureSize = 512, int maxAtlasSize = 2048);
+
+        /**
+        * Sets the thread pool in which the default instance is skinned
+        *@param pThreadPool - thread pool, if nullptr the default instance is skinned on the calling thread
+        *@note The thread pool is not owned by this class, and should remain valid while it's used
+        */
+        virtual void SetThreadPool(ThreadPool* pThreadPool);
+
         /**
         * Sets the OnGetVertexColor callback
         *@param fOnGetVertexColor - callback function handle
@@ -564,24 +727,23 @@ class MHX2Model
         */
         typedef std::map<std::size_t, Model::IWeightInfluences> IIndexToInflDict;
 
-        /**
-        * Animated bone cache dictionary
-        */
-        typedef std::map<const Model::IBone*, Matrix4x4F> IAnimBoneCacheDict;
-
-        /**
-        * Source vertex buffer cache
-        */
-        typedef std::vector<VertexBuffer::IData*> IVBCache;
-
-        Model*                            m_pModel;
+        std::shared_ptr<Model>            m_pModel;
+        ModelInstance*                    m_pInstance;
+        ThreadPool*                       m_pThreadPool;
         VertexFormat                      m_VertFormatTemplate;
         VertexCulling                     m_VertCullingTemplate;
         Material                          m_MaterialTemplate;
-        IAnimBoneCacheDict                m_AnimBoneCacheDict;
-        IVBCache                          m_VBCache;
         ILogger                           m_Logger;
+        MorphTargets                      m_MorphTargets;
+        std::size_t                       m_MeshletMaxVertices;
+        std::size_t                       m_MeshletMaxTriangles;
+        std::size_t                       m_MaxInfluences;
+        float                             m_MinWeight;
+        int                               m_MaxAtlasTextureSize;
+        int                               m_MaxAtlasSize;
+        bool                              m_MergeMeshes;
         bool                              m_PoseOnly;
+        bool                              m_DQSkinning;
         VertexBuffer::ITfOnGetVertexColor m_fOnGetVertexColor;
         Texture::ITfOnLoadTexture         m_fOnLoadTexture;
 
@@ -606,9 +768,19 @@ class MHX2Model
         * Add a weight influence for a vertex buffer
         *@param pIndexToInfl - index to influence dictionary
         *@param indice - vertex indice in the source buffer
-        *@param pModelVB - model vertex buffer in which the weight influence index should be added
+        *@param vertexOffset - offset of the matching vertex in the model vertex buffer data
+        */
+        void AddWeightInfluence(const IIndexToInflDict* pIndexToInfl, std::size_t indice, std::size_t vertexOffset) const;
+
+        /**
+        * Binds a mesh to the basemesh, thus the morph targets may be applied to it
+        *@param geometryItem - source geometry item read from the file
+        *@param sourceIndices - for each vertex of the mesh vertex buffer, the geometry vertex from which it was built
+        *@param meshIndex - mesh index in the model
         */
-        void AddWeightInfluence(const IIndexToInflDict* pIndexToInfl, std::size_t indice, VertexBuffer* pModelVB) const;
+        void BindTargets(const IGeometryItem&          geometryItem,
+                         const MorphTargets::IIndices& sourceIndices,
+                               std::size_t             meshIndex);
 };
 
 //---------------------------------------------------------------------------
@@ -31,6 +31,7 @@
 // std
 #include <memory>
 #include <cmath>
+#include <type_traits>
 
 // retrograde engine
 #include "Vector3.h"
@@ -78,32 +79,32 @@ class Matrix4x4
         * Copy constructor
         *@param other - other matrix to copy from
         */
-        inline Matrix4x4(const Matrix4x4& other);
+        Matrix4x4(const Matrix4x4& other) = default;
 
         /**
         * Destructor
         */
-        virtual inline ~Matrix4x4();
+        ~Matrix4x4() = default;
 
         /**
         * Assignation operator
         *@param other - other matrix to copy from
         */
-        virtual inline Matrix4x4& operator = (const Matrix4x4& other);
+        Matrix4x4& operator = (const Matrix4x4& other) = default;
 
         /**
         * Equality operator
         *@param other - other matrix to compare
         *@return true if both matrix are equals, otherwise false
         */
-        virtual inline bool operator == (const Matrix4x4& other);
+        inline bool operator == (const Matrix4x4& other);
 
         /**
         * Not equality operator
         *@param other - other matrix to compare
         *@return true if both matrix are not equals, otherwise false
         */
-        virtual inline bool operator != (const Matrix4x4& other);
+        inline bool operator != (const Matrix4x4& other);
 
         /**
         * Set matrix content
@@ -124,29 +125,29 @@ class Matrix4x4
         *@param _43 - matrix value
         *@param _44 - matrix value
         */
-        virtual inline void Set(T _11, T _12, T _13, T _14,
-                                T _21, T _22, T _23, T _24,
-                                T _31, T _32, T _33, T _34,
-                                T _41, T _42, T _43, T _44);
+        inline void Set(T _11, T _12, T _13, T _14,
+                        T _21, T _22, T _23, T _24,
+                        T _31, T _32, T _33, T _34,
+                        T _41, T _42, T _43, T _44);
 
         /**
         * Copies matrix from another
         *@param other - other matrix to copy from
         */
-        virtual inline void Copy(const Matrix4x4& other);
+        inline void Copy(const Matrix4x4& other);
 
         /**
         * Checks if matrix and other matrix are equals
         *@param other - other matrix to compare
         *@return true if matrix are equals, otherwise false
         */
-        virtual inline bool IsEqual(const Matrix4x4& other) const;
+        inline bool IsEqual(const Matrix4x4& other) const;
 
         /**
         * Checks if matrix is an identity matrix
         *@return true if matrix is an identity matrix, otherwise false
         */
-        virtual inline bool IsIdentity() const;
+        inline bool IsIdentity() const;
 
         /**
         * Gets an identity matrix
@@ -158,27 +159,27 @@ class Matrix4x4
         * Inverses a matrix
         *@param[out] determinant - matrix determinant
         */
-        virtual inline Matrix4x4 Inverse(float& determinant) const;
+        inline Matrix4x4 Inverse(float& determinant) const;
 
         /**
         * Transposes a matrix
         *@return transposed matrix
         */
-        virtual inline Matrix4x4 Transpose() const;
+        inline Matrix4x4 Transpose() const;
 
         /**
         * Multiplies matrix by another matrix
         *@param other - other matrix to multiply with
         *@return multiplied resulting matrix
         */
-        virtual inline Matrix4x4 Multiply(const Matrix4x4& other) const;
+        inline Matrix4x4 Multiply(const Matrix4x4& other) const;
 
         /**
         * Translates matrix
         *@param t - translation vector
         *@return copy of translated matrix
         */
-        virtual inline Matrix4x4 Translate(const Vector3<T>& t);
+        inline Matrix4x4 Translate(const Vector3<T>& t);
 
         /**
         * Rotates matrix
@@ -188,39 +189,44 @@ class Matrix4x4
         *@note rotation direction vector should be normalized before calling
         *      this function
         */
-        virtual inline Matrix4x4 Rotate(T angle, const Vector3<T>& r);
+        inline Matrix4x4 Rotate(T angle, const Vector3<T>& r);
 
         /**
         * Scales matrix
         *@param s - scale vector
         *@return copy of scaled matrix
         */
-        virtual inline Matrix4x4 Scale(const Vector3<T>& s);
+        inline Matrix4x4 Scale(const Vector3<T>& s);
 
         /**
         * Applies a transformation matrix to a vector
         *@param vector - vector to transform
         *@return transformed vector
         */
-        virtual inline Vector3<T> Transform(const Vector3<T>& vector) const;
+        inline Vector3<T> Transform(const Vector3<T>& vector) const;
 
         /**
         * Applies a transformation matrix to a normal
         *@param normal - normal to transform
         *@return transformed normal
         */
-        virtual inline Vector3<T> TransformNormal(const Vector3<T>& normal) const;
+        inline Vector3<T> TransformNormal(const Vector3<T>& normal) const;
 
         /**
         * Gets table pointer
         *@return pointer
         */
-        virtual inline const T* GetPtr() const;
+        inline const T* GetPtr() const;
 };
 
 typedef Matrix4x4<float>  Matrix4x4F;
 typedef Matrix4x4<double> Matrix4x4D;
 
+// the matrices contain only their table, thus the palettes may be copied as raw memory
+static_assert(sizeof(Matrix4x4F)  == 16 * sizeof(float), "Matrix4x4F should contain only its components");
+static_assert(alignof(Matrix4x4F) == alignof(float),     "Matrix4x4F should be aligned as its components");
+static_assert(std::is_trivially_copyable<Matrix4x4F>::value, "Matrix4x4F should be trivially copyable");
+
 //---------------------------------------------------------------------------
 // Matrix4x4
 //---------------------------------------------------------------------------
@@ -244,23 +250,6 @@ Matrix4x4<T>::Matrix4x4(T _11, T _12, T _13, T _14,
 }
 //---------------------------------------------------------------------------
 template <class T>
-Matrix4x4<T>::Matrix4x4(const Matrix4x4& other)
-{
-    Copy(other);
-}
-//---------------------------------------------------------------------------
-template <class T>
-Matrix4x4<T>::~Matrix4x4()
-{}
-//---------------------------------------------------------------------------
-template <class T>
-Matrix4x4<T>& Matrix4x4<T>::operator = (const Matrix4x4& other)
-{
-    Copy(other);
-    return *this;
-}
-//---------------------------------------------------------------------------
-template <class T>
 bool Matrix4x4<T>::operator == (const Matrix4x4& other)
 {
     return IsEqual(other);
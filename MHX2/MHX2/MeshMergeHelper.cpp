@@ -0,0 +1,554 @@
+/****************************************************************************
+ * ==> MeshMergeHelper -----------------------------------------------------*
+ ****************************************************************************
+ * Description : Mesh merge helper                                          *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "MeshMergeHelper.h"
+
+// std
+#include <memory>
+#include <map>
+#include <algorithm>
+#include <cmath>
+
+//---------------------------------------------------------------------------
+// MeshMergeHelper::IAtlasItem
+//---------------------------------------------------------------------------
+MeshMergeHelper::IAtlasItem::IAtlasItem() :
+    m_MeshIndex(0),
+    m_Width(0),
+    m_Height(0),
+    m_X(0),
+    m_Y(0)
+{}
+//---------------------------------------------------------------------------
+MeshMergeHelper::IAtlasItem::~IAtlasItem()
+{}
+//---------------------------------------------------------------------------
+// MeshMergeHelper
+//---------------------------------------------------------------------------
+const int MeshMergeHelper::m_Padding;
+//---------------------------------------------------------------------------
+bool MeshMergeHelper::Merge(Model& model, int maxAtlasTextureSize, int maxAtlasSize)
+{
+    const std::size_t meshCount = model.m_Mesh.size();
+
+    // nothing to merge?
+    if (meshCount < 2)
+        return true;
+
+    // malformed deformers?
+    if (model.m_Deformers.size() != meshCount)
+        return false;
+
+    const bool hasMeshlets = (model.m_Meshlets.size() == meshCount);
+    const bool hasBounds   = (model.m_Bounds.size()   == meshCount);
+
+    IIndices            candidates;
+    const VertexBuffer* pRefVB = nullptr;
+
+    // search for the meshes which can be merged, i.e. containing a single triangle list with the same format
+    for (std::size_t i = 0; i < meshCount; ++i)
+    {
+        const Mesh* pMesh = model.m_Mesh[i];
+
+        if (!pMesh || pMesh->m_VB.size() != 1 || !model.m_Deformers[i])
+            continue;
+
+        const VertexBuffer* pVB = pMesh->m_VB[0];
+
+        if (pVB->m_Format.m_Type != VertexFormat::IEType::IE_VT_Triangles || !pVB->m_Ranges.empty())
+            continue;
+
+        if (!pRefVB)
+            pRefVB = pVB;
+        else
+        if (!pVB->m_Format.CompareFormat(pRefVB->m_Format)  ||
+             pVB->m_Culling.m_Type != pRefVB->m_Culling.m_Type ||
+             pVB->m_Culling.m_Face != pRefVB->m_Culling.m_Face)
+            continue;
+
+        candidates.push_back(i);
+    }
+
+    // nothing to merge?
+    if (candidates.size() < 2)
+        return true;
+
+    // pack the small textures in atlases, one per transparency and wireframe combination, in order to draw
+    // all the meshes using them at once
+    if (maxAtlasTextureSize > 0 &&
+        ((unsigned)pRefVB->m_Format.m_Format & (unsigned)VertexFormat::IEFormat::IE_VF_TexCoords))
+        for (unsigned char i = 0; i < 4; ++i)
+        {
+            const bool transparent = (i & 1) != 0;
+            const bool wireframe   = (i & 2) != 0;
+
+            IIndices group;
+
+            for (std::size_t j = 0; j < candidates.size(); ++j)
+            {
+                const Material& material = model.m_Mesh[candidates[j]]->m_VB[0]->m_Material;
+
+                if (material.m_Transparent == transparent && material.m_Wireframe == wireframe)
+                    group.push_back(candidates[j]);
+            }
+
+            if (!BuildAtlas(model, group, maxAtlasTextureSize, maxAtlasSize))
+                return false;
+        }
+
+    // sort the meshes by material, the opaque ones first
+    std::stable_sort(candidates.begin(), candidates.end(),
+            [&model](std::size_t left, std::size_t right)
+            {
+                const Material& l = model.m_Mesh[left]->m_VB[0]->m_Material;
+                const Material& r = model.m_Mesh[right]->m_VB[0]->m_Material;
+
+                if (l.m_Transparent != r.m_Transparent)
+                    return !l.m_Transparent;
+
+                if (l.m_Wireframe != r.m_Wireframe)
+                    return !l.m_Wireframe;
+
+                return std::less<const Texture*>()(l.m_pTexture, r.m_pTexture);
+            });
+
+    std::unique_ptr<VertexBuffer>      pVB(pRefVB->Clone());
+    std::unique_ptr<Model::IDeformers> pDeformers(new Model::IDeformers());
+    std::unique_ptr<Model::IMeshlets>  pMeshlets(hasMeshlets ? new Model::IMeshlets() : nullptr);
+    std::map<std::string, std::size_t> boneToWeights;
+
+    pVB->m_Name = "merged";
+
+    const std::size_t positionStride =
+            pVB->m_Format.m_Storage == VertexFormat::IEStorage::IE_VS_Planar ? 3 : pVB->m_Format.m_Stride;
+
+    // merge the candidates
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+    {
+        const std::size_t        meshIndex = candidates[i];
+              VertexBuffer*      pSrcVB    = model.m_Mesh[meshIndex]->m_VB[0];
+        const Model::IDeformers* pSrcDef   = model.m_Deformers[meshIndex];
+        const std::size_t        first     = pVB->GetVertexCount();
+
+        if (!Append(*pSrcVB, *pVB))
+            return false;
+
+        const std::size_t count = pVB->GetVertexCount() - first;
+
+        VertexBuffer::IRange* pLastRange = pVB->m_Ranges.empty() ? nullptr : pVB->m_Ranges.back();
+
+        // same material as the previous mesh? Extend the draw range
+        if (pLastRange                                                                &&
+            pLastRange->m_Material.m_pTexture    == pSrcVB->m_Material.m_pTexture    &&
+            pLastRange->m_Material.m_Transparent == pSrcVB->m_Material.m_Transparent &&
+            pLastRange->m_Material.m_Wireframe   == pSrcVB->m_Material.m_Wireframe)
+            pLastRange->m_Count += count;
+        else
+        {
+            std::unique_ptr<VertexBuffer::IRange> pRange(new VertexBuffer::IRange());
+            pRange->m_Start                  = first;
+            pRange->m_Count                  = count;
+            pRange->m_Material.m_pTexture    = pSrcVB->m_Material.m_pTexture;
+            pRange->m_Material.m_Color       = pSrcVB->m_Material.m_Color;
+            pRange->m_Material.m_Transparent = pSrcVB->m_Material.m_Transparent;
+            pRange->m_Material.m_Wireframe   = pSrcVB->m_Material.m_Wireframe;
+
+            pVB->m_Ranges.push_back(pRange.get());
+            pRange.release();
+        }
+
+        // merge the skin weights of the same bones
+        for (std::size_t j = 0; j < pSrcDef->m_SkinWeights.size(); ++j)
+        {
+            const Model::ISkinWeights* pSrcWeights = pSrcDef->m_SkinWeights[j];
+
+            std::map<std::string, std::size_t>::iterator it = boneToWeights.find(pSrcWeights->m_BoneName);
+
+            // first time the bone is found?
+            if (it == boneToWeights.end())
+            {
+                std::unique_ptr<Model::ISkinWeights> pSkinWeights(new Model::ISkinWeights());
+                pSkinWeights->m_BoneName = pSrcWeights->m_BoneName;
+                pSkinWeights->m_pBone    = pSrcWeights->m_pBone;
+                pSkinWeights->m_Matrix   = pSrcWeights->m_Matrix;
+
+                it = boneToWeights.insert(std::make_pair(pSrcWeights->m_BoneName, pDeformers->m_SkinWeights.size())).first;
+
+                pDeformers->m_SkinWeights.push_back(pSkinWeights.get());
+                pSkinWeights.release();
+            }
+
+            Model::ISkinWeights* pSkinWeights = pDeformers->m_SkinWeights[it->second];
+
+            // copy the weight influences, and move them to the vertices location in the merged buffer
+            for (std::size_t k = 0; k < pSrcWeights->m_WeightInfluences.size(); ++k)
+            {
+                std::unique_ptr<Model::IWeightInfluence> pInfluence(new Model::IWeightInfluence());
+                pInfluence->m_Index       = pSrcWeights->m_WeightInfluences[k]->m_Index;
+                pInfluence->m_VertexIndex = pSrcWeights->m_WeightInfluences[k]->m_VertexIndex;
+
+                for (std::size_t l = 0; l < pInfluence->m_VertexIndex.size(); ++l)
+                    pInfluence->m_VertexIndex[l] += first * positionStride;
+
+                pSkinWeights->m_WeightInfluences.push_back(pInfluence.get());
+                pInfluence.release();
+
+                pSkinWeights->m_Weights.push_back(k < pSrcWeights->m_Weights.size() ? pSrcWeights->m_Weights[k] : 0.0f);
+            }
+        }
+
+        // move the meshlets to their location in the merged buffer
+        if (pMeshlets && model.m_Meshlets[meshIndex])
+            for (std::size_t j = 0; j < model.m_Meshlets[meshIndex]->m_Meshlets.size(); ++j)
+            {
+                std::unique_ptr<Model::IMeshlet> pMeshlet(new Model::IMeshlet(*model.m_Meshlets[meshIndex]->m_Meshlets[j]));
+                pMeshlet->m_Start += first;
+
+                pMeshlets->m_Meshlets.push_back(pMeshlet.get());
+                pMeshlet.release();
+            }
+    }
+
+    // the merged mesh is placed first
+    std::vector<Mesh*>              meshes;
+    std::vector<Model::IDeformers*> deformers;
+    std::vector<Model::IMeshlets*>  meshlets;
+    std::vector<Model::IBounds*>    bounds;
+    std::vector<bool>               merged(meshCount, false);
+
+    std::unique_ptr<Mesh> pMesh(new Mesh());
+    pMesh->m_VB.push_back(pVB.get());
+    pVB.release();
+
+    meshes.push_back(pMesh.release());
+    deformers.push_back(pDeformers.release());
+
+    if (hasMeshlets)
+        meshlets.push_back(pMeshlets.release());
+
+    if (hasBounds)
+        bounds.push_back(nullptr);
+
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+    {
+        merged[candidates[i]] = true;
+
+        // the textures are owned by the draw ranges now
+        model.m_Mesh[candidates[i]]->m_VB[0]->m_Material.m_pTexture = nullptr;
+    }
+
+    // keep the meshes which weren't merged, and delete the merged ones
+    for (std::size_t i = 0; i < meshCount; ++i)
+        if (!merged[i])
+        {
+            meshes.push_back(model.m_Mesh[i]);
+            deformers.push_back(model.m_Deformers[i]);
+
+            if (hasMeshlets)
+                meshlets.push_back(model.m_Meshlets[i]);
+
+            if (hasBounds)
+                bounds.push_back(model.m_Bounds[i]);
+        }
+        else
+        {
+            delete model.m_Mesh[i];
+            delete model.m_Deformers[i];
+
+            if (hasMeshlets)
+                delete model.m_Meshlets[i];
+
+            if (hasBounds)
+                delete model.m_Bounds[i];
+        }
+
+    model.m_Mesh      = meshes;
+    model.m_Deformers = deformers;
+    model.m_Meshlets  = meshlets;
+    model.m_Bounds    = bounds;
+
+    // calculate the merged mesh bounds
+    return model.BuildBounds(0);
+}
+//---------------------------------------------------------------------------
+bool MeshMergeHelper::BuildAtlas(Model& model, const IIndices& meshIndices, int maxAtlasTextureSize, int maxAtlasSize)
+{
+    IAtlasItems    items;
+    const Texture* pTemplate = nullptr;
+
+    // collect the textures small enough to be packed
+    for (std::size_t i = 0; i < meshIndices.size(); ++i)
+    {
+        VertexBuffer*  pVB      = model.m_Mesh[meshIndices[i]]->m_VB[0];
+        const Texture* pTexture = pVB->m_Material.m_pTexture;
+
+        if (!pTexture || pTexture->m_Width <= 0 || pTexture->m_Height <= 0)
+            continue;
+
+        if (pTexture->m_Width > maxAtlasTextureSize || pTexture->m_Height > maxAtlasTextureSize)
+            continue;
+
+        const std::size_t vertexCount = pVB->GetVertexCount();
+        std::size_t       stride      = 0;
+        const float*      pUVs        = GetTexCoords(*pVB, stride);
+
+        if (!pUVs)
+            continue;
+
+        bool repeated = false;
+
+        // texture coordinates out of the [0, 1] range repeat the texture, which cannot be done in an atlas
+        for (std::size_t j = 0; j < vertexCount && !repeated; ++j)
+            repeated = pUVs[j * stride]     < -0.001f || pUVs[j * stride]     > 1.001f ||
+                       pUVs[j * stride + 1] < -0.001f || pUVs[j * stride + 1] > 1.001f;
+
+        if (repeated)
+            continue;
+
+        std::vector<unsigned char> pixels;
+
+        // the texture cannot provide its pixels?
+        if (!pTexture->GetPixels(pixels))
+            continue;
+
+        const std::size_t pixelCount    = (std::size_t)pTexture->m_Width * (std::size_t)pTexture->m_Height;
+        const std::size_t bytesPerPixel = pTexture->m_Format == Texture::IEFormat::IE_FT_24bit ? 3 : 4;
+
+        if (pixels.size() < pixelCount * bytesPerPixel)
+            continue;
+
+        IAtlasItem item;
+        item.m_MeshIndex = meshIndices[i];
+        item.m_Width     = pTexture->m_Width;
+        item.m_Height    = pTexture->m_Height;
+        item.m_Pixels.resize(pixelCount * 4);
+
+        // convert the pixels to 32 bit
+        for (std::size_t j = 0; j < pixelCount; ++j)
+        {
+            item.m_Pixels[j * 4]     = pixels[j * bytesPerPixel];
+            item.m_Pixels[j * 4 + 1] = pixels[j * bytesPerPixel + 1];
+            item.m_Pixels[j * 4 + 2] = pixels[j * bytesPerPixel + 2];
+            item.m_Pixels[j * 4 + 3] = bytesPerPixel == 4 ? pixels[j * bytesPerPixel + 3] : 255;
+        }
+
+        items.push_back(item);
+
+        if (!pTemplate)
+            pTemplate = pTexture;
+    }
+
+    int width  = 0;
+    int height = 0;
+
+    // place the items, remove the largest ones until the others fit
+    while (items.size() >= 2 && !Pack(items, maxAtlasSize, width, height))
+        items.erase(std::max_element(items.begin(), items.end(),
+                [](const IAtlasItem& left, const IAtlasItem& right)
+                {
+                    return left.m_Width * left.m_Height < right.m_Width * right.m_Height;
+                }));
+
+    // an atlas is only useful for several textures
+    if (items.size() < 2)
+        return true;
+
+    std::unique_ptr<Texture> pAtlas(pTemplate->CreateEmpty());
+
+    // the texture kind doesn't support the atlas?
+    if (!pAtlas)
+        return true;
+
+    std::vector<unsigned char> pixels((std::size_t)width * (std::size_t)height * 4, 0);
+
+    // copy the items in the atlas, the padding repeats the item borders
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        const IAtlasItem& item = items[i];
+
+        for (int y = -m_Padding; y < item.m_Height + m_Padding; ++y)
+            for (int x = -m_Padding; x < item.m_Width + m_Padding; ++x)
+            {
+                const int         srcX = std::min(std::max(x, 0), item.m_Width  - 1);
+                const int         srcY = std::min(std::max(y, 0), item.m_Height - 1);
+                const std::size_t src  = ((std::size_t)srcY * item.m_Width + srcX) * 4;
+                const std::size_t dst  = ((std::size_t)(item.m_Y + y) * width + (item.m_X + x)) * 4;
+
+                std::copy(&item.m_Pixels[src], &item.m_Pixels[src] + 4, &pixels[dst]);
+            }
+    }
+
+    pAtlas->m_Width     = width;
+    pAtlas->m_Height    = height;
+    pAtlas->m_Format    = Texture::IEFormat::IE_FT_32bit;
+    pAtlas->m_Target    = pTemplate->m_Target;
+    pAtlas->m_WrapMode  = Texture::IEWrapMode::IE_WM_Clamp_To_Edge;
+    pAtlas->m_MinFilter = pTemplate->m_MinFilter;
+    pAtlas->m_MagFilter = pTemplate->m_MagFilter;
+
+    if (!pAtlas->Create(&pixels[0]))
+        return false;
+
+    // remap the texture coordinates to the atlas, and replace the item textures by the atlas
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        const IAtlasItem& item = items[i];
+        VertexBuffer*     pVB  = model.m_Mesh[item.m_MeshIndex]->m_VB[0];
+
+        const std::size_t vertexCount = pVB->GetVertexCount();
+        std::size_t       stride      = 0;
+        float*            pUVs        = GetTexCoords(*pVB, stride);
+
+        const float offsetU = (float)item.m_X      / (float)width;
+        const float offsetV = (float)item.m_Y      / (float)height;
+        const float scaleU  = (float)item.m_Width  / (float)width;
+        const float scaleV  = (float)item.m_Height / (float)height;
+
+        for (std::size_t j = 0; j < vertexCount; ++j)
+        {
+            pUVs[j * stride]     = offsetU + pUVs[j * stride]     * scaleU;
+            pUVs[j * stride + 1] = offsetV + pUVs[j * stride + 1] * scaleV;
+        }
+
+        delete pVB->m_Material.m_pTexture;
+        pVB->m_Material.m_pTexture = pAtlas.get();
+    }
+
+    pAtlas.release();
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool MeshMergeHelper::Pack(IAtlasItems& items, int maxAtlasSize, int& width, int& height)
+{
+    IIndices order(items.size());
+    int      area = 0;
+
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        order[i] = i;
+        area    += (items[i].m_Width + m_Padding * 2) * (items[i].m_Height + m_Padding * 2);
+    }
+
+    // place the highest items first, it minimizes the space lost in the shelves
+    std::sort(order.begin(), order.end(),
+            [&items](std::size_t left, std::size_t right)
+            {
+                return items[left].m_Height > items[right].m_Height;
+            });
+
+    // start from the smallest power of 2 square able to contain the items area
+    width = 1;
+
+    while (width * width < area)
+        width <<= 1;
+
+    height = width;
+
+    while (width <= maxAtlasSize && height <= maxAtlasSize)
+    {
+        int  x           = 0;
+        int  y           = 0;
+        int  shelfHeight = 0;
+        bool fit         = true;
+
+        // place the items in shelves, from left to right and top to bottom
+        for (std::size_t i = 0; i < order.size() && fit; ++i)
+        {
+            IAtlasItem& item       = items[order[i]];
+            const int   itemWidth  = item.m_Width  + m_Padding * 2;
+            const int   itemHeight = item.m_Height + m_Padding * 2;
+
+            // open a new shelf
+            if (x + itemWidth > width)
+            {
+                x           = 0;
+                y          += shelfHeight;
+                shelfHeight = 0;
+            }
+
+            fit = (x + itemWidth <= width && y + itemHeight <= height);
+
+            item.m_X    = x + m_Padding;
+            item.m_Y    = y + m_Padding;
+            x          += itemWidth;
+            shelfHeight = std::max(shelfHeight, itemHeight);
+        }
+
+        if (fit)
+            return true;
+
+        // grow the atlas
+        if (width <= height)
+            width <<= 1;
+        else
+            height <<= 1;
+    }
+
+    return false;
+}
+//---------------------------------------------------------------------------
+float* MeshMergeHelper::GetTexCoords(VertexBuffer& vb, std::size_t& stride)
+{
+    // no texture coordinates?
+    if (!((unsigned)vb.m_Format.m_Format & (unsigned)VertexFormat::IEFormat::IE_VF_TexCoords))
+        return nullptr;
+
+    if (vb.m_Format.m_Storage == VertexFormat::IEStorage::IE_VS_Planar)
+    {
+        stride = 2;
+        return vb.m_Streams.m_TexCoords.empty() ? nullptr : &vb.m_Streams.m_TexCoords[0];
+    }
+
+    // the texture coordinates follow the position and the normal
+    const std::size_t offset =
+            ((unsigned)vb.m_Format.m_Format & (unsigned)VertexFormat::IEFormat::IE_VF_Normals) ? 6 : 3;
+
+    stride = vb.m_Format.m_Stride;
+    return vb.m_Data.size() > offset ? &vb.m_Data[offset] : nullptr;
+}
+//---------------------------------------------------------------------------
+bool MeshMergeHelper::Append(const VertexBuffer& src, VertexBuffer& dst)
+{
+    // both buffers should share the same format
+    if (!src.m_Format.CompareFormat(dst.m_Format))
+        return false;
+
+    if (src.m_Format.m_Storage == VertexFormat::IEStorage::IE_VS_Planar)
+    {
+        dst.m_Streams.m_Positions.insert(dst.m_Streams.m_Positions.end(), src.m_Streams.m_Positions.begin(), src.m_Streams.m_Positions.end());
+        dst.m_Streams.m_Normals.insert  (dst.m_Streams.m_Normals.end(),   src.m_Streams.m_Normals.begin(),   src.m_Streams.m_Normals.end());
+        dst.m_Streams.m_TexCoords.insert(dst.m_Streams.m_TexCoords.end(), src.m_Streams.m_TexCoords.begin(), src.m_Streams.m_TexCoords.end());
+        dst.m_Streams.m_Colors.insert   (dst.m_Streams.m_Colors.end(),    src.m_Streams.m_Colors.begin(),    src.m_Streams.m_Colors.end());
+    }
+    else
+        dst.m_Data.insert(dst.m_Data.end(), src.m_Data.begin(), src.m_Data.end());
+
+    return true;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,117 @@
+/****************************************************************************
+ * ==> MeshMergeHelper -----------------------------------------------------*
+ ****************************************************************************
+ * Description : Mesh merge helper                                          *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <vector>
+
+// classes
+#include "Model.h"
+
+/**
+* Mesh merge helper, merges the meshes of a model in order to draw them with as few calls as possible
+*@author Jean-Milost Reymond
+*/
+class MeshMergeHelper
+{
+    public:
+        typedef std::vector<std::size_t> IIndices;
+
+        /**
+        * Merges the meshes of a model sharing the same vertex format in a single mesh, in which the vertices are
+        * grouped by material
+        *@param model - model to merge
+        *@param maxAtlasTextureSize - max width and height a texture may have to be packed in an atlas, 0 to disable
+        *                             the atlas
+        *@param maxAtlasSize - max atlas width and height
+        *@return true on success, otherwise false
+        *@note The merged mesh is placed first in the model, and its vertex buffer contains a draw range per
+        *      material, opaque materials first. The meshes which cannot be merged are kept unchanged. This function
+        *      should be called while the meshes still contain their bind pose
+        */
+        static bool Merge(Model& model, int maxAtlasTextureSize, int maxAtlasSize);
+
+    private:
+        /**
+        * Atlas item
+        */
+        struct IAtlasItem
+        {
+            std::size_t                m_MeshIndex; // index of the mesh using the texture
+            std::vector<unsigned char> m_Pixels;    // texture pixels, 4 bytes per pixel
+            int                        m_Width;
+            int                        m_Height;
+            int                        m_X;         // x position in the atlas, padding excluded
+            int                        m_Y;         // y position in the atlas, padding excluded
+
+            IAtlasItem();
+            virtual ~IAtlasItem();
+        };
+
+        typedef std::vector<IAtlasItem> IAtlasItems;
+
+        static const int m_Padding = 2; // pixels added around each atlas item, to avoid bleeding while filtering
+
+        /**
+        * Packs the small textures used by a group of meshes in an atlas, and remaps the mesh texture coordinates
+        *@param model - model owning the meshes
+        *@param meshIndices - indices of the meshes to pack
+        *@param maxAtlasTextureSize - max width and height a texture may have to be packed in the atlas
+        *@param maxAtlasSize - max atlas width and height
+        *@return true on success, otherwise false
+        *@note On success the packed meshes all reference the atlas texture, which is owned by none of them
+        */
+        static bool BuildAtlas(Model& model, const IIndices& meshIndices, int maxAtlasTextureSize, int maxAtlasSize);
+
+        /**
+        * Places the atlas items
+        *@param[in, out] items - items to place, their position is updated on success
+        *@param maxAtlasSize - max atlas width and height
+        *@param[out] width - atlas width
+        *@param[out] height - atlas height
+        *@return true on success, false if the items cannot fit in the max atlas size
+        */
+        static bool Pack(IAtlasItems& items, int maxAtlasSize, int& width, int& height);
+
+        /**
+        * Gets the texture coordinates of a vertex buffer
+        *@param vb - vertex buffer
+        *@param[out] stride - length between each texture coordinate, in values
+        *@return the first texture coordinate, nullptr if the buffer contains no texture coordinates
+        */
+        static float* GetTexCoords(VertexBuffer& vb, std::size_t& stride);
+
+        /**
+        * Appends the vertices of a vertex buffer to another
+        *@param src - source vertex buffer
+        *@param[in, out] dst - destination vertex buffer
+        *@return true on success, otherwise false
+        */
+        static bool Append(const VertexBuffer& src, VertexBuffer& dst);
+};
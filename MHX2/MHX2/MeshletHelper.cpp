@@ -0,0 +1,452 @@
+/****************************************************************************
+ * ==> MeshletHelper -------------------------------------------------------*
+ ****************************************************************************
+ * Description : Meshlet (i.e. mesh cluster) helper                         *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "MeshletHelper.h"
+
+// std
+#include <memory>
+#include <map>
+#include <limits>
+
+// classes
+#include "Box.h"
+
+//---------------------------------------------------------------------------
+// MeshletHelper
+//---------------------------------------------------------------------------
+bool MeshletHelper::Build(const VertexBuffer&       vb,
+                          const IIndices*           pSourceIndices,
+                          const Model::IDeformers*  pDeformers,
+                                std::size_t         maxVertices,
+                                std::size_t         maxTriangles,
+                                Model::IMeshlets&   meshlets)
+{
+    // only triangle lists may be split
+    if (vb.m_Format.m_Type != VertexFormat::IEType::IE_VT_Triangles)
+        return false;
+
+    // the stride should be already calculated
+    if (!vb.m_Format.m_Stride)
+        return false;
+
+    // a meshlet should at least be able to contain one triangle
+    if (maxVertices < 3 || !maxTriangles)
+        return false;
+
+    const std::size_t vertexCount   = vb.GetVertexCount();
+    const std::size_t triangleCount = vertexCount / 3;
+    const std::size_t firstMeshlet  = meshlets.m_Meshlets.size();
+
+    // source indices should match with the vertex buffer
+    if (pSourceIndices && pSourceIndices->size() < vertexCount)
+        return false;
+
+    IIndices                         vertexToMeshlet(vertexCount, std::numeric_limits<std::size_t>::max());
+    IIndices                         sources;
+    std::unique_ptr<Model::IMeshlet> pMeshlet;
+
+    sources.reserve(maxVertices);
+
+    // iterate through the triangles and group them in meshlets
+    for (std::size_t i = 0; i < triangleCount; ++i)
+    {
+        std::size_t triangleSources[3];
+        std::size_t newSourceCount = 0;
+
+        // count the source vertices the triangle would add to the current meshlet
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+            const std::size_t vertexIndex = (i * 3) + j;
+
+            triangleSources[j] = pSourceIndices ? (*pSourceIndices)[vertexIndex] : vertexIndex;
+
+            bool found = std::find(sources.begin(), sources.end(), triangleSources[j]) != sources.end();
+
+            // also search in the previous triangle vertices
+            for (std::size_t k = 0; k < j && !found; ++k)
+                found = (triangleSources[k] == triangleSources[j]);
+
+            if (!found)
+                ++newSourceCount;
+        }
+
+        // is the current meshlet full?
+        if (pMeshlet && ((pMeshlet->m_Count / 3) >= maxTriangles || sources.size() + newSourceCount > maxVertices))
+        {
+            pMeshlet->m_SourceCount = sources.size();
+            CalculateBounds(vb, *pMeshlet);
+
+            meshlets.m_Meshlets.push_back(pMeshlet.get());
+            pMeshlet.release();
+
+            sources.clear();
+        }
+
+        // start a new meshlet, if needed
+        if (!pMeshlet)
+        {
+            pMeshlet.reset(new Model::IMeshlet());
+            pMeshlet->m_Start = i * 3;
+        }
+
+        // add the triangle to the meshlet
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+            if (std::find(sources.begin(), sources.end(), triangleSources[j]) == sources.end())
+                sources.push_back(triangleSources[j]);
+
+            vertexToMeshlet[(i * 3) + j] = meshlets.m_Meshlets.size();
+        }
+
+        pMeshlet->m_Count += 3;
+    }
+
+    // close the last meshlet
+    if (pMeshlet)
+    {
+        pMeshlet->m_SourceCount = sources.size();
+        CalculateBounds(vb, *pMeshlet);
+
+        meshlets.m_Meshlets.push_back(pMeshlet.get());
+        pMeshlet.release();
+    }
+
+    // calculate the bone bounds, if possible
+    if (pDeformers)
+        CalculateBoneSpheres(vb, *pDeformers, vertexToMeshlet, firstMeshlet, meshlets);
+
+    return true;
+}
+//---------------------------------------------------------------------------
+void MeshletHelper::UpdateBounds(const VertexBuffer& vb, const Model::IDeformers* pDeformers, Model::IMeshlets& meshlets)
+{
+    const std::size_t meshletCount = meshlets.m_Meshlets.size();
+    const std::size_t vertexCount  = vb.GetVertexCount();
+
+    IIndices vertexToMeshlet(vertexCount, std::numeric_limits<std::size_t>::max());
+
+    // recalculate the meshlet bounds, and find the meshlet containing each vertex
+    for (std::size_t i = 0; i < meshletCount; ++i)
+    {
+        Model::IMeshlet* pMeshlet = meshlets.m_Meshlets[i];
+
+        CalculateBounds(vb, *pMeshlet);
+        pMeshlet->m_Bones.clear();
+
+        const std::size_t end = std::min(pMeshlet->m_Start + pMeshlet->m_Count, vertexCount);
+
+        for (std::size_t j = pMeshlet->m_Start; j < end; ++j)
+            vertexToMeshlet[j] = i;
+    }
+
+    // recalculate the bone bounds, if possible
+    if (pDeformers)
+        CalculateBoneSpheres(vb, *pDeformers, vertexToMeshlet, 0, meshlets);
+}
+//---------------------------------------------------------------------------
+bool MeshletHelper::GetSkinnedBounds(const Model::IMeshlet& meshlet,
+                                     const IMatrices&       palette,
+                                           SphereF&         sphere,
+                                           Vector3F&        coneApex,
+                                           Vector3F&        coneAxis,
+                                           float&           coneCutoff)
+{
+    const std::size_t boneCount = meshlet.m_Bones.size();
+
+    // no bone influences the meshlet, so it keeps its bind pose
+    if (!boneCount)
+    {
+        sphere     = meshlet.m_Sphere;
+        coneApex   = meshlet.m_ConeApex;
+        coneAxis   = meshlet.m_ConeAxis;
+        coneCutoff = meshlet.m_ConeCutoff;
+        return true;
+    }
+
+    sphere = SphereF();
+
+    // each skinned vertex is a weighted average of its bone transformed positions, so it is contained
+    // in the union of the transformed bone spheres
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        // matrix is missing?
+        if (meshlet.m_Bones[i].m_BoneIndex >= palette.size())
+            return false;
+
+        sphere.Merge(meshlet.m_Bones[i].m_Sphere.Transform(palette[meshlet.m_Bones[i].m_BoneIndex]));
+    }
+
+    // is the meshlet rigidly bound to a single bone?
+    if (boneCount == 1 && meshlet.m_ConeCutoff < 1.0f)
+    {
+        const Matrix4x4F& matrix = palette[meshlet.m_Bones[0].m_BoneIndex];
+
+        // the normal cone follows the bone
+        coneApex   = matrix.Transform(meshlet.m_ConeApex);
+        coneAxis   = matrix.TransformNormal(meshlet.m_ConeAxis).Normalize();
+        coneCutoff = meshlet.m_ConeCutoff;
+        return true;
+    }
+
+    // the normal cone cannot be used
+    coneApex   = sphere.m_Center;
+    coneAxis   = meshlet.m_ConeAxis;
+    coneCutoff = 1.0f;
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool MeshletHelper::IsBackFacing(const Vector3F& coneApex,
+                                 const Vector3F& coneAxis,
+                                       float     coneCutoff,
+                                 const Vector3F& viewPos)
+{
+    // degenerated cone, the meshlet may always be visible
+    if (coneCutoff >= 1.0f)
+        return false;
+
+    return ((coneApex - viewPos).Normalize().Dot(coneAxis) >= coneCutoff);
+}
+//---------------------------------------------------------------------------
+bool MeshletHelper::IsOutsideFrustum(const SphereF& sphere, const Matrix4x4F& modelViewProj)
+{
+    // empty sphere, nothing to show
+    if (sphere.IsEmpty())
+        return true;
+
+    const float(&m)[4][4] = modelViewProj.m_Table;
+
+    // extract the 6 frustum planes (left, right, bottom, top, near, far) from the matrix
+    const float planes[6][4] =
+    {
+        {m[0][3] + m[0][0], m[1][3] + m[1][0], m[2][3] + m[2][0], m[3][3] + m[3][0]},
+        {m[0][3] - m[0][0], m[1][3] - m[1][0], m[2][3] - m[2][0], m[3][3] - m[3][0]},
+        {m[0][3] + m[0][1], m[1][3] + m[1][1], m[2][3] + m[2][1], m[3][3] + m[3][1]},
+        {m[0][3] - m[0][1], m[1][3] - m[1][1], m[2][3] - m[2][1], m[3][3] - m[3][1]},
+        {m[0][3] + m[0][2], m[1][3] + m[1][2], m[2][3] + m[2][2], m[3][3] + m[3][2]},
+        {m[0][3] - m[0][2], m[1][3] - m[1][2], m[2][3] - m[2][2], m[3][3] - m[3][2]}
+    };
+
+    // check the sphere against each plane
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        const float length = std::sqrt(planes[i][0] * planes[i][0] +
+                                       planes[i][1] * planes[i][1] +
+                                       planes[i][2] * planes[i][2]);
+
+        // degenerated plane?
+        if (!length)
+            continue;
+
+        const float distance = (planes[i][0] * sphere.m_Center.m_X +
+                                planes[i][1] * sphere.m_Center.m_Y +
+                                planes[i][2] * sphere.m_Center.m_Z +
+                                planes[i][3]) / length;
+
+        // is the sphere fully behind the plane?
+        if (distance < -sphere.m_Radius)
+            return true;
+    }
+
+    return false;
+}
+//---------------------------------------------------------------------------
+void MeshletHelper::CalculateBounds(const VertexBuffer& vb, Model::IMeshlet& meshlet)
+{
+    const std::size_t end = meshlet.m_Start + meshlet.m_Count;
+
+    std::size_t  stride     = 0;
+    const float* pPositions = vb.GetPositions(stride);
+
+    // no vertex?
+    if (!pPositions)
+        return;
+
+    BoxF box;
+
+    // calculate the box surrounding the meshlet
+    for (std::size_t i = meshlet.m_Start; i < end; ++i)
+        box.Add(Vector3F(pPositions[i * stride], pPositions[i * stride + 1], pPositions[i * stride + 2]));
+
+    // calculate the bounding sphere from the box center
+    meshlet.m_Sphere.m_Center = box.GetCenter();
+    meshlet.m_Sphere.m_Radius = 0.0f;
+
+    for (std::size_t i = meshlet.m_Start; i < end; ++i)
+    {
+        const Vector3F vertex(pPositions[i * stride], pPositions[i * stride + 1], pPositions[i * stride + 2]);
+
+        meshlet.m_Sphere.m_Radius = std::max(meshlet.m_Sphere.m_Radius, (vertex - meshlet.m_Sphere.m_Center).Length());
+    }
+
+    std::vector<Vector3F> normals;
+    normals.reserve(meshlet.m_Count / 3);
+
+    Vector3F axis;
+
+    // calculate the triangle normals, and their average direction
+    for (std::size_t i = meshlet.m_Start; i + 2 < end; i += 3)
+    {
+        const Vector3F v0(pPositions[ i      * stride], pPositions[ i      * stride + 1], pPositions[ i      * stride + 2]);
+        const Vector3F v1(pPositions[(i + 1) * stride], pPositions[(i + 1) * stride + 1], pPositions[(i + 1) * stride + 2]);
+        const Vector3F v2(pPositions[(i + 2) * stride], pPositions[(i + 2) * stride + 1], pPositions[(i + 2) * stride + 2]);
+
+        const Vector3F normal = (v1 - v0).Cross(v2 - v0).Normalize();
+
+        normals.push_back(normal);
+        axis += normal;
+    }
+
+    meshlet.m_ConeAxis   = axis.Normalize();
+    meshlet.m_ConeApex   = meshlet.m_Sphere.m_Center;
+    meshlet.m_ConeCutoff = 1.0f;
+
+    // normals cancel each other, the cone cannot be used
+    if (meshlet.m_ConeAxis == Vector3F())
+        return;
+
+    float minDot = 1.0f;
+
+    // search for the largest angle between the axis and a triangle normal
+    for (std::size_t i = 0; i < normals.size(); ++i)
+        // degenerated triangles have no normal and can be ignored
+        if (normals[i] != Vector3F())
+            minDot = std::min(minDot, normals[i].Dot(meshlet.m_ConeAxis));
+
+    // the cone is too wide (more than about 84 degrees) to be useful
+    if (minDot <= 0.1f)
+        return;
+
+    float maxT = 0.0f;
+
+    // place the apex in a such manner that all the triangles are in front of it
+    for (std::size_t i = 0; i < normals.size(); ++i)
+    {
+        if (normals[i] == Vector3F())
+            continue;
+
+        const std::size_t index = (meshlet.m_Start + (i * 3)) * stride;
+        const Vector3F    v0(pPositions[index], pPositions[index + 1], pPositions[index + 2]);
+
+        maxT = std::max(maxT, (meshlet.m_Sphere.m_Center - v0).Dot(normals[i]) / meshlet.m_ConeAxis.Dot(normals[i]));
+    }
+
+    meshlet.m_ConeApex   = meshlet.m_Sphere.m_Center - (meshlet.m_ConeAxis * maxT);
+    meshlet.m_ConeCutoff = std::sqrt(1.0f - (minDot * minDot));
+}
+//---------------------------------------------------------------------------
+void MeshletHelper::CalculateBoneSpheres(const VertexBuffer&      vb,
+                                         const Model::IDeformers& deformers,
+                                         const IIndices&          vertexToMeshlet,
+                                               std::size_t        firstMeshlet,
+                                               Model::IMeshlets&  meshlets)
+{
+    typedef std::map<std::size_t, BoxF>    IBoneBoxes;
+    typedef std::map<std::size_t, SphereF> IBoneSpheres;
+
+    const std::size_t meshletCount = meshlets.m_Meshlets.size() - firstMeshlet;
+    const std::size_t weightsCount = deformers.m_SkinWeights.size();
+
+    std::size_t  stride     = 0;
+    const float* pPositions = vb.GetPositions(stride);
+
+    // no vertex?
+    if (!pPositions)
+        return;
+
+    std::vector<IBoneBoxes>   boneBoxes(meshletCount);
+    std::vector<IBoneSpheres> boneSpheres(meshletCount);
+
+    // the vertices are processed twice, first to find the sphere centers, then to find their radius
+    for (std::size_t pass = 0; pass < 2; ++pass)
+    {
+        // convert the boxes found in the first pass to spheres
+        if (pass)
+            for (std::size_t i = 0; i < meshletCount; ++i)
+                for (IBoneBoxes::const_iterator it = boneBoxes[i].begin(); it != boneBoxes[i].end(); ++it)
+                    boneSpheres[i][it->first] = SphereF(it->second.GetCenter(), 0.0f);
+
+        for (std::size_t i = 0; i < weightsCount; ++i)
+        {
+            const Model::ISkinWeights* pSkinWeights = deformers.m_SkinWeights[i];
+
+            // the spheres are keyed by their bone, thus the skin weights without bone cannot be used
+            if (!pSkinWeights || !pSkinWeights->m_pBone)
+                continue;
+
+            const std::size_t boneIndex      = pSkinWeights->m_pBone->m_Index;
+            const std::size_t influenceCount = pSkinWeights->m_WeightInfluences.size();
+
+            for (std::size_t j = 0; j < influenceCount; ++j)
+            {
+                // a vertex not weighted by the bone isn't moved by it
+                if (j < pSkinWeights->m_Weights.size() && pSkinWeights->m_Weights[j] <= 0.0f)
+                    continue;
+
+                const Model::IWeightInfluence* pInfluence  = pSkinWeights->m_WeightInfluences[j];
+                const std::size_t              vertexCount = pInfluence->m_VertexIndex.size();
+
+                for (std::size_t k = 0; k < vertexCount; ++k)
+                {
+                    // the vertex index is the offset of the vertex in the buffer position data
+                    const std::size_t offset = pInfluence->m_VertexIndex[k];
+                    const std::size_t vertex = offset / stride;
+
+                    // vertex isn't part of a meshlet?
+                    if (vertex >= vertexToMeshlet.size() || vertexToMeshlet[vertex] >= meshlets.m_Meshlets.size())
+                        continue;
+
+                    const std::size_t meshlet = vertexToMeshlet[vertex] - firstMeshlet;
+
+                    // the vertex is kept in the model space, the pose palette applies the inverse bind matrix itself
+                    const Vector3F position(pPositions[offset], pPositions[offset + 1], pPositions[offset + 2]);
+
+                    if (!pass)
+                        boneBoxes[meshlet][boneIndex].Add(position);
+                    else
+                    {
+                        SphereF& sphere = boneSpheres[meshlet][boneIndex];
+                        sphere.m_Radius = std::max(sphere.m_Radius, (position - sphere.m_Center).Length());
+                    }
+                }
+            }
+        }
+    }
+
+    // populate the meshlet bones
+    for (std::size_t i = 0; i < meshletCount; ++i)
+        for (IBoneSpheres::const_iterator it = boneSpheres[i].begin(); it != boneSpheres[i].end(); ++it)
+        {
+            Model::IMeshletBone bone;
+            bone.m_BoneIndex = it->first;
+            bone.m_Sphere    = it->second;
+
+            meshlets.m_Meshlets[firstMeshlet + i]->m_Bones.push_back(bone);
+        }
+}
+//---------------------------------------------------------------------------
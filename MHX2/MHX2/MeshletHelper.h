@@ -0,0 +1,144 @@
+/****************************************************************************
+ * ==> MeshletHelper -------------------------------------------------------*
+ ****************************************************************************
+ * Description : Meshlet (i.e. mesh cluster) helper                         *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <vector>
+
+// classes
+#include "Vector3.h"
+#include "Matrix4x4.h"
+#include "Sphere.h"
+#include "Vertex.h"
+#include "Model.h"
+
+/**
+* Meshlet helper, splits a mesh into small clusters of triangles and provides the functions to cull them
+*@author Jean-Milost Reymond
+*/
+class MeshletHelper
+{
+    public:
+        typedef std::vector<std::size_t> IIndices;
+        typedef Model::IMatrices         IMatrices;
+
+        /**
+        * Splits a triangle list vertex buffer into meshlets
+        *@param vb - vertex buffer to split, should contain a triangle list
+        *@param pSourceIndices - for each vertex contained in the buffer, the source vertex index from which it was
+        *                        built, if nullptr each vertex is considered as unique
+        *@param pDeformers - mesh deformers, used to calculate the bounding sphere of each bone influencing a meshlet,
+        *                    ignored if nullptr. The spheres are keyed by the bone table indices, thus the bone table
+        *                    should be built
+        *@param maxVertices - max unique source vertices a meshlet may reference
+        *@param maxTriangles - max triangles a meshlet may contain
+        *@param[out] meshlets - meshlets to populate
+        *@return true on success, otherwise false
+        *@note Each meshlet is a consecutive vertex range in the buffer, thus it may be skinned or drawn alone
+        */
+        static bool Build(const VertexBuffer&       vb,
+                          const IIndices*           pSourceIndices,
+                          const Model::IDeformers*  pDeformers,
+                                std::size_t         maxVertices,
+                                std::size_t         maxTriangles,
+                                Model::IMeshlets&   meshlets);
+
+        /**
+        * Updates the bind pose bounds of the meshlets, e.g. after the vertex buffer positions were morphed
+        *@param vb - vertex buffer containing the meshlets
+        *@param pDeformers - mesh deformers, used to calculate the bone bounding spheres, ignored if nullptr. The bone
+        *                    table should be built
+        *@param[in, out] meshlets - meshlets to update, should have been built from the vertex buffer
+        */
+        static void UpdateBounds(const VertexBuffer& vb, const Model::IDeformers* pDeformers, Model::IMeshlets& meshlets);
+
+        /**
+        * Gets the bounds of a meshlet once skinned
+        *@param meshlet - meshlet for which the bounds should be calculated
+        *@param palette - pose matrix palette (inverse bind * global pose), in the same order as the model bone table,
+        *                 e.g. the ModelInstance::m_Palette
+        *@param[out] sphere - skinned bounding sphere
+        *@param[out] coneApex - skinned normal cone apex
+        *@param[out] coneAxis - skinned normal cone axis
+        *@param[out] coneCutoff - skinned normal cone cutoff, 1.0f if the cone cannot be used
+        *@return true on success, otherwise false
+        *@note The bounds are derived from the bones influencing the meshlet, thus the skinned vertices aren't required.
+        *      The vertex weights are expected to sum to 1. The normal cone is only kept for meshlets influenced by a
+        *      single bone, because the blended triangles of the other meshlets may no longer fit in it
+        */
+        static bool GetSkinnedBounds(const Model::IMeshlet& meshlet,
+                                     const IMatrices&       palette,
+                                           SphereF&         sphere,
+                                           Vector3F&        coneApex,
+                                           Vector3F&        coneAxis,
+                                           float&           coneCutoff);
+
+        /**
+        * Checks if all the triangles of a meshlet are back facing the viewer
+        *@param coneApex - meshlet normal cone apex
+        *@param coneAxis - meshlet normal cone axis
+        *@param coneCutoff - meshlet normal cone cutoff
+        *@param viewPos - viewer position, in the same space as the cone
+        *@return true if the whole meshlet is back facing and may be skipped, otherwise false
+        */
+        static bool IsBackFacing(const Vector3F& coneApex,
+                                 const Vector3F& coneAxis,
+                                       float     coneCutoff,
+                                 const Vector3F& viewPos);
+
+        /**
+        * Checks if a bounding sphere is outside the view frustum
+        *@param sphere - bounding sphere to check
+        *@param modelViewProj - combined model, view and projection matrix (i.e. model.Multiply(view).Multiply(proj))
+        *@return true if the sphere is fully outside the frustum and may be skipped, otherwise false
+        */
+        static bool IsOutsideFrustum(const SphereF& sphere, const Matrix4x4F& modelViewProj);
+
+    private:
+        /**
+        * Calculates the bind pose bounding sphere and normal cone of a meshlet
+        *@param vb - vertex buffer containing the meshlet
+        *@param[in, out] meshlet - meshlet for which the bounds should be calculated
+        */
+        static void CalculateBounds(const VertexBuffer& vb, Model::IMeshlet& meshlet);
+
+        /**
+        * Calculates the bind pose bounding sphere, in the model space, of the meshlet vertices influenced by each bone
+        *@param vb - vertex buffer containing the meshlets
+        *@param deformers - mesh deformers
+        *@param vertexToMeshlet - for each vertex, the index of the meshlet containing it
+        *@param firstMeshlet - index of the first meshlet built from the vertex buffer
+        *@param[in, out] meshlets - meshlets for which the bone spheres should be calculated
+        */
+        static void CalculateBoneSpheres(const VertexBuffer&      vb,
+                                         const Model::IDeformers& deformers,
+                                         const IIndices&          vertexToMeshlet,
+                                               std::size_t        firstMeshlet,
+                                               Model::IMeshlets&  meshlets);
+};
@@ -28,8 +28,14 @@
 
 #include "Model.h"
 
+// std
+#include <memory>
+#include <algorithm>
+
 // classes
 #include "Quaternion.h"
+#include "AnimationSampler.h"
+#include "CompressedAnimation.h"
 
 //---------------------------------------------------------------------------
 // Model::IBone
@@ -37,6 +43,7 @@
 Model::IBone::IBone() :
     m_Matrix(Matrix4x4F::Identity()),
     m_pParent(nullptr),
+    m_Index(0),
     m_pCustom(nullptr)
 {}
 //---------------------------------------------------------------------------
@@ -48,6 +55,14 @@ Model::IBone::~IBone()
         delete m_Children[i];
 }
 //---------------------------------------------------------------------------
+// Model::IBoneTable
+//---------------------------------------------------------------------------
+Model::IBoneTable::IBoneTable()
+{}
+//---------------------------------------------------------------------------
+Model::IBoneTable::~IBoneTable()
+{}
+//---------------------------------------------------------------------------
 // Model::IWeightInfluence
 //---------------------------------------------------------------------------
 Model::IWeightInfluence::IWeightInfluence()
@@ -84,6 +99,71 @@ Model::IDeformers::~IDeformers()
         delete m_SkinWeights[i];
 }
 //---------------------------------------------------------------------------
+// Model::IMeshletBone
+//---------------------------------------------------------------------------
+Model::IMeshletBone::IMeshletBone() :
+    m_BoneIndex(0)
+{}
+//---------------------------------------------------------------------------
+Model::IMeshletBone::~IMeshletBone()
+{}
+//---------------------------------------------------------------------------
+// Model::IBounds
+//---------------------------------------------------------------------------
+Model::IBounds::IBounds()
+{}
+//---------------------------------------------------------------------------
+Model::IBounds::~IBounds()
+{}
+//---------------------------------------------------------------------------
+// Model::IVertexInfluences
+//---------------------------------------------------------------------------
+Model::IVertexInfluences::IVertexInfluences() :
+    m_SlotCount(0),
+    m_DroppedCount(0)
+{}
+//---------------------------------------------------------------------------
+Model::IVertexInfluences::~IVertexInfluences()
+{}
+//---------------------------------------------------------------------------
+// Model::ISkeletonLOD
+//---------------------------------------------------------------------------
+Model::ISkeletonLOD::ISkeletonLOD()
+{}
+//---------------------------------------------------------------------------
+Model::ISkeletonLOD::~ISkeletonLOD()
+{
+    const std::size_t influencesCount = m_Influences.size();
+
+    for (std::size_t i = 0; i < influencesCount; ++i)
+        delete m_Influences[i];
+}
+//---------------------------------------------------------------------------
+// Model::IMeshlet
+//---------------------------------------------------------------------------
+Model::IMeshlet::IMeshlet() :
+    m_Start(0),
+    m_Count(0),
+    m_SourceCount(0),
+    m_ConeCutoff(1.0f)
+{}
+//---------------------------------------------------------------------------
+Model::IMeshlet::~IMeshlet()
+{}
+//---------------------------------------------------------------------------
+// Model::IMeshlets
+//---------------------------------------------------------------------------
+Model::IMeshlets::IMeshlets()
+{}
+//---------------------------------------------------------------------------
+Model::IMeshlets::~IMeshlets()
+{
+    const std::size_t count = m_Meshlets.size();
+
+    for (std::size_t i = 0; i < count; ++i)
+        delete m_Meshlets[i];
+}
+//---------------------------------------------------------------------------
 // Model::IAnimationKey
 //---------------------------------------------------------------------------
 Model::IAnimationKey::IAnimationKey() :
@@ -125,7 +205,8 @@ Model::IAnimation::~IAnimation()
 // Model::IAnimationSet
 //---------------------------------------------------------------------------
 Model::IAnimationSet::IAnimationSet() :
-    m_MaxValue(0L)
+    m_MaxValue(0L),
+    m_pCompressed(nullptr)
 {}
 //---------------------------------------------------------------------------
 Model::IAnimationSet::~IAnimationSet()
@@ -134,14 +215,20 @@ Model::IAnimationSet::~IAnimationSet()
 
     for (std::size_t i = 0; i < count; ++i)
         delete m_Animations[i];
+
+    delete m_pCompressed;
 }
 //---------------------------------------------------------------------------
 // Model
 //---------------------------------------------------------------------------
 Model::Model() :
     m_pSkeleton(nullptr),
+    m_MaxInfluences(8),
+    m_Revision(0),
+    m_MinWeight(0.0f),
     m_MeshOnly(false),
-    m_PoseOnly(false)
+    m_PoseOnly(false),
+    m_DQSkinning(false)
 {}
 //---------------------------------------------------------------------------
 Model::~Model()
@@ -150,6 +237,26 @@ Model::~Model()
 
     for (std::size_t i = 0; i < meshCount; ++i)
         delete m_Mesh[i];
+
+    const std::size_t meshletsCount = m_Meshlets.size();
+
+    for (std::size_t i = 0; i < meshletsCount; ++i)
+        delete m_Meshlets[i];
+
+    const std::size_t boundsCount = m_Bounds.size();
+
+    for (std::size_t i = 0; i < boundsCount; ++i)
+        delete m_Bounds[i];
+
+    const std::size_t influencesCount = m_Influences.size();
+
+    for (std::size_t i = 0; i < influencesCount; ++i)
+        delete m_Influences[i];
+
+    const std::size_t lodCount = m_SkeletonLODs.size();
+
+    for (std::size_t i = 0; i < lodCount; ++i)
+        delete m_SkeletonLODs[i];
 }
 //---------------------------------------------------------------------------
 Model::IBone* Model::FindBone(IBone* pBone, const std::string& name) const
@@ -209,3 +316,887 @@ void Model::GetBoneMatrix(const IBone* pBone, const Matrix4x4F& initialMatrix, M
     }
 }
 //---------------------------------------------------------------------------
+void Model::GetBoneAnimMatrix(const IBone*         pBone,
+                              const IAnimationSet* pAnimSet,
+                                    double         elapsedTime,
+                              const Matrix4x4F&    initialMatrix,
+                                    Matrix4x4F&    matrix) const
+{
+    // no bone?
+    if (!pBone)
+        return;
+
+    const double time = pAnimSet ? AnimationSampler::GetTime(*pAnimSet, elapsedTime) : 0.0;
+
+    // set the output matrix as identity
+    matrix = Matrix4x4F::Identity();
+
+    // iterate through bones
+    while (pBone)
+    {
+        // get the bone bind pose local matrix, from the bone table if it contains the bone
+        const bool inTable = pBone->m_Index < m_BoneTable.m_Bones.size() && m_BoneTable.m_Bones[pBone->m_Index] == pBone;
+
+        const Matrix4x4F& bindLocal   = inTable ? m_BoneTable.m_Local[pBone->m_Index] : pBone->m_Matrix;
+              Matrix4x4F  localMatrix = bindLocal;
+
+        // search for the bone animation, and sample it if found
+        if (pAnimSet && pAnimSet->m_pCompressed)
+        {
+            if (inTable)
+                pAnimSet->m_pCompressed->SampleBone(pBone->m_Index, time, bindLocal, localMatrix);
+        }
+        else
+        if (pAnimSet)
+            for (std::size_t i = 0; i < pAnimSet->m_Animations.size(); ++i)
+            {
+                const IAnimation* pAnimation = pAnimSet->m_Animations[i];
+
+                if (!pAnimation)
+                    continue;
+
+                if (pAnimation->m_pBone == pBone || (!pAnimation->m_pBone && pAnimation->m_BoneName == pBone->m_Name))
+                {
+                    AnimationSampler::SampleBone(*pAnimation,
+                                                  time,
+                                                  bindLocal,
+                                                  AnimationSampler::IEInterpolation::IE_I_Nlerp,
+                                                  localMatrix);
+                    break;
+                }
+            }
+
+        // stack the previously calculated matrix with the current bone one
+        matrix = matrix.Multiply(localMatrix);
+
+        // go to parent bone
+        pBone = pBone->m_pParent;
+    }
+
+    // initial matrix provided?
+    if (!initialMatrix.IsIdentity())
+        matrix = matrix.Multiply(initialMatrix);
+}
+//---------------------------------------------------------------------------
+int Model::FindBoneIndex(const std::string& name) const
+{
+    const std::size_t count = m_BoneTable.m_Names.size();
+
+    for (std::size_t i = 0; i < count; ++i)
+        if (m_BoneTable.m_Names[i] == name)
+            return (int)i;
+
+    return -1;
+}
+//---------------------------------------------------------------------------
+bool Model::GetGlobalPose(const IMatrices& localPose, IMatrices& globalPose) const
+{
+    const std::size_t count = m_BoneTable.m_Parents.size();
+
+    // local pose doesn't match with the bone table?
+    if (localPose.size() != count)
+        return false;
+
+    globalPose.resize(count);
+
+    // the parents precede their children, thus their global matrix is always known
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const int parent = m_BoneTable.m_Parents[i];
+
+        if (parent < 0)
+            globalPose[i] = localPose[i];
+        else
+            globalPose[i] = localPose[i].Multiply(globalPose[parent]);
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool Model::CompressAnimationSet(std::size_t index, float maxError, double frameRate)
+{
+    // invalid animation set?
+    if (index >= m_AnimationSet.size() || !m_AnimationSet[index])
+        return false;
+
+    IAnimationSet* pAnimSet = m_AnimationSet[index];
+
+    std::unique_ptr<CompressedAnimation> pCompressed(new CompressedAnimation());
+
+    if (!pCompressed->Compress(*this, *pAnimSet, maxError, frameRate))
+        return false;
+
+    // the keys are no longer required
+    for (std::size_t i = 0; i < pAnimSet->m_Animations.size(); ++i)
+        delete pAnimSet->m_Animations[i];
+
+    pAnimSet->m_Animations.clear();
+    pAnimSet->m_Animations.shrink_to_fit();
+
+    delete pAnimSet->m_pCompressed;
+    pAnimSet->m_pCompressed = pCompressed.release();
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool Model::BuildBounds(std::size_t meshIndex)
+{
+    // invalid mesh?
+    if (meshIndex >= m_Mesh.size() || !m_Mesh[meshIndex])
+        return false;
+
+    // bounds table should follow the meshes
+    if (m_Bounds.size() < m_Mesh.size())
+        m_Bounds.resize(m_Mesh.size(), nullptr);
+
+    if (!m_Bounds[meshIndex])
+        m_Bounds[meshIndex] = new IBounds();
+
+    IBounds*    pBounds = m_Bounds[meshIndex];
+    const Mesh* pMesh   = m_Mesh[meshIndex];
+
+    pBounds->m_Box.Clear();
+
+    // calculate the mesh bounding box
+    for (std::size_t i = 0; i < pMesh->m_VB.size(); ++i)
+    {
+        const std::size_t count      = pMesh->m_VB[i]->GetVertexCount();
+        std::size_t       stride     = 0;
+        const float*      pPositions = pMesh->m_VB[i]->GetPositions(stride);
+
+        for (std::size_t j = 0; j < count; ++j)
+            pBounds->m_Box.Add(Vector3F(pPositions[j * stride], pPositions[j * stride + 1], pPositions[j * stride + 2]));
+    }
+
+    // calculate the mesh bounding sphere, centered on the box
+    pBounds->m_Sphere = SphereF();
+
+    if (!pBounds->m_Box.IsEmpty())
+    {
+        pBounds->m_Sphere.m_Center = pBounds->m_Box.GetCenter();
+        pBounds->m_Sphere.m_Radius = 0.0f;
+
+        for (std::size_t i = 0; i < pMesh->m_VB.size(); ++i)
+        {
+            const std::size_t count      = pMesh->m_VB[i]->GetVertexCount();
+            std::size_t       stride     = 0;
+            const float*      pPositions = pMesh->m_VB[i]->GetPositions(stride);
+
+            for (std::size_t j = 0; j < count; ++j)
+                pBounds->m_Sphere.m_Radius =
+                        std::max(pBounds->m_Sphere.m_Radius,
+                                (Vector3F(pPositions[j * stride], pPositions[j * stride + 1], pPositions[j * stride + 2]) -
+                                        pBounds->m_Sphere.m_Center).Length());
+        }
+    }
+
+    // no bone deforms the mesh?
+    if (meshIndex >= m_Deformers.size() || !m_Deformers[meshIndex] || pMesh->m_VB.size() != 1)
+        return true;
+
+    const std::size_t positionCount = pMesh->m_VB[0]->GetVertexCount();
+    std::size_t       stride        = 0;
+    const float*      pPositions    = pMesh->m_VB[0]->GetPositions(stride);
+    const std::size_t dataSize      = positionCount ? (positionCount - 1) * stride + 3 : 0;
+
+    // calculate the bounds of the vertices influenced by each bone. They are kept in the model space, thus the pose
+    // palette, which applies the inverse bind matrix itself, transforms them
+    for (std::size_t i = 0; i < m_Deformers[meshIndex]->m_SkinWeights.size(); ++i)
+    {
+        ISkinWeights* pSkinWeights = m_Deformers[meshIndex]->m_SkinWeights[i];
+
+        if (!pSkinWeights)
+            continue;
+
+        pSkinWeights->m_Box.Clear();
+
+        for (std::size_t j = 0; j < pSkinWeights->m_WeightInfluences.size(); ++j)
+        {
+            // a vertex not weighted by the bone isn't moved by it
+            if (j < pSkinWeights->m_Weights.size() && pSkinWeights->m_Weights[j] <= 0.0f)
+                continue;
+
+            const IWeightInfluence* pInfluence = pSkinWeights->m_WeightInfluences[j];
+
+            for (std::size_t k = 0; k < pInfluence->m_VertexIndex.size(); ++k)
+            {
+                const std::size_t offset = pInfluence->m_VertexIndex[k];
+
+                // invalid vertex index?
+                if (offset + 2 >= dataSize)
+                    continue;
+
+                pSkinWeights->m_Box.Add(Vector3F(pPositions[offset], pPositions[offset + 1], pPositions[offset + 2]));
+            }
+        }
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool Model::BuildBoneTable(bool globalMatrices)
+{
+    m_BoneTable = IBoneTable();
+
+    // no skeleton?
+    if (!m_pSkeleton)
+        return true;
+
+    IBone::IBones stack(1, m_pSkeleton);
+
+    // list the bones parents first, in depth first order
+    while (!stack.empty())
+    {
+        IBone* pBone = stack.back();
+        stack.pop_back();
+
+        // too many bones to be indexed?
+        if (m_BoneTable.m_Bones.size() >= 0xFFFF)
+            return false;
+
+        pBone->m_Index = m_BoneTable.m_Bones.size();
+        m_BoneTable.m_Bones.push_back(pBone);
+        m_BoneTable.m_Parents.push_back(pBone->m_pParent ? (int)pBone->m_pParent->m_Index : -1);
+        m_BoneTable.m_Names.push_back(pBone->m_Name);
+
+        // push the children in reverse order, thus they are listed in their original order
+        for (std::size_t i = pBone->m_Children.size(); i; --i)
+            stack.push_back(pBone->m_Children[i - 1]);
+    }
+
+    const std::size_t boneCount = m_BoneTable.m_Bones.size();
+
+    m_BoneTable.m_Local.resize(boneCount);
+    m_BoneTable.m_Global.resize(boneCount);
+
+    // get the bind pose, either from the local or the global bone matrices
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        const int   parent = m_BoneTable.m_Parents[i];
+        Matrix4x4F& local  = m_BoneTable.m_Local[i];
+        Matrix4x4F& global = m_BoneTable.m_Global[i];
+        float       determinant;
+
+        if (!globalMatrices)
+        {
+            local  = m_BoneTable.m_Bones[i]->m_Matrix;
+            global = parent < 0 ? local : local.Multiply(m_BoneTable.m_Global[parent]);
+        }
+        else
+        {
+            global = m_BoneTable.m_Bones[i]->m_Matrix;
+
+            // the local matrix is the global one expressed in the parent space
+            local = parent < 0 ? global : global.Multiply(m_BoneTable.m_Global[parent].Inverse(determinant));
+        }
+    }
+
+    m_BoneTable.m_InverseBind.resize(boneCount, Matrix4x4F::Identity());
+
+    std::vector<bool> found(boneCount, false);
+
+    // read the inverse bind matrices from the skin weights
+    for (std::size_t i = 0; i < m_Deformers.size(); ++i)
+    {
+        if (!m_Deformers[i])
+            continue;
+
+        for (std::size_t j = 0; j < m_Deformers[i]->m_SkinWeights.size(); ++j)
+        {
+            const ISkinWeights* pSkinWeights = m_Deformers[i]->m_SkinWeights[j];
+
+            if (!pSkinWeights || !pSkinWeights->m_pBone)
+                continue;
+
+            const std::size_t index = pSkinWeights->m_pBone->m_Index;
+
+            // bone doesn't belong to the skeleton?
+            if (index >= m_BoneTable.m_Bones.size() || m_BoneTable.m_Bones[index] != pSkinWeights->m_pBone)
+                return false;
+
+            // the palette cannot be shared if the bone is bound differently by several meshes
+            if (found[index] && m_BoneTable.m_InverseBind[index] != pSkinWeights->m_Matrix)
+                return false;
+
+            m_BoneTable.m_InverseBind[index] = pSkinWeights->m_Matrix;
+            found[index]         = true;
+        }
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool Model::BuildInfluences(std::size_t meshIndex)
+{
+    // invalid mesh?
+    if (meshIndex >= m_Mesh.size() || !m_Mesh[meshIndex])
+        return false;
+
+    // influences table should follow the meshes
+    if (m_Influences.size() < m_Mesh.size())
+        m_Influences.resize(m_Mesh.size(), nullptr);
+
+    if (m_Influences[meshIndex])
+    {
+        delete m_Influences[meshIndex];
+        m_Influences[meshIndex] = nullptr;
+    }
+
+    const Mesh* pMesh = m_Mesh[meshIndex];
+
+    // no bone deforms the mesh?
+    if (meshIndex >= m_Deformers.size() || !m_Deformers[meshIndex] || pMesh->m_VB.size() != 1)
+        return true;
+
+    const IDeformers* pDeformers  = m_Deformers[meshIndex];
+    const std::size_t weightCount = pDeformers->m_SkinWeights.size();
+    const std::size_t vertexCount = pMesh->m_VB[0]->GetVertexCount();
+    std::size_t       stride      = 0;
+    const float*      pPositions  = pMesh->m_VB[0]->GetPositions(stride);
+
+    // check that the bone table contains the bones deforming the mesh
+    for (std::size_t i = 0; i < weightCount; ++i)
+    {
+        const ISkinWeights* pSkinWeights = pDeformers->m_SkinWeights[i];
+
+        if (!pSkinWeights)
+            continue;
+
+        const IBone* pBone = pSkinWeights->m_pBone;
+
+        if (!pBone || pBone->m_Index >= m_BoneTable.m_Bones.size() || m_BoneTable.m_Bones[pBone->m_Index] != pBone)
+            return false;
+    }
+
+    if (!pPositions || !stride)
+        return !vertexCount;
+
+    std::vector<std::size_t> counts(vertexCount, 0);
+    std::vector<std::size_t> keptCounts(vertexCount, 0);
+    std::size_t              maxCount = 0;
+
+    // count the bones influencing each vertex
+    for (std::size_t i = 0; i < weightCount; ++i)
+    {
+        const ISkinWeights* pSkinWeights = pDeformers->m_SkinWeights[i];
+
+        if (!pSkinWeights)
+            continue;
+
+        for (std::size_t j = 0; j < pSkinWeights->m_WeightInfluences.size() && j < pSkinWeights->m_Weights.size(); ++j)
+        {
+            // a vertex not weighted by the bone isn't moved by it
+            if (pSkinWeights->m_Weights[j] <= 0.0f)
+                continue;
+
+            const IWeightInfluence* pInfluence = pSkinWeights->m_WeightInfluences[j];
+
+            for (std::size_t k = 0; k < pInfluence->m_VertexIndex.size(); ++k)
+            {
+                const std::size_t vertex = pInfluence->m_VertexIndex[k] / stride;
+
+                // malformed influence?
+                if (pInfluence->m_VertexIndex[k] % stride || vertex >= vertexCount)
+                    return false;
+
+                maxCount = std::max(maxCount, ++counts[vertex]);
+
+                // count the influences strong enough to be kept
+                if (pSkinWeights->m_Weights[j] >= m_MinWeight)
+                    ++keptCounts[vertex];
+            }
+        }
+    }
+
+    // the influences are pruned if required, i.e. their count is limited per vertex, and the weak ones are dropped
+    const std::size_t maxInfluences = m_MaxInfluences <= 2 ? 2 : (m_MaxInfluences <= 4 ? 4 : 8);
+    const bool        prune         = (maxInfluences < 8 || m_MinWeight > 0.0f);
+    std::size_t       maxKept       = 0;
+
+    // a vertex always keeps its strongest influence
+    if (prune)
+        for (std::size_t i = 0; i < vertexCount; ++i)
+            maxKept = std::max(maxKept, std::min(std::max(keptCounts[i], std::size_t(counts[i] ? 1 : 0)), maxInfluences));
+
+    std::unique_ptr<IVertexInfluences> pInfluences(new IVertexInfluences());
+    pInfluences->m_SlotCount = prune ? (maxKept <= 2 ? 2 : (maxKept <= 4 ? 4 : 8)) : (maxCount <= 4 ? 4 : 8);
+    pInfluences->m_BoneIndices.resize(vertexCount * pInfluences->m_SlotCount, 0);
+    pInfluences->m_Weights.resize(vertexCount * pInfluences->m_SlotCount, 0.0f);
+
+    const std::size_t slotCount = pInfluences->m_SlotCount;
+
+    // fill the slots, keeping them sorted by decreasing weight. When a vertex has no slot left, the weakest
+    // influence is dropped
+    for (std::size_t i = 0; i < weightCount; ++i)
+    {
+        const ISkinWeights* pSkinWeights = pDeformers->m_SkinWeights[i];
+
+        if (!pSkinWeights)
+            continue;
+
+        for (std::size_t j = 0; j < pSkinWeights->m_WeightInfluences.size() && j < pSkinWeights->m_Weights.size(); ++j)
+        {
+            const float weight = pSkinWeights->m_Weights[j];
+
+            if (weight <= 0.0f)
+                continue;
+
+            const IWeightInfluence* pInfluence = pSkinWeights->m_WeightInfluences[j];
+
+            for (std::size_t k = 0; k < pInfluence->m_VertexIndex.size(); ++k)
+            {
+                const std::size_t first        = (pInfluence->m_VertexIndex[k] / stride) * slotCount;
+                unsigned short*   pBoneIndices = &pInfluences->m_BoneIndices[first];
+                float*            pWeights     = &pInfluences->m_Weights[first];
+
+                // weaker than all the kept influences?
+                if (pWeights[slotCount - 1] >= weight)
+                    continue;
+
+                std::size_t slot = slotCount - 1;
+
+                // shift the weaker influences to insert the new one
+                while (slot && pWeights[slot - 1] < weight)
+                {
+                    pBoneIndices[slot] = pBoneIndices[slot - 1];
+                    pWeights[slot]     = pWeights[slot - 1];
+                    --slot;
+                }
+
+                pBoneIndices[slot] = (unsigned short)pSkinWeights->m_pBone->m_Index;
+                pWeights[slot]     = weight;
+            }
+        }
+    }
+
+    if (prune)
+    {
+        // drop the weak influences, then renormalize the weights of each vertex to 1
+        for (std::size_t i = 0; i < vertexCount; ++i)
+        {
+            unsigned short* pBoneIndices = &pInfluences->m_BoneIndices[i * slotCount];
+            float*          pWeights     = &pInfluences->m_Weights[i * slotCount];
+            std::size_t     kept         = 0;
+            float           sum          = 0.0f;
+
+            for (std::size_t j = 0; j < slotCount; ++j)
+                if (pWeights[j] > 0.0f && (!j || pWeights[j] >= m_MinWeight))
+                {
+                    sum += pWeights[j];
+                    ++kept;
+                }
+                else
+                {
+                    pBoneIndices[j] = 0;
+                    pWeights[j]     = 0.0f;
+                }
+
+            pInfluences->m_DroppedCount += counts[i] - kept;
+
+            if (sum <= 0.0f)
+                continue;
+
+            const float factor = 1.0f / sum;
+
+            for (std::size_t j = 0; j < kept; ++j)
+                pWeights[j] *= factor;
+        }
+    }
+    else
+    // renormalize the vertices which lost influences, in order to keep their original weight sum
+    if (maxCount > slotCount)
+    {
+        std::vector<float> sums(vertexCount, 0.0f);
+
+        for (std::size_t i = 0; i < weightCount; ++i)
+        {
+            const ISkinWeights* pSkinWeights = pDeformers->m_SkinWeights[i];
+
+            if (!pSkinWeights)
+                continue;
+
+            for (std::size_t j = 0; j < pSkinWeights->m_WeightInfluences.size() && j < pSkinWeights->m_Weights.size(); ++j)
+                if (pSkinWeights->m_Weights[j] > 0.0f)
+                    for (std::size_t k = 0; k < pSkinWeights->m_WeightInfluences[j]->m_VertexIndex.size(); ++k)
+                        sums[pSkinWeights->m_WeightInfluences[j]->m_VertexIndex[k] / stride] += pSkinWeights->m_Weights[j];
+        }
+
+        for (std::size_t i = 0; i < vertexCount; ++i)
+        {
+            if (counts[i] <= slotCount)
+                continue;
+
+            pInfluences->m_DroppedCount += counts[i] - slotCount;
+
+            float* pWeights = &pInfluences->m_Weights[i * slotCount];
+            float  kept     = 0.0f;
+
+            for (std::size_t j = 0; j < slotCount; ++j)
+                kept += pWeights[j];
+
+            if (kept <= 0.0f)
+                continue;
+
+            const float factor = sums[i] / kept;
+
+            for (std::size_t j = 0; j < slotCount; ++j)
+                pWeights[j] *= factor;
+        }
+    }
+
+    m_Influences[meshIndex] = pInfluences.release();
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool Model::SelectBonesByName(const IBoneTable::INames& names, IBoneSelection& selection) const
+{
+    const std::size_t boneCount = m_BoneTable.m_Parents.size();
+
+    // no bone table?
+    if (!boneCount)
+        return false;
+
+    if (selection.size() < boneCount)
+        selection.resize(boneCount, false);
+
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+        const int index = FindBoneIndex(names[i]);
+
+        if (index >= 0)
+            selection[index] = true;
+    }
+
+    // the parents precede their children, thus the selection is propagated in a single forward pass
+    for (std::size_t i = 0; i < boneCount; ++i)
+        if (m_BoneTable.m_Parents[i] >= 0 && selection[m_BoneTable.m_Parents[i]])
+            selection[i] = true;
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool Model::SelectBonesByDepth(std::size_t maxDepth, IBoneSelection& selection) const
+{
+    const std::size_t boneCount = m_BoneTable.m_Parents.size();
+
+    // no bone table?
+    if (!boneCount)
+        return false;
+
+    if (selection.size() < boneCount)
+        selection.resize(boneCount, false);
+
+    std::vector<std::size_t> depths(boneCount, 0);
+
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        const int parent = m_BoneTable.m_Parents[i];
+
+        if (parent >= 0)
+            depths[i] = depths[parent] + 1;
+
+        if (depths[i] > maxDepth)
+            selection[i] = true;
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool Model::SelectBonesByVolume(float minVolume, IBoneSelection& selection) const
+{
+    const std::size_t boneCount = m_BoneTable.m_Parents.size();
+
+    // no bone table?
+    if (!boneCount)
+        return false;
+
+    if (selection.size() < boneCount)
+        selection.resize(boneCount, false);
+
+    std::vector<float> volumes(boneCount, 0.0f);
+
+    // get the volume each bone influences on each mesh
+    for (std::size_t i = 0; i < m_Deformers.size(); ++i)
+    {
+        const IDeformers* pDeformers = m_Deformers[i];
+
+        if (!pDeformers)
+            continue;
+
+        for (std::size_t j = 0; j < pDeformers->m_SkinWeights.size(); ++j)
+        {
+            const ISkinWeights* pSkinWeights = pDeformers->m_SkinWeights[j];
+
+            if (!pSkinWeights || !pSkinWeights->m_pBone || pSkinWeights->m_pBone->m_Index >= boneCount)
+                continue;
+
+            const BoxF& box = pSkinWeights->m_Box;
+
+            // empty box?
+            if (box.m_Max.m_X < box.m_Min.m_X || box.m_Max.m_Y < box.m_Min.m_Y || box.m_Max.m_Z < box.m_Min.m_Z)
+                continue;
+
+            volumes[pSkinWeights->m_pBone->m_Index] += (box.m_Max.m_X - box.m_Min.m_X) *
+                                                       (box.m_Max.m_Y - box.m_Min.m_Y) *
+                                                       (box.m_Max.m_Z - box.m_Min.m_Z);
+        }
+    }
+
+    // add the volume of the descendants, thus a bone is never larger than its parent and the selection always
+    // contains the descendants of the selected bones
+    for (std::size_t i = boneCount; i-- > 0;)
+        if (m_BoneTable.m_Parents[i] >= 0)
+            volumes[m_BoneTable.m_Parents[i]] += volumes[i];
+
+    for (std::size_t i = 0; i < boneCount; ++i)
+        if (m_BoneTable.m_Parents[i] >= 0 && volumes[i] < minVolume)
+            selection[i] = true;
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool Model::AddSkeletonLOD(const IBoneSelection& selection, std::size_t& lodIndex)
+{
+    const std::size_t boneCount = m_BoneTable.m_Parents.size();
+
+    // no bone table?
+    if (!boneCount)
+        return false;
+
+    std::unique_ptr<ISkeletonLOD> pLOD(new ISkeletonLOD());
+    pLOD->m_Targets.resize(boneCount);
+
+    // collapse each selected bone, and its descendants, into its nearest kept ancestor. The parents precede their
+    // children, thus the ancestor target is always known
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        const int parent = m_BoneTable.m_Parents[i];
+
+        if (parent < 0 || (!(i < selection.size() && selection[i]) && pLOD->m_Targets[parent] == std::size_t(parent)))
+        {
+            pLOD->m_Targets[i] = i;
+            pLOD->m_Bones.push_back(i);
+        }
+        else
+            pLOD->m_Targets[i] = pLOD->m_Targets[parent];
+    }
+
+    const std::size_t meshCount = m_Influences.size();
+
+    pLOD->m_Influences.resize(meshCount, nullptr);
+
+    // merge the influences of each mesh
+    for (std::size_t i = 0; i < meshCount; ++i)
+    {
+        const IVertexInfluences* pSrcInfluences = m_Influences[i];
+
+        if (!pSrcInfluences)
+            continue;
+
+        const std::size_t srcSlotCount = pSrcInfluences->m_SlotCount;
+
+        // malformed influences?
+        if (!srcSlotCount                                                            ||
+            pSrcInfluences->m_BoneIndices.size() != pSrcInfluences->m_Weights.size() ||
+            pSrcInfluences->m_Weights.size() % srcSlotCount)
+            return false;
+
+        const std::size_t vertexCount = pSrcInfluences->m_Weights.size() / srcSlotCount;
+
+        IVertexInfluences::IBoneIndices boneIndices(pSrcInfluences->m_BoneIndices.size(), 0);
+        IWeights                        weights(pSrcInfluences->m_Weights.size(), 0.0f);
+        std::size_t                     maxCount = 0;
+
+        // replace each bone by its target, the weights of a same target are added, keeping the slots sorted by
+        // decreasing weight
+        for (std::size_t j = 0; j < vertexCount; ++j)
+        {
+            const unsigned short* pSrcBoneIndices = &pSrcInfluences->m_BoneIndices[j * srcSlotCount];
+            const float*          pSrcWeights     = &pSrcInfluences->m_Weights[j * srcSlotCount];
+            unsigned short*       pBoneIndices    = &boneIndices[j * srcSlotCount];
+            float*                pWeights        = &weights[j * srcSlotCount];
+            std::size_t           count           = 0;
+
+            for (std::size_t k = 0; k < srcSlotCount && pSrcWeights[k] > 0.0f; ++k)
+            {
+                // malformed influence?
+                if (pSrcBoneIndices[k] >= boneCount)
+                    return false;
+
+                const unsigned short target = (unsigned short)pLOD->m_Targets[pSrcBoneIndices[k]];
+                std::size_t          slot   = 0;
+
+                while (slot < count && pBoneIndices[slot] != target)
+                    ++slot;
+
+                if (slot == count)
+                {
+                    pBoneIndices[slot] = target;
+                    pWeights[slot]     = 0.0f;
+                    ++count;
+                }
+
+                pWeights[slot] += pSrcWeights[k];
+
+                // move the merged influence before the weaker ones
+                while (slot && pWeights[slot - 1] < pWeights[slot])
+                {
+                    std::swap(pBoneIndices[slot], pBoneIndices[slot - 1]);
+                    std::swap(pWeights[slot],     pWeights[slot - 1]);
+                    --slot;
+                }
+            }
+
+            maxCount = std::max(maxCount, count);
+        }
+
+        std::unique_ptr<IVertexInfluences> pInfluences(new IVertexInfluences());
+        pInfluences->m_SlotCount    = std::min(maxCount <= 2 ? std::size_t(2) : (maxCount <= 4 ? 4 : 8), srcSlotCount);
+        pInfluences->m_DroppedCount = pSrcInfluences->m_DroppedCount;
+
+        const std::size_t slotCount = pInfluences->m_SlotCount;
+
+        // the merged influences need fewer slots?
+        if (slotCount == srcSlotCount)
+        {
+            pInfluences->m_BoneIndices.swap(boneIndices);
+            pInfluences->m_Weights.swap(weights);
+        }
+        else
+        {
+            pInfluences->m_BoneIndices.resize(vertexCount * slotCount);
+            pInfluences->m_Weights.resize(vertexCount * slotCount);
+
+            for (std::size_t j = 0; j < vertexCount; ++j)
+                for (std::size_t k = 0; k < slotCount; ++k)
+                {
+                    pInfluences->m_BoneIndices[j * slotCount + k] = boneIndices[j * srcSlotCount + k];
+                    pInfluences->m_Weights[j * slotCount + k]     = weights[j * srcSlotCount + k];
+                }
+        }
+
+        pLOD->m_Influences[i] = pInfluences.release();
+    }
+
+    lodIndex = m_SkeletonLODs.size();
+
+    m_SkeletonLODs.push_back(pLOD.get());
+    pLOD.release();
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool Model::GetInfluenceError(std::size_t meshIndex, const IMatrices& palette, float& maxError) const
+{
+    maxError = 0.0f;
+
+    // influences not packed?
+    if (meshIndex >= m_Influences.size() || !m_Influences[meshIndex] || meshIndex >= m_Deformers.size() ||
+        !m_Deformers[meshIndex] || !m_Mesh[meshIndex] || m_Mesh[meshIndex]->m_VB.size() != 1)
+        return false;
+
+    // palette doesn't match with the bone table?
+    if (palette.size() != m_BoneTable.m_Bones.size())
+        return false;
+
+    const IVertexInfluences* pInfluences = m_Influences[meshIndex];
+    const IDeformers*        pDeformers  = m_Deformers[meshIndex];
+    const std::size_t        slotCount   = pInfluences->m_SlotCount;
+    const std::size_t        vertexCount = m_Mesh[meshIndex]->m_VB[0]->GetVertexCount();
+    std::size_t              stride      = 0;
+    const float*             pPositions  = m_Mesh[meshIndex]->m_VB[0]->GetPositions(stride);
+
+    if (!pPositions || !stride || pInfluences->m_Weights.size() != vertexCount * slotCount)
+        return !vertexCount;
+
+    std::vector<float> expected(vertexCount * 3, 0.0f);
+
+    // skin the vertices by all the deformer influences
+    for (std::size_t i = 0; i < pDeformers->m_SkinWeights.size(); ++i)
+    {
+        const ISkinWeights* pSkinWeights = pDeformers->m_SkinWeights[i];
+
+        if (!pSkinWeights || !pSkinWeights->m_pBone || pSkinWeights->m_pBone->m_Index >= palette.size())
+            continue;
+
+        const Matrix4x4F& matrix = palette[pSkinWeights->m_pBone->m_Index];
+
+        for (std::size_t j = 0; j < pSkinWeights->m_WeightInfluences.size() && j < pSkinWeights->m_Weights.size(); ++j)
+        {
+            const float weight = pSkinWeights->m_Weights[j];
+
+            if (weight <= 0.0f)
+                continue;
+
+            const IWeightInfluence* pInfluence = pSkinWeights->m_WeightInfluences[j];
+
+            for (std::size_t k = 0; k < pInfluence->m_VertexIndex.size(); ++k)
+            {
+                const std::size_t offset = pInfluence->m_VertexIndex[k];
+                const std::size_t vertex = offset / stride;
+
+                if (vertex >= vertexCount)
+                    continue;
+
+                const Vector3F position =
+                        matrix.Transform(Vector3F(pPositions[offset], pPositions[offset + 1], pPositions[offset + 2]));
+
+                expected[vertex * 3]     += position.m_X * weight;
+                expected[vertex * 3 + 1] += position.m_Y * weight;
+                expected[vertex * 3 + 2] += position.m_Z * weight;
+            }
+        }
+    }
+
+    // skin the vertices by the packed influences, and compare
+    for (std::size_t i = 0; i < vertexCount; ++i)
+    {
+        const unsigned short* pBoneIndices = &pInfluences->m_BoneIndices[i * slotCount];
+        const float*          pWeights     = &pInfluences->m_Weights[i * slotCount];
+        const Vector3F        source(pPositions[i * stride], pPositions[i * stride + 1], pPositions[i * stride + 2]);
+        Vector3F              position(0.0f, 0.0f, 0.0f);
+
+        for (std::size_t j = 0; j < slotCount && pWeights[j] > 0.0f; ++j)
+            position = position + palette[pBoneIndices[j]].Transform(source) * pWeights[j];
+
+        maxError = std::max(maxError, (position - Vector3F(expected[i * 3], expected[i * 3 + 1], expected[i * 3 + 2])).Length());
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool Model::CalculateSkinnedBounds(std::size_t      meshIndex,
+                                   const IMatrices& palette,
+                                         BoxF&      box,
+                                         SphereF&   sphere) const
+{
+    // no deformer for this mesh?
+    if (meshIndex >= m_Deformers.size() || !m_Deformers[meshIndex])
+        return false;
+
+    const IDeformers::ISkinWeightsData& skinWeights = m_Deformers[meshIndex]->m_SkinWeights;
+
+    // palette doesn't match with the bone table?
+    if (palette.size() != m_BoneTable.m_Bones.size())
+        return false;
+
+    box.Clear();
+
+    // each skinned vertex is a weighted average of its bone transformed positions, so it remains inside the
+    // union of the transformed bone boxes
+    for (std::size_t i = 0; i < skinWeights.size(); ++i)
+        if (skinWeights[i] && skinWeights[i]->m_pBone && skinWeights[i]->m_pBone->m_Index < palette.size())
+            box.Merge(skinWeights[i]->m_Box.Transform(palette[skinWeights[i]->m_pBone->m_Index]));
+
+    sphere = SphereF();
+
+    if (!box.IsEmpty())
+    {
+        sphere.m_Center = box.GetCenter();
+        sphere.m_Radius = box.GetRadius();
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
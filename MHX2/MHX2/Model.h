@@ -32,8 +32,12 @@
 #include "Color.h"
 #include "Vector3.h"
 #include "Matrix4x4.h"
+#include "Box.h"
+#include "Sphere.h"
 #include "Vertex.h"
 
+class CompressedAnimation;
+
 /**
 * Model
 *@author Jean-Milost Reymond
@@ -53,6 +57,11 @@ class Model
             IE_KT_MatrixKeys =  4
         };
 
+        /**
+        * Matrix list
+        */
+        typedef std::vector<Matrix4x4F> IMatrices;
+
         /**
         * Bone, it's a hierarchical local transformation to apply to a mesh
         */
@@ -64,12 +73,33 @@ class Model
             Matrix4x4F  m_Matrix;   // matrix containing the bone transformation to apply
             IBone*      m_pParent;  // bone parent, root bone if nullptr
             IBones      m_Children; // bone children
+            std::size_t m_Index;    // bone index in the model bone table
             void*       m_pCustom;  // custom data, depends on implementation
 
             IBone();
             virtual ~IBone();
         };
 
+        /**
+        * Bone table, it's the flat form of the skeleton. The bones are sorted parents first, thus a pose may be
+        * calculated in a single forward pass. All the tables are sorted in the same order
+        */
+        struct IBoneTable
+        {
+            typedef std::vector<int>         IParents;
+            typedef std::vector<std::string> INames;
+
+            IBone::IBones m_Bones;       // skeleton bones, the tree remains a view of the table. Not owned
+            IParents      m_Parents;     // parent bone index, always lower than the bone index, -1 for the root bone
+            INames        m_Names;       // bone names
+            IMatrices     m_Local;       // bind pose local matrices, relative to the parent bone
+            IMatrices     m_Global;      // bind pose global matrices, relative to the model
+            IMatrices     m_InverseBind; // inverse bind matrices, identity if the bone deforms no mesh
+
+            IBoneTable();
+            virtual ~IBoneTable();
+        };
+
         /**
         * Weights
         */
@@ -83,7 +113,7 @@ class Model
             typedef std::vector<std::size_t> IVertexIndex;
 
             std::size_t  m_Index;       // index in the indexed vertex buffer
-            IVertexIndex m_VertexIndex; // index in the vertex buffer
+            IVertexIndex m_VertexIndex; // offset of the vertex in the vertex buffer position data
 
             IWeightInfluence();
             virtual ~IWeightInfluence();
@@ -106,6 +136,7 @@ class Model
             Matrix4x4F        m_TransformLinkMatrix; // transform link matrix (used in FBX files)
             IWeightInfluences m_WeightInfluences;    // table allowing to retrieve the vertices influenced by a weight
             IWeights          m_Weights;             // weights indicating the bone influence on vertices, between 0.0f and 1.0f
+            BoxF              m_Box;                 // bind pose bounds of the influenced vertices, in the model space
 
             ISkinWeights();
             virtual ~ISkinWeights();
@@ -124,16 +155,119 @@ class Model
             virtual ~IDeformers();
         };
 
+        /**
+        * Mesh bounds
+        */
+        struct IBounds
+        {
+            BoxF    m_Box;    // bounding box
+            SphereF m_Sphere; // bounding sphere
+
+            IBounds();
+            virtual ~IBounds();
+        };
+
+        /**
+        * Packed vertex influences, it's a fixed count of (bone, weight) slots per vertex, sorted in the same order as
+        * the vertex buffer vertices. The slots of a vertex are sorted by decreasing weight, the unused ones have a
+        * 0.0f weight
+        */
+        struct IVertexInfluences
+        {
+            typedef std::vector<unsigned short> IBoneIndices;
+
+            std::size_t  m_SlotCount;    // slot count per vertex, either 2, 4 or 8
+            IBoneIndices m_BoneIndices;  // index of the slot bone in the model bone table
+            IWeights     m_Weights;      // slot weight
+            std::size_t  m_DroppedCount; // influences dropped while packed
+
+            IVertexInfluences();
+            virtual ~IVertexInfluences();
+        };
+
+        /**
+        * Bone selection, it's a flag per bone, in the same order as the bone table
+        */
+        typedef std::vector<bool> IBoneSelection;
+
+        /**
+        * Skeleton level of detail, the minor bones are collapsed into their nearest kept ancestor, which takes over
+        * their skin weights. A collapsed bone keeps its bind pose relative to its ancestor, thus its palette matrix
+        * is the ancestor one
+        */
+        struct ISkeletonLOD
+        {
+            typedef std::vector<std::size_t>        IIndices;
+            typedef std::vector<IVertexInfluences*> IInfluences;
+
+            IIndices    m_Bones;      // kept bones, in the bone table order
+            IIndices    m_Targets;    // bone each bone is collapsed into, itself if kept, in the bone table order
+            IInfluences m_Influences; // packed vertex influences referencing only the kept bones, sorted in the same order as the meshes
+
+            ISkeletonLOD();
+            virtual ~ISkeletonLOD();
+        };
+
+        /**
+        * Meshlet bone, it's the bounding sphere of the meshlet vertices influenced by a bone, expressed in the model space
+        */
+        struct IMeshletBone
+        {
+            std::size_t m_BoneIndex; // bone index in the model bone table
+            SphereF     m_Sphere;    // bind pose bounding sphere of the influenced vertices, in the model space
+
+            IMeshletBone();
+            virtual ~IMeshletBone();
+        };
+
+        /**
+        * Meshlet bones
+        */
+        typedef std::vector<IMeshletBone> IMeshletBones;
+
+        /**
+        * Meshlet, it's a small cluster of consecutive triangles belonging to a mesh vertex buffer
+        */
+        struct IMeshlet
+        {
+            std::size_t   m_Start;       // first vertex of the cluster in the vertex buffer (in vertices, not in floats)
+            std::size_t   m_Count;       // cluster vertex count, always a multiple of 3
+            std::size_t   m_SourceCount; // unique source vertex count referenced by the cluster
+            SphereF       m_Sphere;      // bind pose bounding sphere
+            Vector3F      m_ConeApex;    // normal cone apex
+            Vector3F      m_ConeAxis;    // normal cone axis
+            float         m_ConeCutoff;  // normal cone cutoff (sinus of the cone spread angle), 1.0f if the cone is unusable
+            IMeshletBones m_Bones;       // bones influencing the cluster vertices
+
+            IMeshlet();
+            virtual ~IMeshlet();
+        };
+
+        /**
+        * Mesh meshlets, it's the list of clusters a mesh vertex buffer is divided into
+        */
+        struct IMeshlets
+        {
+            typedef std::vector<IMeshlet*> IMeshletData;
+
+            IMeshletData m_Meshlets;
+
+            IMeshlets();
+            virtual ~IMeshlets();
+        };
+
         /**
         * Animation key, may be a rotation, a translation, a scale, a matrix, ...
+        *@note The rotation values are a quaternion in x, y, z, w order, the scale and position values are x, y, z,
+        *      and the matrix values are its 4 rows
         */
         struct IAnimationKey
         {
             typedef std::vector<float> IValues;
 
-            std::size_t m_Frame;
-            long long   m_TimeStamp;
-            IValues     m_Values;
+            std::size_t m_Frame;     // key frame index
+            long long   m_TimeStamp; // key time, in AnimationSampler::m_TicksPerSecond units
+            IValues     m_Values;    // key values, depend on the key type
 
             IAnimationKey();
             virtual ~IAnimationKey();
@@ -175,19 +309,29 @@ class Model
         {
             typedef std::vector<IAnimation*> IAnimations;
 
-            IAnimations m_Animations; // animations belonging to this set
-            long long   m_MaxValue;   // maximum value the animation may reach before looping or stopping
+            IAnimations          m_Animations;  // animations belonging to this set
+            long long            m_MaxValue;    // maximum value the animation may reach before looping or stopping
+            CompressedAnimation* m_pCompressed; // compressed animations, sampled instead of the keys if not nullptr
 
             IAnimationSet();
             virtual ~IAnimationSet();
         };
 
-        std::vector<Mesh*>          m_Mesh;         // meshes composing the model
-        std::vector<IDeformers*>    m_Deformers;    // mesh deformers, sorted in the same order as the meshes
-        std::vector<IAnimationSet*> m_AnimationSet; // set of animations to apply to bones
-        IBone*                      m_pSkeleton;    // model skeleton
-        bool                        m_MeshOnly;     // if activated, only the mesh will be drawn. All other data will be ignored
-        bool                        m_PoseOnly;     // if activated, the model will take the default pose but will not be animated
+        std::vector<Mesh*>              m_Mesh;          // meshes composing the model
+        std::vector<IDeformers*>        m_Deformers;     // mesh deformers, sorted in the same order as the meshes
+        std::vector<IMeshlets*>         m_Meshlets;      // mesh clusters, sorted in the same order as the meshes. May be empty
+        std::vector<IBounds*>           m_Bounds;        // mesh bind pose bounds, sorted in the same order as the meshes
+        std::vector<IVertexInfluences*> m_Influences;    // packed vertex influences, sorted in the same order as the meshes
+        std::vector<IAnimationSet*>     m_AnimationSet;  // set of animations to apply to bones
+        IBoneTable                      m_BoneTable;     // flat skeleton, indexes the matrix palettes and the vertex influences
+        std::vector<ISkeletonLOD*>      m_SkeletonLODs;  // skeleton levels of detail, the instances use the full skeleton if none is selected
+        IBone*                          m_pSkeleton;     // model skeleton
+        std::size_t                     m_MaxInfluences; // max influences kept per vertex when packed, either 2, 4 or 8
+        std::size_t                     m_Revision;      // bind pose revision, incremented each time the bind pose vertices change
+        float                           m_MinWeight;     // influences weaker than it are dropped when packed, except the strongest one
+        bool                            m_MeshOnly;      // if activated, only the mesh will be drawn. All other data will be ignored
+        bool                            m_PoseOnly;      // if activated, the model will take the default pose but will not be animated
+        bool                            m_DQSkinning;    // if activated, the meshes are skinned by dual quaternions instead of blended matrices
 
         Model();
         virtual ~Model();
@@ -207,4 +351,146 @@ class Model
         *@param[out] matrix - animation matrix
         */
         virtual void GetBoneMatrix(const IBone* pBone, const Matrix4x4F& initialMatrix, Matrix4x4F& matrix) const;
+
+        /**
+        * Gets the bone animation matrix, by walking the bone parents
+        *@param pBone - bone for which the matrix should be calculated
+        *@param pAnimSet - animation set to sample, if nullptr the bind pose is used
+        *@param elapsedTime - elapsed time in seconds, loops on the animation set duration
+        *@param initialMatrix - the initial matrix
+        *@param[out] matrix - animation matrix
+        *@note This function is convenient to get a single bone, the AnimationSampler class should be used to get
+        *      the whole pose
+        */
+        virtual void GetBoneAnimMatrix(const IBone*         pBone,
+                                       const IAnimationSet* pAnimSet,
+                                             double         elapsedTime,
+                                       const Matrix4x4F&    initialMatrix,
+                                             Matrix4x4F&    matrix) const;
+
+        /**
+        * Compresses an animation set
+        *@param index - animation set index
+        *@param maxError - maximum error allowed, in model units
+        *@param frameRate - frame rate at which the animation set is resampled, in frames per second
+        *@return true on success, otherwise false
+        *@note On success the animation keys are deleted, and the animation set is sampled from its compressed form.
+        *      The bone table should be built before this function is called
+        */
+        virtual bool CompressAnimationSet(std::size_t index, float maxError, double frameRate = 30.0);
+
+        /**
+        * Builds the bind pose bounds of a mesh, and the bounds of the bones deforming it
+        *@param meshIndex - mesh index
+        *@return true on success, otherwise false
+        *@note The mesh vertex buffer should contain the bind pose when this function is called
+        */
+        virtual bool BuildBounds(std::size_t meshIndex);
+
+        /**
+        * Finds a bone in the bone table
+        *@param name - bone name to find
+        *@return the bone index, -1 if not found
+        */
+        virtual int FindBoneIndex(const std::string& name) const;
+
+        /**
+        * Calculates a global pose from a local pose, in a single pass over the bone table
+        *@param localPose - local bone matrices, in the same order as the bone table
+        *@param[out] globalPose - global bone matrices, in the same order as the bone table
+        *@return true on success, otherwise false
+        */
+        virtual bool GetGlobalPose(const IMatrices& localPose, IMatrices& globalPose) const;
+
+        /**
+        * Builds the bone table, i.e. the flat form of the skeleton
+        *@param globalMatrices - if true, the bone matrices are relative to the model, as in mhx2 files, otherwise
+        *                        they are relative to their parent
+        *@return true on success, otherwise false
+        *@note The inverse bind matrix of a bone is read from the skin weights linked to it, and is the identity if
+        *      the bone deforms no mesh. The function fails if several skin weights link the same bone with different
+        *      matrices, or if the skeleton contains more than 0xFFFF bones
+        */
+        virtual bool BuildBoneTable(bool globalMatrices = false);
+
+        /**
+        * Builds the packed vertex influences of a mesh from its deformers
+        *@param meshIndex - mesh index
+        *@return true on success, otherwise false
+        *@note 4 slots are used if no vertex is influenced by more bones, otherwise 8. If a vertex is influenced by
+        *      more than 8 bones, only the 8 strongest are kept and their weights are renormalized. If m_MaxInfluences
+        *      is lower than 8 or m_MinWeight is set, the influences are pruned, the slot count is the lowest of 2, 4
+        *      or 8 fitting the kept influences, and the weights of each vertex are renormalized to 1. The bone table
+        *      should be built before this function is called. As the weights are renormalized, the pruning causes no
+        *      error on the bind pose, use GetInfluenceError() to measure it on an animated pose
+        */
+        virtual bool BuildInfluences(std::size_t meshIndex);
+
+        /**
+        * Selects bones by name, with all their descendants
+        *@param names - names of the bones to select, the unknown names are ignored
+        *@param[in, out] selection - bone selection to add to, resized to the bone table size if required
+        *@return true on success, otherwise false
+        *@note The bone table should be built before this function is called
+        */
+        virtual bool SelectBonesByName(const IBoneTable::INames& names, IBoneSelection& selection) const;
+
+        /**
+        * Selects the bones deeper than a depth in the skeleton
+        *@param maxDepth - max depth of the unselected bones, the root bones are at depth 0
+        *@param[in, out] selection - bone selection to add to, resized to the bone table size if required
+        *@return true on success, otherwise false
+        *@note The bone table should be built before this function is called
+        */
+        virtual bool SelectBonesByDepth(std::size_t maxDepth, IBoneSelection& selection) const;
+
+        /**
+        * Selects the bones whose influence volume, added to the one of their descendants, is lower than a volume
+        *@param minVolume - min influence volume of the unselected bones, in model units
+        *@param[in, out] selection - bone selection to add to, resized to the bone table size if required
+        *@return true on success, otherwise false
+        *@note The influence volume of a bone is the volume of the bind pose bounding box of the vertices it
+        *      influences, added on each mesh. The bounds should be built before this function is called, the root
+        *      bones are never selected
+        */
+        virtual bool SelectBonesByVolume(float minVolume, IBoneSelection& selection) const;
+
+        /**
+        * Adds a skeleton level of detail
+        *@param selection - bones to collapse into their nearest unselected ancestor, their descendants are also
+        *                   collapsed. The root bones are always kept
+        *@param[out] lodIndex - index of the new level of detail in m_SkeletonLODs
+        *@return true on success, otherwise false
+        *@note The skin weights of the collapsed bones are merged into their ancestor ones, thus the vertices may
+        *      need fewer slots. The influences should be packed before this function is called, and the levels of
+        *      detail should be added again if they are packed again
+        */
+        virtual bool AddSkeletonLOD(const IBoneSelection& selection, std::size_t& lodIndex);
+
+        /**
+        * Gets the max vertex position error the packed influences of a mesh cause on a pose, compared to its deformers
+        *@param meshIndex - mesh index
+        *@param palette - pose matrix palette, i.e. the inverse bind matrix multiplied by the pose matrix of each bone,
+        *                 in the same order as the bone table
+        *@param[out] maxError - max vertex position error, in model units
+        *@return true on success, otherwise false
+        *@note The influences should be packed before this function is called
+        */
+        virtual bool GetInfluenceError(std::size_t meshIndex, const IMatrices& palette, float& maxError) const;
+
+        /**
+        * Calculates the bounds of a skinned mesh
+        *@param meshIndex - mesh index
+        *@param palette - pose matrix palette, i.e. the inverse bind matrix multiplied by the pose matrix of each bone,
+        *                 in the same order as the bone table
+        *@param[out] box - skinned bounding box
+        *@param[out] sphere - skinned bounding sphere
+        *@return true on success, otherwise false
+        *@note The bounds are calculated by transforming the bind pose bone bounds, thus no vertex is read. The
+        *      result is conservative as long as the vertex weights sum to 1
+        */
+        virtual bool CalculateSkinnedBounds(std::size_t      meshIndex,
+                                            const IMatrices& palette,
+                                                  BoxF&      box,
+                                                  SphereF&   sphere) const;
 };
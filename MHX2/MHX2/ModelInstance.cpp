@@ -0,0 +1,760 @@
+/****************************************************************************
+ * ==> ModelInstance -------------------------------------------------------*
+ ****************************************************************************
+ * Description : Lightweight model instance, owns only its pose and output  *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "ModelInstance.h"
+
+// std
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+//---------------------------------------------------------------------------
+// ModelInstance::IChunk
+//---------------------------------------------------------------------------
+ModelInstance::IChunk::IChunk() :
+    m_MeshIndex(0)
+{}
+//---------------------------------------------------------------------------
+ModelInstance::IChunk::~IChunk()
+{}
+//---------------------------------------------------------------------------
+// ModelInstance
+//---------------------------------------------------------------------------
+ModelInstance::ModelInstance(const std::shared_ptr<const Model>& pModel) :
+    m_AnimSetIndex(0),
+    m_ElapsedTime(0.0),
+    m_pModel(pModel),
+    m_pPoseCache(nullptr),
+    m_PendingChunks(0),
+    m_CacheHits(0),
+    m_CacheMisses(0),
+    m_PoseTime(0.0),
+    m_PoseRevision(0),
+    m_PoseSetIndex(-1),
+    m_SkeletonLOD(-1),
+    m_Culling(false),
+    m_PoseValid(false)
+{
+    // no model?
+    if (!m_pModel)
+        return;
+
+    const bool        skinned   = (m_pModel->m_pSkeleton != nullptr);
+    const std::size_t meshCount = m_pModel->m_Mesh.size();
+
+    // create the output meshes
+    for (std::size_t i = 0; i < meshCount; ++i)
+    {
+        std::unique_ptr<Mesh> pMesh(new Mesh());
+
+        const Mesh* pSrcMesh = m_pModel->m_Mesh[i];
+
+        if (pSrcMesh)
+            for (std::size_t j = 0; j < pSrcMesh->m_VB.size(); ++j)
+            {
+                const VertexBuffer* pSrcVB = pSrcMesh->m_VB[j];
+
+                // the output buffer only contains the format, everything else is read from its source
+                std::unique_ptr<VertexBuffer> pVB(pSrcVB->Clone(false));
+                pVB->m_pSource = pSrcVB;
+
+                // only the positions and normals of the skinned buffers are modified by the instance. In an
+                // interleaved buffer they cannot be separated from the other vertex data, which should thus be copied
+                if (skinned)
+                {
+                    if (pSrcVB->m_Format.m_Storage == VertexFormat::IEStorage::IE_VS_Planar)
+                    {
+                        pVB->m_Streams.m_Positions = pSrcVB->m_Streams.m_Positions;
+                        pVB->m_Streams.m_Normals   = pSrcVB->m_Streams.m_Normals;
+                    }
+                    else
+                        pVB->m_Data = pSrcVB->m_Data;
+                }
+
+                pMesh->m_VB.push_back(pVB.get());
+                pVB.release();
+            }
+
+        m_Mesh.push_back(pMesh.get());
+        pMesh.release();
+
+        std::unique_ptr<Model::IBounds> pBounds(new Model::IBounds());
+
+        // start from the bind pose bounds
+        if (i < m_pModel->m_Bounds.size() && m_pModel->m_Bounds[i])
+        {
+            pBounds->m_Box    = m_pModel->m_Bounds[i]->m_Box;
+            pBounds->m_Sphere = m_pModel->m_Bounds[i]->m_Sphere;
+        }
+
+        m_Bounds.push_back(pBounds.get());
+        pBounds.release();
+    }
+}
+//---------------------------------------------------------------------------
+ModelInstance::~ModelInstance()
+{
+    for (std::size_t i = 0; i < m_Mesh.size(); ++i)
+        delete m_Mesh[i];
+
+    for (std::size_t i = 0; i < m_Bounds.size(); ++i)
+        delete m_Bounds[i];
+}
+//---------------------------------------------------------------------------
+const Model* ModelInstance::GetModel() const
+{
+    return m_pModel.get();
+}
+//---------------------------------------------------------------------------
+const std::shared_ptr<const Model>& ModelInstance::GetSharedModel() const
+{
+    return m_pModel;
+}
+//---------------------------------------------------------------------------
+bool ModelInstance::Update(int animSetIndex, double elapsedTime)
+{
+    int    poseSetIndex;
+    double poseTime;
+    GetPoseKey(animSetIndex, elapsedTime, poseSetIndex, poseTime);
+
+    // the pose didn't change? Keep the skinned meshes
+    if (IsPoseCached(poseSetIndex, poseTime))
+    {
+        ++m_CacheHits;
+        return true;
+    }
+
+    ++m_CacheMisses;
+
+    if (!Prepare(animSetIndex, elapsedTime))
+        return false;
+
+    const std::size_t chunkCount = m_Chunks.size();
+
+    // skin the chunks on the calling thread
+    for (std::size_t i = 0; i < chunkCount; ++i)
+        if (!SkinChunk(i))
+            return false;
+
+    m_PoseSetIndex = poseSetIndex;
+    m_PoseTime     = poseTime;
+    m_PoseRevision = m_pModel->m_Revision;
+    m_PoseValid    = true;
+    return true;
+}
+//---------------------------------------------------------------------------
+bool ModelInstance::Update(int animSetIndex, double elapsedTime, ThreadPool& pool, ThreadPool::ITaskGroup& group)
+{
+    int    poseSetIndex;
+    double poseTime;
+    GetPoseKey(animSetIndex, elapsedTime, poseSetIndex, poseTime);
+
+    // the pose didn't change? Keep the skinned meshes
+    if (IsPoseCached(poseSetIndex, poseTime))
+    {
+        ++m_CacheHits;
+        return true;
+    }
+
+    ++m_CacheMisses;
+
+    if (!Prepare(animSetIndex, elapsedTime))
+        return false;
+
+    // skin the chunks in the pool
+    pool.Run(OnSkinChunk, this, m_Chunks.size(), group);
+
+    m_PoseSetIndex = poseSetIndex;
+    m_PoseTime     = poseTime;
+    m_PoseRevision = m_pModel->m_Revision;
+    m_PoseValid    = true;
+    return true;
+}
+//---------------------------------------------------------------------------
+bool ModelInstance::Update(const Model::IMatrices& localPose)
+{
+    // no model, or pose not matching the bone table?
+    if (!m_pModel || localPose.size() != m_pModel->m_BoneTable.m_Local.size())
+        return false;
+
+    ++m_CacheMisses;
+
+    if (!Prepare(-1, 0.0, &localPose))
+        return false;
+
+    const std::size_t chunkCount = m_Chunks.size();
+
+    // skin the chunks on the calling thread
+    for (std::size_t i = 0; i < chunkCount; ++i)
+        if (!SkinChunk(i))
+            return false;
+
+    // the pose remains invalid, because the skinned meshes match no animation set pose
+    return true;
+}
+//---------------------------------------------------------------------------
+bool ModelInstance::Update(const Model::IMatrices& localPose, ThreadPool& pool, ThreadPool::ITaskGroup& group)
+{
+    // no model, or pose not matching the bone table?
+    if (!m_pModel || localPose.size() != m_pModel->m_BoneTable.m_Local.size())
+        return false;
+
+    ++m_CacheMisses;
+
+    if (!Prepare(-1, 0.0, &localPose))
+        return false;
+
+    // skin the chunks in the pool
+    pool.Run(OnSkinChunk, this, m_Chunks.size(), group);
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool ModelInstance::UpdatePalette(const Model::IMatrices& palette)
+{
+    // no model, or palette not matching the bone table?
+    if (!m_pModel || palette.size() != m_pModel->m_BoneTable.m_Local.size())
+        return false;
+
+    ++m_CacheMisses;
+
+    if (!Prepare(-1, 0.0, nullptr, &palette))
+        return false;
+
+    const std::size_t chunkCount = m_Chunks.size();
+
+    // skin the chunks on the calling thread
+    for (std::size_t i = 0; i < chunkCount; ++i)
+        if (!SkinChunk(i))
+            return false;
+
+    // the pose remains invalid, because the skinned meshes match no animation set pose
+    return true;
+}
+//---------------------------------------------------------------------------
+void ModelInstance::SetPoseCache(PoseCache* pPoseCache)
+{
+    m_pPoseCache = pPoseCache;
+
+    // the cached poses may be quantized, thus differ from the previous one
+    m_PoseValid = false;
+}
+//---------------------------------------------------------------------------
+void ModelInstance::Invalidate()
+{
+    m_PoseValid = false;
+}
+//---------------------------------------------------------------------------
+std::size_t ModelInstance::GetCacheHits() const
+{
+    return m_CacheHits;
+}
+//---------------------------------------------------------------------------
+std::size_t ModelInstance::GetCacheMisses() const
+{
+    return m_CacheMisses;
+}
+//---------------------------------------------------------------------------
+bool ModelInstance::SetSkeletonLOD(int lodIndex)
+{
+    // invalid level of detail?
+    if (lodIndex < -1 || !m_pModel || (lodIndex >= 0 && std::size_t(lodIndex) >= m_pModel->m_SkeletonLODs.size()))
+        return false;
+
+    // the meshes are skinned by other influences, thus they should be skinned again even if the pose didn't change
+    if (lodIndex != m_SkeletonLOD)
+        m_PoseValid = false;
+
+    m_SkeletonLOD = lodIndex;
+
+    return true;
+}
+//---------------------------------------------------------------------------
+int ModelInstance::GetSkeletonLOD() const
+{
+    return m_SkeletonLOD;
+}
+//---------------------------------------------------------------------------
+void ModelInstance::EnableCulling(const Vector3F& viewPos, const Matrix4x4F& modelViewProj)
+{
+    // the culled clusters weren't skinned, thus the meshes should be skinned again if the viewer changed
+    if (!m_Culling || viewPos != m_ViewPos || !m_ModelViewProj.IsEqual(modelViewProj))
+        m_PoseValid = false;
+
+    m_ViewPos       = viewPos;
+    m_ModelViewProj = modelViewProj;
+    m_Culling       = true;
+}
+//---------------------------------------------------------------------------
+void ModelInstance::DisableCulling()
+{
+    // the culled clusters should be skinned
+    if (m_Culling)
+        m_PoseValid = false;
+
+    m_Culling = false;
+}
+//---------------------------------------------------------------------------
+bool ModelInstance::Prepare(int                     animSetIndex,
+                            double                  elapsedTime,
+                            const Model::IMatrices* pLocalPose,
+                            const Model::IMatrices* pPalette)
+{
+    // no model?
+    if (!m_pModel)
+        return false;
+
+    m_AnimSetIndex = animSetIndex;
+    m_ElapsedTime  = elapsedTime;
+    m_PoseValid    = false;
+
+    // the chunks are rebuilt on each update, the memory is kept
+    m_Chunks.clear();
+
+    // if mesh has no skeleton, the output meshes are drawn from the model data
+    if (!m_pModel->m_pSkeleton)
+        return true;
+
+    // malformed deformers?
+    if (m_pModel->m_Mesh.size() != m_pModel->m_Deformers.size())
+        return false;
+
+    // build the matrix palette once, all the meshes index it
+    BuildPalette(animSetIndex, elapsedTime, pLocalPose, pPalette);
+
+    const std::size_t meshCount = m_Mesh.size();
+
+    // iterate through model meshes
+    for (std::size_t i = 0; i < meshCount; ++i)
+        if (!PrepareMesh(i))
+            return false;
+
+    m_PendingChunks = m_Chunks.size();
+
+    return true;
+}
+//---------------------------------------------------------------------------
+void ModelInstance::BuildPalette(int                     animSetIndex,
+                                 double                  elapsedTime,
+                                 const Model::IMatrices* pLocalPose,
+                                 const Model::IMatrices* pPalette)
+{
+    const Model::IBoneTable&   boneTable = m_pModel->m_BoneTable;
+    const Model::ISkeletonLOD* pLOD      = GetLOD();
+
+    // palette provided? Only the palette the skinning method requires is built from it
+    if (pPalette && pPalette->size() == boneTable.m_Local.size())
+    {
+        m_Palette = *pPalette;
+
+        // the collapsed bones follow their target
+        if (pLOD)
+            for (std::size_t i = 0; i < m_Palette.size(); ++i)
+                if (pLOD->m_Targets[i] != i)
+                    m_Palette[i] = m_Palette[pLOD->m_Targets[i]];
+
+        if (m_pModel->m_DQSkinning)
+            SkinningHelper::BuildDQPalette(m_Palette, m_SkinPalette);
+        else
+            SkinningHelper::BuildPalette(m_Palette, m_SkinPalette);
+
+        return;
+    }
+
+    // get the global pose
+    if (pLocalPose && pLocalPose->size() == boneTable.m_Local.size())
+    {
+        m_LocalPose = *pLocalPose;
+        m_pModel->GetGlobalPose(m_LocalPose, m_GlobalPose);
+    }
+    else
+    if (m_pPoseCache && !m_pModel->m_PoseOnly)
+    {
+        // get the pose shared by the other instances, if cached it's copied as is, with its palettes
+        const PoseCache::IPose* pPose = m_pPoseCache->GetPose(*m_pModel, animSetIndex, elapsedTime);
+
+        if (pPose)
+        {
+            m_LocalPose   = pPose->m_LocalPose;
+            m_GlobalPose  = pPose->m_GlobalPose;
+            m_Palette     = pPose->m_Palette;
+            m_SkinPalette = pPose->m_SkinPalette;
+
+            // the cached pose is sampled on the full skeleton, the collapsed bones should follow their target to
+            // keep the pose bounds conservative. The skinning palette entries of the collapsed bones aren't used
+            if (pLOD)
+                for (std::size_t i = 0; i < m_Palette.size(); ++i)
+                    if (pLOD->m_Targets[i] != i)
+                        m_Palette[i] = m_Palette[pLOD->m_Targets[i]];
+
+            return;
+        }
+
+        // no valid animation set, use the bind pose
+        m_LocalPose = boneTable.m_Local;
+        m_pModel->GetGlobalPose(m_LocalPose, m_GlobalPose);
+    }
+    else
+    if (m_pModel->m_PoseOnly)
+        // in mhx2 files, the bones matrix are pre-calculated, so the bind pose may be used as is
+        m_GlobalPose = boneTable.m_Global;
+    else
+    {
+        // sample the animation set, the bind pose is used if the model has no animation
+        if (!m_Sampler.Sample(*m_pModel, animSetIndex, elapsedTime, m_LocalPose, pLOD))
+            m_LocalPose = boneTable.m_Local;
+
+        m_pModel->GetGlobalPose(m_LocalPose, m_GlobalPose);
+    }
+
+    const std::size_t boneCount = m_GlobalPose.size();
+
+    m_Palette.resize(boneCount);
+
+    // calculate the palette in a single pass over the bone table. A collapsed bone keeps its bind pose relative to
+    // its target, thus its palette matrix is the target one, which precedes it
+    if (pLOD)
+        for (std::size_t i = 0; i < boneCount; ++i)
+            if (pLOD->m_Targets[i] == i)
+                m_Palette[i] = boneTable.m_InverseBind[i].Multiply(m_GlobalPose[i]);
+            else
+                m_Palette[i] = m_Palette[pLOD->m_Targets[i]];
+    else
+        for (std::size_t i = 0; i < boneCount; ++i)
+            m_Palette[i] = boneTable.m_InverseBind[i].Multiply(m_GlobalPose[i]);
+
+    // build the palette the skinning method requires
+    if (m_pModel->m_DQSkinning)
+        SkinningHelper::BuildDQPalette(m_Palette, m_SkinPalette);
+    else
+        SkinningHelper::BuildPalette(m_Palette, m_SkinPalette);
+}
+//---------------------------------------------------------------------------
+bool ModelInstance::PrepareMesh(std::size_t index)
+{
+    // get model mesh
+    const Mesh* pSrcMesh = m_pModel->m_Mesh[index];
+    Mesh*       pMesh    = m_Mesh[index];
+
+    // found it?
+    if (!pSrcMesh || !pMesh)
+        return true;
+
+    // normally each mesh should contain only one vertex buffer
+    if (pSrcMesh->m_VB.size() != 1 || pMesh->m_VB.size() != 1)
+        // unsupported if not (because cannot know which texture should be binded. If a such model
+        // exists, a custom version of this function should also be written for it)
+        return true;
+
+    const Model::IDeformers* pDeformers  = m_pModel->m_Deformers[index];
+    const std::size_t        weightCount = pDeformers->m_SkinWeights.size();
+
+    // mesh contains skin weights?
+    if (!weightCount)
+        return false;
+
+    const Model::ISkeletonLOD*                    pLOD       = GetLOD();
+    const std::vector<Model::IVertexInfluences*>& influences = pLOD ? pLOD->m_Influences : m_pModel->m_Influences;
+
+    // mesh influences aren't packed?
+    if (index >= influences.size() || !influences[index])
+        return false;
+
+    const Model::IVertexInfluences* pInfluences = influences[index];
+
+    // get the bind pose and output vertex positions. If the vertex storage is planar, the positions are tightly packed
+    const std::size_t positionCount = pMesh->m_VB[0]->GetVertexCount();
+    const std::size_t slotCount     = pInfluences->m_SlotCount;
+    std::size_t       srcStride     = 0;
+    std::size_t       stride        = 0;
+    const float*      pSrcPositions = pSrcMesh->m_VB[0]->GetPositions(srcStride);
+    float*            pPositions    = pMesh->m_VB[0]->GetPositions(stride);
+
+    // the instance and its model should share the same layout
+    if (!pSrcPositions || !pPositions || srcStride != stride)
+        return false;
+
+    // get the bind pose and output normals, if any
+    std::size_t  srcNormalStride = 0;
+    std::size_t  normalStride    = 0;
+    const float* pSrcNormals     = pSrcMesh->m_VB[0]->GetNormals(srcNormalStride);
+    float*       pNormals        = pMesh->m_VB[0]->GetNormals(normalStride);
+
+    if ((pSrcNormals != nullptr) != (pNormals != nullptr) || srcNormalStride != normalStride)
+        return false;
+
+    // the influences should follow the vertices
+    if (positionCount                     != pSrcMesh->m_VB[0]->GetVertexCount() ||
+        pInfluences->m_Weights.size()     != positionCount * slotCount           ||
+        pInfluences->m_BoneIndices.size() != positionCount * slotCount)
+        return false;
+
+    // no matrix palette?
+    if (m_SkinPalette.empty())
+        return false;
+
+    const SkinningHelper::IEMethod method = m_pModel->m_DQSkinning ? SkinningHelper::IEMethod::IE_M_DualQuaternion :
+                                                                     SkinningHelper::IEMethod::IE_M_Linear;
+
+    // cull the clusters, only the visible ones are skinned and drawn
+    VertexBuffer::ISpans& spans = pMesh->m_VB[0]->m_Visible;
+    CullMeshlets(index, spans);
+
+    const std::size_t spanCount = spans.empty() ? 1 : spans.size();
+
+    // split the skinning into chunks. Each vertex is skinned in a single linear pass, the transformations influencing
+    // it are blended first, then its position and normal are transformed once by the result
+    for (std::size_t i = 0; i < spanCount; ++i)
+    {
+        const std::size_t first = spans.empty() ? 0             : spans[i].m_Start;
+        const std::size_t end   = spans.empty() ? positionCount : std::min(spans[i].m_Start + spans[i].m_Count, positionCount);
+
+        for (std::size_t start = first; start < end; start += m_ChunkSize)
+        {
+            IChunk chunk;
+            chunk.m_MeshIndex = index;
+
+            SkinningHelper::ISkinData& data = chunk.m_Data;
+            data.m_Method       = method;
+            data.m_pPalette     = &m_SkinPalette[0];
+            data.m_pBoneIndices = &pInfluences->m_BoneIndices[start * slotCount];
+            data.m_pWeights     = &pInfluences->m_Weights[start * slotCount];
+            data.m_pSrc         = &pSrcPositions[start * stride];
+            data.m_pDst         = &pPositions[start * stride];
+            data.m_pSrcNormals  = pSrcNormals ? &pSrcNormals[start * normalStride] : nullptr;
+            data.m_pDstNormals  = pNormals    ? &pNormals[start * normalStride]    : nullptr;
+            data.m_SlotCount    = slotCount;
+            data.m_Stride       = stride;
+            data.m_NormalStride = normalStride;
+            data.m_Count        = std::min(m_ChunkSize, end - start);
+
+            m_Chunks.push_back(chunk);
+        }
+    }
+
+    // update the pose bounds from the bone bounds. A dual quaternion skinned vertex follows the rotation arc of its
+    // bones instead of their linear blend, thus it may leave the bone bounds. In this case the bounds are taken from
+    // the skinned vertices
+    if (!m_pModel->m_DQSkinning && index < m_Bounds.size() && m_Bounds[index])
+        m_pModel->CalculateSkinnedBounds(index, m_Palette, m_Bounds[index]->m_Box, m_Bounds[index]->m_Sphere);
+
+    return true;
+}
+//---------------------------------------------------------------------------
+void ModelInstance::CullMeshlets(std::size_t index, VertexBuffer::ISpans& spans) const
+{
+    spans.clear();
+
+    // culling disabled, or mesh not split into clusters? The clusters bounds are derived from the linear blend, thus
+    // they cannot be used in dual quaternion mode
+    if (!m_Culling || m_pModel->m_DQSkinning || index >= m_pModel->m_Meshlets.size() || !m_pModel->m_Meshlets[index])
+        return;
+
+    const Model::IMeshlets::IMeshletData& meshlets = m_pModel->m_Meshlets[index]->m_Meshlets;
+
+    // the back faces may only be skipped if the buffer culls them anyway
+    const bool backCulled =
+            (m_pModel->m_Mesh[index]->m_VB[0]->m_Culling.m_Type == VertexCulling::IECullingType::IE_CT_Back);
+
+    bool culled = false;
+
+    // the clusters are consecutive vertex ranges, so the consecutive visible ones are merged in a single span
+    for (std::size_t i = 0; i < meshlets.size(); ++i)
+    {
+        const Model::IMeshlet* pMeshlet = meshlets[i];
+
+        SphereF  sphere;
+        Vector3F coneApex;
+        Vector3F coneAxis;
+        float    coneCutoff = 1.0f;
+
+        // is the cluster culled?
+        if (MeshletHelper::GetSkinnedBounds(*pMeshlet, m_Palette, sphere, coneApex, coneAxis, coneCutoff) &&
+            (MeshletHelper::IsOutsideFrustum(sphere, m_ModelViewProj) ||
+            (backCulled && MeshletHelper::IsBackFacing(coneApex, coneAxis, coneCutoff, m_ViewPos))))
+        {
+            culled = true;
+            continue;
+        }
+
+        // extend the previous span, if possible
+        if (!spans.empty() && spans.back().m_Start + spans.back().m_Count == pMeshlet->m_Start)
+            spans.back().m_Count += pMeshlet->m_Count;
+        else
+        {
+            VertexBuffer::ISpan span;
+            span.m_Start = pMeshlet->m_Start;
+            span.m_Count = pMeshlet->m_Count;
+
+            spans.push_back(span);
+        }
+    }
+
+    // nothing culled? The whole mesh is visible
+    if (!culled)
+    {
+        spans.clear();
+        return;
+    }
+
+    // everything culled? A single empty span hides the whole mesh
+    if (spans.empty())
+        spans.push_back(VertexBuffer::ISpan());
+}
+//---------------------------------------------------------------------------
+const Model::ISkeletonLOD* ModelInstance::GetLOD() const
+{
+    // full skeleton?
+    if (m_SkeletonLOD < 0 || std::size_t(m_SkeletonLOD) >= m_pModel->m_SkeletonLODs.size())
+        return nullptr;
+
+    const Model::ISkeletonLOD* pLOD = m_pModel->m_SkeletonLODs[m_SkeletonLOD];
+
+    // the level of detail should match the skeleton
+    if (!pLOD || pLOD->m_Targets.size() != m_pModel->m_BoneTable.m_Local.size())
+        return nullptr;
+
+    return pLOD;
+}
+//---------------------------------------------------------------------------
+void ModelInstance::GetPoseKey(int animSetIndex, double elapsedTime, int& poseSetIndex, double& poseTime) const
+{
+    poseSetIndex = animSetIndex;
+    poseTime     = 0.0;
+
+    // no model?
+    if (!m_pModel)
+    {
+        poseSetIndex = -1;
+        return;
+    }
+
+    // the pose cache may quantize the time, thus it knows at which time the pose is sampled
+    if (m_pPoseCache)
+    {
+        if (!m_pPoseCache->GetSampleTime(*m_pModel, animSetIndex, elapsedTime, poseTime))
+        {
+            poseSetIndex = -1;
+            poseTime     = 0.0;
+        }
+
+        return;
+    }
+
+    // invalid animation set? The bind pose is used
+    if (animSetIndex < 0 || std::size_t(animSetIndex) >= m_pModel->m_AnimationSet.size() ||
+        !m_pModel->m_AnimationSet[animSetIndex])
+    {
+        poseSetIndex = -1;
+        return;
+    }
+
+    // the elapsed time is looped on the animation set duration, and rounded to the animation key time stamps, thus
+    // the loops share the same key despite the rounding errors
+    poseTime = std::floor(AnimationSampler::GetTime(*m_pModel->m_AnimationSet[animSetIndex], elapsedTime) + 0.5) /
+            double(AnimationSampler::m_TicksPerSecond);
+}
+//---------------------------------------------------------------------------
+bool ModelInstance::IsPoseCached(int poseSetIndex, double poseTime) const
+{
+    // no valid pose?
+    if (!m_PoseValid || !m_pModel)
+        return false;
+
+    // the bind pose changed since the meshes were skinned, e.g. a morph target was applied?
+    if (m_PoseRevision != m_pModel->m_Revision)
+        return false;
+
+    // in pose only mode, the pose never changes
+    if (m_pModel->m_PoseOnly)
+        return true;
+
+    return (poseSetIndex == m_PoseSetIndex && poseTime == m_PoseTime);
+}
+//---------------------------------------------------------------------------
+bool ModelInstance::SkinChunk(std::size_t index)
+{
+    IChunk& chunk = m_Chunks[index];
+
+    if (!SkinningHelper::Skin(chunk.m_Data))
+        return false;
+
+    // in dual quaternion mode, the bounds are taken from the skinned vertices, while they are still in cache
+    if (m_pModel->m_DQSkinning)
+    {
+        const SkinningHelper::ISkinData& data = chunk.m_Data;
+
+        chunk.m_Box.Clear();
+
+        for (std::size_t i = 0; i < data.m_Count; ++i)
+        {
+            const float* pPosition = &data.m_pDst[i * data.m_Stride];
+            chunk.m_Box.Add(Vector3F(pPosition[0], pPosition[1], pPosition[2]));
+        }
+
+        // the last skinned chunk, whatever the thread, updates the pose bounds
+        if (m_PendingChunks.fetch_sub(1) == 1)
+            MergeChunkBounds();
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+void ModelInstance::MergeChunkBounds()
+{
+    const std::size_t chunkCount = m_Chunks.size();
+
+    // the chunks are sorted by mesh, their bounds replace the bounds of the mesh they belong to
+    for (std::size_t i = 0; i < chunkCount; ++i)
+    {
+        const IChunk& chunk = m_Chunks[i];
+
+        if (chunk.m_MeshIndex >= m_Bounds.size() || !m_Bounds[chunk.m_MeshIndex])
+            continue;
+
+        Model::IBounds* pBounds = m_Bounds[chunk.m_MeshIndex];
+
+        // first chunk of the mesh?
+        if (!i || m_Chunks[i - 1].m_MeshIndex != chunk.m_MeshIndex)
+            pBounds->m_Box.Clear();
+
+        pBounds->m_Box.Merge(chunk.m_Box);
+
+        pBounds->m_Sphere.m_Center = pBounds->m_Box.GetCenter();
+        pBounds->m_Sphere.m_Radius = pBounds->m_Box.GetRadius();
+    }
+}
+//---------------------------------------------------------------------------
+void ModelInstance::OnSkinChunk(void* pData, std::size_t index)
+{
+    ModelInstance* pInstance = static_cast<ModelInstance*>(pData);
+
+    // the chunks are validated while prepared, thus the skinning cannot fail
+    pInstance->SkinChunk(index);
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,307 @@
+/****************************************************************************
+ * ==> ModelInstance -------------------------------------------------------*
+ ****************************************************************************
+ * Description : Lightweight model instance, owns only its pose and output  *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <vector>
+#include <memory>
+#include <atomic>
+
+// classes
+#include "Model.h"
+#include "AnimationSampler.h"
+#include "PoseCache.h"
+#include "SkinningHelper.h"
+#include "ThreadPool.h"
+#include "MeshletHelper.h"
+
+/**
+* Model instance, owns only its pose and its skinned output, the geometry, skin weights, skeleton, materials and
+* textures are read from a shared immutable model
+*@author Jean-Milost Reymond
+*/
+class ModelInstance
+{
+    public:
+        std::vector<Mesh*>           m_Mesh;          // output meshes, sorted in the same order as the model meshes
+        std::vector<Model::IBounds*> m_Bounds;        // current pose bounds, sorted in the same order as the meshes. In
+                                                      // dual quaternion mode, they're taken from the skinned vertices
+        Model::IMatrices             m_LocalPose;     // current pose local bone matrices, sorted in the same order as the model bone table
+        Model::IMatrices             m_GlobalPose;    // current pose global bone matrices, in the same order
+        Model::IMatrices             m_Palette;       // current pose matrix palette (inverse bind * global pose), in the same order
+        int                          m_AnimSetIndex;  // animation set index of the current pose
+        double                       m_ElapsedTime;   // elapsed time of the current pose, in seconds
+
+        /**
+        * Constructor
+        *@param pModel - shared model to instantiate
+        *@note Only the vertex positions and normals of the skinned meshes are allocated by the instance, all the
+        *      other data are read from the model vertex buffers, which are set as source of the instance vertex
+        *      buffers. For this reason the model should not be modified while it's instantiated
+        */
+        ModelInstance(const std::shared_ptr<const Model>& pModel);
+
+        virtual ~ModelInstance();
+
+        /**
+        * Gets the instantiated model
+        *@return the instantiated model, nullptr if no model
+        */
+        virtual const Model* GetModel() const;
+
+        /**
+        * Gets the shared instantiated model
+        *@return the shared instantiated model
+        */
+        virtual const std::shared_ptr<const Model>& GetSharedModel() const;
+
+        /**
+        * Updates the instance pose and skins its output meshes
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds
+        *@return true on success, otherwise false
+        */
+        virtual bool Update(int animSetIndex, double elapsedTime);
+
+        /**
+        * Updates the instance pose and queues the skinning of its output meshes in a thread pool
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds
+        *@param pool - thread pool in which the meshes will be skinned
+        *@param group - group to which the skinning tasks are added, may be shared by several instances
+        *@return true on success, otherwise false
+        *@note The pose bounds are up to date when this function returns, but the output meshes are only skinned
+        *      once pool.Wait(group) returns. Meanwhile the instance should neither be updated, drawn nor deleted.
+        *      No task is queued if the pose didn't change since the last update. In dual quaternion mode, the pose
+        *      bounds are taken from the skinned vertices, thus they are also only up to date once pool.Wait(group)
+        *      returns
+        */
+        virtual bool Update(int animSetIndex, double elapsedTime, ThreadPool& pool, ThreadPool::ITaskGroup& group);
+
+        /**
+        * Updates the instance from a local pose, e.g. a pose evaluated by a PoseBlender, and skins its output meshes
+        *@param localPose - local bone matrices, in the same order as the model bone table
+        *@return true on success, otherwise false
+        *@note The pose cache doesn't apply, the meshes are always skinned
+        */
+        virtual bool Update(const Model::IMatrices& localPose);
+
+        /**
+        * Updates the instance from a local pose, and queues the skinning of its output meshes in a thread pool
+        *@param localPose - local bone matrices, in the same order as the model bone table
+        *@param pool - thread pool in which the meshes will be skinned
+        *@param group - group to which the skinning tasks are added, may be shared by several instances
+        *@return true on success, otherwise false
+        *@note See the animation set overload for the constraints while the meshes are skinned
+        */
+        virtual bool Update(const Model::IMatrices& localPose, ThreadPool& pool, ThreadPool::ITaskGroup& group);
+
+        /**
+        * Skins the output meshes with a given matrix palette, e.g. interpolated between 2 poses
+        *@param palette - matrix palette (inverse bind * global pose), in the same order as the model bone table
+        *@return true on success, otherwise false
+        *@note The local and global poses of the instance aren't updated. As the linear blend skinning is linear in
+        *      the palette matrices, interpolating 2 palettes interpolates the skinned vertices
+        */
+        virtual bool UpdatePalette(const Model::IMatrices& palette);
+
+        /**
+        * Sets the pose cache, shared with the other instances updated during the same frame
+        *@param pPoseCache - pose cache, the instance samples its own poses if nullptr. Not owned
+        *@note The pose is copied from the cache, thus the cache may begin a new frame as soon as the instance was
+        *      updated
+        */
+        virtual void SetPoseCache(PoseCache* pPoseCache);
+
+        /**
+        * Invalidates the current pose, thus the next update will skin the meshes even if the pose didn't change
+        */
+        virtual void Invalidate();
+
+        /**
+        * Gets the pose cache hit count, i.e. the updates for which the skinned meshes were reused
+        *@return the pose cache hit count
+        */
+        virtual std::size_t GetCacheHits() const;
+
+        /**
+        * Gets the pose cache miss count, i.e. the updates for which the meshes were skinned
+        *@return the pose cache miss count
+        */
+        virtual std::size_t GetCacheMisses() const;
+
+        /**
+        * Sets the skeleton level of detail
+        *@param lodIndex - index of the level of detail in the model m_SkeletonLODs, the full skeleton is used if -1
+        *@return true on success, otherwise false
+        *@note The collapsed bones aren't sampled, and the meshes are skinned by the merged influences, which may
+        *      require fewer slots. The level of detail may be changed on each update, e.g. from the screen size
+        */
+        virtual bool SetSkeletonLOD(int lodIndex);
+
+        /**
+        * Gets the skeleton level of detail
+        *@return the index of the level of detail in the model m_SkeletonLODs, -1 if the full skeleton is used
+        */
+        virtual int GetSkeletonLOD() const;
+
+        /**
+        * Enables the cluster culling, the clusters of the skinned meshes which are outside the view frustum or back
+        * facing the viewer are neither skinned nor drawn
+        *@param viewPos - viewer position, in the model space
+        *@param modelViewProj - combined model, view and projection matrix (i.e. model.Multiply(view).Multiply(proj))
+        *@note The model meshes should be split into meshlets. A viewer change invalidates the pose, thus the clusters
+        *      becoming visible are skinned on the next update. The clusters aren't culled in dual quaternion mode,
+        *      because their bounds are derived from the linear blend
+        */
+        virtual void EnableCulling(const Vector3F& viewPos, const Matrix4x4F& modelViewProj);
+
+        /**
+        * Disables the cluster culling, the whole meshes are skinned and drawn on the next update
+        */
+        virtual void DisableCulling();
+
+    private:
+        /**
+        * Skinning chunk
+        */
+        struct IChunk
+        {
+            SkinningHelper::ISkinData m_Data;
+            BoxF                      m_Box;       // skinned vertices bounds, only calculated in dual quaternion mode
+            std::size_t               m_MeshIndex; // skinned mesh index
+
+            IChunk();
+            virtual ~IChunk();
+        };
+
+        typedef std::vector<IChunk> IChunks;
+
+        static const std::size_t m_ChunkSize = 1024; // vertices skinned per chunk, sized to keep its data in cache
+
+        std::shared_ptr<const Model> m_pModel;
+        SkinningHelper::IPalette     m_SkinPalette;
+        AnimationSampler             m_Sampler;
+        PoseCache*                   m_pPoseCache;
+        IChunks                      m_Chunks;
+        std::atomic<std::size_t>     m_PendingChunks;
+        std::size_t                  m_CacheHits;
+        std::size_t                  m_CacheMisses;
+        Matrix4x4F                   m_ModelViewProj;
+        Vector3F                     m_ViewPos;
+        double                       m_PoseTime;
+        std::size_t                  m_PoseRevision;
+        int                          m_PoseSetIndex;
+        int                          m_SkeletonLOD;
+        bool                         m_Culling;
+        bool                         m_PoseValid;
+
+        /**
+        * Gets the key of the pose matching an animation set and an elapsed time, i.e. the pose actually sampled
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds
+        *@param[out] poseSetIndex - animation set index of the pose, -1 for the bind pose
+        *@param[out] poseTime - time at which the pose is sampled, in seconds, looped on the animation set duration
+        *                       and quantized by the pose cache, if any, otherwise rounded to the animation key time
+        *                       stamps. Always 0.0 for the bind pose
+        */
+        void GetPoseKey(int animSetIndex, double elapsedTime, int& poseSetIndex, double& poseTime) const;
+
+        /**
+        * Checks if the skinned meshes already match a pose
+        *@param poseSetIndex - animation set index of the pose, as returned by GetPoseKey()
+        *@param poseTime - time at which the pose is sampled, as returned by GetPoseKey()
+        *@return true if the skinned meshes already match the pose, otherwise false
+        */
+        bool IsPoseCached(int poseSetIndex, double poseTime) const;
+
+        /**
+        * Updates the pose and splits the skinning into chunks
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds
+        *@param pLocalPose - local pose to use, if nullptr the animation set is sampled
+        *@param pPalette - matrix palette to use, if not nullptr the pose is ignored
+        *@return true on success, otherwise false
+        */
+        bool Prepare(int                     animSetIndex,
+                     double                  elapsedTime,
+                     const Model::IMatrices* pLocalPose = nullptr,
+                     const Model::IMatrices* pPalette   = nullptr);
+
+        /**
+        * Builds the matrix palette of the current pose, shared by all the meshes
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds
+        *@param pLocalPose - local pose to use, if nullptr the animation set is sampled
+        *@param pPalette - matrix palette to use, if not nullptr the pose is ignored
+        */
+        void BuildPalette(int                     animSetIndex,
+                          double                  elapsedTime,
+                          const Model::IMatrices* pLocalPose,
+                          const Model::IMatrices* pPalette);
+
+        /**
+        * Builds the pose bounds of a mesh, and splits its skinning into chunks
+        *@param index - mesh index
+        *@return true on success, otherwise false
+        */
+        bool PrepareMesh(std::size_t index);
+
+        /**
+        * Culls the clusters of a mesh in the current pose
+        *@param index - mesh index
+        *@param[out] spans - visible vertex spans, empty if the whole mesh is visible or cannot be culled
+        */
+        void CullMeshlets(std::size_t index, VertexBuffer::ISpans& spans) const;
+
+        /**
+        * Gets the skeleton level of detail
+        *@return the skeleton level of detail, nullptr if the full skeleton is used
+        */
+        const Model::ISkeletonLOD* GetLOD() const;
+
+        /**
+        * Skins a chunk. In dual quaternion mode, the pose bounds are updated once the last chunk is skinned
+        *@param index - chunk index
+        *@return true on success, otherwise false
+        */
+        bool SkinChunk(std::size_t index);
+
+        /**
+        * Updates the pose bounds of the skinned meshes from their chunks bounds
+        */
+        void MergeChunkBounds();
+
+        /**
+        * Called when a skinning chunk should be executed
+        *@param pData - model instance
+        *@param index - chunk index
+        */
+        static void OnSkinChunk(void* pData, std::size_t index);
+};
@@ -0,0 +1,82 @@
+/****************************************************************************
+ * ==> ModelInstanceBuffer -------------------------------------------------*
+ ****************************************************************************
+ * Description : Triple buffered instance, pipelines its update and draw    *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "ModelInstanceBuffer.h"
+
+//---------------------------------------------------------------------------
+// ModelInstanceBuffer
+//---------------------------------------------------------------------------
+ModelInstanceBuffer::ModelInstanceBuffer(const std::shared_ptr<const Model>& pModel) :
+    m_Exchange(1),
+    m_Back(0),
+    m_Front(2),
+    m_Drawable(false)
+{
+    for (unsigned i = 0; i < m_Count; ++i)
+        m_pInstances[i] = new ModelInstance(pModel);
+}
+//---------------------------------------------------------------------------
+ModelInstanceBuffer::~ModelInstanceBuffer()
+{
+    for (unsigned i = 0; i < m_Count; ++i)
+        delete m_pInstances[i];
+}
+//---------------------------------------------------------------------------
+ModelInstance* ModelInstanceBuffer::BeginUpdate()
+{
+    return m_pInstances[m_Back];
+}
+//---------------------------------------------------------------------------
+void ModelInstanceBuffer::EndUpdate()
+{
+    // publish the updated instance and get back the exchanged one. The release makes the skinned data visible to
+    // the draw thread, the acquire ensures the draw thread no longer reads the instance which is got back
+    m_Back = m_Exchange.exchange(m_Back | m_NewFrame, std::memory_order_acq_rel) & m_IndexMask;
+}
+//---------------------------------------------------------------------------
+bool ModelInstanceBuffer::Update(int animSetIndex, double elapsedTime)
+{
+    if (!BeginUpdate()->Update(animSetIndex, elapsedTime))
+        return false;
+
+    EndUpdate();
+    return true;
+}
+//---------------------------------------------------------------------------
+const ModelInstance* ModelInstanceBuffer::BeginDraw()
+{
+    // a new frame was published? Exchange it with the previously drawn one
+    if (m_Exchange.load(std::memory_order_relaxed) & m_NewFrame)
+    {
+        m_Front    = m_Exchange.exchange(m_Front, std::memory_order_acq_rel) & m_IndexMask;
+        m_Drawable = true;
+    }
+
+    return m_Drawable ? m_pInstances[m_Front] : nullptr;
+}
+//---------------------------------------------------------------------------
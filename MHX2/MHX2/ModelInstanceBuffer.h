@@ -0,0 +1,98 @@
+/****************************************************************************
+ * ==> ModelInstanceBuffer -------------------------------------------------*
+ ****************************************************************************
+ * Description : Triple buffered instance, pipelines its update and draw    *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <atomic>
+#include <memory>
+
+// classes
+#include "ModelInstance.h"
+
+/**
+* Triple buffered model instance, allows an update thread to skin the next frame while a draw thread reads the
+* current one. Each side owns its own instance, and the frames are exchanged through a third one, thus neither
+* thread waits for the other and no lock is required
+*@author Jean-Milost Reymond
+*/
+class ModelInstanceBuffer
+{
+    public:
+        /**
+        * Constructor
+        *@param pModel - shared model to instantiate
+        */
+        ModelInstanceBuffer(const std::shared_ptr<const Model>& pModel);
+
+        virtual ~ModelInstanceBuffer();
+
+        /**
+        * Acquires the instance in which the next frame should be skinned
+        *@return the instance to update
+        *@note Should only be called from the update thread. The instance belongs to this thread until EndUpdate()
+        *      is called, and may be updated in any way, e.g. in a thread pool, as long as the update is completed
+        *      before EndUpdate() is called
+        */
+        virtual ModelInstance* BeginUpdate();
+
+        /**
+        * Releases the instance acquired by BeginUpdate() and publishes it as the most recent frame
+        *@note Should only be called from the update thread
+        */
+        virtual void EndUpdate();
+
+        /**
+        * Updates the next frame on the calling thread and publishes it
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds
+        *@return true on success, otherwise false
+        *@note Should only be called from the update thread. The frame isn't published on failure
+        */
+        virtual bool Update(int animSetIndex, double elapsedTime);
+
+        /**
+        * Acquires the most recently published frame
+        *@return the instance to draw, nullptr if no frame was published yet
+        *@note Should only be called from the draw thread. The returned instance remains valid and unchanged until
+        *      the next BeginDraw() call, which releases it. If no new frame was published meanwhile, the same
+        *      instance is returned again
+        */
+        virtual const ModelInstance* BeginDraw();
+
+    private:
+        static const unsigned m_Count     = 3;   // instance count, one per thread plus one in exchange
+        static const unsigned m_IndexMask = 0x3; // mask to extract the instance index from the exchange value
+        static const unsigned m_NewFrame  = 0x4; // set in the exchange value if it contains a frame not drawn yet
+
+        ModelInstance*        m_pInstances[m_Count];
+        std::atomic<unsigned> m_Exchange; // index of the exchanged instance, with the m_NewFrame flag
+        unsigned              m_Back;     // index of the instance owned by the update thread
+        unsigned              m_Front;    // index of the instance owned by the draw thread
+        bool                  m_Drawable; // if true, the front instance contains a published frame
+};
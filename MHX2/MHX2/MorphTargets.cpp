@@ -0,0 +1,492 @@
+/****************************************************************************
+ * ==> MorphTargets --------------------------------------------------------*
+ ****************************************************************************
+ * Description : MakeHuman morph targets, applied as sparse vertex deltas   *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "MorphTargets.h"
+
+// std
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+// classes
+#include "MeshletHelper.h"
+
+// the deltas are added by SSE2 instructions when available
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define MORPH_TARGETS_SSE2
+
+    // std
+    #include <emmintrin.h>
+#endif
+
+//---------------------------------------------------------------------------
+// MorphTargets::IMeshTarget
+//---------------------------------------------------------------------------
+MorphTargets::IMeshTarget::IMeshTarget() :
+    m_MeshIndex(0)
+{}
+//---------------------------------------------------------------------------
+MorphTargets::IMeshTarget::~IMeshTarget()
+{}
+//---------------------------------------------------------------------------
+// MorphTargets::ITarget
+//---------------------------------------------------------------------------
+MorphTargets::ITarget::ITarget() :
+    m_Weight(0.0f),
+    m_AppliedWeight(0.0f)
+{}
+//---------------------------------------------------------------------------
+MorphTargets::ITarget::~ITarget()
+{}
+//---------------------------------------------------------------------------
+// MorphTargets::IBinding
+//---------------------------------------------------------------------------
+MorphTargets::IBinding::IBinding() :
+    m_MeshIndex(0),
+    m_VertexCount(0)
+{}
+//---------------------------------------------------------------------------
+MorphTargets::IBinding::~IBinding()
+{}
+//---------------------------------------------------------------------------
+// MorphTargets
+//---------------------------------------------------------------------------
+MorphTargets::MorphTargets()
+{}
+//---------------------------------------------------------------------------
+MorphTargets::~MorphTargets()
+{}
+//---------------------------------------------------------------------------
+void MorphTargets::Clear()
+{
+    m_Targets.clear();
+    m_Bindings.clear();
+}
+//---------------------------------------------------------------------------
+bool MorphTargets::Bind(std::size_t meshIndex, const IIndices& refs, const IWeights& weights, std::size_t refCount)
+{
+    // invalid references?
+    if (!refCount || refs.empty() || refs.size() != weights.size() || refs.size() % refCount)
+        return false;
+
+    std::unique_ptr<IBinding> pBinding(new IBinding());
+    pBinding->m_MeshIndex   = meshIndex;
+    pBinding->m_VertexCount = refs.size() / refCount;
+
+    const std::size_t baseCount = *std::max_element(refs.begin(), refs.end()) + 1;
+    const std::size_t refTotal  = refs.size();
+
+    pBinding->m_Starts.resize(baseCount + 1, 0);
+
+    // count the followers of each basemesh vertex
+    for (std::size_t i = 0; i < refTotal; ++i)
+        if (weights[i] != 0.0f)
+            ++pBinding->m_Starts[refs[i] + 1];
+
+    for (std::size_t i = 0; i < baseCount; ++i)
+        pBinding->m_Starts[i + 1] += pBinding->m_Starts[i];
+
+    pBinding->m_Followers.resize(pBinding->m_Starts[baseCount]);
+    pBinding->m_FollowerWeights.resize(pBinding->m_Starts[baseCount]);
+
+    IIndices cursors(pBinding->m_Starts.begin(), pBinding->m_Starts.end() - 1);
+
+    // list the followers, the vertices are visited in order, thus each list is ascending
+    for (std::size_t i = 0; i < refTotal; ++i)
+    {
+        if (weights[i] == 0.0f)
+            continue;
+
+        const std::size_t cursor = cursors[refs[i]]++;
+
+        pBinding->m_Followers[cursor]       = i / refCount;
+        pBinding->m_FollowerWeights[cursor] = weights[i];
+    }
+
+    // propagate the already loaded targets, replacing any previous binding of the same mesh
+    for (ITargets::iterator it = m_Targets.begin(); it != m_Targets.end(); ++it)
+    {
+        IMeshTargets& meshTargets = (*it)->m_MeshTargets;
+
+        for (IMeshTargets::iterator itMesh = meshTargets.begin(); itMesh != meshTargets.end(); ++itMesh)
+            if (itMesh->m_MeshIndex == meshIndex)
+            {
+                meshTargets.erase(itMesh);
+                break;
+            }
+
+        meshTargets.push_back(IMeshTarget());
+        Propagate(**it, *pBinding, meshTargets.back());
+    }
+
+    for (IBindings::iterator it = m_Bindings.begin(); it != m_Bindings.end(); ++it)
+        if ((*it)->m_MeshIndex == meshIndex)
+        {
+            m_Bindings.erase(it);
+            break;
+        }
+
+    m_Bindings.push_back(std::move(pBinding));
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool MorphTargets::Open(const std::string& fileName)
+{
+    // no file name?
+    if (fileName.empty())
+        return false;
+
+    std::FILE* pStream = nullptr;
+
+    // open file for read
+    #ifdef _WINDOWS
+        const errno_t error = fopen_s(&pStream, fileName.c_str(), "rb");
+
+        // error occurred?
+        if (error != 0)
+            return false;
+    #else
+        pStream = std::fopen(fileName.c_str(), "rb");
+    #endif
+
+    // is file stream opened?
+    if (!pStream)
+        return false;
+
+    // get file size
+    std::fseek(pStream, 0, SEEK_END);
+    const long fileSize = std::ftell(pStream);
+    std::fseek(pStream, 0, SEEK_SET);
+
+    std::string data;
+    std::size_t readSize = 0;
+
+    // read the whole file at once
+    try
+    {
+        if (fileSize > 0)
+        {
+            data.resize(std::size_t(fileSize));
+            readSize = std::fread(&data[0], 1, data.size(), pStream);
+        }
+    }
+    catch (...)
+    {
+        std::fclose(pStream);
+        return false;
+    }
+
+    std::fclose(pStream);
+
+    if (fileSize <= 0 || readSize != std::size_t(fileSize))
+        return false;
+
+    // name the target from the file name, without path nor extension
+    const std::size_t separator = fileName.find_last_of("/\\");
+    std::string       name      = (separator == std::string::npos) ? fileName : fileName.substr(separator + 1);
+    const std::size_t extension = name.find_last_of('.');
+
+    if (extension != std::string::npos && extension)
+        name = name.substr(0, extension);
+
+    return Read(data, name);
+}
+//---------------------------------------------------------------------------
+bool MorphTargets::Read(const std::string& data, const std::string& name)
+{
+    // target already exists?
+    if (Find(name) >= 0)
+        return false;
+
+    std::unique_ptr<ITarget> pTarget(new ITarget());
+    pTarget->m_Name = name;
+
+    const char* pData = data.c_str();
+    const char* pEnd  = pData + data.size();
+
+    while (pData < pEnd)
+    {
+        // skip the blank chars
+        while (pData < pEnd && (*pData == ' ' || *pData == '\t' || *pData == '\r' || *pData == '\n'))
+            ++pData;
+
+        if (pData >= pEnd)
+            break;
+
+        // comment? Skip the line
+        if (*pData == '#')
+        {
+            while (pData < pEnd && *pData != '\n')
+                ++pData;
+
+            continue;
+        }
+
+        char* pNext = nullptr;
+
+        // read the basemesh vertex index
+        const unsigned long index = std::strtoul(pData, &pNext, 10);
+
+        if (pNext == pData)
+            return false;
+
+        pData = pNext;
+
+        pTarget->m_Indices.push_back(std::size_t(index));
+
+        // read the delta
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            const float value = std::strtof(pData, &pNext);
+
+            if (pNext == pData)
+                return false;
+
+            pData = pNext;
+
+            pTarget->m_Deltas.push_back(value);
+        }
+    }
+
+    // propagate the target to the bound meshes
+    pTarget->m_MeshTargets.resize(m_Bindings.size());
+
+    for (std::size_t i = 0; i < m_Bindings.size(); ++i)
+        Propagate(*pTarget, *m_Bindings[i], pTarget->m_MeshTargets[i]);
+
+    m_Targets.push_back(std::move(pTarget));
+
+    return true;
+}
+//---------------------------------------------------------------------------
+std::size_t MorphTargets::GetCount() const
+{
+    return m_Targets.size();
+}
+//---------------------------------------------------------------------------
+int MorphTargets::Find(const std::string& name) const
+{
+    const std::size_t targetCount = m_Targets.size();
+
+    for (std::size_t i = 0; i < targetCount; ++i)
+        if (m_Targets[i]->m_Name == name)
+            return int(i);
+
+    return -1;
+}
+//---------------------------------------------------------------------------
+std::string MorphTargets::GetName(std::size_t index) const
+{
+    if (index >= m_Targets.size())
+        return "";
+
+    return m_Targets[index]->m_Name;
+}
+//---------------------------------------------------------------------------
+bool MorphTargets::SetWeight(std::size_t index, float weight)
+{
+    if (index >= m_Targets.size())
+        return false;
+
+    m_Targets[index]->m_Weight = weight;
+    return true;
+}
+//---------------------------------------------------------------------------
+float MorphTargets::GetWeight(std::size_t index) const
+{
+    if (index >= m_Targets.size())
+        return 0.0f;
+
+    return m_Targets[index]->m_Weight;
+}
+//---------------------------------------------------------------------------
+bool MorphTargets::IsPending() const
+{
+    for (ITargets::const_iterator it = m_Targets.begin(); it != m_Targets.end(); ++it)
+        if ((*it)->m_Weight != (*it)->m_AppliedWeight)
+            return true;
+
+    return false;
+}
+//---------------------------------------------------------------------------
+bool MorphTargets::Apply(Model& model)
+{
+    IIndices changedMeshes;
+    bool     success = true;
+
+    for (ITargets::iterator it = m_Targets.begin(); it != m_Targets.end(); ++it)
+    {
+        ITarget& target = **it;
+
+        // weight unchanged?
+        if (target.m_Weight == target.m_AppliedWeight)
+            continue;
+
+        // only the weight difference is added, thus the other targets remain applied
+        const float weight = target.m_Weight - target.m_AppliedWeight;
+
+        for (IMeshTargets::const_iterator itMesh = target.m_MeshTargets.begin(); itMesh != target.m_MeshTargets.end(); ++itMesh)
+        {
+            // nothing to apply?
+            if (itMesh->m_Vertices.empty())
+                continue;
+
+            const std::size_t meshIndex = itMesh->m_MeshIndex;
+
+            // mesh no longer exists, or contains several vertex buffers?
+            if (meshIndex >= model.m_Mesh.size() || !model.m_Mesh[meshIndex] || model.m_Mesh[meshIndex]->m_VB.size() != 1)
+            {
+                success = false;
+                continue;
+            }
+
+            VertexBuffer* pVB        = model.m_Mesh[meshIndex]->m_VB[0];
+            std::size_t   stride     = 0;
+            float*        pPositions = pVB->GetPositions(stride);
+
+            if (!pPositions)
+            {
+                success = false;
+                continue;
+            }
+
+            AddDeltas(*itMesh, weight, pPositions, stride, pVB->GetVertexCount());
+
+            if (std::find(changedMeshes.begin(), changedMeshes.end(), meshIndex) == changedMeshes.end())
+                changedMeshes.push_back(meshIndex);
+        }
+
+        target.m_AppliedWeight = target.m_Weight;
+    }
+
+    // notify the instances sharing the model that its bind pose changed
+    if (!changedMeshes.empty())
+        ++model.m_Revision;
+
+    // rebuild the bounds of the changed meshes, once for all the targets
+    for (IIndices::const_iterator it = changedMeshes.begin(); it != changedMeshes.end(); ++it)
+    {
+        if (!model.BuildBounds(*it))
+            success = false;
+
+        if (*it < model.m_Meshlets.size() && model.m_Meshlets[*it])
+            MeshletHelper::UpdateBounds(*model.m_Mesh[*it]->m_VB[0],
+                                        *it < model.m_Deformers.size() ? model.m_Deformers[*it] : nullptr,
+                                        *model.m_Meshlets[*it]);
+    }
+
+    return success;
+}
+//---------------------------------------------------------------------------
+void MorphTargets::Propagate(const ITarget& target, const IBinding& binding, IMeshTarget& meshTarget)
+{
+    meshTarget.m_MeshIndex = binding.m_MeshIndex;
+    meshTarget.m_Vertices.clear();
+    meshTarget.m_Deltas.clear();
+
+    const std::size_t        indexCount = target.m_Indices.size();
+    const std::size_t        baseCount  = binding.m_Starts.size() - 1;
+    IWeights                 deltas(binding.m_VertexCount * 3, 0.0f);
+    std::vector<char>        touched(binding.m_VertexCount, 0);
+
+    // accumulate the weighted basemesh deltas on their followers, a proxy vertex may follow several of them
+    for (std::size_t i = 0; i < indexCount; ++i)
+    {
+        const std::size_t index = target.m_Indices[i];
+
+        // vertex not followed by the mesh?
+        if (index >= baseCount)
+            continue;
+
+        for (std::size_t j = binding.m_Starts[index]; j < binding.m_Starts[index + 1]; ++j)
+        {
+            const std::size_t vertex = binding.m_Followers[j];
+            const float       weight = binding.m_FollowerWeights[j];
+
+            deltas[vertex * 3]     += target.m_Deltas[i * 3]     * weight;
+            deltas[vertex * 3 + 1] += target.m_Deltas[i * 3 + 1] * weight;
+            deltas[vertex * 3 + 2] += target.m_Deltas[i * 3 + 2] * weight;
+
+            touched[vertex] = 1;
+        }
+    }
+
+    // keep the affected vertices in ascending order, their deltas are padded to 4 values
+    for (std::size_t i = 0; i < binding.m_VertexCount; ++i)
+    {
+        if (!touched[i])
+            continue;
+
+        meshTarget.m_Vertices.push_back(i);
+        meshTarget.m_Deltas.push_back(deltas[i * 3]);
+        meshTarget.m_Deltas.push_back(deltas[i * 3 + 1]);
+        meshTarget.m_Deltas.push_back(deltas[i * 3 + 2]);
+        meshTarget.m_Deltas.push_back(0.0f);
+    }
+}
+//---------------------------------------------------------------------------
+void MorphTargets::AddDeltas(const IMeshTarget& meshTarget,
+                                   float        weight,
+                                   float*       pPositions,
+                                   std::size_t  stride,
+                                   std::size_t  vertexCount)
+{
+    const std::size_t count  = meshTarget.m_Vertices.size();
+    const float*      pDelta = meshTarget.m_Deltas.empty() ? nullptr : &meshTarget.m_Deltas[0];
+
+    #ifdef MORPH_TARGETS_SSE2
+        const __m128 factor = _mm_set1_ps(weight);
+    #endif
+
+    for (std::size_t i = 0; i < count; ++i, pDelta += 4)
+    {
+        const std::size_t vertex = meshTarget.m_Vertices[i];
+
+        // vertex out of the buffer?
+        if (vertex >= vertexCount)
+            break;
+
+        float* pPosition = pPositions + vertex * stride;
+
+        #ifdef MORPH_TARGETS_SSE2
+            // the 4th value belongs to the next vertex data, and is left unchanged by the 0.0 delta padding. The
+            // last vertex is processed alone, to not read beyond the buffer
+            if (vertex + 1 < vertexCount)
+            {
+                _mm_storeu_ps(pPosition, _mm_add_ps(_mm_loadu_ps(pPosition), _mm_mul_ps(_mm_loadu_ps(pDelta), factor)));
+                continue;
+            }
+        #endif
+
+        pPosition[0] += pDelta[0] * weight;
+        pPosition[1] += pDelta[1] * weight;
+        pPosition[2] += pDelta[2] * weight;
+    }
+}
+//---------------------------------------------------------------------------
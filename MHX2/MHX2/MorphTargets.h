@@ -0,0 +1,215 @@
+/****************************************************************************
+ * ==> MorphTargets --------------------------------------------------------*
+ ****************************************************************************
+ * Description : MakeHuman morph targets, applied as sparse vertex deltas   *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <string>
+#include <vector>
+#include <memory>
+
+// classes
+#include "Model.h"
+
+/**
+* Morph targets, i.e. the MakeHuman modifiers. A target is a sparse list of vertex deltas applied to the basemesh,
+* read from a .target file. The model meshes are bound to the basemesh, either directly or by a proxy fitting, thus
+* a target is propagated once to the vertices of each mesh when loaded. When a weight changes, only the vertices the
+* target affects are updated, by the weight difference
+*@author Jean-Milost Reymond
+*/
+class MorphTargets
+{
+    public:
+        typedef std::vector<std::size_t> IIndices;
+        typedef std::vector<float>       IWeights;
+
+        MorphTargets();
+        virtual ~MorphTargets();
+
+        /**
+        * Clears the targets and the mesh bindings
+        */
+        virtual void Clear();
+
+        /**
+        * Binds a model mesh to the basemesh
+        *@param meshIndex - model mesh index
+        *@param refs - for each mesh vertex, the refCount basemesh vertex indices it follows
+        *@param weights - for each mesh vertex, the refCount weights of the basemesh vertices it follows
+        *@param refCount - basemesh vertex count each mesh vertex follows, e.g. 1 for the basemesh itself, or 3 for a
+        *                  fitted proxy
+        *@return true on success, otherwise false
+        *@note The targets already loaded are propagated to the mesh
+        */
+        virtual bool Bind(std::size_t meshIndex, const IIndices& refs, const IWeights& weights, std::size_t refCount);
+
+        /**
+        * Opens a target from a .target file
+        *@param fileName - target file name, the target is named from it, without path nor extension
+        *@return true on success, otherwise false
+        */
+        virtual bool Open(const std::string& fileName);
+
+        /**
+        * Reads a target from data
+        *@param data - target data, a line per vertex containing its basemesh index and its x, y and z delta
+        *@param name - target name
+        *@return true on success, otherwise false
+        */
+        virtual bool Read(const std::string& data, const std::string& name);
+
+        /**
+        * Gets the target count
+        *@return the target count
+        */
+        virtual std::size_t GetCount() const;
+
+        /**
+        * Finds a target
+        *@param name - target name
+        *@return the target index, -1 if not found
+        */
+        virtual int Find(const std::string& name) const;
+
+        /**
+        * Gets a target name
+        *@param index - target index
+        *@return the target name, empty if not found
+        */
+        virtual std::string GetName(std::size_t index) const;
+
+        /**
+        * Sets a target weight
+        *@param index - target index
+        *@param weight - target weight, 0.0 to remove the target
+        *@return true on success, otherwise false
+        *@note The weight is only applied on the next Apply() call, thus several weights may change at once
+        */
+        virtual bool SetWeight(std::size_t index, float weight);
+
+        /**
+        * Gets a target weight
+        *@param index - target index
+        *@return the target weight, 0.0 if not found
+        */
+        virtual float GetWeight(std::size_t index) const;
+
+        /**
+        * Checks if weights changed since the last Apply() call
+        *@return true if weights changed, otherwise false
+        */
+        virtual bool IsPending() const;
+
+        /**
+        * Applies the weights changed since the last call to the model bind pose
+        *@param model - model the meshes were bound from
+        *@return true on success, otherwise false
+        *@note Only the affected vertices are updated, then the bounds and the meshlets of the affected meshes are
+        *      rebuilt. The model vertex buffers are modified, thus no instance should be skinned meanwhile. The model
+        *      revision is incremented if a mesh changed, thus all its instances skin their meshes again on their next
+        *      update
+        */
+        virtual bool Apply(Model& model);
+
+    private:
+        /**
+        * Target propagated to a mesh
+        */
+        struct IMeshTarget
+        {
+            std::size_t m_MeshIndex;
+            IIndices    m_Vertices; // affected mesh vertices, ascending
+            IWeights    m_Deltas;   // x, y, z delta and 0.0 padding for each affected vertex
+
+            IMeshTarget();
+            ~IMeshTarget();
+        };
+
+        typedef std::vector<IMeshTarget> IMeshTargets;
+
+        /**
+        * Target
+        */
+        struct ITarget
+        {
+            std::string  m_Name;
+            IIndices     m_Indices;       // basemesh vertex indices
+            IWeights     m_Deltas;        // x, y and z delta for each basemesh vertex
+            IMeshTargets m_MeshTargets;   // target propagated to each bound mesh
+            float        m_Weight;        // weight to apply
+            float        m_AppliedWeight; // weight already applied to the meshes
+
+            ITarget();
+            ~ITarget();
+        };
+
+        /**
+        * Mesh bound to the basemesh. The followers of each basemesh vertex are listed, thus a target may be propagated
+        * without visiting the whole mesh
+        */
+        struct IBinding
+        {
+            std::size_t m_MeshIndex;
+            std::size_t m_VertexCount;     // mesh vertex count
+            IIndices    m_Starts;          // for each basemesh vertex, its first follower, the last entry closes them
+            IIndices    m_Followers;       // mesh vertices following the basemesh vertices
+            IWeights    m_FollowerWeights; // weight of each follower
+
+            IBinding();
+            ~IBinding();
+        };
+
+        typedef std::vector<std::unique_ptr<ITarget>>  ITargets;
+        typedef std::vector<std::unique_ptr<IBinding>> IBindings;
+
+        ITargets  m_Targets;
+        IBindings m_Bindings;
+
+        /**
+        * Propagates a target to a bound mesh
+        *@param target - target to propagate
+        *@param binding - mesh binding
+        *@param[out] meshTarget - target propagated to the mesh
+        */
+        static void Propagate(const ITarget& target, const IBinding& binding, IMeshTarget& meshTarget);
+
+        /**
+        * Adds the weighted deltas of a target to the mesh positions
+        *@param meshTarget - target propagated to the mesh
+        *@param weight - weight to apply
+        *@param pPositions - mesh positions
+        *@param stride - position stride, in floats
+        *@param vertexCount - mesh vertex count
+        */
+        static void AddDeltas(const IMeshTarget& meshTarget,
+                                    float        weight,
+                                    float*       pPositions,
+                                    std::size_t  stride,
+                                    std::size_t  vertexCount);
+};
@@ -0,0 +1,406 @@
+/****************************************************************************
+ * ==> PoseBlender ---------------------------------------------------------*
+ ****************************************************************************
+ * Description : Animation layers blending, on flat local poses             *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "PoseBlender.h"
+
+// std
+#include <cmath>
+#include <algorithm>
+
+// classes
+#include "Quaternion.h"
+
+// the poses are blended by SSE2 instructions when available
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define POSE_BLENDER_SSE2
+
+    // std
+    #include <emmintrin.h>
+#endif
+
+//---------------------------------------------------------------------------
+// PoseBlender::ILayer
+//---------------------------------------------------------------------------
+PoseBlender::ILayer::ILayer() :
+    m_AnimSetIndex(-1),
+    m_ElapsedTime(0.0),
+    m_Weight(0.0f),
+    m_Mode(IEBlendMode::IE_BM_Override),
+    m_pMask(nullptr)
+{}
+//---------------------------------------------------------------------------
+PoseBlender::ILayer::~ILayer()
+{}
+//---------------------------------------------------------------------------
+// PoseBlender::IPose
+//---------------------------------------------------------------------------
+PoseBlender::IPose::IPose()
+{}
+//---------------------------------------------------------------------------
+PoseBlender::IPose::~IPose()
+{}
+//---------------------------------------------------------------------------
+void PoseBlender::IPose::Resize(std::size_t boneCount)
+{
+    m_Rotations.resize(boneCount * 4);
+    m_Positions.resize(boneCount * 4);
+    m_Scales.resize(boneCount * 4);
+}
+//---------------------------------------------------------------------------
+// PoseBlender::ILayerData
+//---------------------------------------------------------------------------
+PoseBlender::ILayerData::ILayerData()
+{}
+//---------------------------------------------------------------------------
+PoseBlender::ILayerData::~ILayerData()
+{}
+//---------------------------------------------------------------------------
+// PoseBlender
+//---------------------------------------------------------------------------
+PoseBlender::PoseBlender() :
+    m_pModel(nullptr)
+{}
+//---------------------------------------------------------------------------
+PoseBlender::~PoseBlender()
+{}
+//---------------------------------------------------------------------------
+bool PoseBlender::SetLayerCount(const Model& model, std::size_t count)
+{
+    const std::size_t boneCount = model.m_BoneTable.m_Local.size();
+
+    // no skeleton?
+    if (!boneCount)
+        return false;
+
+    m_pModel = &model;
+
+    m_Layers.clear();
+    m_Layers.resize(count);
+
+    // allocate the poses, the sampled ones are resized to the bone count, thus the sampler keeps them as is
+    for (std::size_t i = 0; i < count; ++i)
+        m_Layers[i].m_LocalPose.resize(boneCount);
+
+    m_LayerPose.Resize(boneCount);
+    m_Result.Resize(boneCount);
+    m_Weights.resize(boneCount);
+    m_InvBindScales.resize(boneCount * 4);
+
+    Decompose(model.m_BoneTable.m_Local, m_BindPose);
+
+    // the additive layers divide their scale by the bind pose one
+    for (std::size_t i = 0; i < boneCount * 4; ++i)
+        m_InvBindScales[i] = (m_BindPose.m_Scales[i] != 0.0f) ? 1.0f / m_BindPose.m_Scales[i] : 1.0f;
+
+    return true;
+}
+//---------------------------------------------------------------------------
+std::size_t PoseBlender::GetLayerCount() const
+{
+    return m_Layers.size();
+}
+//---------------------------------------------------------------------------
+PoseBlender::ILayer* PoseBlender::GetLayer(std::size_t index)
+{
+    if (index >= m_Layers.size())
+        return nullptr;
+
+    return &m_Layers[index].m_Layer;
+}
+//---------------------------------------------------------------------------
+bool PoseBlender::Evaluate(Model::IMatrices& localPose)
+{
+    // no layer was created?
+    if (!m_pModel)
+        return false;
+
+    const Model::IBoneTable& boneTable = m_pModel->m_BoneTable;
+    const std::size_t        boneCount = m_Weights.size();
+
+    // the skeleton changed since the layers were created?
+    if (boneTable.m_Local.size() != boneCount)
+        return false;
+
+    // start from the bind pose
+    std::copy(m_BindPose.m_Rotations.begin(), m_BindPose.m_Rotations.end(), m_Result.m_Rotations.begin());
+    std::copy(m_BindPose.m_Positions.begin(), m_BindPose.m_Positions.end(), m_Result.m_Positions.begin());
+    std::copy(m_BindPose.m_Scales.begin(),    m_BindPose.m_Scales.end(),    m_Result.m_Scales.begin());
+
+    for (std::size_t i = 0; i < m_Layers.size(); ++i)
+    {
+        ILayerData&   data  = m_Layers[i];
+        const ILayer& layer = data.m_Layer;
+
+        // disabled layer?
+        if (layer.m_Weight <= 0.0f)
+            continue;
+
+        // sample the layer animation, or use the bind pose
+        if (!data.m_Sampler.Sample(*m_pModel, layer.m_AnimSetIndex, layer.m_ElapsedTime, data.m_LocalPose))
+            std::copy(boneTable.m_Local.begin(), boneTable.m_Local.end(), data.m_LocalPose.begin());
+
+        Decompose(data.m_LocalPose, m_LayerPose);
+
+        const float  weight = std::min(layer.m_Weight, 1.0f);
+        const IMask* pMask  = layer.m_pMask;
+
+        // get the weight of each bone
+        for (std::size_t j = 0; j < boneCount; ++j)
+            m_Weights[j] = (pMask && j < pMask->size()) ? weight * std::min(std::max((*pMask)[j], 0.0f), 1.0f) : weight;
+
+        if (layer.m_Mode == IEBlendMode::IE_BM_Additive)
+            BlendAdditive(m_LayerPose, m_BindPose, m_InvBindScales.data(), m_Weights.data(), boneCount, m_Result);
+        else
+            BlendOverride(m_LayerPose, m_Weights.data(), boneCount, m_Result);
+    }
+
+    Compose(m_Result, localPose);
+
+    return true;
+}
+//---------------------------------------------------------------------------
+bool PoseBlender::BuildMask(const Model& model, const std::string& boneName, IMask& mask)
+{
+    const Model::IBoneTable& boneTable = model.m_BoneTable;
+    const std::size_t        boneCount = boneTable.m_Bones.size();
+    const int                boneIndex = model.FindBoneIndex(boneName);
+
+    // bone not found?
+    if (boneIndex < 0)
+        return false;
+
+    if (mask.size() != boneCount)
+        mask.assign(boneCount, 0.0f);
+
+    std::vector<bool> masked(boneCount, false);
+    masked[boneIndex] = true;
+
+    // the bones are sorted parents first, thus the children are found in a single pass
+    for (std::size_t i = std::size_t(boneIndex); i < boneCount; ++i)
+    {
+        if (boneTable.m_Parents[i] >= 0 && masked[boneTable.m_Parents[i]])
+            masked[i] = true;
+
+        if (masked[i])
+            mask[i] = 1.0f;
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+void PoseBlender::Decompose(const Model::IMatrices& localPose, IPose& pose)
+{
+    const std::size_t boneCount = localPose.size();
+
+    pose.Resize(boneCount);
+
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        const Matrix4x4F& matrix   = localPose[i];
+              Matrix4x4F  rotation = Matrix4x4F::Identity();
+              float*      pScale   = &pose.m_Scales[i * 4];
+
+        // extract the scale from the rotation rows
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+            pScale[j] = std::sqrt(matrix.m_Table[j][0] * matrix.m_Table[j][0] +
+                                  matrix.m_Table[j][1] * matrix.m_Table[j][1] +
+                                  matrix.m_Table[j][2] * matrix.m_Table[j][2]);
+
+            for (std::size_t k = 0; k < 3; ++k)
+                rotation.m_Table[j][k] = (pScale[j] > 0.0f) ? matrix.m_Table[j][k] / pScale[j] : 0.0f;
+
+            pose.m_Positions[i * 4 + j] = matrix.m_Table[3][j];
+        }
+
+        pScale[3]                   = 1.0f;
+        pose.m_Positions[i * 4 + 3] = 0.0f;
+
+        // FromMatrix() returns the conjugate of the quaternion ToMatrix() expects
+        bool              error      = false;
+        const QuaternionF quaternion = QuaternionF().FromMatrix(rotation, error).Conjugate().Normalize();
+        float*            pRotation  = &pose.m_Rotations[i * 4];
+
+        pRotation[0] = error ? 0.0f : quaternion.m_X;
+        pRotation[1] = error ? 0.0f : quaternion.m_Y;
+        pRotation[2] = error ? 0.0f : quaternion.m_Z;
+        pRotation[3] = error ? 1.0f : quaternion.m_W;
+    }
+}
+//---------------------------------------------------------------------------
+void PoseBlender::Compose(const IPose& pose, Model::IMatrices& localPose)
+{
+    const std::size_t boneCount = pose.m_Rotations.size() / 4;
+
+    localPose.resize(boneCount);
+
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        const float* pRotation = &pose.m_Rotations[i * 4];
+        const float* pPosition = &pose.m_Positions[i * 4];
+        const float* pScale    = &pose.m_Scales[i * 4];
+        Matrix4x4F&  matrix    = localPose[i];
+
+        matrix = QuaternionF(pRotation[0], pRotation[1], pRotation[2], pRotation[3]).ToMatrix();
+
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+            matrix.m_Table[j][0] *= pScale[j];
+            matrix.m_Table[j][1] *= pScale[j];
+            matrix.m_Table[j][2] *= pScale[j];
+            matrix.m_Table[3][j]  = pPosition[j];
+        }
+    }
+}
+//---------------------------------------------------------------------------
+void PoseBlender::BlendOverride(const IPose& pose, const float* pWeights, std::size_t boneCount, IPose& result)
+{
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        const float weight = pWeights[i];
+
+        // bone not affected?
+        if (weight <= 0.0f)
+            continue;
+
+        const float* pSrcPosition = &pose.m_Positions[i * 4];
+        const float* pSrcScale    = &pose.m_Scales[i * 4];
+              float* pPosition    = &result.m_Positions[i * 4];
+              float* pScale       = &result.m_Scales[i * 4];
+              float  rotation[4];
+
+        // interpolate the rotation
+        AnimationSampler::Nlerp(&result.m_Rotations[i * 4], &pose.m_Rotations[i * 4], weight, rotation);
+        std::copy(rotation, rotation + 4, &result.m_Rotations[i * 4]);
+
+        // interpolate the position and the scale
+        #ifdef POSE_BLENDER_SSE2
+            const __m128 factor   = _mm_set1_ps(weight);
+            const __m128 position = _mm_loadu_ps(pPosition);
+            const __m128 scale    = _mm_loadu_ps(pScale);
+
+            _mm_storeu_ps(pPosition, _mm_add_ps(position, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pSrcPosition), position), factor)));
+            _mm_storeu_ps(pScale,    _mm_add_ps(scale,    _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pSrcScale),    scale),    factor)));
+        #else
+            for (std::size_t j = 0; j < 4; ++j)
+            {
+                pPosition[j] += (pSrcPosition[j] - pPosition[j]) * weight;
+                pScale[j]    += (pSrcScale[j]    - pScale[j])    * weight;
+            }
+        #endif
+    }
+}
+//---------------------------------------------------------------------------
+void PoseBlender::BlendAdditive(const IPose&      pose,
+                                const IPose&      reference,
+                                const float*      pInvScales,
+                                const float*      pWeights,
+                                      std::size_t boneCount,
+                                      IPose&      result)
+{
+    const float identity[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+
+    for (std::size_t i = 0; i < boneCount; ++i)
+    {
+        const float weight = pWeights[i];
+
+        // bone not affected?
+        if (weight <= 0.0f)
+            continue;
+
+        const float* pRefRotation = &reference.m_Rotations[i * 4];
+        const float* pRefPosition = &reference.m_Positions[i * 4];
+        const float* pSrcPosition = &pose.m_Positions[i * 4];
+        const float* pSrcScale    = &pose.m_Scales[i * 4];
+        const float* pInvScale    = &pInvScales[i * 4];
+              float* pRotation    = &result.m_Rotations[i * 4];
+              float* pPosition    = &result.m_Positions[i * 4];
+              float* pScale       = &result.m_Scales[i * 4];
+
+        // get the rotation difference to the reference, i.e. the rotation to apply after the reference one
+        const float invRefRotation[4] = {-pRefRotation[0], -pRefRotation[1], -pRefRotation[2], pRefRotation[3]};
+              float delta[4];
+              float weightedDelta[4];
+
+        MultiplyRotations(invRefRotation, &pose.m_Rotations[i * 4], delta);
+
+        // weight the difference, then apply it
+        AnimationSampler::Nlerp(identity, delta, weight, weightedDelta);
+        MultiplyRotations(pRotation, weightedDelta, pRotation);
+
+        // add the position difference, and multiply by the scale ratio
+        #ifdef POSE_BLENDER_SSE2
+            const __m128 factor = _mm_set1_ps(weight);
+            const __m128 one    = _mm_set1_ps(1.0f);
+            const __m128 offset = _mm_sub_ps(_mm_loadu_ps(pSrcPosition), _mm_loadu_ps(pRefPosition));
+            const __m128 ratio  = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(pSrcScale), _mm_loadu_ps(pInvScale)), one);
+
+            _mm_storeu_ps(pPosition, _mm_add_ps(_mm_loadu_ps(pPosition), _mm_mul_ps(offset, factor)));
+            _mm_storeu_ps(pScale,    _mm_mul_ps(_mm_loadu_ps(pScale),    _mm_add_ps(one, _mm_mul_ps(ratio, factor))));
+        #else
+            for (std::size_t j = 0; j < 4; ++j)
+            {
+                pPosition[j] += (pSrcPosition[j] - pRefPosition[j]) * weight;
+                pScale[j]    *= 1.0f + (pSrcScale[j] * pInvScale[j] - 1.0f) * weight;
+            }
+        #endif
+    }
+}
+//---------------------------------------------------------------------------
+void PoseBlender::MultiplyRotations(const float* pFirst, const float* pSecond, float* pResult)
+{
+    #ifdef POSE_BLENDER_SSE2
+        const __m128 first  = _mm_loadu_ps(pFirst);
+        const __m128 second = _mm_loadu_ps(pSecond);
+
+        // each first rotation component multiplies a swizzled and signed second rotation
+        const __m128 w = _mm_mul_ps(_mm_shuffle_ps(first, first, _MM_SHUFFLE(3, 3, 3, 3)), second);
+        const __m128 x = _mm_mul_ps(_mm_shuffle_ps(first, first, _MM_SHUFFLE(0, 0, 0, 0)),
+                                    _mm_xor_ps(_mm_shuffle_ps(second, second, _MM_SHUFFLE(0, 1, 2, 3)),
+                                               _mm_set_ps(-0.0f,  0.0f, -0.0f,  0.0f)));
+        const __m128 y = _mm_mul_ps(_mm_shuffle_ps(first, first, _MM_SHUFFLE(1, 1, 1, 1)),
+                                    _mm_xor_ps(_mm_shuffle_ps(second, second, _MM_SHUFFLE(1, 0, 3, 2)),
+                                               _mm_set_ps(-0.0f, -0.0f,  0.0f,  0.0f)));
+        const __m128 z = _mm_mul_ps(_mm_shuffle_ps(first, first, _MM_SHUFFLE(2, 2, 2, 2)),
+                                    _mm_xor_ps(_mm_shuffle_ps(second, second, _MM_SHUFFLE(2, 3, 0, 1)),
+                                               _mm_set_ps(-0.0f,  0.0f,  0.0f, -0.0f)));
+
+        _mm_storeu_ps(pResult, _mm_add_ps(_mm_add_ps(w, x), _mm_add_ps(y, z)));
+    #else
+        const float x = pFirst[3] * pSecond[0] + pFirst[0] * pSecond[3] + pFirst[1] * pSecond[2] - pFirst[2] * pSecond[1];
+        const float y = pFirst[3] * pSecond[1] - pFirst[0] * pSecond[2] + pFirst[1] * pSecond[3] + pFirst[2] * pSecond[0];
+        const float z = pFirst[3] * pSecond[2] + pFirst[0] * pSecond[1] - pFirst[1] * pSecond[0] + pFirst[2] * pSecond[3];
+        const float w = pFirst[3] * pSecond[3] - pFirst[0] * pSecond[0] - pFirst[1] * pSecond[1] - pFirst[2] * pSecond[2];
+
+        pResult[0] = x;
+        pResult[1] = y;
+        pResult[2] = z;
+        pResult[3] = w;
+    #endif
+}
+//---------------------------------------------------------------------------
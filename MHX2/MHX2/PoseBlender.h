@@ -0,0 +1,216 @@
+/****************************************************************************
+ * ==> PoseBlender ---------------------------------------------------------*
+ ****************************************************************************
+ * Description : Animation layers blending, on flat local poses             *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <vector>
+#include <string>
+
+// classes
+#include "Model.h"
+#include "AnimationSampler.h"
+
+/**
+* Pose blender, evaluates a stack of animation layers into a single local pose. Each layer samples an animation set,
+* then is blended over the result of the previous layers, either by overriding it (e.g. a crossfade between 2
+* animations) or by adding its difference to the bind pose (e.g. a facial expression over a body animation). A mask
+* may restrict a layer to some bones. The poses are blended as rotations, positions and scales, and all the memory is
+* allocated when the layers are created
+*@author Jean-Milost Reymond
+*/
+class PoseBlender
+{
+    public:
+        /**
+        * Bone mask, contains a weight for each bone, in the same order as the model bone table
+        */
+        typedef std::vector<float> IMask;
+
+        /**
+        * Blend mode
+        */
+        enum class IEBlendMode
+        {
+            IE_BM_Override = 0, // the layer pose is interpolated with the previous layers result
+            IE_BM_Additive      // the layer pose difference to the bind pose is added to the previous layers result
+        };
+
+        /**
+        * Animation layer
+        */
+        struct ILayer
+        {
+                  int         m_AnimSetIndex; // animation set to sample, the bind pose is used if invalid
+                  double      m_ElapsedTime;  // elapsed time in seconds
+                  float       m_Weight;       // layer weight, between 0.0f (disabled) and 1.0f
+                  IEBlendMode m_Mode;         // blend mode
+            const IMask*      m_pMask;        // bone mask, the layer applies on all the bones if nullptr. Not owned
+
+            ILayer();
+            ~ILayer();
+        };
+
+        PoseBlender();
+        virtual ~PoseBlender();
+
+        /**
+        * Creates the layers
+        *@param model - model to animate
+        *@param count - layer count
+        *@return true on success, otherwise false
+        *@note The layers are reset, and all the memory the evaluation requires is allocated. The bone table should
+        *      be built before this function is called, and the model should remain valid while the layers are
+        *      evaluated
+        */
+        virtual bool SetLayerCount(const Model& model, std::size_t count);
+
+        /**
+        * Gets the layer count
+        *@return the layer count
+        */
+        virtual std::size_t GetLayerCount() const;
+
+        /**
+        * Gets a layer
+        *@param index - layer index, the layers are blended in their index order
+        *@return the layer, nullptr if not found
+        */
+        virtual ILayer* GetLayer(std::size_t index);
+
+        /**
+        * Evaluates the layers
+        *@param[out] localPose - local bone matrices, in the same order as the model bone table
+        *@return true on success, otherwise false
+        *@note The layers start from the bind pose, thus the first layer should override it with a 1.0f weight
+        */
+        virtual bool Evaluate(Model::IMatrices& localPose);
+
+        /**
+        * Builds a mask applying to a bone and to all its children
+        *@param model - model owning the bone
+        *@param boneName - root bone name of the masked bones
+        *@param[in, out] mask - mask to update, resized to the bone count and filled with 0.0f if its size differs
+        *@return true on success, otherwise false
+        */
+        static bool BuildMask(const Model& model, const std::string& boneName, IMask& mask);
+
+    private:
+        /**
+        * Decomposed pose, each bone uses 4 values in each table, thus it may be blended by SIMD instructions
+        */
+        struct IPose
+        {
+            typedef std::vector<float> IValues;
+
+            IValues m_Rotations; // bone rotations, in x, y, z, w order
+            IValues m_Positions; // bone positions, the last value is unused
+            IValues m_Scales;    // bone scales, the last value is unused
+
+            IPose();
+            ~IPose();
+
+            /**
+            * Resizes the pose
+            *@param boneCount - bone count
+            */
+            void Resize(std::size_t boneCount);
+        };
+
+        /**
+        * Layer data
+        */
+        struct ILayerData
+        {
+            ILayer           m_Layer;     // layer parameters
+            AnimationSampler m_Sampler;   // layer animation sampler, keeps its cursors between the evaluations
+            Model::IMatrices m_LocalPose; // sampled local pose
+
+            ILayerData();
+            ~ILayerData();
+        };
+
+        typedef std::vector<ILayerData> ILayers;
+        typedef std::vector<float>      IWeights;
+
+        const Model*   m_pModel;
+              ILayers  m_Layers;
+              IPose    m_BindPose;
+              IPose    m_LayerPose;
+              IPose    m_Result;
+              IWeights m_Weights;
+              IWeights m_InvBindScales;
+
+        /**
+        * Decomposes local matrices into a pose
+        *@param localPose - local bone matrices
+        *@param[out] pose - decomposed pose
+        */
+        static void Decompose(const Model::IMatrices& localPose, IPose& pose);
+
+        /**
+        * Composes a pose into local matrices
+        *@param pose - decomposed pose
+        *@param[out] localPose - local bone matrices
+        */
+        static void Compose(const IPose& pose, Model::IMatrices& localPose);
+
+        /**
+        * Blends a pose over a result, by interpolation
+        *@param pose - pose to blend
+        *@param pWeights - weight of each bone
+        *@param boneCount - bone count
+        *@param[in, out] result - result to blend over
+        */
+        static void BlendOverride(const IPose& pose, const float* pWeights, std::size_t boneCount, IPose& result);
+
+        /**
+        * Blends a pose over a result, by adding its difference to a reference pose
+        *@param pose - pose to blend
+        *@param reference - reference pose, i.e. the pose which adds nothing
+        *@param pInvScales - reference pose inverted scales, 4 values per bone
+        *@param pWeights - weight of each bone
+        *@param boneCount - bone count
+        *@param[in, out] result - result to blend over
+        */
+        static void BlendAdditive(const IPose&      pose,
+                                  const IPose&      reference,
+                                  const float*      pInvScales,
+                                  const float*      pWeights,
+                                        std::size_t boneCount,
+                                        IPose&      result);
+
+        /**
+        * Multiplies 2 rotations
+        *@param pFirst - first rotation, in x, y, z, w order
+        *@param pSecond - second rotation, in x, y, z, w order
+        *@param[out] pResult - resulting rotation, in x, y, z, w order, may be one of the multiplied rotations
+        *@note The result is the same as QuaternionF::Multiply(), the first rotation being the multiplied one
+        */
+        static void MultiplyRotations(const float* pFirst, const float* pSecond, float* pResult);
+};
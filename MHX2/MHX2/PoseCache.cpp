@@ -0,0 +1,259 @@
+/****************************************************************************
+ * ==> PoseCache -----------------------------------------------------------*
+ ****************************************************************************
+ * Description : Pose cache shared by the instances of a frame              *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "PoseCache.h"
+
+// std
+#include <cmath>
+#include <functional>
+
+//---------------------------------------------------------------------------
+// PoseCache::IPose
+//---------------------------------------------------------------------------
+PoseCache::IPose::IPose()
+{}
+//---------------------------------------------------------------------------
+PoseCache::IPose::~IPose()
+{}
+//---------------------------------------------------------------------------
+// PoseCache::IKey
+//---------------------------------------------------------------------------
+PoseCache::IKey::IKey() :
+    m_pModel(nullptr),
+    m_AnimSetIndex(-1),
+    m_Time(0)
+{}
+//---------------------------------------------------------------------------
+PoseCache::IKey::IKey(const Model* pModel, int animSetIndex, long long time) :
+    m_pModel(pModel),
+    m_AnimSetIndex(animSetIndex),
+    m_Time(time)
+{}
+//---------------------------------------------------------------------------
+PoseCache::IKey::~IKey()
+{}
+//---------------------------------------------------------------------------
+bool PoseCache::IKey::operator < (const IKey& other) const
+{
+    if (m_pModel != other.m_pModel)
+        return std::less<const Model*>()(m_pModel, other.m_pModel);
+
+    if (m_AnimSetIndex != other.m_AnimSetIndex)
+        return m_AnimSetIndex < other.m_AnimSetIndex;
+
+    return m_Time < other.m_Time;
+}
+//---------------------------------------------------------------------------
+// PoseCache
+//---------------------------------------------------------------------------
+PoseCache::PoseCache() :
+    m_PoolUsed(0),
+    m_Hits(0),
+    m_Misses(0),
+    m_TimeStep(0.0)
+{}
+//---------------------------------------------------------------------------
+PoseCache::~PoseCache()
+{}
+//---------------------------------------------------------------------------
+void PoseCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Poses.clear();
+    m_Pool.clear();
+    m_Samplers.clear();
+
+    m_PoolUsed = 0;
+}
+//---------------------------------------------------------------------------
+void PoseCache::SetTimeStep(double timeStep)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    // the quantized times change, thus the cached poses can no longer be found
+    m_Poses.clear();
+
+    m_PoolUsed = 0;
+    m_TimeStep = (timeStep > 0.0) ? timeStep : 0.0;
+}
+//---------------------------------------------------------------------------
+void PoseCache::BeginFrame()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Poses.clear();
+
+    m_PoolUsed = 0;
+}
+//---------------------------------------------------------------------------
+const PoseCache::IPose* PoseCache::GetPose(const Model& model, int animSetIndex, double elapsedTime)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    long long quantizedTime;
+    double    sampleTime;
+
+    // invalid animation set?
+    if (!Quantize(model, animSetIndex, elapsedTime, quantizedTime, sampleTime))
+        return nullptr;
+
+    const IKey key(&model, animSetIndex, quantizedTime);
+
+    // already cached?
+    IPoses::const_iterator it = m_Poses.find(key);
+
+    if (it != m_Poses.end())
+    {
+        ++m_Hits;
+        return it->second;
+    }
+
+    ++m_Misses;
+
+    // reuse the pose memory of the previous frames
+    if (m_PoolUsed == m_Pool.size())
+        m_Pool.push_back(std::unique_ptr<IPose>(new IPose()));
+
+    IPose* pPose = m_Pool[m_PoolUsed++].get();
+
+    BuildPose(model, animSetIndex, sampleTime, *pPose);
+
+    m_Poses[key] = pPose;
+
+    return pPose;
+}
+//---------------------------------------------------------------------------
+bool PoseCache::GetSampleTime(const Model& model, int animSetIndex, double elapsedTime, double& sampleTime) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    long long quantizedTime;
+
+    return Quantize(model, animSetIndex, elapsedTime, quantizedTime, sampleTime);
+}
+//---------------------------------------------------------------------------
+std::size_t PoseCache::GetHits() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Hits;
+}
+//---------------------------------------------------------------------------
+std::size_t PoseCache::GetMisses() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Misses;
+}
+//---------------------------------------------------------------------------
+double PoseCache::GetHitRate() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    const std::size_t count = m_Hits + m_Misses;
+
+    return count ? double(m_Hits) / double(count) : 0.0;
+}
+//---------------------------------------------------------------------------
+void PoseCache::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Hits   = 0;
+    m_Misses = 0;
+}
+//---------------------------------------------------------------------------
+bool PoseCache::Quantize(const Model&     model,
+                               int        animSetIndex,
+                               double     elapsedTime,
+                               long long& quantizedTime,
+                               double&    sampleTime) const
+{
+    // invalid animation set?
+    if (animSetIndex < 0 || std::size_t(animSetIndex) >= model.m_AnimationSet.size())
+        return false;
+
+    const Model::IAnimationSet* pAnimSet = model.m_AnimationSet[animSetIndex];
+
+    if (!pAnimSet)
+        return false;
+
+    // loop the time on the animation duration, thus all the loops share the same poses
+    const double ticksPerSecond = double(AnimationSampler::m_TicksPerSecond);
+    const double time           = AnimationSampler::GetTime(*pAnimSet, elapsedTime);
+
+    // quantize the time, the pose is sampled at the beginning of its time step
+    if (m_TimeStep > 0.0)
+    {
+        quantizedTime = (long long)std::floor(time / (m_TimeStep * ticksPerSecond));
+        sampleTime    = double(quantizedTime) * m_TimeStep;
+    }
+    else
+    {
+        quantizedTime = (long long)std::floor(time + 0.5);
+
+        // a time rounded up to the animation end loops to its beginning
+        if (quantizedTime >= pAnimSet->m_MaxValue)
+            quantizedTime = 0;
+
+        // the pose is sampled at the key time, thus it only depends on the key
+        sampleTime = double(quantizedTime) / ticksPerSecond;
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+void PoseCache::BuildPose(const Model& model, int animSetIndex, double elapsedTime, IPose& pose)
+{
+    const Model::IBoneTable& boneTable = model.m_BoneTable;
+
+    // each animation set keeps its own sampler, thus its cursors remain valid between the frames
+    std::unique_ptr<AnimationSampler>& pSampler = m_Samplers[IKey(&model, animSetIndex, 0)];
+
+    if (!pSampler)
+        pSampler.reset(new AnimationSampler());
+
+    // sample the animation set, the bind pose is used on error
+    if (!pSampler->Sample(model, animSetIndex, elapsedTime, pose.m_LocalPose))
+        pose.m_LocalPose = boneTable.m_Local;
+
+    model.GetGlobalPose(pose.m_LocalPose, pose.m_GlobalPose);
+
+    const std::size_t boneCount = pose.m_GlobalPose.size();
+
+    pose.m_Palette.resize(boneCount);
+
+    for (std::size_t i = 0; i < boneCount; ++i)
+        pose.m_Palette[i] = boneTable.m_InverseBind[i].Multiply(pose.m_GlobalPose[i]);
+
+    // build the palette the skinning method requires
+    if (model.m_DQSkinning)
+        SkinningHelper::BuildDQPalette(pose.m_Palette, pose.m_SkinPalette);
+    else
+        SkinningHelper::BuildPalette(pose.m_Palette, pose.m_SkinPalette);
+}
+//---------------------------------------------------------------------------
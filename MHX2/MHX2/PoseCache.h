@@ -0,0 +1,183 @@
+/****************************************************************************
+ * ==> PoseCache -----------------------------------------------------------*
+ ****************************************************************************
+ * Description : Pose cache shared by the instances of a frame              *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// classes
+#include "Model.h"
+#include "AnimationSampler.h"
+#include "SkinningHelper.h"
+
+/**
+* Pose cache, shared by the instances updated during a frame. A pose is sampled and its palette is calculated only
+* once for each model, animation set and quantized time, then copied to all the instances playing the same animation
+* at the same time. The elapsed time may be quantized, thus the instances playing close times share the same pose
+*@author Jean-Milost Reymond
+*/
+class PoseCache
+{
+    public:
+        /**
+        * Cached pose
+        */
+        struct IPose
+        {
+            Model::IMatrices         m_LocalPose;   // local bone matrices, in the same order as the model bone table
+            Model::IMatrices         m_GlobalPose;  // global bone matrices, in the same order
+            Model::IMatrices         m_Palette;     // matrix palette (inverse bind * global pose), in the same order
+            SkinningHelper::IPalette m_SkinPalette; // palette the skinning method of the model requires
+
+            IPose();
+            ~IPose();
+        };
+
+        PoseCache();
+        virtual ~PoseCache();
+
+        /**
+        * Clears the cache, and releases its memory
+        */
+        virtual void Clear();
+
+        /**
+        * Sets the time quantization step
+        *@param timeStep - time step in seconds, the time is only rounded to the animation key time stamps if 0.0
+        *@note E.g. a 1/30 step shares the poses between all the instances playing the same animation frame at 30 fps
+        */
+        virtual void SetTimeStep(double timeStep);
+
+        /**
+        * Starts a new frame, i.e. forgets the poses cached by the previous one
+        *@note The memory is kept for the next poses. Shouldn't be called while an instance is updated
+        */
+        virtual void BeginFrame();
+
+        /**
+        * Gets a pose, samples and caches it if not already cached
+        *@param model - model owning the animation set
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds
+        *@return the pose, nullptr on error
+        *@note The pose remains valid until the next frame begins. This function is thread safe
+        */
+        virtual const IPose* GetPose(const Model& model, int animSetIndex, double elapsedTime);
+
+        /**
+        * Gets the time at which the pose matching an elapsed time is sampled
+        *@param model - model owning the animation set
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds
+        *@param[out] sampleTime - sample time in seconds, looped on the animation set duration and quantized
+        *@return true on success, false if the animation set is invalid
+        *@note Two elapsed times sharing the same sample time share the same pose. This function is thread safe
+        */
+        virtual bool GetSampleTime(const Model& model, int animSetIndex, double elapsedTime, double& sampleTime) const;
+
+        /**
+        * Gets the hit count, i.e. the requested poses which were already cached
+        *@return the hit count
+        */
+        virtual std::size_t GetHits() const;
+
+        /**
+        * Gets the miss count, i.e. the requested poses which were sampled
+        *@return the miss count
+        */
+        virtual std::size_t GetMisses() const;
+
+        /**
+        * Gets the hit rate
+        *@return the hit rate, between 0.0 and 1.0
+        */
+        virtual double GetHitRate() const;
+
+        /**
+        * Resets the hit and miss counts
+        */
+        virtual void ResetStats();
+
+    private:
+        /**
+        * Pose key
+        */
+        struct IKey
+        {
+            const Model*    m_pModel;       // model owning the animation set
+                  int       m_AnimSetIndex; // animation set index
+                  long long m_Time;         // quantized time, in time steps, or in animation key time stamps
+
+            IKey();
+            IKey(const Model* pModel, int animSetIndex, long long time);
+            ~IKey();
+
+            bool operator < (const IKey& other) const;
+        };
+
+        typedef std::map<IKey, IPose*>                            IPoses;
+        typedef std::vector<std::unique_ptr<IPose>>               IPosePool;
+        typedef std::map<IKey, std::unique_ptr<AnimationSampler>> ISamplers;
+
+        IPoses             m_Poses;
+        IPosePool          m_Pool;
+        ISamplers          m_Samplers;
+        std::size_t        m_PoolUsed;
+        std::size_t        m_Hits;
+        std::size_t        m_Misses;
+        double             m_TimeStep;
+        mutable std::mutex m_Mutex;
+
+        /**
+        * Quantizes an elapsed time, the cache should be locked
+        *@param model - model owning the animation set
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds
+        *@param[out] quantizedTime - quantized time, in time steps, or in animation key time stamps
+        *@param[out] sampleTime - time at which the pose is sampled, in seconds
+        *@return true on success, false if the animation set is invalid
+        */
+        bool Quantize(const Model&     model,
+                            int        animSetIndex,
+                            double     elapsedTime,
+                            long long& quantizedTime,
+                            double&    sampleTime) const;
+
+        /**
+        * Samples a pose and calculates its palettes
+        *@param model - model owning the animation set
+        *@param animSetIndex - animation set index
+        *@param elapsedTime - elapsed time in seconds
+        *@param[out] pose - pose
+        */
+        void BuildPose(const Model& model, int animSetIndex, double elapsedTime, IPose& pose);
+};
@@ -30,6 +30,7 @@
 
 // std
 #include <algorithm>
+#include <type_traits>
 
 // retrograde engine
 #include "Vector3.h"
@@ -63,16 +64,16 @@ class Quaternion
         * Copy constructor
         *@param other - other quaternion to copy from
         */
-        inline Quaternion(const Quaternion& other);
+        Quaternion(const Quaternion& other) = default;
 
-        virtual ~Quaternion();
+        ~Quaternion() = default;
 
         /**
         * Copy operator
         *@param other - other vector to copy from
         *@return this vector
         */
-        virtual inline Quaternion& operator = (const Quaternion& other);
+        Quaternion& operator = (const Quaternion& other) = default;
 
         /**
         * Negation operator
@@ -80,33 +81,33 @@ class Quaternion
         *@note BE CAREFUL This is a mathematical inversion, to invert the quaternion,
         *      use the Inverse() function insetad
         */
-        virtual inline Quaternion operator - () const;
+        inline Quaternion operator - () const;
 
         /**
         * Equality operator
         *@param value - value to compare
         *@return true if values are identical, otherwise false
         */
-        virtual inline bool operator == (const Quaternion& value) const;
+        inline bool operator == (const Quaternion& value) const;
 
         /**
         * Not equality operator
         *@param value - value to compare
         *@return true if values are not identical, otherwise false
         */
-        virtual inline bool operator != (const Quaternion& value) const;
+        inline bool operator != (const Quaternion& value) const;
 
         /**
         * Initializes the quaternion to its identity value
         */
-        virtual inline Quaternion Identity() const;
+        inline Quaternion Identity() const;
 
         /**
         * Builds the quaternion from an angle and a vector representing a rotation axis
         *@param angle - rotation angle
         *@param pAxis - rotation axis
         */
-        virtual inline void FromAxis(T angle, const Vector3<T>& axis);
+        inline void FromAxis(T angle, const Vector3<T>& axis);
 
         /**
         * Builds the quaternion from Euler angles
@@ -114,7 +115,7 @@ class Quaternion
         *@param angleY - rotation angle on y axis
         *@param angleZ - rotation angle on z axis
         */
-        virtual inline void FromEuler(T angleX, T angleY, T angleZ);
+        inline void FromEuler(T angleX, T angleY, T angleZ);
 
         /**
         * Builds the quaternion from a pitch, yaw and roll angles
@@ -122,64 +123,64 @@ class Quaternion
         *@param yaw - the yaw angle in radians, yaw is comparable to a head left/right movement
         *@param roll - the roll angle in radians, roll is comparable to an aircraft rolling movement
         */
-        virtual inline void FromPitchYawRoll(T pitch, T yaw, T roll);
+        inline void FromPitchYawRoll(T pitch, T yaw, T roll);
 
         /**
         * Gets the quaternion squared length
         *@return the quaternion squared length
         */
-        virtual inline T LengthSquared() const;
+        inline T LengthSquared() const;
 
         /**
         * Gets the quaternion length
         *@return the quaternion length
         */
-        virtual inline T Length() const;
+        inline T Length() const;
 
         /**
         * Normalizes the quaternion
         */
-        virtual inline Quaternion Normalize() const;
+        inline Quaternion Normalize() const;
 
         /**
         * Calculates the dot product between 2 quaternions
         *@param other - other quaternion to dot with
         *@return the resulting angle
         */
-        virtual inline T Dot(const Quaternion& other) const;
+        inline T Dot(const Quaternion& other) const;
 
         /**
         * Scales a quaternion
         *@param s - scale factor
         *@return scaled quaternion
         */
-        virtual inline Quaternion Scale(T s) const;
+        inline Quaternion Scale(T s) const;
 
         /**
         * Conjugates the quaternion
         *@return conjugated quaternion
         */
-        virtual inline Quaternion Conjugate() const;
+        inline Quaternion Conjugate() const;
 
         /**
         * Multiplies a quaternion by another
         *@param other - other quaternion to multiply with
         *@param[out] pR - multiplied quaternion
         */
-        virtual inline Quaternion Multiply(const Quaternion& other) const;
+        inline Quaternion Multiply(const Quaternion& other) const;
 
         /**
         * Inverses the quaternion
         *@return inverted quaternion
         */
-        virtual inline Quaternion Inverse() const;
+        inline Quaternion Inverse() const;
 
         /**
         * Rotates a vector by the quaternion
         *@param vector - vector to rotate
         *@return rotated vector
         */
-        virtual inline Vector3<T> Rotate(const Vector3<T>& vector) const;
+        inline Vector3<T> Rotate(const Vector3<T>& vector) const;
 
         /**
         * Gets the spherical linear interpolated quaternion between 2 quaternions
@@ -188,7 +189,7 @@ class Quaternion
         *@param[out] error - if true, an error happened while the interpolation was calculated
         *@return the resulting spherical linear interpolated quaternion
         */
-        virtual inline Quaternion Slerp(const Quaternion& other, T p, bool& error) const;
+        inline Quaternion Slerp(const Quaternion& other, T p, bool& error) const;
 
         /**
         * Gets a quaternion from a matrix
@@ -196,18 +197,23 @@ class Quaternion
         *@param[out] error - if true, an error happened while the matrix was calculated
         *@return the quaternion
         */
-        virtual inline Quaternion FromMatrix(const Matrix4x4<T>& matrix, bool& error) const;
+        inline Quaternion FromMatrix(const Matrix4x4<T>& matrix, bool& error) const;
 
         /**
         * Gets a rotation matrix from the quaternion
         *@return the rotation matrix
         */
-        virtual inline Matrix4x4<T> ToMatrix() const;
+        inline Matrix4x4<T> ToMatrix() const;
 };
 
 typedef Quaternion<float>  QuaternionF;
 typedef Quaternion<double> QuaternionD;
 
+// the quaternions contain only their components, thus their arrays may be copied as raw memory
+static_assert(sizeof(QuaternionF)  == 4 * sizeof(float), "QuaternionF should contain only its components");
+static_assert(alignof(QuaternionF) == alignof(float),    "QuaternionF should be aligned as its components");
+static_assert(std::is_trivially_copyable<QuaternionF>::value, "QuaternionF should be trivially copyable");
+
 //---------------------------------------------------------------------------
 // Quaternion functions
 //---------------------------------------------------------------------------
@@ -227,29 +233,6 @@ Quaternion<T>::Quaternion(T x, T y, T z, T w) :
     m_W(w)
 {}
 //---------------------------------------------------------------------------
-template <class T>
-Quaternion<T>::Quaternion(const Quaternion& other) :
-    m_X(other.m_X),
-    m_Y(other.m_Y),
-    m_Z(other.m_Z),
-    m_W(other.m_W)
-{}
-//---------------------------------------------------------------------------
-template <class T>
-Quaternion<T>::~Quaternion()
-{}
-//---------------------------------------------------------------------------
-template<class T>
-Quaternion<T>& Quaternion<T>::operator = (const Quaternion& other)
-{
-    m_X = other.m_X;
-    m_Y = other.m_Y;
-    m_Z = other.m_Z;
-    m_W = other.m_W;
-
-    return *this;
-}
-//---------------------------------------------------------------------------
 template<class T>
 Quaternion<T> Quaternion<T>::operator - () const
 {
@@ -31,6 +31,7 @@
 // classes
 #include "Texture_OpenGL.h"
 #include "Shader_OpenGL.h"
+#include "VertexLayout.h"
 
 //---------------------------------------------------------------------------
 // Renderer_OpenGL
@@ -306,153 +307,15 @@ bool Renderer_OpenGL::Draw(const Mesh&       mesh,
                 case VertexCulling::IECullingFace::IE_CF_CCW: glFrontFace(GL_CCW); break;
             }
 
-            // configure the alpha blending
-            if (mesh.m_VB[i]->m_Material.m_Transparent)
-            {
-                if (disableDepthTestOnTransparency)
-                    glDisable(GL_DEPTH_TEST);
-
-                glEnable(GL_BLEND);
-                glBlendEquation(GL_FUNC_ADD);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            }
-            else
-                glDisable(GL_BLEND);
-
-            // configure the wireframe mode
-            if (mesh.m_VB[i]->m_Material.m_Wireframe)
-                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-            else
-                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-            // get shader position attribute
-            GLint posAttrib = GetAttribute(pShader, Shader::IEAttribute::IE_SA_Vertices);
+            IVBDrawer drawer;
+            drawer.m_pRenderer                      = this;
+            drawer.m_pVB                            = mesh.m_VB[i];
+            drawer.m_pShader                        = pShader;
+            drawer.m_DisableDepthTestOnTransparency = disableDepthTestOnTransparency;
 
-            // found it?
-            if (posAttrib == -1)
+            // bind and draw the vertex buffer, using the compile-time layout matching with its format
+            if (!VertexLayoutDispatcher::Dispatch(mesh.m_VB[i]->m_Format.m_Format, drawer))
                 return false;
-
-            // calculate stride. NOTE the vertex contains always at least 3 values for the x, y and z coordinates
-            std::size_t stride       =  3;
-            GLint       normalAttrib = -1;
-
-            // do use shader normal attribute?
-            if ((unsigned)mesh.m_VB[i]->m_Format.m_Format & (unsigned)VertexFormat::IEFormat::IE_VF_Normals)
-            {
-                // get shader normal attribute
-                normalAttrib = GetAttribute(pShader, Shader::IEAttribute::IE_SA_Normal);
-
-                // found it?
-                if (normalAttrib == -1)
-                    return false;
-
-                stride += 3;
-            }
-
-            GLint uvAttrib = -1;
-
-            // do use shader UV attribute?
-            if ((unsigned)mesh.m_VB[i]->m_Format.m_Format & (unsigned)VertexFormat::IEFormat::IE_VF_TexCoords)
-            {
-                // get shader UV attribute
-                uvAttrib = GetAttribute(pShader, Shader::IEAttribute::IE_SA_Texture);
-
-                // found it?
-                if (uvAttrib == -1)
-                    return false;
-
-                // add texture coordinates to stride
-                stride += 2;
-            }
-
-            GLint colorAttrib = -1;
-
-            // do use shader color attribute?
-            if ((unsigned)mesh.m_VB[i]->m_Format.m_Format & (unsigned)VertexFormat::IEFormat::IE_VF_Colors)
-            {
-                // get shader color attribute
-                colorAttrib = GetAttribute(pShader, Shader::IEAttribute::IE_SA_Color);
-
-                // found it?
-                if (colorAttrib == -1)
-                    return false;
-
-                // add color to stride
-                stride += 4;
-            }
-
-            // select the texture to apply
-            SelectTexture(pShader, mesh.m_VB[i]->m_Material.m_pTexture);
-
-            std::size_t offset = 0;
-
-            // connect vertices to vertex shader position attribute
-            glEnableVertexAttribArray(posAttrib);
-            glVertexAttribPointer(posAttrib,
-                                  3,
-                                  GL_FLOAT,
-                                  GL_FALSE,
-                                  (GLsizei)(stride * sizeof(float)),
-                                  &mesh.m_VB[i]->m_Data[offset]);
-
-            offset = 3;
-
-            // vertex buffer contains normals?
-            if (normalAttrib != -1)
-            {
-                // connect the vertices to the vertex shader normal attribute
-                glEnableVertexAttribArray(normalAttrib);
-                glVertexAttribPointer(normalAttrib,
-                                      3,
-                                      GL_FLOAT,
-                                      GL_FALSE,
-                                      (GLsizei)(stride * sizeof(float)),
-                                      &mesh.m_VB[i]->m_Data[offset]);
-
-                offset += 3;
-            }
-
-            // vertex buffer contains texture coordinates?
-            if (uvAttrib != -1)
-            {
-                // connect the color to the vertex shader vColor attribute and redirect to
-                // the fragment shader
-                glEnableVertexAttribArray(uvAttrib);
-                glVertexAttribPointer(uvAttrib,
-                                      2,
-                                      GL_FLOAT,
-                                      GL_FALSE,
-                                      (GLsizei)(stride * sizeof(float)),
-                                      &mesh.m_VB[i]->m_Data[offset]);
-
-                offset += 2;
-            }
-
-            // vertex buffer contains colors?
-            if (colorAttrib != -1)
-            {
-                // connect the color to the vertex shader vColor attribute and redirect to
-                // the fragment shader
-                glEnableVertexAttribArray(colorAttrib);
-                glVertexAttribPointer(colorAttrib,
-                                      4,
-                                      GL_FLOAT,
-                                      GL_FALSE,
-                                      (GLsizei)(stride * sizeof(float)),
-                                      &mesh.m_VB[i]->m_Data[offset]);
-            }
-
-            // draw mesh
-            switch (mesh.m_VB[i]->m_Format.m_Type)
-            {
-                case VertexFormat::IEType::IE_VT_Triangles:     glDrawArrays(GL_TRIANGLES,      0, (GLsizei)(mesh.m_VB[i]->m_Data.size() / stride)); break;
-                case VertexFormat::IEType::IE_VT_TriangleStrip: glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei)(mesh.m_VB[i]->m_Data.size() / stride)); break;
-                case VertexFormat::IEType::IE_VT_TriangleFan:   glDrawArrays(GL_TRIANGLE_FAN,   0, (GLsizei)(mesh.m_VB[i]->m_Data.size() / stride)); break;
-                case VertexFormat::IEType::IE_VT_Quads:         glDrawArrays(GL_QUADS,          0, (GLsizei)(mesh.m_VB[i]->m_Data.size() / stride)); break;
-                case VertexFormat::IEType::IE_VT_QuadStrip:     glDrawArrays(GL_QUAD_STRIP,     0, (GLsizei)(mesh.m_VB[i]->m_Data.size() / stride)); break;
-                case VertexFormat::IEType::IE_VT_Unknown:
-                default:                                        throw new std::exception("Unknown vertex type");
-            }
         }
     }
     catch (...)
@@ -594,3 +457,235 @@ int Renderer_OpenGL::GetAttribute(const Shader* pShader, Shader::IEAttribute att
     return glGetAttribLocation((GLuint)pShader->GetProgramID(), propertyName.c_str());
 }
 //---------------------------------------------------------------------------
+void Renderer_OpenGL::SelectMaterial(const Material& material,
+                                     const Shader*   pShader,
+                                           bool      disableDepthTestOnTransparency) const
+{
+    // configure the alpha blending
+    if (material.m_Transparent)
+    {
+        if (disableDepthTestOnTransparency)
+            glDisable(GL_DEPTH_TEST);
+
+        glEnable(GL_BLEND);
+        glBlendEquation(GL_FUNC_ADD);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    else
+        glDisable(GL_BLEND);
+
+    // configure the wireframe mode
+    if (material.m_Wireframe)
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    else
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    // select the texture to apply
+    SelectTexture(pShader, material.m_pTexture);
+}
+//---------------------------------------------------------------------------
+// Renderer_OpenGL::IVBDrawer
+//---------------------------------------------------------------------------
+Renderer_OpenGL::IVBDrawer::IVBDrawer() :
+    m_pRenderer(nullptr),
+    m_pVB(nullptr),
+    m_pShader(nullptr),
+    m_DisableDepthTestOnTransparency(false)
+{}
+//---------------------------------------------------------------------------
+Renderer_OpenGL::IVBDrawer::~IVBDrawer()
+{}
+//---------------------------------------------------------------------------
+template <class TLayout>
+bool Renderer_OpenGL::IVBDrawer::Visit()
+{
+    // vertex buffer doesn't match with its format?
+    if (m_pVB->m_Format.m_Stride && m_pVB->m_Format.m_Stride != TLayout::m_Stride)
+        return false;
+
+    // get shader position attribute
+    const GLint posAttrib = GetAttribute(m_pShader, Shader::IEAttribute::IE_SA_Vertices);
+
+    // found it?
+    if (posAttrib == -1)
+        return false;
+
+    GLint normalAttrib = -1;
+
+    // do use shader normal attribute?
+    if (TLayout::m_HasNormals)
+    {
+        // get shader normal attribute
+        normalAttrib = GetAttribute(m_pShader, Shader::IEAttribute::IE_SA_Normal);
+
+        // found it?
+        if (normalAttrib == -1)
+            return false;
+    }
+
+    GLint uvAttrib = -1;
+
+    // do use shader UV attribute?
+    if (TLayout::m_HasTexCoords)
+    {
+        // get shader UV attribute
+        uvAttrib = GetAttribute(m_pShader, Shader::IEAttribute::IE_SA_Texture);
+
+        // found it?
+        if (uvAttrib == -1)
+            return false;
+    }
+
+    GLint colorAttrib = -1;
+
+    // do use shader color attribute?
+    if (TLayout::m_HasColors)
+    {
+        // get shader color attribute
+        colorAttrib = GetAttribute(m_pShader, Shader::IEAttribute::IE_SA_Color);
+
+        // found it?
+        if (colorAttrib == -1)
+            return false;
+    }
+
+    const float* pPositions = nullptr;
+    const float* pNormals   = nullptr;
+    const float* pUVs       = nullptr;
+    const float* pColors    = nullptr;
+    GLsizei      stride     = 0;
+
+    // the material, the draw ranges and the data missing in the buffer are read from its source, if any
+    const VertexBuffer* pShared = m_pVB->m_pSource ? m_pVB->m_pSource : m_pVB;
+
+    // get the vertex data. In planar storage each stream is bound separately and is tightly packed
+    if (m_pVB->m_Format.m_Storage == VertexFormat::IEStorage::IE_VS_Planar)
+    {
+        const VertexBuffer::IStreams& own    = m_pVB->m_Streams;
+        const VertexBuffer::IStreams& shared = pShared->m_Streams;
+
+        const VertexBuffer::IData& positions = own.m_Positions.empty() ? shared.m_Positions : own.m_Positions;
+        const VertexBuffer::IData& normals   = own.m_Normals.empty()   ? shared.m_Normals   : own.m_Normals;
+        const VertexBuffer::IData& texCoords = own.m_TexCoords.empty() ? shared.m_TexCoords : own.m_TexCoords;
+        const VertexBuffer::IData& colors    = own.m_Colors.empty()    ? shared.m_Colors    : own.m_Colors;
+
+        // nothing to draw?
+        if (positions.empty())
+            return true;
+
+        // malformed streams?
+        if ((TLayout::m_HasNormals   && normals.empty())   ||
+            (TLayout::m_HasTexCoords && texCoords.empty()) ||
+            (TLayout::m_HasColors    && colors.empty()))
+            return false;
+
+        pPositions = &positions[0];
+        pNormals   = TLayout::m_HasNormals   ? &normals[0]   : nullptr;
+        pUVs       = TLayout::m_HasTexCoords ? &texCoords[0] : nullptr;
+        pColors    = TLayout::m_HasColors    ? &colors[0]    : nullptr;
+    }
+    else
+    {
+        const VertexBuffer::IData& data = m_pVB->m_Data.empty() ? pShared->m_Data : m_pVB->m_Data;
+
+        // nothing to draw?
+        if (data.empty())
+            return true;
+
+        pPositions = &data[0];
+        pNormals   = pPositions + TLayout::m_NormalOffset;
+        pUVs       = pPositions + TLayout::m_TexCoordOffset;
+        pColors    = pPositions + TLayout::m_ColorOffset;
+        stride     = (GLsizei)(TLayout::m_Stride * sizeof(float));
+    }
+
+    // connect vertices to vertex shader position attribute
+    glEnableVertexAttribArray(posAttrib);
+    glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, stride, pPositions);
+
+    // vertex buffer contains normals?
+    if (TLayout::m_HasNormals)
+    {
+        // connect the vertices to the vertex shader normal attribute
+        glEnableVertexAttribArray(normalAttrib);
+        glVertexAttribPointer(normalAttrib, 3, GL_FLOAT, GL_FALSE, stride, pNormals);
+    }
+
+    // vertex buffer contains texture coordinates?
+    if (TLayout::m_HasTexCoords)
+    {
+        // connect the texture coordinates to the vertex shader attribute
+        glEnableVertexAttribArray(uvAttrib);
+        glVertexAttribPointer(uvAttrib, 2, GL_FLOAT, GL_FALSE, stride, pUVs);
+    }
+
+    // vertex buffer contains colors?
+    if (TLayout::m_HasColors)
+    {
+        // connect the color to the vertex shader vColor attribute and redirect to
+        // the fragment shader
+        glEnableVertexAttribArray(colorAttrib);
+        glVertexAttribPointer(colorAttrib, 4, GL_FLOAT, GL_FALSE, stride, pColors);
+    }
+
+    // no draw range? Draw the whole buffer with its material
+    if (pShared->m_Ranges.empty())
+    {
+        m_pRenderer->SelectMaterial(pShared->m_Material, m_pShader, m_DisableDepthTestOnTransparency);
+        DrawArrays(0, pShared->GetVertexCount());
+        return true;
+    }
+
+    // draw each range with its own material, the vertex data remain bound
+    for (std::size_t i = 0; i < pShared->m_Ranges.size(); ++i)
+    {
+        m_pRenderer->SelectMaterial(pShared->m_Ranges[i]->m_Material, m_pShader, m_DisableDepthTestOnTransparency);
+        DrawArrays(pShared->m_Ranges[i]->m_Start, pShared->m_Ranges[i]->m_Count);
+    }
+
+    return true;
+}
+//---------------------------------------------------------------------------
+void Renderer_OpenGL::IVBDrawer::DrawArrays(std::size_t start, std::size_t count) const
+{
+    const VertexBuffer::ISpans& spans = m_pVB->m_Visible;
+
+    // whole range visible?
+    if (spans.empty())
+    {
+        DrawVisibleArrays(start, count);
+        return;
+    }
+
+    const std::size_t end = start + count;
+
+    // draw only the visible parts of the range
+    for (std::size_t i = 0; i < spans.size(); ++i)
+    {
+        const std::size_t spanEnd = spans[i].m_Start + spans[i].m_Count;
+        const std::size_t first   = spans[i].m_Start > start ? spans[i].m_Start : start;
+        const std::size_t last    = spanEnd < end ? spanEnd : end;
+
+        if (first < last)
+            DrawVisibleArrays(first, last - first);
+    }
+}
+//---------------------------------------------------------------------------
+void Renderer_OpenGL::IVBDrawer::DrawVisibleArrays(std::size_t start, std::size_t count) const
+{
+    const GLint   first       = (GLint)start;
+    const GLsizei vertexCount = (GLsizei)count;
+
+    // draw mesh
+    switch (m_pVB->m_Format.m_Type)
+    {
+        case VertexFormat::IEType::IE_VT_Triangles:     glDrawArrays(GL_TRIANGLES,      first, vertexCount); break;
+        case VertexFormat::IEType::IE_VT_TriangleStrip: glDrawArrays(GL_TRIANGLE_STRIP, first, vertexCount); break;
+        case VertexFormat::IEType::IE_VT_TriangleFan:   glDrawArrays(GL_TRIANGLE_FAN,   first, vertexCount); break;
+        case VertexFormat::IEType::IE_VT_Quads:         glDrawArrays(GL_QUADS,          first, vertexCount); break;
+        case VertexFormat::IEType::IE_VT_QuadStrip:     glDrawArrays(GL_QUAD_STRIP,     first, vertexCount); break;
+        case VertexFormat::IEType::IE_VT_Unknown:
+        default:                                        throw new std::exception("Unknown vertex type");
+    }
+}
+//---------------------------------------------------------------------------
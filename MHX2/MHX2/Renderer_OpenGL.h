@@ -208,6 +208,49 @@ class Renderer_OpenGL : public Renderer
         static GLint GetAttribute(const Shader* pShader, Shader::IEAttribute attribute);
 
     private:
+        /**
+        * Vertex buffer drawer, binds and draws a vertex buffer using the compile-time layout matching with its format
+        */
+        struct IVBDrawer
+        {
+            const Renderer_OpenGL* m_pRenderer;
+            const VertexBuffer*    m_pVB;
+            const Shader*          m_pShader;
+            bool                   m_DisableDepthTestOnTransparency;
+
+            IVBDrawer();
+            virtual ~IVBDrawer();
+
+            /**
+            * Binds and draws the vertex buffer
+            *@return true on success, otherwise false
+            */
+            template <class TLayout>
+            bool Visit();
+
+            /**
+            * Draws the visible part of a range of the bound vertex buffer
+            *@param start - first vertex to draw
+            *@param count - vertex count to draw
+            */
+            void DrawArrays(std::size_t start, std::size_t count) const;
+
+            /**
+            * Draws a visible range of the bound vertex buffer
+            *@param start - first vertex to draw
+            *@param count - vertex count to draw
+            */
+            void DrawVisibleArrays(std::size_t start, std::size_t count) const;
+        };
+
+        /**
+        * Selects a material to draw with
+        *@param material - material to select
+        *@param pShader - shader that will draw the material
+        *@param disableDepthTestOnTransparency - if true, the depth test will be disabled on transparent materials
+        */
+        void SelectMaterial(const Material& material, const Shader* pShader, bool disableDepthTestOnTransparency) const;
+
         HDC   m_hDC;
         HGLRC m_hRC;
 };
@@ -0,0 +1,842 @@
+/****************************************************************************
+ * ==> SkinningHelper ------------------------------------------------------*
+ ****************************************************************************
+ * Description : Linear blend skinning kernels, selected from the CPU       *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "SkinningHelper.h"
+
+// std
+#include <cmath>
+
+// classes
+#include "Quaternion.h"
+
+// the SIMD kernels are only available on x86 CPUs
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+    #define SKINNING_HELPER_X86
+
+    // std
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+    #include <immintrin.h>
+
+    // MSVC allows to use any instruction set intrinsic, other compilers require to enable it per function
+    #ifdef _MSC_VER
+        #define SKINNING_HELPER_TARGET(isa)
+    #else
+        #define SKINNING_HELPER_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#endif
+
+//---------------------------------------------------------------------------
+// SkinningHelper::ISkinData
+//---------------------------------------------------------------------------
+SkinningHelper::ISkinData::ISkinData() :
+    m_Method(IEMethod::IE_M_Linear),
+    m_pPalette(nullptr),
+    m_pBoneIndices(nullptr),
+    m_pWeights(nullptr),
+    m_pSrc(nullptr),
+    m_pDst(nullptr),
+    m_pSrcNormals(nullptr),
+    m_pDstNormals(nullptr),
+    m_SlotCount(0),
+    m_Stride(0),
+    m_NormalStride(0),
+    m_Count(0)
+{}
+//---------------------------------------------------------------------------
+SkinningHelper::ISkinData::~ISkinData()
+{}
+//---------------------------------------------------------------------------
+// SkinningHelper
+//---------------------------------------------------------------------------
+void SkinningHelper::BuildPalette(const Model::IMatrices& finalMatrices, IPalette& palette)
+{
+    const std::size_t count = finalMatrices.size();
+
+    palette.resize(count * 12);
+
+    for (std::size_t i = 0; i < count; ++i)
+        for (std::size_t j = 0; j < 4; ++j)
+        {
+            palette[i * 12 + j * 3]     = finalMatrices[i].m_Table[j][0];
+            palette[i * 12 + j * 3 + 1] = finalMatrices[i].m_Table[j][1];
+            palette[i * 12 + j * 3 + 2] = finalMatrices[i].m_Table[j][2];
+        }
+}
+//---------------------------------------------------------------------------
+void SkinningHelper::BuildDQPalette(const Model::IMatrices& finalMatrices, IPalette& palette)
+{
+    const std::size_t count = finalMatrices.size();
+
+    palette.resize(count * 8);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Matrix4x4F rotation = Matrix4x4F::Identity();
+
+        // extract the rotation, without scaling
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+            const Vector3F axis(finalMatrices[i].m_Table[j][0],
+                                finalMatrices[i].m_Table[j][1],
+                                finalMatrices[i].m_Table[j][2]);
+            const float    length = axis.Length();
+
+            if (!length)
+                continue;
+
+            rotation.m_Table[j][0] = axis.m_X / length;
+            rotation.m_Table[j][1] = axis.m_Y / length;
+            rotation.m_Table[j][2] = axis.m_Z / length;
+        }
+
+        bool        error = false;
+        QuaternionF real  = QuaternionF().FromMatrix(rotation, error);
+
+        // invalid rotation? Keep the translation only
+        if (error || !real.LengthSquared())
+            real = QuaternionF(0.0f, 0.0f, 0.0f, 1.0f);
+        else
+            real = real.Normalize();
+
+        // the dual part contains the translation, rotated by the real part (i.e. d = 0.5 * t * r)
+        const QuaternionF translation(finalMatrices[i].m_Table[3][0],
+                                      finalMatrices[i].m_Table[3][1],
+                                      finalMatrices[i].m_Table[3][2],
+                                      0.0f);
+        const QuaternionF dual = translation.Multiply(real).Scale(0.5f);
+
+        float* pDQ = &palette[i * 8];
+        pDQ[0]     = real.m_X;
+        pDQ[1]     = real.m_Y;
+        pDQ[2]     = real.m_Z;
+        pDQ[3]     = real.m_W;
+        pDQ[4]     = dual.m_X;
+        pDQ[5]     = dual.m_Y;
+        pDQ[6]     = dual.m_Z;
+        pDQ[7]     = dual.m_W;
+    }
+}
+//---------------------------------------------------------------------------
+SkinningHelper::IEKernel SkinningHelper::GetBestKernel()
+{
+    static const IEKernel kernel = DetectKernel();
+    return kernel;
+}
+//---------------------------------------------------------------------------
+bool SkinningHelper::IsSupported(IEKernel kernel)
+{
+    // each kernel requires a CPU supporting the previous ones
+    return ((int)kernel <= (int)GetBestKernel());
+}
+//---------------------------------------------------------------------------
+bool SkinningHelper::Skin(const ISkinData& data)
+{
+    return Skin(data, GetBestKernel());
+}
+//---------------------------------------------------------------------------
+bool SkinningHelper::Skin(const ISkinData& data, IEKernel kernel)
+{
+    // nothing to skin?
+    if (!data.m_Count)
+        return true;
+
+    // invalid data?
+    if (!data.m_pPalette || !data.m_pBoneIndices || !data.m_pWeights || !data.m_pSrc || !data.m_pDst)
+        return false;
+
+    if (!data.m_SlotCount || data.m_Stride < 3)
+        return false;
+
+    if (data.m_pSrcNormals && (!data.m_pDstNormals || data.m_NormalStride < 3))
+        return false;
+
+    // kernel not supported by the CPU?
+    if (!IsSupported(kernel))
+        return false;
+
+    // skin with dual quaternions. Each vertex is blended in its own registers, thus there is no remaining vertex
+    if (data.m_Method == IEMethod::IE_M_DualQuaternion)
+    {
+        switch (kernel)
+        {
+            case IEKernel::IE_K_SSE41:  SkinDQSSE41(data);  break;
+            case IEKernel::IE_K_AVX2:
+            case IEKernel::IE_K_AVX512: SkinDQAVX2(data);   break;
+            default:                    SkinDQScalar(data); break;
+        }
+
+        return true;
+    }
+
+    std::size_t start = 0;
+
+    switch (kernel)
+    {
+        case IEKernel::IE_K_SSE41:  start = SkinSSE41(data);  break;
+        case IEKernel::IE_K_AVX2:   start = SkinAVX2(data);   break;
+        case IEKernel::IE_K_AVX512: start = SkinAVX512(data); break;
+        default:                                              break;
+    }
+
+    // skin the remaining vertices
+    SkinScalar(data, start);
+
+    return true;
+}
+//---------------------------------------------------------------------------
+SkinningHelper::IEKernel SkinningHelper::DetectKernel()
+{
+    #ifdef SKINNING_HELPER_X86
+        int info[4] = {};
+
+        // get the highest supported function
+        #ifdef _MSC_VER
+            __cpuid(info, 0);
+        #else
+            __cpuid(0, info[0], info[1], info[2], info[3]);
+        #endif
+
+        const int maxFunction = info[0];
+
+        if (maxFunction < 1)
+            return IEKernel::IE_K_Scalar;
+
+        #ifdef _MSC_VER
+            __cpuid(info, 1);
+        #else
+            __cpuid(1, info[0], info[1], info[2], info[3]);
+        #endif
+
+        const bool sse41   = (info[2] & (1 << 19)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx     = (info[2] & (1 << 28)) != 0;
+
+        if (!sse41)
+            return IEKernel::IE_K_Scalar;
+
+        // the OS should save the AVX registers (XMM and YMM state)
+        if (!osxsave || !avx || maxFunction < 7)
+            return IEKernel::IE_K_SSE41;
+
+        unsigned long long xcr0 = 0;
+
+        #ifdef _MSC_VER
+            xcr0 = _xgetbv(0);
+        #else
+            unsigned eax = 0;
+            unsigned edx = 0;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            xcr0 = ((unsigned long long)edx << 32) | eax;
+        #endif
+
+        if ((xcr0 & 0x6) != 0x6)
+            return IEKernel::IE_K_SSE41;
+
+        #ifdef _MSC_VER
+            __cpuidex(info, 7, 0);
+        #else
+            __cpuid_count(7, 0, info[0], info[1], info[2], info[3]);
+        #endif
+
+        const bool avx2    = (info[1] & (1 << 5))  != 0;
+        const bool avx512f = (info[1] & (1 << 16)) != 0;
+
+        if (!avx2)
+            return IEKernel::IE_K_SSE41;
+
+        // the OS should also save the AVX-512 registers (opmask, ZMM0-15 upper halves and ZMM16-31 state)
+        if (!avx512f || (xcr0 & 0xE0) != 0xE0)
+            return IEKernel::IE_K_AVX2;
+
+        return IEKernel::IE_K_AVX512;
+    #else
+        return IEKernel::IE_K_Scalar;
+    #endif
+}
+//---------------------------------------------------------------------------
+void SkinningHelper::SkinScalar(const ISkinData& data, std::size_t start)
+{
+    const std::size_t slotCount    = data.m_SlotCount;
+    const std::size_t stride       = data.m_Stride;
+    const std::size_t normalStride = data.m_NormalStride;
+
+    for (std::size_t i = start; i < data.m_Count; ++i)
+    {
+        const unsigned short* pBoneIndices = &data.m_pBoneIndices[i * slotCount];
+        const float*          pWeights     = &data.m_pWeights[i * slotCount];
+        const float*          pSrc         = &data.m_pSrc[i * stride];
+              float*          pDst         = &data.m_pDst[i * stride];
+
+        float blend[12] = {};
+
+        // blend the matrices influencing the vertex
+        for (std::size_t j = 0; j < slotCount; ++j)
+        {
+            const float* pMatrix = &data.m_pPalette[pBoneIndices[j] * 12];
+            const float  weight  = pWeights[j];
+
+            for (std::size_t k = 0; k < 12; ++k)
+                blend[k] += pMatrix[k] * weight;
+        }
+
+        // apply the blended transformation to the bind pose vertex. A vertex without influence collapses to the origin
+        pDst[0] = pSrc[0] * blend[0] + pSrc[1] * blend[3] + pSrc[2] * blend[6] + blend[9];
+        pDst[1] = pSrc[0] * blend[1] + pSrc[1] * blend[4] + pSrc[2] * blend[7] + blend[10];
+        pDst[2] = pSrc[0] * blend[2] + pSrc[1] * blend[5] + pSrc[2] * blend[8] + blend[11];
+
+        // no normal to skin?
+        if (!data.m_pSrcNormals)
+            continue;
+
+        const float* pSrcNormal = &data.m_pSrcNormals[i * normalStride];
+              float* pDstNormal = &data.m_pDstNormals[i * normalStride];
+
+        // apply the blended rotation to the bind pose normal
+        const float x = pSrcNormal[0] * blend[0] + pSrcNormal[1] * blend[3] + pSrcNormal[2] * blend[6];
+        const float y = pSrcNormal[0] * blend[1] + pSrcNormal[1] * blend[4] + pSrcNormal[2] * blend[7];
+        const float z = pSrcNormal[0] * blend[2] + pSrcNormal[1] * blend[5] + pSrcNormal[2] * blend[8];
+
+        // renormalize it, the blended rotation may scale it
+        const float length = std::sqrt(x * x + y * y + z * z);
+
+        pDstNormal[0] = length > 0.0f ? x / length : x;
+        pDstNormal[1] = length > 0.0f ? y / length : y;
+        pDstNormal[2] = length > 0.0f ? z / length : z;
+    }
+}
+//---------------------------------------------------------------------------
+void SkinningHelper::SkinDQScalar(const ISkinData& data)
+{
+    const std::size_t slotCount    = data.m_SlotCount;
+    const std::size_t stride       = data.m_Stride;
+    const std::size_t normalStride = data.m_NormalStride;
+
+    for (std::size_t i = 0; i < data.m_Count; ++i)
+    {
+        const unsigned short* pBoneIndices = &data.m_pBoneIndices[i * slotCount];
+        const float*          pWeights     = &data.m_pWeights[i * slotCount];
+        const float*          pPivot       = &data.m_pPalette[pBoneIndices[0] * 8];
+
+        float blend[8] = {};
+
+        // blend the dual quaternions influencing the vertex
+        for (std::size_t j = 0; j < slotCount; ++j)
+        {
+            const float* pDQ    = &data.m_pPalette[pBoneIndices[j] * 8];
+            const float  weight = GetDQWeight(pDQ, pPivot, pWeights[j]);
+
+            for (std::size_t k = 0; k < 8; ++k)
+                blend[k] += pDQ[k] * weight;
+        }
+
+        TransformDQ(blend,
+                    &data.m_pSrc[i * stride],
+                    &data.m_pDst[i * stride],
+                    data.m_pSrcNormals ? &data.m_pSrcNormals[i * normalStride] : nullptr,
+                    data.m_pSrcNormals ? &data.m_pDstNormals[i * normalStride] : nullptr);
+    }
+}
+//---------------------------------------------------------------------------
+float SkinningHelper::GetDQWeight(const float* pDQ, const float* pPivot, float weight)
+{
+    const float dot = pDQ[0] * pPivot[0] + pDQ[1] * pPivot[1] + pDQ[2] * pPivot[2] + pDQ[3] * pPivot[3];
+    return (dot < 0.0f) ? -weight : weight;
+}
+//---------------------------------------------------------------------------
+void SkinningHelper::TransformDQ(const float* blend,
+                                 const float* pSrc,
+                                       float* pDst,
+                                 const float* pSrcNormal,
+                                       float* pDstNormal)
+{
+    const float length = std::sqrt(blend[0] * blend[0] + blend[1] * blend[1] + blend[2] * blend[2] + blend[3] * blend[3]);
+
+    // no influence? The vertex collapses to the origin, as with the linear blend skinning
+    if (!length)
+    {
+        pDst[0] = 0.0f;
+        pDst[1] = 0.0f;
+        pDst[2] = 0.0f;
+
+        if (pSrcNormal)
+        {
+            pDstNormal[0] = 0.0f;
+            pDstNormal[1] = 0.0f;
+            pDstNormal[2] = 0.0f;
+        }
+
+        return;
+    }
+
+    // normalize the blended dual quaternion
+    const float rX = blend[0] / length;
+    const float rY = blend[1] / length;
+    const float rZ = blend[2] / length;
+    const float rW = blend[3] / length;
+    const float dX = blend[4] / length;
+    const float dY = blend[5] / length;
+    const float dZ = blend[6] / length;
+    const float dW = blend[7] / length;
+
+    // get the translation (i.e. t = 2 * d * conjugate(r))
+    const float tX = 2.0f * (rW * dX - dW * rX + rY * dZ - rZ * dY);
+    const float tY = 2.0f * (rW * dY - dW * rY + rZ * dX - rX * dZ);
+    const float tZ = 2.0f * (rW * dZ - dW * rZ + rX * dY - rY * dX);
+
+    // rotate the position (i.e. v' = v + 2 * r.xyz x (r.xyz x v + r.w * v)) and translate it
+    const float cX = rY * pSrc[2] - rZ * pSrc[1] + rW * pSrc[0];
+    const float cY = rZ * pSrc[0] - rX * pSrc[2] + rW * pSrc[1];
+    const float cZ = rX * pSrc[1] - rY * pSrc[0] + rW * pSrc[2];
+
+    pDst[0] = pSrc[0] + 2.0f * (rY * cZ - rZ * cY) + tX;
+    pDst[1] = pSrc[1] + 2.0f * (rZ * cX - rX * cZ) + tY;
+    pDst[2] = pSrc[2] + 2.0f * (rX * cY - rY * cX) + tZ;
+
+    // no normal to skin?
+    if (!pSrcNormal)
+        return;
+
+    // rotate the normal, its length is kept
+    const float nX = rY * pSrcNormal[2] - rZ * pSrcNormal[1] + rW * pSrcNormal[0];
+    const float nY = rZ * pSrcNormal[0] - rX * pSrcNormal[2] + rW * pSrcNormal[1];
+    const float nZ = rX * pSrcNormal[1] - rY * pSrcNormal[0] + rW * pSrcNormal[2];
+
+    pDstNormal[0] = pSrcNormal[0] + 2.0f * (rY * nZ - rZ * nY);
+    pDstNormal[1] = pSrcNormal[1] + 2.0f * (rZ * nX - rX * nZ);
+    pDstNormal[2] = pSrcNormal[2] + 2.0f * (rX * nY - rY * nX);
+}
+//---------------------------------------------------------------------------
+#ifdef SKINNING_HELPER_X86
+SKINNING_HELPER_TARGET("sse4.1")
+std::size_t SkinningHelper::SkinSSE41(const ISkinData& data)
+{
+    const std::size_t slotCount    = data.m_SlotCount;
+    const std::size_t stride       = data.m_Stride;
+    const std::size_t normalStride = data.m_NormalStride;
+    const __m128i     matSize      = _mm_set1_epi32(12);
+    const __m128      zero         = _mm_setzero_ps();
+
+    std::size_t i = 0;
+
+    for (; i + 4 <= data.m_Count; i += 4)
+    {
+        const unsigned short* pBoneIndices = &data.m_pBoneIndices[i * slotCount];
+        const float*          pWeights     = &data.m_pWeights[i * slotCount];
+        const float*          pSrc         = &data.m_pSrc[i * stride];
+              float*          pDst         = &data.m_pDst[i * stride];
+
+        __m128 blend[12];
+
+        for (std::size_t k = 0; k < 12; ++k)
+            blend[k] = _mm_setzero_ps();
+
+        // blend the matrices influencing each vertex, one vertex per lane
+        for (std::size_t j = 0; j < slotCount; ++j)
+        {
+            const __m128i offsets = _mm_mullo_epi32(_mm_set_epi32(pBoneIndices[3 * slotCount + j],
+                                                                  pBoneIndices[2 * slotCount + j],
+                                                                  pBoneIndices[slotCount + j],
+                                                                  pBoneIndices[j]),
+                                                    matSize);
+            const __m128  weight  = _mm_set_ps(pWeights[3 * slotCount + j],
+                                               pWeights[2 * slotCount + j],
+                                               pWeights[slotCount + j],
+                                               pWeights[j]);
+
+            const float* pM0 = &data.m_pPalette[_mm_extract_epi32(offsets, 0)];
+            const float* pM1 = &data.m_pPalette[_mm_extract_epi32(offsets, 1)];
+            const float* pM2 = &data.m_pPalette[_mm_extract_epi32(offsets, 2)];
+            const float* pM3 = &data.m_pPalette[_mm_extract_epi32(offsets, 3)];
+
+            for (std::size_t k = 0; k < 12; ++k)
+                blend[k] = _mm_add_ps(blend[k], _mm_mul_ps(_mm_set_ps(pM3[k], pM2[k], pM1[k], pM0[k]), weight));
+        }
+
+        // apply the blended transformations to the bind pose vertices
+        const __m128 x = _mm_set_ps(pSrc[3 * stride],     pSrc[2 * stride],     pSrc[stride],     pSrc[0]);
+        const __m128 y = _mm_set_ps(pSrc[3 * stride + 1], pSrc[2 * stride + 1], pSrc[stride + 1], pSrc[1]);
+        const __m128 z = _mm_set_ps(pSrc[3 * stride + 2], pSrc[2 * stride + 2], pSrc[stride + 2], pSrc[2]);
+
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            const __m128 result = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, blend[k]),
+                                                                   _mm_mul_ps(y, blend[3 + k])),
+                                                        _mm_mul_ps(z, blend[6 + k])),
+                                             blend[9 + k]);
+
+            alignas(16) float values[4];
+            _mm_store_ps(values, result);
+
+            for (std::size_t l = 0; l < 4; ++l)
+                pDst[l * stride + k] = values[l];
+        }
+
+        // no normal to skin?
+        if (!data.m_pSrcNormals)
+            continue;
+
+        const float* pSrcNormal = &data.m_pSrcNormals[i * normalStride];
+              float* pDstNormal = &data.m_pDstNormals[i * normalStride];
+
+        const __m128 nX = _mm_set_ps(pSrcNormal[3 * normalStride],
+                                     pSrcNormal[2 * normalStride],
+                                     pSrcNormal[normalStride],
+                                     pSrcNormal[0]);
+        const __m128 nY = _mm_set_ps(pSrcNormal[3 * normalStride + 1],
+                                     pSrcNormal[2 * normalStride + 1],
+                                     pSrcNormal[normalStride + 1],
+                                     pSrcNormal[1]);
+        const __m128 nZ = _mm_set_ps(pSrcNormal[3 * normalStride + 2],
+                                     pSrcNormal[2 * normalStride + 2],
+                                     pSrcNormal[normalStride + 2],
+                                     pSrcNormal[2]);
+
+        // apply the blended rotations to the bind pose normals
+        __m128 normal[3];
+
+        for (std::size_t k = 0; k < 3; ++k)
+            normal[k] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nX, blend[k]), _mm_mul_ps(nY, blend[3 + k])),
+                                   _mm_mul_ps(nZ, blend[6 + k]));
+
+        // renormalize them
+        const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(normal[0], normal[0]),
+                                                                _mm_mul_ps(normal[1], normal[1])),
+                                                     _mm_mul_ps(normal[2], normal[2])));
+        const __m128 valid  = _mm_cmpgt_ps(length, zero);
+
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            alignas(16) float values[4];
+            _mm_store_ps(values, _mm_blendv_ps(normal[k], _mm_div_ps(normal[k], length), valid));
+
+            for (std::size_t l = 0; l < 4; ++l)
+                pDstNormal[l * normalStride + k] = values[l];
+        }
+    }
+
+    return i;
+}
+//---------------------------------------------------------------------------
+SKINNING_HELPER_TARGET("avx2")
+std::size_t SkinningHelper::SkinAVX2(const ISkinData& data)
+{
+    const int     slotCount    = (int)data.m_SlotCount;
+    const int     stride       = (int)data.m_Stride;
+    const int     normalStride = (int)data.m_NormalStride;
+    const __m256i lanes        = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    const __m256i slotLanes    = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(slotCount));
+    const __m256i posLanes     = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(stride));
+    const __m256i normalLanes  = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(normalStride));
+    const __m256i matSize      = _mm256_set1_epi32(12);
+    const __m256  zero         = _mm256_setzero_ps();
+
+    std::size_t i = 0;
+
+    for (; i + 8 <= data.m_Count; i += 8)
+    {
+        const unsigned short* pBoneIndices = &data.m_pBoneIndices[i * slotCount];
+        const float*          pWeights     = &data.m_pWeights[i * slotCount];
+        const float*          pSrc         = &data.m_pSrc[i * stride];
+              float*          pDst         = &data.m_pDst[i * stride];
+
+        __m256 blend[12];
+
+        for (std::size_t k = 0; k < 12; ++k)
+            blend[k] = _mm256_setzero_ps();
+
+        // blend the matrices influencing each vertex, one vertex per lane
+        for (int j = 0; j < slotCount; ++j)
+        {
+            const __m256i offsets = _mm256_mullo_epi32(_mm256_set_epi32(pBoneIndices[7 * slotCount + j],
+                                                                        pBoneIndices[6 * slotCount + j],
+                                                                        pBoneIndices[5 * slotCount + j],
+                                                                        pBoneIndices[4 * slotCount + j],
+                                                                        pBoneIndices[3 * slotCount + j],
+                                                                        pBoneIndices[2 * slotCount + j],
+                                                                        pBoneIndices[slotCount + j],
+                                                                        pBoneIndices[j]),
+                                                       matSize);
+            const __m256  weight  = _mm256_i32gather_ps(pWeights + j, slotLanes, 4);
+
+            for (std::size_t k = 0; k < 12; ++k)
+                blend[k] = _mm256_add_ps(blend[k],
+                                         _mm256_mul_ps(_mm256_i32gather_ps(data.m_pPalette + k, offsets, 4), weight));
+        }
+
+        // apply the blended transformations to the bind pose vertices
+        const __m256 x = _mm256_i32gather_ps(pSrc,     posLanes, 4);
+        const __m256 y = _mm256_i32gather_ps(pSrc + 1, posLanes, 4);
+        const __m256 z = _mm256_i32gather_ps(pSrc + 2, posLanes, 4);
+
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            const __m256 result = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, blend[k]),
+                                                                            _mm256_mul_ps(y, blend[3 + k])),
+                                                              _mm256_mul_ps(z, blend[6 + k])),
+                                                blend[9 + k]);
+
+            alignas(32) float values[8];
+            _mm256_store_ps(values, result);
+
+            for (int l = 0; l < 8; ++l)
+                pDst[l * stride + k] = values[l];
+        }
+
+        // no normal to skin?
+        if (!data.m_pSrcNormals)
+            continue;
+
+        const float* pSrcNormal = &data.m_pSrcNormals[i * normalStride];
+              float* pDstNormal = &data.m_pDstNormals[i * normalStride];
+
+        const __m256 nX = _mm256_i32gather_ps(pSrcNormal,     normalLanes, 4);
+        const __m256 nY = _mm256_i32gather_ps(pSrcNormal + 1, normalLanes, 4);
+        const __m256 nZ = _mm256_i32gather_ps(pSrcNormal + 2, normalLanes, 4);
+
+        // apply the blended rotations to the bind pose normals
+        __m256 normal[3];
+
+        for (std::size_t k = 0; k < 3; ++k)
+            normal[k] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nX, blend[k]), _mm256_mul_ps(nY, blend[3 + k])),
+                                      _mm256_mul_ps(nZ, blend[6 + k]));
+
+        // renormalize them
+        const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(normal[0], normal[0]),
+                                                                         _mm256_mul_ps(normal[1], normal[1])),
+                                                           _mm256_mul_ps(normal[2], normal[2])));
+        const __m256 valid  = _mm256_cmp_ps(length, zero, _CMP_GT_OQ);
+
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            alignas(32) float values[8];
+            _mm256_store_ps(values, _mm256_blendv_ps(normal[k], _mm256_div_ps(normal[k], length), valid));
+
+            for (int l = 0; l < 8; ++l)
+                pDstNormal[l * normalStride + k] = values[l];
+        }
+    }
+
+    return i;
+}
+//---------------------------------------------------------------------------
+SKINNING_HELPER_TARGET("avx512f")
+std::size_t SkinningHelper::SkinAVX512(const ISkinData& data)
+{
+    const int     slotCount    = (int)data.m_SlotCount;
+    const int     stride       = (int)data.m_Stride;
+    const int     normalStride = (int)data.m_NormalStride;
+    const __m512i lanes        = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m512i slotLanes    = _mm512_mullo_epi32(lanes, _mm512_set1_epi32(slotCount));
+    const __m512i posLanes     = _mm512_mullo_epi32(lanes, _mm512_set1_epi32(stride));
+    const __m512i normalLanes  = _mm512_mullo_epi32(lanes, _mm512_set1_epi32(normalStride));
+    const __m512i matSize      = _mm512_set1_epi32(12);
+    const __m512  zero         = _mm512_setzero_ps();
+
+    std::size_t i = 0;
+
+    for (; i + 16 <= data.m_Count; i += 16)
+    {
+        const unsigned short* pBoneIndices = &data.m_pBoneIndices[i * slotCount];
+        const float*          pWeights     = &data.m_pWeights[i * slotCount];
+        const float*          pSrc         = &data.m_pSrc[i * stride];
+              float*          pDst         = &data.m_pDst[i * stride];
+
+        __m512 blend[12];
+
+        for (std::size_t k = 0; k < 12; ++k)
+            blend[k] = _mm512_setzero_ps();
+
+        // blend the matrices influencing each vertex, one vertex per lane
+        for (int j = 0; j < slotCount; ++j)
+        {
+            alignas(64) int boneIndices[16];
+
+            for (int l = 0; l < 16; ++l)
+                boneIndices[l] = pBoneIndices[l * slotCount + j];
+
+            const __m512i offsets = _mm512_mullo_epi32(_mm512_load_si512(boneIndices), matSize);
+            const __m512  weight  = _mm512_i32gather_ps(slotLanes, pWeights + j, 4);
+
+            for (std::size_t k = 0; k < 12; ++k)
+                blend[k] = _mm512_add_ps(blend[k],
+                                         _mm512_mul_ps(_mm512_i32gather_ps(offsets, data.m_pPalette + k, 4), weight));
+        }
+
+        // apply the blended transformations to the bind pose vertices
+        const __m512 x = _mm512_i32gather_ps(posLanes, pSrc,     4);
+        const __m512 y = _mm512_i32gather_ps(posLanes, pSrc + 1, 4);
+        const __m512 z = _mm512_i32gather_ps(posLanes, pSrc + 2, 4);
+
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            const __m512 result = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(x, blend[k]),
+                                                                            _mm512_mul_ps(y, blend[3 + k])),
+                                                              _mm512_mul_ps(z, blend[6 + k])),
+                                                blend[9 + k]);
+
+            _mm512_i32scatter_ps(pDst + k, posLanes, result, 4);
+        }
+
+        // no normal to skin?
+        if (!data.m_pSrcNormals)
+            continue;
+
+        const float* pSrcNormal = &data.m_pSrcNormals[i * normalStride];
+              float* pDstNormal = &data.m_pDstNormals[i * normalStride];
+
+        const __m512 nX = _mm512_i32gather_ps(normalLanes, pSrcNormal,     4);
+        const __m512 nY = _mm512_i32gather_ps(normalLanes, pSrcNormal + 1, 4);
+        const __m512 nZ = _mm512_i32gather_ps(normalLanes, pSrcNormal + 2, 4);
+
+        // apply the blended rotations to the bind pose normals
+        __m512 normal[3];
+
+        for (std::size_t k = 0; k < 3; ++k)
+            normal[k] = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(nX, blend[k]), _mm512_mul_ps(nY, blend[3 + k])),
+                                      _mm512_mul_ps(nZ, blend[6 + k]));
+
+        // renormalize them
+        const __m512    length = _mm512_sqrt_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(normal[0], normal[0]),
+                                                                            _mm512_mul_ps(normal[1], normal[1])),
+                                                              _mm512_mul_ps(normal[2], normal[2])));
+        const __mmask16 valid  = _mm512_cmp_ps_mask(length, zero, _CMP_GT_OQ);
+
+        for (std::size_t k = 0; k < 3; ++k)
+            _mm512_i32scatter_ps(pDstNormal + k,
+                                 normalLanes,
+                                 _mm512_mask_div_ps(normal[k], valid, normal[k], length),
+                                 4);
+    }
+
+    return i;
+}
+//---------------------------------------------------------------------------
+SKINNING_HELPER_TARGET("sse4.1")
+void SkinningHelper::SkinDQSSE41(const ISkinData& data)
+{
+    const std::size_t slotCount    = data.m_SlotCount;
+    const std::size_t stride       = data.m_Stride;
+    const std::size_t normalStride = data.m_NormalStride;
+
+    for (std::size_t i = 0; i < data.m_Count; ++i)
+    {
+        const unsigned short* pBoneIndices = &data.m_pBoneIndices[i * slotCount];
+        const float*          pWeights     = &data.m_pWeights[i * slotCount];
+        const float*          pPivot       = &data.m_pPalette[pBoneIndices[0] * 8];
+
+        __m128 real = _mm_setzero_ps();
+        __m128 dual = _mm_setzero_ps();
+
+        // blend the dual quaternions influencing the vertex, the real and dual parts in their own register
+        for (std::size_t j = 0; j < slotCount; ++j)
+        {
+            const float* pDQ    = &data.m_pPalette[pBoneIndices[j] * 8];
+            const __m128 weight = _mm_set1_ps(GetDQWeight(pDQ, pPivot, pWeights[j]));
+
+            real = _mm_add_ps(real, _mm_mul_ps(_mm_loadu_ps(pDQ),     weight));
+            dual = _mm_add_ps(dual, _mm_mul_ps(_mm_loadu_ps(pDQ + 4), weight));
+        }
+
+        alignas(16) float blend[8];
+        _mm_store_ps(blend,     real);
+        _mm_store_ps(blend + 4, dual);
+
+        TransformDQ(blend,
+                    &data.m_pSrc[i * stride],
+                    &data.m_pDst[i * stride],
+                    data.m_pSrcNormals ? &data.m_pSrcNormals[i * normalStride] : nullptr,
+                    data.m_pSrcNormals ? &data.m_pDstNormals[i * normalStride] : nullptr);
+    }
+}
+//---------------------------------------------------------------------------
+SKINNING_HELPER_TARGET("avx2")
+void SkinningHelper::SkinDQAVX2(const ISkinData& data)
+{
+    const std::size_t slotCount    = data.m_SlotCount;
+    const std::size_t stride       = data.m_Stride;
+    const std::size_t normalStride = data.m_NormalStride;
+
+    for (std::size_t i = 0; i < data.m_Count; ++i)
+    {
+        const unsigned short* pBoneIndices = &data.m_pBoneIndices[i * slotCount];
+        const float*          pWeights     = &data.m_pWeights[i * slotCount];
+        const float*          pPivot       = &data.m_pPalette[pBoneIndices[0] * 8];
+
+        __m256 dq = _mm256_setzero_ps();
+
+        // blend the dual quaternions influencing the vertex, each one fits in a single register
+        for (std::size_t j = 0; j < slotCount; ++j)
+        {
+            const float* pDQ    = &data.m_pPalette[pBoneIndices[j] * 8];
+            const __m256 weight = _mm256_set1_ps(GetDQWeight(pDQ, pPivot, pWeights[j]));
+
+            dq = _mm256_add_ps(dq, _mm256_mul_ps(_mm256_loadu_ps(pDQ), weight));
+        }
+
+        alignas(32) float blend[8];
+        _mm256_store_ps(blend, dq);
+
+        TransformDQ(blend,
+                    &data.m_pSrc[i * stride],
+                    &data.m_pDst[i * stride],
+                    data.m_pSrcNormals ? &data.m_pSrcNormals[i * normalStride] : nullptr,
+                    data.m_pSrcNormals ? &data.m_pDstNormals[i * normalStride] : nullptr);
+    }
+}
+//---------------------------------------------------------------------------
+#else
+std::size_t SkinningHelper::SkinSSE41(const ISkinData& data)
+{
+    return 0;
+}
+//---------------------------------------------------------------------------
+std::size_t SkinningHelper::SkinAVX2(const ISkinData& data)
+{
+    return 0;
+}
+//---------------------------------------------------------------------------
+std::size_t SkinningHelper::SkinAVX512(const ISkinData& data)
+{
+    return 0;
+}
+//---------------------------------------------------------------------------
+void SkinningHelper::SkinDQSSE41(const ISkinData& data)
+{
+    SkinDQScalar(data);
+}
+//---------------------------------------------------------------------------
+void SkinningHelper::SkinDQAVX2(const ISkinData& data)
+{
+    SkinDQScalar(data);
+}
+#endif
+//---------------------------------------------------------------------------
@@ -0,0 +1,216 @@
+/****************************************************************************
+ * ==> SkinningHelper ------------------------------------------------------*
+ ****************************************************************************
+ * Description : Linear blend skinning kernels, selected from the CPU       *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <vector>
+
+// classes
+#include "Model.h"
+
+/**
+* Skinning helper, provides the linear blend skinning kernels. The best kernel supported by the CPU is selected at
+* runtime, a portable scalar kernel is always available
+*@author Jean-Milost Reymond
+*/
+class SkinningHelper
+{
+    public:
+        typedef std::vector<float> IPalette;
+
+        /**
+        * Skinning kernel
+        */
+        enum class IEKernel
+        {
+            IE_K_Scalar = 0, // portable kernel, one vertex per iteration
+            IE_K_SSE41,      // SSE4.1 kernel, 4 vertices per iteration
+            IE_K_AVX2,       // AVX2 kernel, 8 vertices per iteration
+            IE_K_AVX512      // AVX-512 kernel, 16 vertices per iteration
+        };
+
+        /**
+        * Skinning method
+        */
+        enum class IEMethod
+        {
+            IE_M_Linear = 0,     // linear blend skinning, the palette contains matrices
+            IE_M_DualQuaternion  // dual quaternion skinning, the palette contains dual quaternions
+        };
+
+        /**
+        * Skinning data, describes the vertices to skin
+        */
+        struct ISkinData
+        {
+                  IEMethod        m_Method;       // skinning method
+            const float*          m_pPalette;     // matrix or dual quaternion palette, depending on the method
+            const unsigned short* m_pBoneIndices; // packed vertex influences bone indices, in the palette
+            const float*          m_pWeights;     // packed vertex influences weights
+            const float*          m_pSrc;         // bind pose positions
+                  float*          m_pDst;         // skinned positions
+            const float*          m_pSrcNormals;  // bind pose normals, if nullptr only the positions are skinned
+                  float*          m_pDstNormals;  // skinned normals
+                  std::size_t     m_SlotCount;    // influence slot count per vertex
+                  std::size_t     m_Stride;       // position stride in floats, shared by the source and destination
+                  std::size_t     m_NormalStride; // normal stride in floats, shared by the source and destination
+                  std::size_t     m_Count;        // vertex count to skin
+
+            ISkinData();
+            virtual ~ISkinData();
+        };
+
+        /**
+        * Builds a matrix palette, in which each matrix is stored as the 3 first columns of its 4 rows
+        *@param finalMatrices - final bone matrices
+        *@param[out] palette - matrix palette
+        */
+        static void BuildPalette(const Model::IMatrices& finalMatrices, IPalette& palette);
+
+        /**
+        * Builds a dual quaternion palette, in which each matrix is converted to a dual quaternion, stored as its real
+        * part followed by its dual part, both in x, y, z, w order
+        *@param finalMatrices - final bone matrices
+        *@param[out] palette - dual quaternion palette
+        *@note A dual quaternion can only represent a rigid transformation, thus any scaling is removed from the
+        *      matrices
+        */
+        static void BuildDQPalette(const Model::IMatrices& finalMatrices, IPalette& palette);
+
+        /**
+        * Gets the best kernel supported by the CPU
+        *@return the best kernel supported by the CPU
+        *@note The CPU features are only detected on the first call
+        */
+        static IEKernel GetBestKernel();
+
+        /**
+        * Checks if a kernel is supported by the CPU
+        *@param kernel - kernel to check
+        *@return true if the kernel is supported, otherwise false
+        */
+        static bool IsSupported(IEKernel kernel);
+
+        /**
+        * Skins vertices with the best kernel supported by the CPU
+        *@param data - skinning data
+        *@return true on success, otherwise false
+        */
+        static bool Skin(const ISkinData& data);
+
+        /**
+        * Skins vertices with a given kernel
+        *@param data - skinning data
+        *@param kernel - kernel to use
+        *@return true on success, otherwise false
+        *@note The normals are transformed by the rotation part of the blended matrix and renormalized, in the same
+        *      pass as the positions. All the kernels blend the matrices, then transform the vertices, with the same
+        *      operations in the same order, thus their results are identical unless the compiler contracts them to
+        *      fused multiply-adds. The vertices remaining after the last full iteration are skinned by the scalar
+        *      kernel
+        */
+        static bool Skin(const ISkinData& data, IEKernel kernel);
+
+    private:
+        /**
+        * Detects the best kernel supported by the CPU
+        *@return the best kernel supported by the CPU
+        */
+        static IEKernel DetectKernel();
+
+        /**
+        * Skins a vertex range with the scalar kernel
+        *@param data - skinning data
+        *@param start - first vertex to skin
+        */
+        static void SkinScalar(const ISkinData& data, std::size_t start);
+
+        /**
+        * Skins vertices with the SSE4.1 kernel
+        *@param data - skinning data
+        *@return first vertex left to skin
+        */
+        static std::size_t SkinSSE41(const ISkinData& data);
+
+        /**
+        * Skins vertices with the AVX2 kernel
+        *@param data - skinning data
+        *@return first vertex left to skin
+        */
+        static std::size_t SkinAVX2(const ISkinData& data);
+
+        /**
+        * Skins vertices with the AVX-512 kernel
+        *@param data - skinning data
+        *@return first vertex left to skin
+        */
+        static std::size_t SkinAVX512(const ISkinData& data);
+
+        /**
+        * Skins vertices with the scalar dual quaternion kernel
+        *@param data - skinning data
+        */
+        static void SkinDQScalar(const ISkinData& data);
+
+        /**
+        * Skins vertices with the SSE4.1 dual quaternion kernel, the real and dual parts are blended in 2 registers
+        *@param data - skinning data
+        */
+        static void SkinDQSSE41(const ISkinData& data);
+
+        /**
+        * Skins vertices with the AVX2 dual quaternion kernel, the whole dual quaternion is blended in 1 register
+        *@param data - skinning data
+        */
+        static void SkinDQAVX2(const ISkinData& data);
+
+        /**
+        * Gets the weight to apply to a dual quaternion while blending it, negated if its real part isn't in the
+        * same hemisphere as the pivot one, in order to blend along the shortest path
+        *@param pDQ - dual quaternion to blend
+        *@param pPivot - pivot dual quaternion
+        *@param weight - vertex weight
+        *@return the weight to apply
+        */
+        static float GetDQWeight(const float* pDQ, const float* pPivot, float weight);
+
+        /**
+        * Normalizes a blended dual quaternion and applies it to a vertex
+        *@param blend - blended dual quaternion
+        *@param pSrc - bind pose position
+        *@param[out] pDst - skinned position
+        *@param pSrcNormal - bind pose normal, ignored if nullptr
+        *@param[out] pDstNormal - skinned normal
+        */
+        static void TransformDQ(const float* blend,
+                                const float* pSrc,
+                                      float* pDst,
+                                const float* pSrcNormal,
+                                      float* pDstNormal);
+};
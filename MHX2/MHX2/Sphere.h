@@ -0,0 +1,184 @@
+/****************************************************************************
+ * ==> Sphere --------------------------------------------------------------*
+ ****************************************************************************
+ * Description : Bounding sphere                                            *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <algorithm>
+#include <type_traits>
+#include <cmath>
+
+// classes
+#include "Vector3.h"
+#include "Matrix4x4.h"
+
+/**
+* Bounding sphere
+*@author Jean-Milost Reymond
+*/
+template <class T>
+class Sphere
+{
+    public:
+        Vector3<T> m_Center; // sphere center
+        T          m_Radius; // sphere radius, negative if the sphere is empty
+
+        /**
+        * Constructor
+        *@note The sphere is empty until another sphere is merged with it
+        */
+        inline Sphere();
+
+        /**
+        * Constructor
+        *@param center - sphere center
+        *@param radius - sphere radius
+        */
+        inline Sphere(const Vector3<T>& center, T radius);
+
+        /**
+        * Copy constructor
+        *@param other - other sphere to copy from
+        */
+        Sphere(const Sphere& other) = default;
+
+        ~Sphere() = default;
+
+        /**
+        * Copy operator
+        *@param other - other sphere to copy from
+        *@return this sphere
+        */
+        Sphere& operator = (const Sphere& other) = default;
+
+        /**
+        * Checks if the sphere is empty
+        *@return true if the sphere is empty, otherwise false
+        */
+        inline bool IsEmpty() const;
+
+        /**
+        * Extends the sphere to contain another sphere
+        *@param other - other sphere to merge with
+        */
+        inline void Merge(const Sphere& other);
+
+        /**
+        * Transforms the sphere by a matrix
+        *@param matrix - transform matrix
+        *@return the transformed sphere
+        *@note The radius is scaled by the largest axis scale found in the matrix, thus the resulting
+        *      sphere always contains the transformed content, even if the scale isn't uniform
+        */
+        inline Sphere Transform(const Matrix4x4<T>& matrix) const;
+};
+
+typedef Sphere<float>  SphereF;
+typedef Sphere<double> SphereD;
+
+// the spheres contain only their center and radius, thus their arrays may be copied as raw memory, e.g. in meshlets
+static_assert(sizeof(SphereF)  == sizeof(Vector3F) + sizeof(float), "SphereF should contain only its components");
+static_assert(alignof(SphereF) == alignof(float),                   "SphereF should be aligned as its components");
+static_assert(std::is_trivially_copyable<SphereF>::value, "SphereF should be trivially copyable");
+
+//---------------------------------------------------------------------------
+// Sphere
+//---------------------------------------------------------------------------
+template <class T>
+Sphere<T>::Sphere() :
+    m_Radius(T(-1.0))
+{}
+//---------------------------------------------------------------------------
+template <class T>
+Sphere<T>::Sphere(const Vector3<T>& center, T radius) :
+    m_Center(center),
+    m_Radius(radius)
+{}
+//---------------------------------------------------------------------------
+template <class T>
+bool Sphere<T>::IsEmpty() const
+{
+    return (m_Radius < T(0.0));
+}
+//---------------------------------------------------------------------------
+template <class T>
+void Sphere<T>::Merge(const Sphere& other)
+{
+    // nothing to merge?
+    if (other.IsEmpty())
+        return;
+
+    // this sphere is empty, just copy the other one
+    if (IsEmpty())
+    {
+        *this = other;
+        return;
+    }
+
+    const Vector3<T> delta    = other.m_Center - m_Center;
+    const T          distance = delta.Length();
+
+    // is the other sphere already inside this one?
+    if (distance + other.m_Radius <= m_Radius)
+        return;
+
+    // is this sphere inside the other one?
+    if (distance + m_Radius <= other.m_Radius)
+    {
+        *this = other;
+        return;
+    }
+
+    // calculate the sphere enclosing both spheres
+    const T radius = (distance + m_Radius + other.m_Radius) * T(0.5);
+
+    m_Center = m_Center + delta * ((radius - m_Radius) / distance);
+    m_Radius = radius;
+}
+//---------------------------------------------------------------------------
+template <class T>
+Sphere<T> Sphere<T>::Transform(const Matrix4x4<T>& matrix) const
+{
+    // nothing to transform?
+    if (IsEmpty())
+        return *this;
+
+    // get the squared scale of each matrix axis
+    const T scaleX = matrix.m_Table[0][0] * matrix.m_Table[0][0] +
+                     matrix.m_Table[0][1] * matrix.m_Table[0][1] +
+                     matrix.m_Table[0][2] * matrix.m_Table[0][2];
+    const T scaleY = matrix.m_Table[1][0] * matrix.m_Table[1][0] +
+                     matrix.m_Table[1][1] * matrix.m_Table[1][1] +
+                     matrix.m_Table[1][2] * matrix.m_Table[1][2];
+    const T scaleZ = matrix.m_Table[2][0] * matrix.m_Table[2][0] +
+                     matrix.m_Table[2][1] * matrix.m_Table[2][1] +
+                     matrix.m_Table[2][2] * matrix.m_Table[2][2];
+
+    return Sphere(matrix.Transform(m_Center), m_Radius * std::sqrt(std::max(scaleX, std::max(scaleY, scaleZ))));
+}
+//---------------------------------------------------------------------------
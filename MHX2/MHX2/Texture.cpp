@@ -58,3 +58,13 @@ void Texture::Clear()
     m_Height    = 0;
 }
 //---------------------------------------------------------------------------
+bool Texture::GetPixels(std::vector<unsigned char>& pixels) const
+{
+    return false;
+}
+//---------------------------------------------------------------------------
+Texture* Texture::CreateEmpty() const
+{
+    return nullptr;
+}
+//---------------------------------------------------------------------------
@@ -141,4 +141,18 @@ class Texture
         *@return Texture identifier
         */
         virtual inline std::size_t GetID() const = 0;
+
+        /**
+        * Gets the texture pixels
+        *@param[out] pixels - texture pixels, row by row, 3 bytes per pixel for 24 bit textures, 4 for 32 bit ones
+        *@return true on success, false on error or if the texture cannot provide its pixels
+        */
+        virtual bool GetPixels(std::vector<unsigned char>& pixels) const;
+
+        /**
+        * Creates a new empty texture of the same kind
+        *@return the new texture, nullptr if not supported
+        *@note The returned texture should be deleted when useless
+        */
+        virtual Texture* CreateEmpty() const;
 };
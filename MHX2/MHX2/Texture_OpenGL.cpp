@@ -108,6 +108,30 @@ void Texture_OpenGL::Select(const  Shader* pShader) const
         glActiveTexture(GL_TEXTURE0);
 }
 //---------------------------------------------------------------------------
+bool Texture_OpenGL::GetPixels(std::vector<unsigned char>& pixels) const
+{
+    // no texture?
+    if (!m_Index || m_Width <= 0 || m_Height <= 0)
+        return false;
+
+    const GLuint target = GetTarget();
+    const GLuint format = GetFormat();
+
+    pixels.resize((std::size_t)m_Width * (std::size_t)m_Height * (m_Format == IEFormat::IE_FT_24bit ? 3 : 4));
+
+    // read the texture back, without any padding between the rows
+    glBindTexture(target, m_Index);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(target, 0, format, GL_UNSIGNED_BYTE, &pixels[0]);
+
+    return true;
+}
+//---------------------------------------------------------------------------
+Texture* Texture_OpenGL::CreateEmpty() const
+{
+    return new Texture_OpenGL();
+}
+//---------------------------------------------------------------------------
 GLuint Texture_OpenGL::GetTarget() const
 {
     // search for texture target
@@ -69,6 +69,20 @@ class Texture_OpenGL : public Texture
         */
         virtual void Select(const Shader* pShader) const;
 
+        /**
+        * Gets the texture pixels
+        *@param[out] pixels - texture pixels, row by row, 3 bytes per pixel for 24 bit textures, 4 for 32 bit ones
+        *@return true on success, otherwise false
+        */
+        virtual bool GetPixels(std::vector<unsigned char>& pixels) const;
+
+        /**
+        * Creates a new empty texture of the same kind
+        *@return the new texture
+        *@note The returned texture should be deleted when useless
+        */
+        virtual Texture* CreateEmpty() const;
+
     protected:
         /**
         * Gets texture target
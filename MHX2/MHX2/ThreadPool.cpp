@@ -0,0 +1,258 @@
+/****************************************************************************
+ * ==> ThreadPool ----------------------------------------------------------*
+ ****************************************************************************
+ * Description : Persistent work-stealing thread pool                       *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#include "ThreadPool.h"
+
+// std
+#include <algorithm>
+
+//---------------------------------------------------------------------------
+// ThreadPool::ITaskGroup
+//---------------------------------------------------------------------------
+ThreadPool::ITaskGroup::ITaskGroup() :
+    m_Pending(0)
+{}
+//---------------------------------------------------------------------------
+ThreadPool::ITaskGroup::~ITaskGroup()
+{
+    // wait until the last task finished to notify the group
+    std::unique_lock<std::mutex> lock(m_Mutex);
+}
+//---------------------------------------------------------------------------
+bool ThreadPool::ITaskGroup::IsDone() const
+{
+    return !m_Pending.load();
+}
+//---------------------------------------------------------------------------
+// ThreadPool::ITask
+//---------------------------------------------------------------------------
+ThreadPool::ITask::ITask() :
+    m_fOnTask(nullptr),
+    m_pData(nullptr),
+    m_Index(0),
+    m_pGroup(nullptr)
+{}
+//---------------------------------------------------------------------------
+ThreadPool::ITask::~ITask()
+{}
+//---------------------------------------------------------------------------
+// ThreadPool::IQueue
+//---------------------------------------------------------------------------
+ThreadPool::IQueue::IQueue()
+{}
+//---------------------------------------------------------------------------
+ThreadPool::IQueue::~IQueue()
+{}
+//---------------------------------------------------------------------------
+// ThreadPool
+//---------------------------------------------------------------------------
+ThreadPool::ThreadPool(std::size_t threadCount) :
+    m_Queued(0),
+    m_NextQueue(0),
+    m_Stop(false)
+{
+    // use one worker per hardware thread by default
+    if (!threadCount)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (std::size_t i = 0; i < threadCount; ++i)
+        m_Queues.push_back(new IQueue());
+
+    for (std::size_t i = 0; i < threadCount; ++i)
+        m_Threads.push_back(std::thread(&ThreadPool::Work, this, i));
+}
+//---------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    // notify the workers to stop once all the queued tasks are executed
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+
+    m_Signal.notify_all();
+
+    for (std::size_t i = 0; i < m_Threads.size(); ++i)
+        m_Threads[i].join();
+
+    for (std::size_t i = 0; i < m_Queues.size(); ++i)
+        delete m_Queues[i];
+}
+//---------------------------------------------------------------------------
+std::size_t ThreadPool::GetThreadCount() const
+{
+    return m_Threads.size();
+}
+//---------------------------------------------------------------------------
+void ThreadPool::Run(ITfOnTask fOnTask, void* pData, std::size_t count, ITaskGroup& group)
+{
+    // nothing to run?
+    if (!fOnTask || !count)
+        return;
+
+    group.m_Pending += count;
+
+    const std::size_t queueCount = m_Queues.size();
+    const std::size_t first      = m_NextQueue.fetch_add(1) % queueCount;
+
+    // spread the tasks over the worker queues, as consecutive blocks in order to keep neighboring tasks together
+    for (std::size_t i = 0; i < queueCount; ++i)
+    {
+        const std::size_t start = (count * i)       / queueCount;
+        const std::size_t end   = (count * (i + 1)) / queueCount;
+
+        if (start == end)
+            continue;
+
+        IQueue* pQueue = m_Queues[(first + i) % queueCount];
+
+        std::unique_lock<std::mutex> lock(pQueue->m_Mutex);
+
+        for (std::size_t j = start; j < end; ++j)
+        {
+            ITask task;
+            task.m_fOnTask = fOnTask;
+            task.m_pData   = pData;
+            task.m_Index   = j;
+            task.m_pGroup  = &group;
+
+            pQueue->m_Tasks.push_back(task);
+        }
+    }
+
+    // wake up the workers. The counter is changed under the lock, thus no worker may miss it before sleeping
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Queued += count;
+    }
+
+    m_Signal.notify_all();
+}
+//---------------------------------------------------------------------------
+void ThreadPool::Wait(ITaskGroup& group)
+{
+    ITask task;
+
+    // help the workers while the group isn't done
+    while (!group.IsDone())
+    {
+        if (PopTask(m_Queues.size(), task))
+        {
+            Execute(task);
+            continue;
+        }
+
+        // no task left to steal, the remaining ones are running, wait until they end
+        std::unique_lock<std::mutex> lock(group.m_Mutex);
+
+        while (!group.IsDone())
+            group.m_Done.wait(lock);
+    }
+}
+//---------------------------------------------------------------------------
+void ThreadPool::Work(std::size_t index)
+{
+    ITask task;
+
+    while (true)
+    {
+        if (PopTask(index, task))
+        {
+            Execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+
+        // sleep until new tasks are queued
+        while (!m_Stop && !m_Queued.load())
+            m_Signal.wait(lock);
+
+        // stop once all the queued tasks are executed
+        if (m_Stop && !m_Queued.load())
+            return;
+    }
+}
+//---------------------------------------------------------------------------
+bool ThreadPool::PopTask(std::size_t index, ITask& task)
+{
+    const std::size_t queueCount = m_Queues.size();
+
+    // pop the most recent task from the worker own queue, it's the most likely to be in cache
+    if (index < queueCount)
+    {
+        IQueue* pQueue = m_Queues[index];
+
+        std::unique_lock<std::mutex> lock(pQueue->m_Mutex);
+
+        if (!pQueue->m_Tasks.empty())
+        {
+            task = pQueue->m_Tasks.back();
+            pQueue->m_Tasks.pop_back();
+            --m_Queued;
+            return true;
+        }
+    }
+
+    // steal the oldest task of another queue
+    for (std::size_t i = 1; i <= queueCount; ++i)
+    {
+        const std::size_t victim = (index + i) % queueCount;
+
+        if (victim == index)
+            continue;
+
+        IQueue* pQueue = m_Queues[victim];
+
+        std::unique_lock<std::mutex> lock(pQueue->m_Mutex);
+
+        if (!pQueue->m_Tasks.empty())
+        {
+            task = pQueue->m_Tasks.front();
+            pQueue->m_Tasks.pop_front();
+            --m_Queued;
+            return true;
+        }
+    }
+
+    return false;
+}
+//---------------------------------------------------------------------------
+void ThreadPool::Execute(const ITask& task)
+{
+    task.m_fOnTask(task.m_pData, task.m_Index);
+
+    // the lock prevents the notification to happen between the check and the wait of a waiting thread, and the
+    // group to be deleted before the notification ends
+    std::unique_lock<std::mutex> lock(task.m_pGroup->m_Mutex);
+
+    // last task of the group? Notify the waiting threads
+    if (!--task.m_pGroup->m_Pending)
+        task.m_pGroup->m_Done.notify_all();
+}
+//---------------------------------------------------------------------------
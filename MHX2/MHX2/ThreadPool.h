@@ -0,0 +1,163 @@
+/****************************************************************************
+ * ==> ThreadPool ----------------------------------------------------------*
+ ****************************************************************************
+ * Description : Persistent work-stealing thread pool                       *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/**
+* Persistent work-stealing thread pool. Each worker owns a task queue, and steals the tasks of the other workers once
+* its own queue is empty. The threads are created once and kept alive until the pool is deleted
+*@author Jean-Milost Reymond
+*/
+class ThreadPool
+{
+    public:
+        /**
+        * Called when a task should be executed
+        *@param pData - task data, as passed to Run()
+        *@param index - task index, between 0 and the task count passed to Run()
+        */
+        typedef void (*ITfOnTask)(void* pData, std::size_t index);
+
+        /**
+        * Task group, it's a completion barrier counting the tasks which aren't executed yet
+        *@note A group should not be deleted before all its tasks were executed
+        */
+        class ITaskGroup
+        {
+            public:
+                ITaskGroup();
+                virtual ~ITaskGroup();
+
+                /**
+                * Checks if all the tasks of the group were executed
+                *@return true if all the tasks were executed, otherwise false
+                */
+                virtual bool IsDone() const;
+
+            private:
+                std::atomic<std::size_t> m_Pending;
+                std::mutex               m_Mutex;
+                std::condition_variable  m_Done;
+
+                friend class ThreadPool;
+        };
+
+        /**
+        * Constructor
+        *@param threadCount - worker thread count, if 0 one worker is created per hardware thread
+        */
+        ThreadPool(std::size_t threadCount = 0);
+
+        virtual ~ThreadPool();
+
+        /**
+        * Gets the worker thread count
+        *@return the worker thread count
+        */
+        virtual std::size_t GetThreadCount() const;
+
+        /**
+        * Queues tasks to execute
+        *@param fOnTask - task function
+        *@param pData - task data
+        *@param count - task count, the function is called once per index between 0 and count
+        *@param group - group the tasks belong to
+        *@note This function returns immediately, call Wait() on the group to wait until all its tasks are executed
+        */
+        virtual void Run(ITfOnTask fOnTask, void* pData, std::size_t count, ITaskGroup& group);
+
+        /**
+        * Waits until all the tasks of a group are executed
+        *@param group - group to wait for
+        *@note The calling thread executes queued tasks while waiting
+        */
+        virtual void Wait(ITaskGroup& group);
+
+    private:
+        /**
+        * Task
+        */
+        struct ITask
+        {
+            ITfOnTask   m_fOnTask;
+            void*       m_pData;
+            std::size_t m_Index;
+            ITaskGroup* m_pGroup;
+
+            ITask();
+            virtual ~ITask();
+        };
+
+        /**
+        * Worker task queue
+        */
+        struct IQueue
+        {
+            std::deque<ITask> m_Tasks;
+            std::mutex        m_Mutex;
+
+            IQueue();
+            virtual ~IQueue();
+        };
+
+        std::vector<std::thread> m_Threads;
+        std::vector<IQueue*>     m_Queues;
+        std::atomic<std::size_t> m_Queued;
+        std::atomic<std::size_t> m_NextQueue;
+        std::mutex               m_Mutex;
+        std::condition_variable  m_Signal;
+        bool                     m_Stop;
+
+        /**
+        * Worker thread loop
+        *@param index - worker index
+        */
+        void Work(std::size_t index);
+
+        /**
+        * Pops the next task, from the worker own queue first, otherwise stolen from the other queues
+        *@param index - worker index, a non-worker thread only steals tasks
+        *@param[out] task - popped task
+        *@return true if a task was popped, otherwise false
+        */
+        bool PopTask(std::size_t index, ITask& task);
+
+        /**
+        * Executes a task and notifies its group once it's done
+        *@param task - task to execute
+        */
+        void Execute(const ITask& task);
+};
@@ -30,6 +30,7 @@
 
 // std
 #include <algorithm>
+#include <type_traits>
 
 /**
 * 2D vector
@@ -55,131 +56,136 @@ class Vector2
         * Copy constructor
         *@param other - other vector to copy from
         */
-        inline Vector2(const Vector2& other);
+        Vector2(const Vector2& other) = default;
 
-        virtual ~Vector2();
+        ~Vector2() = default;
 
         /**
         * Copy operator
         *@param other - other vector to copy from
         *@return this vector
         */
-        virtual inline Vector2& operator = (const Vector2& other);
+        Vector2& operator = (const Vector2& other) = default;
 
         /**
         * Addition operator
         *@param value - value to add
         *@return resulting vector
         */
-        virtual inline Vector2 operator + (const Vector2& value) const;
-        virtual inline Vector2 operator + (const T& value) const;
+        inline Vector2 operator + (const Vector2& value) const;
+        inline Vector2 operator + (const T& value) const;
 
         /**
         * Subtraction operator
         *@param value - value to subtract
         *@return resulting vector
         */
-        virtual inline Vector2 operator - (const Vector2& value) const;
-        virtual inline Vector2 operator - (const T& value) const;
+        inline Vector2 operator - (const Vector2& value) const;
+        inline Vector2 operator - (const T& value) const;
 
         /**
         * Negation operator
         *@return inverted vector
         */
-        virtual inline Vector2 operator - () const;
+        inline Vector2 operator - () const;
 
         /**
         * Multiplication operator
         *@param value - value to multiply
         *@return resulting vector
         */
-        virtual inline Vector2 operator * (const Vector2& value) const;
-        virtual inline Vector2 operator * (const T& value) const;
+        inline Vector2 operator * (const Vector2& value) const;
+        inline Vector2 operator * (const T& value) const;
 
         /**
         * Division operator
         *@param value - value to divide
         *@return resulting vector
         */
-        virtual inline Vector2 operator / (const Vector2& value) const;
-        virtual inline Vector2 operator / (const T& value) const;
+        inline Vector2 operator / (const Vector2& value) const;
+        inline Vector2 operator / (const T& value) const;
 
         /**
         * Addition and assignation operator
         *@param value - value to add
         *@return resulting vector
         */
-        virtual inline const Vector2& operator += (const Vector2& value);
-        virtual inline const Vector2& operator += (const T& value);
+        inline const Vector2& operator += (const Vector2& value);
+        inline const Vector2& operator += (const T& value);
 
         /**
         * Subtraction and assignation operator
         *@param value - value to subtract
         *@return resulting vector
         */
-        virtual inline const Vector2& operator -= (const Vector2& value);
-        virtual inline const Vector2& operator -= (const T& value);
+        inline const Vector2& operator -= (const Vector2& value);
+        inline const Vector2& operator -= (const T& value);
 
         /**
         * Multiplication and assignation operator
         *@param value - value to multiply
         *@return resulting vector
         */
-        virtual inline const Vector2& operator *= (const Vector2& value);
-        virtual inline const Vector2& operator *= (const T& value);
+        inline const Vector2& operator *= (const Vector2& value);
+        inline const Vector2& operator *= (const T& value);
 
         /**
         * Division and assignation operator
         *@param value - value to divide
         *@return resulting vector
         */
-        virtual inline const Vector2& operator /= (const Vector2& value);
-        virtual inline const Vector2& operator /= (const T& value);
+        inline const Vector2& operator /= (const Vector2& value);
+        inline const Vector2& operator /= (const T& value);
 
         /**
         * Equality operator
         *@param value - value to compare
         *@return true if values are identical, otherwise false
         */
-        virtual inline bool operator == (const Vector2& value) const;
+        inline bool operator == (const Vector2& value) const;
 
         /**
         * Not equality operator
         *@param value - value to compare
         *@return true if values are not identical, otherwise false
         */
-        virtual inline bool operator != (const Vector2& value) const;
+        inline bool operator != (const Vector2& value) const;
 
         /**
         * Calculates the vector length
         *@return vector length
         */
-        virtual inline T Length() const;
+        inline T Length() const;
 
         /**
         * Normalizes the vector
         *@return normalized vector
         */
-        virtual inline Vector2 Normalize() const;
+        inline Vector2 Normalize() const;
 
         /**
         * Calculates cross product between 2 vectors
         *@param vector - other vector to cross with
         *@return the resulting vector
         */
-        virtual inline Vector2 Cross(const Vector2& vector) const;
+        inline Vector2 Cross(const Vector2& vector) const;
 
         /**
         * Calculates dot product between 2 vectors
         *@param vector - other vector to dot with
         *@return resulting angle
         */
-        virtual inline T Dot(const Vector2& vector) const;
+        inline T Dot(const Vector2& vector) const;
 };
 
 typedef Vector2<float>  Vector2F;
 typedef Vector2<double> Vector2D;
 
+// the vectors contain only their coordinates, thus their arrays may be copied as raw memory
+static_assert(sizeof(Vector2F)  == 2 * sizeof(float), "Vector2F should contain only its components");
+static_assert(alignof(Vector2F) == alignof(float),    "Vector2F should be aligned as its components");
+static_assert(std::is_trivially_copyable<Vector2F>::value, "Vector2F should be trivially copyable");
+
 //---------------------------------------------------------------------------
 // Vector2
 //---------------------------------------------------------------------------
@@ -195,25 +201,6 @@ Vector2<T>::Vector2(T x, T y) :
     m_Y(y)
 {}
 //---------------------------------------------------------------------------
-template <class T>
-Vector2<T>::Vector2(const Vector2& other) :
-    m_X(other.m_X),
-    m_Y(other.m_Y)
-{}
-//---------------------------------------------------------------------------
-template <class T>
-Vector2<T>::~Vector2()
-{}
-//---------------------------------------------------------------------------
-template<class T>
-Vector2<T>& Vector2<T>::operator = (const Vector2& other)
-{
-    m_X = other.m_X;
-    m_Y = other.m_Y;
-
-    return *this;
-}
-//---------------------------------------------------------------------------
 template<class T>
 Vector2<T> Vector2<T>::operator + (const Vector2& value) const
 {
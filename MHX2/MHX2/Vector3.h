@@ -30,6 +30,7 @@
 
 // std
 #include <algorithm>
+#include <type_traits>
 
 /**
 * 3D vector
@@ -57,131 +58,136 @@ class Vector3
         * Copy constructor
         *@param other - other vector to copy from
         */
-        inline Vector3(const Vector3& other);
+        Vector3(const Vector3& other) = default;
 
-        virtual ~Vector3();
+        ~Vector3() = default;
 
         /**
         * Copy operator
         *@param other - other vector to copy from
         *@return this vector
         */
-        virtual inline Vector3& operator = (const Vector3& other);
+        Vector3& operator = (const Vector3& other) = default;
 
         /**
         * Addition operator
         *@param value - value to add
         *@return resulting vector
         */
-        virtual inline Vector3 operator + (const Vector3& value) const;
-        virtual inline Vector3 operator + (const T& value) const;
+        inline Vector3 operator + (const Vector3& value) const;
+        inline Vector3 operator + (const T& value) const;
 
         /**
         * Subtraction operator
         *@param value - value to subtract
         *@return resulting vector
         */
-        virtual inline Vector3 operator - (const Vector3& value) const;
-        virtual inline Vector3 operator - (const T& value) const;
+        inline Vector3 operator - (const Vector3& value) const;
+        inline Vector3 operator - (const T& value) const;
 
         /**
         * Negation operator
         *@return inverted vector
         */
-        virtual inline Vector3 operator - () const;
+        inline Vector3 operator - () const;
 
         /**
         * Multiplication operator
         *@param value - value to multiply
         *@return resulting vector
         */
-        virtual inline Vector3 operator * (const Vector3& value) const;
-        virtual inline Vector3 operator * (const T& value) const;
+        inline Vector3 operator * (const Vector3& value) const;
+        inline Vector3 operator * (const T& value) const;
 
         /**
         * Division operator
         *@param value - value to divide
         *@return resulting vector
         */
-        virtual inline Vector3 operator / (const Vector3& value) const;
-        virtual inline Vector3 operator / (const T& value) const;
+        inline Vector3 operator / (const Vector3& value) const;
+        inline Vector3 operator / (const T& value) const;
 
         /**
         * Addition and assignation operator
         *@param value - value to add
         *@return resulting vector
         */
-        virtual inline const Vector3& operator += (const Vector3& value);
-        virtual inline const Vector3& operator += (const T& value);
+        inline const Vector3& operator += (const Vector3& value);
+        inline const Vector3& operator += (const T& value);
 
         /**
         * Subtraction and assignation operator
         *@param value - value to subtract
         *@return resulting vector
         */
-        virtual inline const Vector3& operator -= (const Vector3& value);
-        virtual inline const Vector3& operator -= (const T& value);
+        inline const Vector3& operator -= (const Vector3& value);
+        inline const Vector3& operator -= (const T& value);
 
         /**
         * Multiplication and assignation operator
         *@param value - value to multiply
         *@return resulting vector
         */
-        virtual inline const Vector3& operator *= (const Vector3& value);
-        virtual inline const Vector3& operator *= (const T& value);
+        inline const Vector3& operator *= (const Vector3& value);
+        inline const Vector3& operator *= (const T& value);
 
         /**
         * Division and assignation operator
         *@param value - value to divide
         *@return resulting vector
         */
-        virtual inline const Vector3& operator /= (const Vector3& value);
-        virtual inline const Vector3& operator /= (const T& value);
+        inline const Vector3& operator /= (const Vector3& value);
+        inline const Vector3& operator /= (const T& value);
 
         /**
         * Equality operator
         *@param value - value to compare
         *@return true if values are identical, otherwise false
         */
-        virtual inline bool operator == (const Vector3& value) const;
+        inline bool operator == (const Vector3& value) const;
 
         /**
         * Not equality operator
         *@param value - value to compare
         *@return true if values are not identical, otherwise false
         */
-        virtual inline bool operator != (const Vector3& value) const;
+        inline bool operator != (const Vector3& value) const;
 
         /**
         * Calculates the vector length
         *@return vector length
         */
-        virtual inline T Length() const;
+        inline T Length() const;
 
         /**
         * Normalizes the vector
         *@return normalized vector
         */
-        virtual inline Vector3 Normalize() const;
+        inline Vector3 Normalize() const;
 
         /**
         * Calculates cross product between 2 vectors
         *@param vector - other vector to cross with
         *@return the resulting vector
         */
-        virtual inline Vector3 Cross(const Vector3& vector) const;
+        inline Vector3 Cross(const Vector3& vector) const;
 
         /**
         * Calculates dot product between 2 vectors
         *@param vector - other vector to dot with
         *@return resulting angle
         */
-        virtual inline T Dot(const Vector3& vector) const;
+        inline T Dot(const Vector3& vector) const;
 };
 
 typedef Vector3<float>  Vector3F;
 typedef Vector3<double> Vector3D;
 
+// the vectors contain only their coordinates, thus their arrays may be copied as raw memory, e.g. in a vertex buffer
+static_assert(sizeof(Vector3F)  == 3 * sizeof(float), "Vector3F should contain only its components");
+static_assert(alignof(Vector3F) == alignof(float),    "Vector3F should be aligned as its components");
+static_assert(std::is_trivially_copyable<Vector3F>::value, "Vector3F should be trivially copyable");
+
 //---------------------------------------------------------------------------
 // Vector3
 //---------------------------------------------------------------------------
@@ -199,27 +205,6 @@ Vector3<T>::Vector3(T x, T y, T z) :
     m_Z(z)
 {}
 //---------------------------------------------------------------------------
-template <class T>
-Vector3<T>::Vector3(const Vector3& other) :
-    m_X(other.m_X),
-    m_Y(other.m_Y),
-    m_Z(other.m_Z)
-{}
-//---------------------------------------------------------------------------
-template <class T>
-Vector3<T>::~Vector3()
-{}
-//---------------------------------------------------------------------------
-template<class T>
-Vector3<T>& Vector3<T>::operator = (const Vector3& other)
-{
-    m_X = other.m_X;
-    m_Y = other.m_Y;
-    m_Z = other.m_Z;
-
-    return *this;
-}
-//---------------------------------------------------------------------------
 template<class T>
 Vector3<T> Vector3<T>::operator + (const Vector3& value) const
 {
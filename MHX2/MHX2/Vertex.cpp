@@ -30,6 +30,11 @@
 
  // std
 #include <memory>
+#include <algorithm>
+#include <cstring>
+
+// classes
+#include "VertexLayout.h"
 
 
 //---------------------------------------------------------------------------
@@ -53,7 +58,8 @@ Material::~Material()
 VertexFormat::VertexFormat() :
     m_Stride(0),
     m_Type(IEType::IE_VT_Unknown),
-    m_Format(IEFormat::IE_VF_None)
+    m_Format(IEFormat::IE_VF_None),
+    m_Storage(IEStorage::IE_VS_Interleaved)
 {}
 //---------------------------------------------------------------------------
 VertexFormat::~VertexFormat()
@@ -79,9 +85,10 @@ void VertexFormat::CalculateStride()
 //---------------------------------------------------------------------------
 bool VertexFormat::CompareFormat(const VertexFormat& other) const
 {
-    return (m_Stride == other.m_Stride &&
-            m_Type   == other.m_Type   &&
-            m_Format == other.m_Format);
+    return (m_Stride  == other.m_Stride &&
+            m_Type    == other.m_Type   &&
+            m_Format  == other.m_Format &&
+            m_Storage == other.m_Storage);
 }
 //---------------------------------------------------------------------------
 // VertexBuffer
@@ -96,22 +103,31 @@ VertexCulling::~VertexCulling()
 //---------------------------------------------------------------------------
 // VertexBuffer
 //---------------------------------------------------------------------------
-VertexBuffer::VertexBuffer()
+VertexBuffer::VertexBuffer() :
+    m_pSource(nullptr)
 {}
 //---------------------------------------------------------------------------
 VertexBuffer::~VertexBuffer()
-{}
+{
+    const std::size_t count = m_Ranges.size();
+
+    // clear the draw ranges
+    for (std::size_t i = 0; i < count; ++i)
+        delete m_Ranges[i];
+}
 //---------------------------------------------------------------------------
 VertexBuffer* VertexBuffer::Clone(bool includeData) const
 {
     // clone vertex
     std::unique_ptr<VertexBuffer> pClone(new VertexBuffer());
-    pClone->m_Name = m_Name;
+    pClone->m_Name    = m_Name;
+    pClone->m_pSource = m_pSource;
 
     // copy the format
-    pClone->m_Format.m_Stride = m_Format.m_Stride;
-    pClone->m_Format.m_Type   = m_Format.m_Type;
-    pClone->m_Format.m_Format = m_Format.m_Format;
+    pClone->m_Format.m_Stride  = m_Format.m_Stride;
+    pClone->m_Format.m_Type    = m_Format.m_Type;
+    pClone->m_Format.m_Format  = m_Format.m_Format;
+    pClone->m_Format.m_Storage = m_Format.m_Storage;
 
     // copy the culling
     pClone->m_Culling.m_Type = m_Culling.m_Type;
@@ -133,6 +149,23 @@ VertexBuffer* VertexBuffer::Clone(bool includeData) const
         // copy the data
         for (std::size_t i = 0; i < dataCount; ++i)
             pClone->m_Data[i] = m_Data[i];
+
+        // copy the planar streams
+        pClone->m_Streams = m_Streams;
+
+        // copy the draw ranges. Like for the buffer material, the textures are not copied
+        for (std::size_t i = 0; i < m_Ranges.size(); ++i)
+        {
+            std::unique_ptr<IRange> pRange(new IRange());
+            pRange->m_Start                  = m_Ranges[i]->m_Start;
+            pRange->m_Count                  = m_Ranges[i]->m_Count;
+            pRange->m_Material.m_Color       = m_Ranges[i]->m_Material.m_Color;
+            pRange->m_Material.m_Transparent = m_Ranges[i]->m_Material.m_Transparent;
+            pRange->m_Material.m_Wireframe   = m_Ranges[i]->m_Material.m_Wireframe;
+
+            pClone->m_Ranges.push_back(pRange.get());
+            pRange.release();
+        }
     }
 
     return pClone.release();
@@ -144,100 +177,344 @@ bool VertexBuffer::Add(const Vector3F*           pVertex,
                              std::size_t         groupIndex,
                        const ITfOnGetVertexColor fOnGetVertexColor)
 {
-    // the stride should be already calculated
+    // a single vertex is a batch of one, in which a missing source is filled with empty data
+    IVertexWriter writer;
+    writer.m_pVB               = this;
+    writer.m_pVertices         = pVertex;
+    writer.m_pNormals          = pNormal;
+    writer.m_pUVs              = pUV;
+    writer.m_Count             = 1;
+    writer.m_GroupIndex        = groupIndex;
+    writer.m_fOnGetVertexColor = fOnGetVertexColor;
+
+    return VertexLayoutDispatcher::Dispatch(m_Format.m_Format, writer);
+}
+//---------------------------------------------------------------------------
+bool VertexBuffer::Add(const Vector3F*           pVertices,
+                       const Vector3F*           pNormals,
+                       const Vector2F*           pUVs,
+                             std::size_t         count,
+                             std::size_t         groupIndex,
+                       const ITfOnGetVertexColor fOnGetVertexColor)
+{
+    // nothing to add?
+    if (!count)
+        return true;
+
+    IVertexWriter writer;
+    writer.m_pVB               = this;
+    writer.m_pVertices         = pVertices;
+    writer.m_pNormals          = pNormals;
+    writer.m_pUVs              = pUVs;
+    writer.m_Count             = count;
+    writer.m_GroupIndex        = groupIndex;
+    writer.m_fOnGetVertexColor = fOnGetVertexColor;
+
+    return VertexLayoutDispatcher::Dispatch(m_Format.m_Format, writer);
+}
+//---------------------------------------------------------------------------
+std::size_t VertexBuffer::GetVertexCount() const
+{
+    if (m_Format.m_Storage == VertexFormat::IEStorage::IE_VS_Planar)
+        return m_Streams.m_Positions.size() / 3;
+
+    // no stride?
     if (!m_Format.m_Stride)
-    {
-        m_Format.CalculateStride();
+        return 0;
 
-        // still empty?
-        if (!m_Format.m_Stride)
-            return false;
+    return m_Data.size() / m_Format.m_Stride;
+}
+//---------------------------------------------------------------------------
+float* VertexBuffer::GetPositions(std::size_t& stride)
+{
+    return const_cast<float*>(static_cast<const VertexBuffer*>(this)->GetPositions(stride));
+}
+//---------------------------------------------------------------------------
+const float* VertexBuffer::GetPositions(std::size_t& stride) const
+{
+    if (m_Format.m_Storage == VertexFormat::IEStorage::IE_VS_Planar)
+    {
+        stride = 3;
+        return m_Streams.m_Positions.empty() ? nullptr : &m_Streams.m_Positions[0];
     }
 
-    // keep the current offset
-    std::size_t offset = m_Data.size();
-
-    // allocate memory for new vertex
-    m_Data.resize(m_Data.size() + m_Format.m_Stride);
+    stride = m_Format.m_Stride;
+    return m_Data.empty() ? nullptr : &m_Data[0];
+}
+//---------------------------------------------------------------------------
+float* VertexBuffer::GetNormals(std::size_t& stride)
+{
+    return const_cast<float*>(static_cast<const VertexBuffer*>(this)->GetNormals(stride));
+}
+//---------------------------------------------------------------------------
+const float* VertexBuffer::GetNormals(std::size_t& stride) const
+{
+    // no normal in the vertex format?
+    if (!((unsigned)m_Format.m_Format & (unsigned)VertexFormat::IEFormat::IE_VF_Normals))
+        return nullptr;
 
-    // source vertex exists?
-    if (!pVertex)
+    if (m_Format.m_Storage == VertexFormat::IEStorage::IE_VS_Planar)
     {
-        // cannot add a nonexistent vertex, fill with empty data in this case
-        m_Data[offset]     = 0.0f;
-        m_Data[offset + 1] = 0.0f;
-        m_Data[offset + 2] = 0.0f;
+        stride = 3;
+        return m_Streams.m_Normals.empty() ? nullptr : &m_Streams.m_Normals[0];
     }
-    else
+
+    // in an interleaved buffer the normal always follows the position
+    stride = m_Format.m_Stride;
+    return m_Data.empty() ? nullptr : &m_Data[3];
+}
+//---------------------------------------------------------------------------
+bool VertexBuffer::SetStorage(VertexFormat::IEStorage storage)
+{
+    // nothing to convert?
+    if (m_Format.m_Storage == storage)
+        return true;
+
+    // the stride should be already calculated
+    if (!m_Format.m_Stride)
+        m_Format.CalculateStride();
+
+    IStorageConverter converter;
+    converter.m_pVB     = this;
+    converter.m_Storage = storage;
+
+    return VertexLayoutDispatcher::Dispatch(m_Format.m_Format, converter);
+}
+//---------------------------------------------------------------------------
+// VertexBuffer::IRange
+//---------------------------------------------------------------------------
+VertexBuffer::IRange::IRange() :
+    m_Start(0),
+    m_Count(0)
+{}
+//---------------------------------------------------------------------------
+VertexBuffer::IRange::~IRange()
+{}
+//---------------------------------------------------------------------------
+// VertexBuffer::ISpan
+//---------------------------------------------------------------------------
+VertexBuffer::ISpan::ISpan() :
+    m_Start(0),
+    m_Count(0)
+{}
+//---------------------------------------------------------------------------
+VertexBuffer::ISpan::~ISpan()
+{}
+//---------------------------------------------------------------------------
+// VertexBuffer::IVertexWriter
+//---------------------------------------------------------------------------
+VertexBuffer::IVertexWriter::IVertexWriter() :
+    m_pVB(nullptr),
+    m_pVertices(nullptr),
+    m_pNormals(nullptr),
+    m_pUVs(nullptr),
+    m_Count(0),
+    m_GroupIndex(0),
+    m_fOnGetVertexColor(nullptr)
+{}
+//---------------------------------------------------------------------------
+VertexBuffer::IVertexWriter::~IVertexWriter()
+{}
+//---------------------------------------------------------------------------
+template <class TLayout>
+bool VertexBuffer::IVertexWriter::Visit()
+{
+    // the stride should be already calculated
+    if (!m_pVB->m_Format.m_Stride)
+        m_pVB->m_Format.m_Stride = TLayout::m_Stride;
+
+    // stride doesn't match with the format?
+    if (m_pVB->m_Format.m_Stride != TLayout::m_Stride)
+        return false;
+
+    // planar storage?
+    if (m_pVB->m_Format.m_Storage == VertexFormat::IEStorage::IE_VS_Planar)
     {
-        // copy vertex from source
-        m_Data[offset]     = pVertex->m_X;
-        m_Data[offset + 1] = pVertex->m_Y;
-        m_Data[offset + 2] = pVertex->m_Z;
+        const std::size_t first = m_pVB->m_Streams.m_Positions.size() / 3;
+
+        // allocate memory for all the new vertices at once
+        m_pVB->m_Streams.m_Positions.resize((first + m_Count) * 3);
+
+        if (TLayout::m_HasNormals)
+            m_pVB->m_Streams.m_Normals.resize((first + m_Count) * 3);
+
+        if (TLayout::m_HasTexCoords)
+            m_pVB->m_Streams.m_TexCoords.resize((first + m_Count) * 2);
+
+        if (TLayout::m_HasColors)
+            m_pVB->m_Streams.m_Colors.resize((first + m_Count) * 4);
+
+        // the vectors contain only their coordinates, thus the sources are copied at once. A missing source keeps
+        // the empty data the streams were resized with
+        if (m_pVertices)
+            std::memcpy(&m_pVB->m_Streams.m_Positions[first * 3], m_pVertices, m_Count * sizeof(Vector3F));
+
+        if (TLayout::m_HasNormals && m_pNormals)
+            std::memcpy(&m_pVB->m_Streams.m_Normals[first * 3], m_pNormals, m_Count * sizeof(Vector3F));
+
+        if (TLayout::m_HasTexCoords && m_pUVs)
+            std::memcpy(&m_pVB->m_Streams.m_TexCoords[first * 2], m_pUVs, m_Count * sizeof(Vector2F));
+
+        if (TLayout::m_HasColors)
+            for (std::size_t i = 0; i < m_Count; ++i)
+            {
+                ColorF color;
+
+                // get the vertex color
+                if (m_fOnGetVertexColor)
+                    color = m_fOnGetVertexColor(m_pVB, m_pNormals ? &m_pNormals[i] : nullptr, m_GroupIndex);
+                else
+                    color = m_pVB->m_Material.m_Color;
+
+                float* pColor = &m_pVB->m_Streams.m_Colors[(first + i) * 4];
+                pColor[0]     = color.m_R;
+                pColor[1]     = color.m_G;
+                pColor[2]     = color.m_B;
+                pColor[3]     = color.m_A;
+            }
+
+        return true;
     }
 
-    offset += 3;
+    // keep the current offset
+    const std::size_t offset = m_pVB->m_Data.size();
+
+    // allocate memory for all the new vertices at once
+    m_pVB->m_Data.resize(offset + m_Count * TLayout::m_Stride);
 
-    // vertex has a normal?
-    if ((unsigned)m_Format.m_Format & (unsigned)VertexFormat::IEFormat::IE_VF_Normals)
+    float* pData = &m_pVB->m_Data[offset];
+
+    for (std::size_t i = 0; i < m_Count; ++i)
     {
-        // source normal exists?
-        if (!pNormal)
-        {
-            // cannot add a nonexistent normal, fill with empty data in this case
-            m_Data[offset]     = 0.0f;
-            m_Data[offset + 1] = 0.0f;
-            m_Data[offset + 2] = 0.0f;
-        }
-        else
+        const Vector3F* pNormal = m_pNormals ? &m_pNormals[i] : nullptr;
+        ColorF          color;
+
+        // get the vertex color
+        if (TLayout::m_HasColors)
         {
-            // copy normal from source
-            m_Data[offset]     = pNormal->m_X;
-            m_Data[offset + 1] = pNormal->m_Y;
-            m_Data[offset + 2] = pNormal->m_Z;
+            if (m_fOnGetVertexColor)
+                color = m_fOnGetVertexColor(m_pVB, pNormal, m_GroupIndex);
+            else
+                color = m_pVB->m_Material.m_Color;
         }
 
-        offset += 3;
+        TLayout::Write(pData,
+                       m_pVertices ? &m_pVertices[i] : nullptr,
+                       pNormal,
+                       m_pUVs      ? &m_pUVs[i]      : nullptr,
+                       color);
+
+        pData += TLayout::m_Stride;
     }
 
-    // vertex has UV texture coordinates?
-    if ((unsigned)m_Format.m_Format & (unsigned)VertexFormat::IEFormat::IE_VF_TexCoords)
+    return true;
+}
+//---------------------------------------------------------------------------
+// VertexBuffer::IStorageConverter
+//---------------------------------------------------------------------------
+VertexBuffer::IStorageConverter::IStorageConverter() :
+    m_pVB(nullptr),
+    m_Storage(VertexFormat::IEStorage::IE_VS_Interleaved)
+{}
+//---------------------------------------------------------------------------
+VertexBuffer::IStorageConverter::~IStorageConverter()
+{}
+//---------------------------------------------------------------------------
+template <class TLayout>
+bool VertexBuffer::IStorageConverter::Visit()
+{
+    // stride doesn't match with the format?
+    if (m_pVB->m_Format.m_Stride != TLayout::m_Stride)
+        return false;
+
+    IData&    data    = m_pVB->m_Data;
+    IStreams& streams = m_pVB->m_Streams;
+
+    switch (m_Storage)
     {
-        // source texture coordinates exists?
-        if (!pUV)
+        case VertexFormat::IEStorage::IE_VS_Planar:
         {
-            // cannot add nonexistent texture coordinates, fill with empty data in this case
-            m_Data[offset]     = 0.0f;
-            m_Data[offset + 1] = 0.0f;
+            const std::size_t count = data.size() / TLayout::m_Stride;
+
+            streams.m_Positions.resize(count * 3);
+            streams.m_Normals.resize  (TLayout::m_HasNormals   ? count * 3 : 0);
+            streams.m_TexCoords.resize(TLayout::m_HasTexCoords ? count * 2 : 0);
+            streams.m_Colors.resize   (TLayout::m_HasColors    ? count * 4 : 0);
+
+            // split the interleaved vertices into streams
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const float* pSrc = &data[i * TLayout::m_Stride];
+
+                std::copy(pSrc, pSrc + 3, &streams.m_Positions[i * 3]);
+
+                if (TLayout::m_HasNormals)
+                    std::copy(pSrc + TLayout::m_NormalOffset,
+                              pSrc + TLayout::m_NormalOffset + 3,
+                             &streams.m_Normals[i * 3]);
+
+                if (TLayout::m_HasTexCoords)
+                    std::copy(pSrc + TLayout::m_TexCoordOffset,
+                              pSrc + TLayout::m_TexCoordOffset + 2,
+                             &streams.m_TexCoords[i * 2]);
+
+                if (TLayout::m_HasColors)
+                    std::copy(pSrc + TLayout::m_ColorOffset,
+                              pSrc + TLayout::m_ColorOffset + 4,
+                             &streams.m_Colors[i * 4]);
+            }
+
+            // release the interleaved data
+            IData().swap(data);
+            break;
         }
-        else
+
+        case VertexFormat::IEStorage::IE_VS_Interleaved:
         {
-            // copy texture coordinates from source
-            m_Data[offset]     = pUV->m_X;
-            m_Data[offset + 1] = pUV->m_Y;
-        }
+            const std::size_t count = streams.m_Positions.size() / 3;
 
-        offset += 2;
-    }
+            // malformed streams?
+            if ((TLayout::m_HasNormals   && streams.m_Normals.size()   != count * 3) ||
+                (TLayout::m_HasTexCoords && streams.m_TexCoords.size() != count * 2) ||
+                (TLayout::m_HasColors    && streams.m_Colors.size()    != count * 4))
+                return false;
 
-    // vertex has color?
-    if ((unsigned)m_Format.m_Format & (unsigned)VertexFormat::IEFormat::IE_VF_Colors)
-    {
-        ColorF color;
+            data.resize(count * TLayout::m_Stride);
 
-        // get the vertex color
-        if (fOnGetVertexColor)
-            color = fOnGetVertexColor(this, pNormal, groupIndex);
-        else
-            color = m_Material.m_Color;
-
-        // set color data
-        m_Data[offset]     = color.m_R;
-        m_Data[offset + 1] = color.m_G;
-        m_Data[offset + 2] = color.m_B;
-        m_Data[offset + 3] = color.m_A;
+            // interleave the streams
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                float* pDst = &data[i * TLayout::m_Stride];
+
+                std::copy(&streams.m_Positions[i * 3], &streams.m_Positions[i * 3] + 3, pDst);
+
+                if (TLayout::m_HasNormals)
+                    std::copy(&streams.m_Normals[i * 3],
+                              &streams.m_Normals[i * 3] + 3,
+                               pDst + TLayout::m_NormalOffset);
+
+                if (TLayout::m_HasTexCoords)
+                    std::copy(&streams.m_TexCoords[i * 2],
+                              &streams.m_TexCoords[i * 2] + 2,
+                               pDst + TLayout::m_TexCoordOffset);
+
+                if (TLayout::m_HasColors)
+                    std::copy(&streams.m_Colors[i * 4],
+                              &streams.m_Colors[i * 4] + 4,
+                               pDst + TLayout::m_ColorOffset);
+            }
+
+            // release the planar data
+            streams = IStreams();
+            break;
+        }
+
+        default:
+            return false;
     }
 
+    m_pVB->m_Format.m_Storage = m_Storage;
+
     return true;
 }
 //---------------------------------------------------------------------------
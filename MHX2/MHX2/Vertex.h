@@ -84,9 +84,19 @@ class VertexFormat
             IE_VF_Colors    = 0x04  // each vertex contains its own color
         };
 
-        std::size_t m_Stride; // vertex stride (i.e. length between each vertex) in bytes
-        IEType      m_Type;   // vertex type (i.e. how vertex is organized: triangle list, triangle fan, ...)
-        IEFormat    m_Format; // vertex format (i.e. what data vertex contains: position, normal, texture, ...)
+        /**
+        * Vertex storage enumeration
+        */
+        enum class IEStorage
+        {
+            IE_VS_Interleaved = 0, // all the vertex values are interleaved in a single array (i.e. array of structures)
+            IE_VS_Planar           // each vertex value kind is tightly packed in its own stream (i.e. structure of arrays)
+        };
+
+        std::size_t m_Stride;  // vertex stride (i.e. length between each vertex) in bytes
+        IEType      m_Type;    // vertex type (i.e. how vertex is organized: triangle list, triangle fan, ...)
+        IEFormat    m_Format;  // vertex format (i.e. what data vertex contains: position, normal, texture, ...)
+        IEStorage   m_Storage; // vertex storage (i.e. how the vertex data are organized in memory)
 
         VertexFormat();
         virtual ~VertexFormat();
@@ -146,11 +156,57 @@ class VertexBuffer
     public:
         typedef std::vector<float> IData;
 
-        std::string   m_Name;
-        VertexFormat  m_Format;
-        VertexCulling m_Culling;
-        Material      m_Material;
-        IData         m_Data;
+        /**
+        * Vertex streams, used when the vertex storage is planar
+        */
+        struct IStreams
+        {
+            IData m_Positions; // x, y and z values
+            IData m_Normals;   // x, y and z values, empty if the vertex format contains no normal
+            IData m_TexCoords; // u and v values, empty if the vertex format contains no texture coordinates
+            IData m_Colors;    // r, g, b and a values, empty if the vertex format contains no color
+        };
+
+        /**
+        * Draw range, a part of the buffer drawn with its own material
+        */
+        struct IRange
+        {
+            std::size_t m_Start;    // first range vertex
+            std::size_t m_Count;    // range vertex count
+            Material    m_Material; // range material
+
+            IRange();
+            virtual ~IRange();
+        };
+
+        typedef std::vector<IRange*> IRanges;
+
+        /**
+        * Visible span, a part of the buffer left to draw, e.g. once its culled clusters were removed
+        */
+        struct ISpan
+        {
+            std::size_t m_Start; // first span vertex
+            std::size_t m_Count; // span vertex count
+
+            ISpan();
+            virtual ~ISpan();
+        };
+
+        typedef std::vector<ISpan> ISpans;
+
+        std::string         m_Name;
+        VertexFormat        m_Format;
+        VertexCulling       m_Culling;
+        Material            m_Material;
+        IData               m_Data;    // interleaved vertex data, empty if the vertex storage is planar
+        IStreams            m_Streams; // planar vertex data, empty if the vertex storage is interleaved
+        IRanges             m_Ranges;  // draw ranges. If empty, the whole buffer is drawn with its material
+        ISpans              m_Visible; // visible spans, sorted by start and never read from the source. If empty, the
+                                       // whole buffer is visible, while a single empty span hides it
+        const VertexBuffer* m_pSource; // source buffer, not owned. If set, the material, the draw ranges and the data
+                                       // left empty in this buffer are read from it
 
         /**
         * Called when a vertex color should be get
@@ -188,6 +244,99 @@ class VertexBuffer
                          const Vector2F*           pUV,
                                std::size_t         groupIndex,
                          const ITfOnGetVertexColor fOnGetVertexColor);
+
+        /**
+        * Adds several vertices to a vertex buffer
+        *@param pVertices - vertices, nullptr if not used
+        *@param pNormals - normals, nullptr if not used
+        *@param pUVs - texture coordinates, nullptr if not used
+        *@param count - vertex count to add, each non-nullptr array should contain this count of items
+        *@param groupIndex - the vertex group index (e.g. the inner and outer vertices of a ring)
+        *@param fOnGetVertexColor - get vertex color callback function to use, nullptr if not used
+        *@return true on success, otherwise false
+        *@note The memory is allocated once for all the vertices
+        */
+        virtual bool Add(const Vector3F*           pVertices,
+                         const Vector3F*           pNormals,
+                         const Vector2F*           pUVs,
+                               std::size_t         count,
+                               std::size_t         groupIndex,
+                         const ITfOnGetVertexColor fOnGetVertexColor);
+
+        /**
+        * Gets the vertex count
+        *@return the vertex count
+        */
+        virtual std::size_t GetVertexCount() const;
+
+        /**
+        * Gets the vertex positions
+        *@param[out] stride - length between each position, in values
+        *@return the first position, nullptr if the buffer is empty
+        *@note The positions are tightly packed (i.e. stride is 3) if the vertex storage is planar
+        */
+        virtual       float* GetPositions(std::size_t& stride);
+        virtual const float* GetPositions(std::size_t& stride) const;
+
+        /**
+        * Gets the vertex normals
+        *@param[out] stride - length between each normal, in values
+        *@return the first normal, nullptr if the buffer is empty or its format contains no normal
+        *@note The normals are tightly packed (i.e. stride is 3) if the vertex storage is planar
+        */
+        virtual       float* GetNormals(std::size_t& stride);
+        virtual const float* GetNormals(std::size_t& stride) const;
+
+        /**
+        * Changes the vertex storage, and converts the existing data to the new storage
+        *@param storage - new vertex storage
+        *@return true on success, otherwise false
+        */
+        virtual bool SetStorage(VertexFormat::IEStorage storage);
+
+    private:
+        /**
+        * Vertex writer, writes the vertices using the compile-time layout matching with the buffer format
+        */
+        struct IVertexWriter
+        {
+            VertexBuffer*       m_pVB;
+            const Vector3F*     m_pVertices;
+            const Vector3F*     m_pNormals;
+            const Vector2F*     m_pUVs;
+            std::size_t         m_Count;
+            std::size_t         m_GroupIndex;
+            ITfOnGetVertexColor m_fOnGetVertexColor;
+
+            IVertexWriter();
+            virtual ~IVertexWriter();
+
+            /**
+            * Writes the vertices
+            *@return true on success, otherwise false
+            */
+            template <class TLayout>
+            bool Visit();
+        };
+
+        /**
+        * Storage converter, converts the vertices using the compile-time layout matching with the buffer format
+        */
+        struct IStorageConverter
+        {
+            VertexBuffer*           m_pVB;
+            VertexFormat::IEStorage m_Storage;
+
+            IStorageConverter();
+            virtual ~IStorageConverter();
+
+            /**
+            * Converts the vertices
+            *@return true on success, otherwise false
+            */
+            template <class TLayout>
+            bool Visit();
+        };
 };
 
 /**
@@ -0,0 +1,170 @@
+/****************************************************************************
+ * ==> VertexLayout --------------------------------------------------------*
+ ****************************************************************************
+ * Description : Compile-time vertex layouts                                *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+#pragma once
+
+// std
+#include <cstddef>
+
+// classes
+#include "Vertex.h"
+
+/**
+* Compile-time vertex layout, the stride and the data offsets are known at compile time
+*@author Jean-Milost Reymond
+*/
+template <bool HasNormals, bool HasTexCoords, bool HasColors>
+class VertexLayout
+{
+    public:
+        static constexpr bool                   m_HasNormals     = HasNormals;
+        static constexpr bool                   m_HasTexCoords   = HasTexCoords;
+        static constexpr bool                   m_HasColors      = HasColors;
+        static constexpr std::size_t            m_NormalOffset   = 3;
+        static constexpr std::size_t            m_TexCoordOffset = m_NormalOffset   + (HasNormals   ? 3 : 0);
+        static constexpr std::size_t            m_ColorOffset    = m_TexCoordOffset + (HasTexCoords ? 2 : 0);
+        static constexpr std::size_t            m_Stride         = m_ColorOffset    + (HasColors    ? 4 : 0);
+        static constexpr VertexFormat::IEFormat m_Format         =
+                (VertexFormat::IEFormat)((HasNormals   ? (unsigned)VertexFormat::IEFormat::IE_VF_Normals   : 0) |
+                                         (HasTexCoords ? (unsigned)VertexFormat::IEFormat::IE_VF_TexCoords : 0) |
+                                         (HasColors    ? (unsigned)VertexFormat::IEFormat::IE_VF_Colors    : 0));
+
+        /**
+        * Writes a vertex
+        *@param pData - vertex data to write to, should contain at least m_Stride values
+        *@param pVertex - vertex, zero is written if nullptr
+        *@param pNormal - normal, zero is written if nullptr
+        *@param pUV - texture coordinate, zero is written if nullptr
+        *@param color - vertex color
+        */
+        static inline void Write(      float*    pData,
+                                 const Vector3F* pVertex,
+                                 const Vector3F* pNormal,
+                                 const Vector2F* pUV,
+                                 const ColorF&   color);
+};
+
+template <bool HasNormals, bool HasTexCoords, bool HasColors>
+constexpr bool VertexLayout<HasNormals, HasTexCoords, HasColors>::m_HasNormals;
+template <bool HasNormals, bool HasTexCoords, bool HasColors>
+constexpr bool VertexLayout<HasNormals, HasTexCoords, HasColors>::m_HasTexCoords;
+template <bool HasNormals, bool HasTexCoords, bool HasColors>
+constexpr bool VertexLayout<HasNormals, HasTexCoords, HasColors>::m_HasColors;
+template <bool HasNormals, bool HasTexCoords, bool HasColors>
+constexpr std::size_t VertexLayout<HasNormals, HasTexCoords, HasColors>::m_NormalOffset;
+template <bool HasNormals, bool HasTexCoords, bool HasColors>
+constexpr std::size_t VertexLayout<HasNormals, HasTexCoords, HasColors>::m_TexCoordOffset;
+template <bool HasNormals, bool HasTexCoords, bool HasColors>
+constexpr std::size_t VertexLayout<HasNormals, HasTexCoords, HasColors>::m_ColorOffset;
+template <bool HasNormals, bool HasTexCoords, bool HasColors>
+constexpr std::size_t VertexLayout<HasNormals, HasTexCoords, HasColors>::m_Stride;
+template <bool HasNormals, bool HasTexCoords, bool HasColors>
+constexpr VertexFormat::IEFormat VertexLayout<HasNormals, HasTexCoords, HasColors>::m_Format;
+
+/**
+* Vertex layout dispatcher, selects the compile-time layout matching with a runtime vertex format
+*@author Jean-Milost Reymond
+*/
+class VertexLayoutDispatcher
+{
+    public:
+        /**
+        * Calls the visitor with the layout matching with a vertex format
+        *@param format - vertex format
+        *@param visitor - visitor, should provide a template <class TLayout> bool Visit() function
+        *@return the visitor result
+        *@note This is the only place where the vertex format flags are tested, the visitor code is fully
+        *      specialized for each layout
+        */
+        template <class TVisitor>
+        static inline bool Dispatch(VertexFormat::IEFormat format, TVisitor& visitor);
+};
+
+//---------------------------------------------------------------------------
+// VertexLayout
+//---------------------------------------------------------------------------
+template <bool HasNormals, bool HasTexCoords, bool HasColors>
+void VertexLayout<HasNormals, HasTexCoords, HasColors>::Write(      float*    pData,
+                                                              const Vector3F* pVertex,
+                                                              const Vector3F* pNormal,
+                                                              const Vector2F* pUV,
+                                                              const ColorF&   color)
+{
+    // write the vertex position
+    pData[0] = pVertex ? pVertex->m_X : 0.0f;
+    pData[1] = pVertex ? pVertex->m_Y : 0.0f;
+    pData[2] = pVertex ? pVertex->m_Z : 0.0f;
+
+    // vertex has a normal?
+    if (HasNormals)
+    {
+        pData[m_NormalOffset]     = pNormal ? pNormal->m_X : 0.0f;
+        pData[m_NormalOffset + 1] = pNormal ? pNormal->m_Y : 0.0f;
+        pData[m_NormalOffset + 2] = pNormal ? pNormal->m_Z : 0.0f;
+    }
+
+    // vertex has UV texture coordinates?
+    if (HasTexCoords)
+    {
+        pData[m_TexCoordOffset]     = pUV ? pUV->m_X : 0.0f;
+        pData[m_TexCoordOffset + 1] = pUV ? pUV->m_Y : 0.0f;
+    }
+
+    // vertex has color?
+    if (HasColors)
+    {
+        pData[m_ColorOffset]     = color.m_R;
+        pData[m_ColorOffset + 1] = color.m_G;
+        pData[m_ColorOffset + 2] = color.m_B;
+        pData[m_ColorOffset + 3] = color.m_A;
+    }
+}
+//---------------------------------------------------------------------------
+// VertexLayoutDispatcher
+//---------------------------------------------------------------------------
+template <class TVisitor>
+bool VertexLayoutDispatcher::Dispatch(VertexFormat::IEFormat format, TVisitor& visitor)
+{
+    const unsigned flags = (unsigned)format & ((unsigned)VertexFormat::IEFormat::IE_VF_Normals   |
+                                               (unsigned)VertexFormat::IEFormat::IE_VF_TexCoords |
+                                               (unsigned)VertexFormat::IEFormat::IE_VF_Colors);
+
+    switch (flags)
+    {
+        case 0x00: return visitor.template Visit<VertexLayout<false, false, false>>();
+        case 0x01: return visitor.template Visit<VertexLayout<true,  false, false>>();
+        case 0x02: return visitor.template Visit<VertexLayout<false, true,  false>>();
+        case 0x03: return visitor.template Visit<VertexLayout<true,  true,  false>>();
+        case 0x04: return visitor.template Visit<VertexLayout<false, false, true>>();
+        case 0x05: return visitor.template Visit<VertexLayout<true,  false, true>>();
+        case 0x06: return visitor.template Visit<VertexLayout<false, true,  true>>();
+        case 0x07: return visitor.template Visit<VertexLayout<true,  true,  true>>();
+        default:   return false;
+    }
+}
+//---------------------------------------------------------------------------
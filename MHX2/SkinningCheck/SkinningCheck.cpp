@@ -0,0 +1,279 @@
+/****************************************************************************
+ * ==> SkinningCheck -------------------------------------------------------*
+ ****************************************************************************
+ * Description : Checks the SIMD skinning kernels against the scalar one    *
+ * Developer   : Jean-Milost Reymond                                        *
+ ****************************************************************************
+ * MIT License - mhx2 reader                                                *
+ *                                                                          *
+ * Permission is hereby granted, free of charge, to any person obtaining a  *
+ * copy of this software and associated documentation files (the            *
+ * "Software"), to deal in the Software without restriction, including      *
+ * without limitation the rights to use, copy, modify, merge, publish,      *
+ * distribute, sublicense, and/or sell copies of the Software, and to       *
+ * permit persons to whom the Software is furnished to do so, subject to    *
+ * the following conditions:                                                *
+ *                                                                          *
+ * The above copyright notice and this permission notice shall be included  *
+ * in all copies or substantial portions of the Software.                   *
+ *                                                                          *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS  *
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF               *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.   *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY     *
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,     *
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE        *
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                   *
+ ****************************************************************************/
+
+// std
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <random>
+
+// classes
+#include "Quaternion.h"
+#include "SkinningHelper.h"
+
+//------------------------------------------------------------------------------
+const std::size_t g_BoneCount   = 64;
+const std::size_t g_VertexCount = 1021; // not a multiple of the SIMD widths, thus the tails are also checked
+const float       g_Tolerance   = 1e-5f;
+//------------------------------------------------------------------------------
+std::mt19937 g_Random(1);
+//------------------------------------------------------------------------------
+/**
+* Skinning check buffers
+*/
+struct ISkinBuffers
+{
+    Model::IMatrices            m_Bones;
+    SkinningHelper::IPalette    m_Palette;
+    SkinningHelper::IPalette    m_DQPalette;
+    std::vector<unsigned short> m_BoneIndices;
+    std::vector<float>          m_Weights;
+    std::vector<float>          m_Src;
+};
+//------------------------------------------------------------------------------
+/**
+* Gets a random value
+*@param min - min value
+*@param max - max value
+*@return random value between min and max
+*/
+float GetRandom(float min, float max)
+{
+    return std::uniform_real_distribution<float>(min, max)(g_Random);
+}
+//------------------------------------------------------------------------------
+/**
+* Builds the skinning buffers, with rigid bone transformations, thus both skinning methods may use them
+*@param slotCount - influence slot count per vertex
+*@param stride - vertex stride in floats, the normal follows the position if at least 6
+*@param[out] buffers - buffers to build
+*/
+void BuildSkinBuffers(std::size_t slotCount, std::size_t stride, ISkinBuffers& buffers)
+{
+    buffers.m_Bones.resize(g_BoneCount);
+
+    for (std::size_t i = 0; i < g_BoneCount; ++i)
+    {
+        const QuaternionF rotation = QuaternionF(GetRandom(-1.0f, 1.0f),
+                                                 GetRandom(-1.0f, 1.0f),
+                                                 GetRandom(-1.0f, 1.0f),
+                                                 GetRandom(-1.0f, 1.0f)).Normalize();
+
+        buffers.m_Bones[i]               = rotation.ToMatrix();
+        buffers.m_Bones[i].m_Table[3][0] = GetRandom(-5.0f, 5.0f);
+        buffers.m_Bones[i].m_Table[3][1] = GetRandom(-5.0f, 5.0f);
+        buffers.m_Bones[i].m_Table[3][2] = GetRandom(-5.0f, 5.0f);
+    }
+
+    SkinningHelper::BuildPalette(buffers.m_Bones, buffers.m_Palette);
+    SkinningHelper::BuildDQPalette(buffers.m_Bones, buffers.m_DQPalette);
+
+    buffers.m_BoneIndices.resize(g_VertexCount * slotCount);
+    buffers.m_Weights.resize(g_VertexCount * slotCount);
+
+    // the weights are sorted by decreasing value, and sum to 1. The last vertices keep a single influence, thus the
+    // empty slots are also checked
+    for (std::size_t i = 0; i < g_VertexCount; ++i)
+    {
+        const std::size_t usedSlots = (i < g_VertexCount - 16) ? slotCount : 1;
+              float       total     = 0.0f;
+
+        for (std::size_t j = 0; j < slotCount; ++j)
+        {
+            buffers.m_BoneIndices[i * slotCount + j] = (unsigned short)(g_Random() % g_BoneCount);
+            buffers.m_Weights[i * slotCount + j]     = (j < usedSlots) ? 1.0f / float(j + 1) : 0.0f;
+            total                                    += buffers.m_Weights[i * slotCount + j];
+        }
+
+        for (std::size_t j = 0; j < slotCount; ++j)
+            buffers.m_Weights[i * slotCount + j] /= total;
+    }
+
+    buffers.m_Src.resize(g_VertexCount * stride);
+
+    for (std::size_t i = 0; i < buffers.m_Src.size(); ++i)
+        buffers.m_Src[i] = GetRandom(-1.0f, 1.0f);
+}
+//------------------------------------------------------------------------------
+/**
+* Skins the buffers with a kernel
+*@param buffers - skinning buffers
+*@param method - skinning method
+*@param kernel - skinning kernel
+*@param slotCount - influence slot count per vertex
+*@param stride - vertex stride in floats
+*@param normals - if true, the normals are also skinned
+*@param[out] dst - skinned vertices
+*@return true on success, otherwise false
+*/
+bool Skin(ISkinBuffers&            buffers,
+          SkinningHelper::IEMethod method,
+          SkinningHelper::IEKernel kernel,
+          std::size_t              slotCount,
+          std::size_t              stride,
+          bool                     normals,
+          std::vector<float>&      dst)
+{
+    const bool dualQuaternion = (method == SkinningHelper::IEMethod::IE_M_DualQuaternion);
+
+    // the destination is filled with the source, thus the values the kernels don't write are identical
+    dst = buffers.m_Src;
+
+    SkinningHelper::ISkinData data;
+    data.m_Method       = method;
+    data.m_pPalette     = dualQuaternion ? &buffers.m_DQPalette[0] : &buffers.m_Palette[0];
+    data.m_pBoneIndices = &buffers.m_BoneIndices[0];
+    data.m_pWeights     = &buffers.m_Weights[0];
+    data.m_pSrc         = &buffers.m_Src[0];
+    data.m_pDst         = &dst[0];
+    data.m_pSrcNormals  = normals ? &buffers.m_Src[3] : nullptr;
+    data.m_pDstNormals  = normals ? &dst[3] : nullptr;
+    data.m_SlotCount    = slotCount;
+    data.m_Stride       = stride;
+    data.m_NormalStride = normals ? stride : 0;
+    data.m_Count        = g_VertexCount;
+
+    return SkinningHelper::Skin(data, kernel);
+}
+//------------------------------------------------------------------------------
+/**
+* Gets a kernel name
+*@param kernel - kernel
+*@return kernel name
+*/
+const char* GetKernelName(SkinningHelper::IEKernel kernel)
+{
+    switch (kernel)
+    {
+        case SkinningHelper::IEKernel::IE_K_Scalar: return "scalar";
+        case SkinningHelper::IEKernel::IE_K_SSE41:  return "sse4.1";
+        case SkinningHelper::IEKernel::IE_K_AVX2:   return "avx2";
+        case SkinningHelper::IEKernel::IE_K_AVX512: return "avx-512";
+        default:                                    return "unknown";
+    }
+}
+//------------------------------------------------------------------------------
+/**
+* Checks a kernel against the scalar kernel
+*@param kernel - skinning kernel to check
+*@param method - skinning method
+*@param slotCount - influence slot count per vertex
+*@param stride - vertex stride in floats
+*@param normals - if true, the normals are also skinned
+*@return true if the kernel matches the scalar kernel, otherwise false
+*/
+bool CheckKernel(SkinningHelper::IEKernel kernel,
+                 SkinningHelper::IEMethod method,
+                 std::size_t              slotCount,
+                 std::size_t              stride,
+                 bool                     normals)
+{
+    ISkinBuffers buffers;
+    BuildSkinBuffers(slotCount, stride, buffers);
+
+    std::vector<float> expected;
+    std::vector<float> result;
+
+    if (!Skin(buffers, method, SkinningHelper::IEKernel::IE_K_Scalar, slotCount, stride, normals, expected))
+    {
+        std::printf("FAILED - the scalar kernel could not skin the vertices\n");
+        return false;
+    }
+
+    if (!Skin(buffers, method, kernel, slotCount, stride, normals, result))
+    {
+        std::printf("FAILED - the %s kernel could not skin the vertices\n", GetKernelName(kernel));
+        return false;
+    }
+
+    float maxDiff = 0.0f;
+
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        const float diff = std::fabs(result[i] - expected[i]);
+
+        // NaN values are reported as a failure
+        if (!(diff <= maxDiff))
+            maxDiff = diff;
+    }
+
+    const bool success = (maxDiff <= g_Tolerance);
+
+    std::printf("%-10s %-6s %6u %7u %8s %14g %s\n",
+                GetKernelName(kernel),
+                (method == SkinningHelper::IEMethod::IE_M_DualQuaternion) ? "dq" : "linear",
+                unsigned(slotCount),
+                unsigned(stride),
+                normals ? "yes" : "no",
+                maxDiff,
+                success ? "ok" : "FAILED");
+
+    return success;
+}
+//------------------------------------------------------------------------------
+int main()
+{
+    const SkinningHelper::IEMethod methods[2]    = {SkinningHelper::IEMethod::IE_M_Linear,
+                                                    SkinningHelper::IEMethod::IE_M_DualQuaternion};
+    const std::size_t              slotCounts[3] = {2, 4, 8};
+    const std::size_t              strides[2]    = {3, 8};
+
+    std::printf("%-10s %-6s %6s %7s %8s %14s\n", "kernel", "method", "slots", "stride", "normals", "max diff");
+
+    bool success = true;
+
+    for (int i = int(SkinningHelper::IEKernel::IE_K_SSE41); i <= int(SkinningHelper::IEKernel::IE_K_AVX512); ++i)
+    {
+        const SkinningHelper::IEKernel kernel = SkinningHelper::IEKernel(i);
+
+        if (!SkinningHelper::IsSupported(kernel))
+        {
+            std::printf("%-10s skipped, not supported by this CPU\n", GetKernelName(kernel));
+            continue;
+        }
+
+        for (std::size_t j = 0; j < 2; ++j)
+            for (std::size_t k = 0; k < 3; ++k)
+                for (std::size_t l = 0; l < 2; ++l)
+                {
+                    // the normals may only follow the positions if the stride contains them
+                    success &= CheckKernel(kernel, methods[j], slotCounts[k], strides[l], false);
+
+                    if (strides[l] >= 6)
+                        success &= CheckKernel(kernel, methods[j], slotCounts[k], strides[l], true);
+                }
+    }
+
+    if (success)
+        std::printf("\nAll the kernels match the scalar kernel\n");
+    else
+        std::printf("\nSome kernels don't match the scalar kernel\n");
+
+    return success ? 0 : 1;
+}
+//------------------------------------------------------------------------------